@@ -36,8 +36,10 @@
 #include <cassert>
 
 #include "appwindow.h"
+#include "database-mirror.h"
 #include "databasesettingsdialog.h"
 #include "error.h"
+#include "trace.h"
 
 Glib::RefPtr<Application> app{};
 
@@ -45,8 +47,11 @@ Application::Application(int argc,char **argv):
 	Gtk::Application(argc,argv, "growbook.org"),
 	m_settings_{Settings::create(argc,argv)},
 	m_database_{},
+	m_backup_scheduler_{},
+	m_backup_error_{},
 	m_appwindow_{nullptr}
 {
+	TRACE_SCOPE("startup","Application::Application");
 	setlocale(LC_ALL,"");
 	bindtextdomain(GETTEXT_PACKAGE,m_settings_->get_locale_dir ().c_str());
 	textdomain(GETTEXT_PACKAGE);
@@ -55,6 +60,7 @@ Application::Application(int argc,char **argv):
 #endif
 
 	m_settings_->load();
+	db_set_sql_dir(m_settings_->get_sql_dir());
 }
 
 Application::~Application()
@@ -72,6 +78,7 @@ Application::create(int argc, char **argv)
 void
 Application::on_activate()
 {
+	TRACE_SCOPE("startup","Application::on_activate");
 	if (m_settings_->get_first_run()) {
 		DatabaseSettingsDialog dialog{m_settings_->get_database_settings()};
 		dialog.run();
@@ -85,6 +92,9 @@ Application::on_activate()
 	    && ! Glib::file_test(dbsettings->get_dbname(),Glib::FILE_TEST_EXISTS)) {
 		create_db=true;
 	}
+
+	// a sqlite3 book is local already
+	bool use_mirror = (m_settings_->get_db_mirror() && !dbsettings->get_dbname_is_filename());
 	
 	if (dbsettings->get_ask_password () && dbsettings->get_password().empty()) {
 		int retry=0;
@@ -133,7 +143,10 @@ Application::on_activate()
 
 		m_database_ = module->create_database(m_settings_->get_database_settings());
 		try {
-			m_database_->connect();
+			// the mirror connects the remote database when it syncs, so
+			// the book opens while the server can not be reached
+			if (!use_mirror)
+				m_database_->connect();
 		} catch (DatabaseError ex) {
 			Gtk::MessageDialog dialog(_("Unable to connect to database!"),
 			                          false,
@@ -175,6 +188,36 @@ Application::on_activate()
 	}
 	if (create_db)
 		m_database_->create_database();
+
+	if (use_mirror) {
+		std::string mirror_file = m_settings_->get_db_mirror_file();
+		g_mkdir_with_parents(Glib::path_get_dirname(mirror_file).c_str(),0700);
+
+		Glib::RefPtr<DatabaseMirror> mirror = DatabaseMirror::create(m_database_,mirror_file);
+		try {
+			mirror->connect();
+		} catch (DatabaseError ex) {
+			Gtk::MessageDialog dialog(_("Unable to open the local mirror of the database!"),
+			                          false,
+			                          Gtk::MESSAGE_ERROR,
+			                          Gtk::BUTTONS_OK,
+			                          false);
+			dialog.set_secondary_text (ex.get_message());
+			dialog.run();
+			dialog.hide();
+			exit(EXIT_FAILURE);
+		}
+		mirror->start_sync(MIRROR_SYNC_INTERVAL);
+		m_database_ = mirror;
+	}
+
+	if (!m_backup_scheduler_) {
+		m_backup_scheduler_ = BackupScheduler::create(m_settings_,m_database_);
+		m_backup_scheduler_->signal_error().connect(sigc::mem_fun(*this,&Application::on_backup_error));
+		m_backup_scheduler_->signal_finished().connect(sigc::mem_fun(*this,&Application::on_backup_finished));
+		m_settings_->signal_save().connect(sigc::mem_fun(*this,&Application::on_settings_saved));
+		m_backup_scheduler_->start();
+	}
 		
 	if (!m_appwindow_) {
 		m_appwindow_ = new AppWindow(m_settings_,m_database_);
@@ -193,6 +236,33 @@ Application::on_hide_window(AppWindow *window)
 	delete window;
 }
 
+void
+Application::on_backup_error(const Glib::ustring &message)
+{
+	fprintf(stderr,"%s\n%s\n",_("Backup of the database failed!"),message.c_str());
+
+	// the scheduler tries again every BACKUP_CHECK_INTERVAL seconds, the
+	// same error is shown once
+	if (m_appwindow_ && message != m_backup_error_) {
+		m_appwindow_->show_backup_error(message);
+		m_backup_error_ = message;
+	}
+}
+
+void
+Application::on_backup_finished(const std::string &filename)
+{
+	m_backup_error_.clear();
+}
+
+void
+Application::on_settings_saved()
+{
+	// picks up changed backup settings
+	if (m_backup_scheduler_)
+		m_backup_scheduler_->start();
+}
+
 AppWindow*
 Application::get_appwindow()
 {
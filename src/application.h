@@ -30,6 +30,7 @@
 #include <gtkmm/application.h>
 
 #include "appwindow.h"
+#include "backup.h"
 #include "settings.h"
 #include "database.h"
 
@@ -39,6 +40,9 @@ class Application:
 	 private:
 		Glib::RefPtr<Settings> m_settings_;
 		Glib::RefPtr<Database> m_database_;
+		Glib::RefPtr<BackupScheduler> m_backup_scheduler_;
+		// the last backup error shown, until a backup succeeds again
+		Glib::ustring m_backup_error_;
 	 	AppWindow *m_appwindow_;
 	 
 	 protected:
@@ -53,6 +57,9 @@ class Application:
 		 void on_activate();
 	private:
 		 void on_hide_window(AppWindow* appwindow);
+		 void on_backup_error(const Glib::ustring &message);
+		 void on_backup_finished(const std::string &filename);
+		 void on_settings_saved();
 		 
 	public:
 		 AppWindow* get_appwindow();
@@ -29,19 +29,24 @@
 #include <gtkmm/menu.h>
 #include <gtkmm/messagedialog.h>
 #include <gtkmm/paned.h>
+#include <gtkmm/progressbar.h>
 #include <gtkmm/image.h>
 #include <gtkmm/button.h>
 #include <gtkmm/separatormenuitem.h>
+#include <glibmm/main.h>
 
 #include <cassert>
 
 #include "databasesettingsdialog.h"
 #include "settingsdialog.h"
 #include "aboutdialog.h"
+#include "diagnosticsdialog.h"
 #include "growlogview.h"
 #include "application.h"
-#include "export.h"
-#include "import.h"
+#include "error.h"
+#include "exportdialog.h"
+#include "importdialog.h"
+#include "trace.h"
 
 #include <iostream>
 
@@ -51,11 +56,27 @@ AppWindow::AppWindow(const Glib::RefPtr<Settings> &settings,
 	m_settings_{settings},
 	m_database_{database},
 	m_menubar_{},
+	m_export_menuitem_{nullptr},
+	m_import_menuitem_{nullptr},
 	m_growlog_selector_{database},
 	m_strain_selector_{database},
 	m_selector_notebook_{},
-	m_browser_notebook_{}
+	m_browser_notebook_{},
+	m_strain_index_{},
+	m_loader_thread_{},
+	m_loader_dispatcher_{},
+	m_growlog_selector_data_{},
+	m_strain_selector_data_{},
+	m_loader_strain_index_{},
+	m_loader_error_{},
+	m_loader_database_{},
+	m_index_pending_{false},
+	m_ongoing_growlogs_{},
+	m_mirror_conflicts_{},
+	m_mirror_refresh_pending_{false},
+	m_backup_error_{}
 {
+	TRACE_SCOPE("startup","AppWindow::AppWindow");
 	assert(settings);
 	assert(database);
 
@@ -71,15 +92,6 @@ AppWindow::AppWindow(const Glib::RefPtr<Settings> &settings,
 	paned->add1(m_selector_notebook_);
 
 	m_browser_notebook_.set_scrollable(true);
-	// open ongoing growlogs
-	if (settings->get_open_ongoing_growlogs()) {
-		std::list<Glib::RefPtr<Growlog> > growlogs{m_database_->get_ongoing_growlogs()};
-		for (auto iter = growlogs.begin(); iter != growlogs.end(); ++iter) {
-			GrowlogView *glv = Gtk::manage(new GrowlogView(m_database_,*iter));
-			if (add_browser_page(*glv) == -1)
-				delete glv;
-		}
-	}
 	paned->add2(m_browser_notebook_);
 	
 	box->pack_start(*paned,true,true,0);
@@ -89,10 +101,21 @@ AppWindow::AppWindow(const Glib::RefPtr<Settings> &settings,
 	add(*box);
 	set_title(_("GrowBook"));
 	show_all();
+
+	m_loader_dispatcher_.connect(sigc::mem_fun(*this,&AppWindow::on_loader_finished));
+	_load_async();
+
+	Glib::RefPtr<DatabaseMirror> mirror = Glib::RefPtr<DatabaseMirror>::cast_dynamic(m_database_);
+	if (mirror) {
+		mirror->signal_synced().connect(sigc::mem_fun(*this,&AppWindow::on_mirror_synced));
+		mirror->signal_conflict().connect(sigc::mem_fun(*this,&AppWindow::on_mirror_conflict));
+	}
 }
 
 AppWindow::~AppWindow()
 {
+	if (m_loader_thread_.joinable())
+		m_loader_thread_.join();
 }
 
 void
@@ -106,10 +129,12 @@ AppWindow::_add_menu()
 	Gtk::MenuItem *menuitem = Gtk::manage(new Gtk::MenuItem(_("Export")));
 	menuitem->signal_activate().connect(sigc::mem_fun(*this,&AppWindow::on_export));
 	submenu_file->append(*menuitem);
+	m_export_menuitem_ = menuitem;
 
 	menuitem = Gtk::manage(new Gtk::MenuItem(_("Import")));
 	menuitem->signal_activate().connect(sigc::mem_fun(*this,&AppWindow::on_import));
 	submenu_file->append(*menuitem);
+	m_import_menuitem_ = menuitem;
 
 	submenu_file->append(*Gtk::manage(new Gtk::SeparatorMenuItem()));
 	
@@ -139,6 +164,10 @@ AppWindow::_add_menu()
 	Gtk::Menu *submenu_help = Gtk::manage(new Gtk::Menu());
 	menuitem_help->set_submenu(*submenu_help);
 
+	menuitem = Gtk::manage(new Gtk::MenuItem(_("Diagnostics")));
+	menuitem->signal_activate().connect(sigc::mem_fun(*this,&AppWindow::on_diagnostics));
+	submenu_help->append(*menuitem);
+
 	menuitem = Gtk::manage(new Gtk::MenuItem(_("About")));
 	menuitem->signal_activate().connect(sigc::mem_fun(*this,&AppWindow::on_about));
 	submenu_help->append(*menuitem);
@@ -146,6 +175,247 @@ AppWindow::_add_menu()
 	m_menubar_.append(*menuitem_help);
 }
 
+void
+AppWindow::_show_error(const Glib::ustring &message,const Glib::ustring &details)
+{
+	Gtk::MessageDialog dialog{*this,
+	                          message,
+	                          false,
+	                          Gtk::MESSAGE_ERROR,
+	                          Gtk::BUTTONS_OK,
+	                          true};
+	dialog.set_secondary_text(details);
+	dialog.run();
+	dialog.hide();
+}
+
+void
+AppWindow::_load_async()
+{
+	if (m_loader_thread_.joinable())
+		return;
+
+	// The database connection is not shared with the main thread while the
+	// loader runs: the selectors are insensitive until on_loader_finished()
+	// and export and import are disabled.
+	m_growlog_selector_.set_loading();
+	m_strain_selector_.set_loading();
+	m_export_menuitem_->set_sensitive(false);
+	m_import_menuitem_->set_sensitive(false);
+
+	m_loader_thread_ = std::thread(&AppWindow::_loader_thread,this);
+}
+
+// Rows that arrive without change signals are put into the strain index by
+// building it anew on the loader thread. The current index answers lookups
+// until on_loader_finished() hands it the new contents. The loader gets a
+// connection of its own, the window goes on using the database meanwhile.
+void
+AppWindow::_build_index_async()
+{
+	if (!m_strain_index_)
+		return;
+	if (m_loader_thread_.joinable()) {
+		m_index_pending_ = true;
+		return;
+	}
+
+	Glib::RefPtr<DatabaseSettings> settings = m_database_->get_settings();
+	Glib::RefPtr<DatabaseModule> module = db_get_module(settings->get_engine());
+	if (!module)
+		return;
+	m_loader_database_ = module->create_database(DatabaseSettings::create(settings->get_engine(),
+	                                                                      settings->get_dbname(),
+	                                                                      settings->get_host(),
+	                                                                      settings->get_port(),
+	                                                                      settings->get_user(),
+	                                                                      settings->get_password(),
+	                                                                      false,
+	                                                                      settings->get_flags()));
+	m_loader_thread_ = std::thread(&AppWindow::_loader_thread,this);
+}
+
+void
+AppWindow::_loader_thread()
+{
+	trace_set_thread_name("loader");
+	TRACE_SCOPE("startup","AppWindow::_loader_thread");
+
+	const Glib::RefPtr<Database> &database = (m_loader_database_ ? m_loader_database_ : m_database_);
+	try {
+		if (m_loader_database_) {
+			m_loader_database_->connect();
+		} else {
+			GrowlogSelector::TreeView::load_data(m_database_,m_growlog_selector_data_);
+			StrainSelector::TreeView::load_data(m_database_,m_strain_selector_data_);
+		}
+
+		m_loader_strain_index_ = StrainIndex::create();
+		m_loader_strain_index_->build(database);
+		if (m_loader_database_)
+			m_loader_database_->close();
+	} catch (DatabaseError &ex) {
+		m_loader_error_ = ex.what();
+	}
+	m_loader_dispatcher_.emit();
+}
+
+void
+AppWindow::on_loader_finished()
+{
+	TRACE_SCOPE("startup","AppWindow::on_loader_finished");
+	m_loader_thread_.join();
+
+	bool index_only = static_cast<bool>(m_loader_database_);
+	m_loader_database_.reset();
+	if (!index_only) {
+		m_growlog_selector_.set_data(m_growlog_selector_data_);
+		m_strain_selector_.set_data(m_strain_selector_data_);
+
+		// Each growlog page is created from its own idle callback, so the
+		// window keeps handling events while the pages are opened.
+		if (m_settings_->get_open_ongoing_growlogs()) {
+			m_ongoing_growlogs_ = m_growlog_selector_data_.ongoing_growlogs;
+			if (!m_ongoing_growlogs_.empty())
+				Glib::signal_idle().connect(sigc::mem_fun(*this,&AppWindow::on_open_ongoing_growlog));
+		}
+		m_growlog_selector_data_ = GrowlogSelector::Data();
+		m_strain_selector_data_ = StrainSelector::Data();
+		m_export_menuitem_->set_sensitive(true);
+		m_import_menuitem_->set_sensitive(true);
+	}
+
+	// From now on the index follows the changes made through the database.
+	// A rebuilt index hands its contents to the one the strain choosers
+	// hold already.
+	if (m_loader_strain_index_ && m_loader_error_.empty()) {
+		if (m_strain_index_) {
+			m_strain_index_->swap(m_loader_strain_index_);
+		} else {
+			m_strain_index_ = m_loader_strain_index_;
+			m_strain_index_->track(m_database_);
+		}
+	}
+	m_loader_strain_index_.reset();
+
+	// the loader may have read the tables before the mirror pulled or an
+	// import merged strains
+	bool index_pending = m_index_pending_;
+	m_index_pending_ = false;
+	if (m_mirror_refresh_pending_) {
+		m_mirror_refresh_pending_ = false;
+		_refresh_mirrored_data();
+	} else if (index_pending) {
+		_build_index_async();
+	}
+
+	if (!m_loader_error_.empty()) {
+		Glib::ustring error = m_loader_error_;
+		m_loader_error_.clear();
+		_show_error(_("Unable to load data from the database!"),error);
+	}
+}
+
+bool
+AppWindow::on_open_ongoing_growlog()
+{
+	if (m_ongoing_growlogs_.empty())
+		return false;
+
+	TRACE_SCOPE("startup","AppWindow::on_open_ongoing_growlog");
+	Glib::RefPtr<Growlog> growlog = m_ongoing_growlogs_.front();
+	m_ongoing_growlogs_.pop_front();
+
+	GrowlogView *glv = Gtk::manage(new GrowlogView(m_database_,growlog));
+	if (add_browser_page(*glv) == -1)
+		delete glv;
+
+	return !m_ongoing_growlogs_.empty();
+}
+
+// Rows pulled by the mirror do not emit the change signals of the database,
+// so everything that shows them is loaded again.
+void
+AppWindow::_refresh_mirrored_data()
+{
+	m_growlog_selector_.refresh();
+	m_strain_selector_.refresh();
+	_build_index_async();
+}
+
+// While the loader owns the connection the refresh waits for
+// on_loader_finished().
+void
+AppWindow::on_mirror_synced(uint64_t pulled_rows)
+{
+	if (!pulled_rows)
+		return;
+
+	if (m_loader_thread_.joinable()) {
+		m_mirror_refresh_pending_ = true;
+		return;
+	}
+	_refresh_mirrored_data();
+}
+
+void
+AppWindow::on_mirror_conflict(const MirrorConflict &conflict)
+{
+	if (m_mirror_conflicts_.empty())
+		Glib::signal_idle().connect(sigc::mem_fun(*this,&AppWindow::on_show_mirror_conflicts));
+	m_mirror_conflicts_.push_back(conflict);
+}
+
+bool
+AppWindow::on_show_mirror_conflicts()
+{
+	Glib::ustring details;
+	for (auto &conflict: m_mirror_conflicts_) {
+		if (!details.empty())
+			details += "\n";
+		switch (conflict.type) {
+			case MIRROR_CONFLICT_MODIFIED:
+				details += Glib::ustring::compose(_("\"%1\" was changed here and on the server, your changes were kept."),
+				                                  conflict.name);
+				break;
+			case MIRROR_CONFLICT_DELETED_REMOTE:
+				details += Glib::ustring::compose(_("\"%1\" was deleted on the server, your changes restored it."),
+				                                  conflict.name);
+				break;
+			case MIRROR_CONFLICT_DELETED_LOCAL:
+				details += Glib::ustring::compose(_("\"%1\" was deleted here and changed on the server, it stays deleted."),
+				                                  conflict.name);
+				break;
+			case MIRROR_CONFLICT_REJECTED:
+				details += Glib::ustring::compose(_("\"%1\" was refused by the server: %2"),
+				                                  conflict.name,
+				                                  conflict.message);
+				break;
+		}
+	}
+	m_mirror_conflicts_.clear();
+
+	_show_error(_("Conflicting changes were found while syncing with the server!"),details);
+	return false;
+}
+
+void
+AppWindow::show_backup_error(const Glib::ustring &message)
+{
+	if (m_backup_error_.empty())
+		Glib::signal_idle().connect(sigc::mem_fun(*this,&AppWindow::on_show_backup_error));
+	m_backup_error_ = message;
+}
+
+bool
+AppWindow::on_show_backup_error()
+{
+	Glib::ustring message = m_backup_error_;
+	m_backup_error_.clear();
+	_show_error(_("Backup of the database failed!"),message);
+	return false;
+}
+
 void
 AppWindow::on_database_settings()
 {
@@ -184,6 +454,14 @@ AppWindow::on_preferences()
 	
 }
 
+void
+AppWindow::on_diagnostics()
+{
+	DiagnosticsDialog dialog{*this};
+	dialog.run();
+	dialog.hide();
+}
+
 void
 AppWindow::on_about()
 {
@@ -240,6 +518,12 @@ AppWindow::get_strain_selector() const
 	return &m_strain_selector_;
 }
 
+Glib::RefPtr<StrainIndex>
+AppWindow::get_strain_index()
+{
+	return m_strain_index_;
+}
+
 int
 AppWindow::add_browser_page(Gtk::Widget &page,const Glib::ustring &title)
 {
@@ -316,7 +600,38 @@ AppWindow::on_export()
 		Glib::RefPtr<Exporter> exporter = dialog.get_exporter();
 		if (!exporter)
 			return;
-		exporter->export_db(*this);
+
+		// A DB_Exporter reports its progress, the main loop runs between
+		// two reports so the progress bar is drawn.
+		Gtk::MessageDialog progress_dialog{*this,
+		                                   _("Exporting the database..."),
+		                                   false,
+		                                   Gtk::MESSAGE_INFO,
+		                                   Gtk::BUTTONS_NONE,
+		                                   true};
+		Gtk::ProgressBar progress_bar;
+		Glib::RefPtr<DB_Exporter> db_exporter = Glib::RefPtr<DB_Exporter>::cast_dynamic(exporter);
+		if (db_exporter) {
+			progress_dialog.get_message_area()->pack_start(progress_bar,false,false,0);
+			progress_dialog.show_all();
+			db_exporter->signal_progress().connect([&progress_bar](uint64_t done, uint64_t total) {
+				if (total)
+					progress_bar.set_fraction(static_cast<double>(done) / total);
+				Glib::RefPtr<Glib::MainContext> context = Glib::MainContext::get_default();
+				while (context->pending())
+					context->iteration(false);
+			});
+		}
+		try {
+			exporter->export_db();
+		} catch (DatabaseError &ex) {
+			progress_dialog.hide();
+			_show_error(_("Export failed!"),ex.what());
+		} catch (Glib::Error &ex) {
+			progress_dialog.hide();
+			_show_error(_("Export failed!"),ex.what());
+		}
+		progress_dialog.hide();
 	}
 }
 
@@ -330,9 +645,33 @@ AppWindow::on_import()
 		Glib::RefPtr<Importer> importer = dialog.get_importer();
 		if (!importer)
 			return;
-		importer->import_db(*this);
+		try {
+			// conflicts are decided in one dialog before anything is written
+			Glib::RefPtr<ImportConflictHandler> handler = ImportConflictDialogHandler::create(*this);
+			Glib::RefPtr<ImportPlan> plan = importer->scan();
+			if (!plan) {
+				importer->import_db(handler);
+			} else if (!plan->has_conflicts()) {
+				importer->import_db(plan,handler);
+			} else {
+				ImportPlanDialog plan_dialog(*this,plan);
+				int plan_response;
+				do {
+					plan_response = plan_dialog.run();
+				} while (plan_response == Gtk::RESPONSE_APPLY && !plan_dialog.apply());
+				plan_dialog.hide();
+				if (plan_response == Gtk::RESPONSE_APPLY)
+					importer->import_db(plan,handler);
+			}
+		} catch (DatabaseError &ex) {
+			_show_error(_("Import failed!"),ex.what());
+		} catch (Glib::Error &ex) {
+			_show_error(_("Import failed!"),ex.what());
+		}
 	}
 	m_growlog_selector_.refresh();
 	m_strain_selector_.refresh();
+	// a sqlite3 merge does not report the strains one by one
+	_build_index_async();
 }
 
@@ -29,10 +29,17 @@
 
 #include <gtkmm/applicationwindow.h>
 #include <gtkmm/menubar.h>
+#include <gtkmm/menuitem.h>
 #include <gtkmm/notebook.h>
+#include <glibmm/dispatcher.h>
+
+#include <list>
+#include <thread>
 
 #include "settings.h"
 #include "database.h"
+#include "database-mirror.h"
+#include "strainindex.h"
 
 #include "strainselector.h"
 #include "growlogselector.h"
@@ -46,6 +53,8 @@ class AppWindow:
 		 Glib::RefPtr<Database> m_database_;
 		 
 		 Gtk::MenuBar m_menubar_;
+		 Gtk::MenuItem *m_export_menuitem_;
+		 Gtk::MenuItem *m_import_menuitem_;
 
 		 GrowlogSelector m_growlog_selector_;
 		 StrainSelector m_strain_selector_;
@@ -54,6 +63,33 @@ class AppWindow:
 		 Gtk::Notebook m_browser_notebook_;
 
 		 sigc::signal<void> m_signal_refresh_;
+
+		 Glib::RefPtr<StrainIndex> m_strain_index_;
+
+		 // The selectors are filled by a loader thread after the window
+		 // has been mapped. The data members below belong to the loader
+		 // thread until m_loader_dispatcher_ has been emitted.
+		 std::thread m_loader_thread_;
+		 Glib::Dispatcher m_loader_dispatcher_;
+		 GrowlogSelector::Data m_growlog_selector_data_;
+		 StrainSelector::Data m_strain_selector_data_;
+		 Glib::RefPtr<StrainIndex> m_loader_strain_index_;
+		 Glib::ustring m_loader_error_;
+		 // set when the loader only builds the strain index, with a
+		 // connection of its own
+		 Glib::RefPtr<Database> m_loader_database_;
+		 // the strain index missed rows while the loader was running
+		 bool m_index_pending_;
+
+		 // ongoing growlogs waiting to be opened from an idle handler
+		 std::list<Glib::RefPtr<Growlog> > m_ongoing_growlogs_;
+
+		 // conflicts of a DatabaseMirror waiting to be shown
+		 std::list<MirrorConflict> m_mirror_conflicts_;
+		 // the mirror pulled rows while the loader was running
+		 bool m_mirror_refresh_pending_;
+		 // a failed backup waiting to be shown
+		 Glib::ustring m_backup_error_;
 		 
 	 public:
 		 AppWindow(const Glib::RefPtr<Settings> &settings,
@@ -62,9 +98,23 @@ class AppWindow:
 
 	 private:
 		 void _add_menu();
+		 void _show_error(const Glib::ustring &message,const Glib::ustring &details);
+		 void _load_async();
+		 void _build_index_async();
+		 void _loader_thread();
+		 void _refresh_mirrored_data();
+
+		 void on_loader_finished();
+		 bool on_open_ongoing_growlog();
+
+		 void on_mirror_synced(uint64_t pulled_rows);
+		 void on_mirror_conflict(const MirrorConflict &conflict);
+		 bool on_show_mirror_conflicts();
+		 bool on_show_backup_error();
 
 		 void on_database_settings();
 		 void on_preferences();
+		 void on_diagnostics();
 		 void on_about();
 
 		 void on_export();
@@ -85,8 +135,17 @@ class AppWindow:
 		 StrainSelector* get_strain_selector();
 		 const StrainSelector* get_strain_selector() const;
 
+		 /*! The search index over all strains of the database. It is empty
+		  * until the loader has finished.
+		  */
+		 Glib::RefPtr<StrainIndex> get_strain_index();
+
 		 int add_browser_page(Gtk::Widget &widget, const Glib::ustring &title);
 		 int add_browser_page(BrowserPage &page);
+
+		 // Shows message from an idle handler, a backup may fail in the
+		 // middle of a timeout source.
+		 void show_backup_error(const Glib::ustring &message);
 };
 
 #endif /* __APPWINDOW_H__ */
@@ -0,0 +1,503 @@
+//           backup.cc
+//  Mo Oktober 19 18:42:07 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// backup.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "backup.h"
+
+#include <glibmm.h>
+#include <glibmm/i18n.h>
+#include <glib/gstdio.h>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <ostream>
+
+#include "database-mirror.h"
+#include "error.h"
+#include "ndjson.h"
+#include "trace.h"
+
+#define BACKUP_PREFIX "growbook-"
+#define BACKUP_PARTIAL_SUFFIX ".part"
+
+/*******************************************************************************
+ * helpers
+ ******************************************************************************/
+
+namespace {
+
+struct BackupCancelled {};
+
+// Throws BackupCancelled on the first write after cancel was set, the
+// stream passes it on when badbit is in its exceptions().
+class CancellableFilebuf:
+	public std::filebuf
+{
+	 private:
+		 const std::atomic<bool> &m_cancel_;
+
+	 public:
+		 CancellableFilebuf(const std::atomic<bool> &cancel):
+			 std::filebuf{},
+			 m_cancel_(cancel)
+		 {}
+
+	 protected:
+		 std::streamsize xsputn(const char *s, std::streamsize n) override
+		 {
+			 if (m_cancel_)
+				 throw BackupCancelled();
+			 return std::filebuf::xsputn(s,n);
+		 }
+
+		 int_type overflow(int_type c) override
+		 {
+			 if (m_cancel_)
+				 throw BackupCancelled();
+			 return std::filebuf::overflow(c);
+		 }
+};
+
+}
+
+static bool
+_has_suffix(const std::string &s, const char *suffix)
+{
+	size_t len = strlen(suffix);
+	return (s.size() >= len && s.compare(s.size() - len,len,suffix) == 0);
+}
+
+static bool
+_has_prefix(const std::string &s, const char *prefix)
+{
+	return (s.compare(0,strlen(prefix),prefix) == 0);
+}
+
+static std::string
+_format_timestamp(time_t t)
+{
+	char buffer[32];
+#ifdef NATIVE_WINDOWS
+	tm *datetime = localtime(&t);
+	if (!datetime || !strftime(buffer,sizeof(buffer),"%Y%m%d-%H%M%S",datetime))
+		return std::to_string(t);
+#else
+	tm datetime;
+	if (localtime_r(&t,&datetime) != &datetime
+	    || !strftime(buffer,sizeof(buffer),"%Y%m%d-%H%M%S",&datetime))
+		return std::to_string(t);
+#endif
+	return buffer;
+}
+
+// Keeps letters, digits, '-', '_' and '.' of name for a directory name.
+static std::string
+_sanitize_name(const std::string &name)
+{
+	std::string ret;
+	for (char c: name) {
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+		    || c == '-' || c == '_' || c == '.')
+			ret += c;
+		else
+			ret += '_';
+	}
+	return ret;
+}
+
+/*******************************************************************************
+ * BackupScheduler
+ ******************************************************************************/
+
+BackupScheduler::BackupScheduler(const Glib::RefPtr<Settings> &settings,
+                                 const Glib::RefPtr<Database> &database):
+	RefClass{},
+	m_settings_{settings},
+	m_database_{database},
+	m_check_connection_{},
+	m_step_connection_{},
+	m_filename_{},
+	m_backup_{},
+	m_thread_database_{},
+	m_thread_{},
+	m_thread_cancel_{false},
+	m_thread_error_{},
+	m_dispatcher_{},
+	m_signal_finished_{},
+	m_signal_error_{}
+{
+}
+
+BackupScheduler::~BackupScheduler()
+{
+	stop();
+}
+
+Glib::RefPtr<BackupScheduler>
+BackupScheduler::create(const Glib::RefPtr<Settings> &settings,
+                        const Glib::RefPtr<Database> &database)
+{
+	return Glib::RefPtr<BackupScheduler>(new BackupScheduler(settings,database));
+}
+
+void
+BackupScheduler::start()
+{
+	m_check_connection_.disconnect();
+	if (!is_running())
+		_remove_partial();
+
+	if (!m_settings_->get_backup_interval())
+		return;
+
+	m_check_connection_ = Glib::signal_timeout().connect_seconds(sigc::mem_fun(*this,&BackupScheduler::on_check),
+	                                                             BACKUP_CHECK_INTERVAL);
+	on_check();
+}
+
+void
+BackupScheduler::stop()
+{
+	m_check_connection_.disconnect();
+	_discard();
+}
+
+void
+BackupScheduler::run_backup()
+{
+	TRACE_SCOPE("backup","BackupScheduler::run_backup");
+
+	if (is_running())
+		return;
+
+	std::string dir = _get_dir();
+	g_mkdir_with_parents(dir.c_str(),0700);
+
+	// a mirror holds its outbox and id map, its rows are exported instead
+	Glib::RefPtr<DatabaseSqlite3> sqlite3_db = Glib::RefPtr<DatabaseSqlite3>::cast_dynamic(m_database_);
+	if (Glib::RefPtr<DatabaseMirror>::cast_dynamic(m_database_))
+		sqlite3_db.reset();
+	std::string filename = BACKUP_PREFIX + _format_timestamp(time(nullptr));
+	filename += (sqlite3_db ? ".db" : ".ndjson");
+	filename = Glib::build_filename(dir,filename);
+	if (Glib::file_test(filename,Glib::FILE_TEST_EXISTS))
+		return;
+
+	m_filename_ = filename;
+	std::string partial = m_filename_ + BACKUP_PARTIAL_SUFFIX;
+
+	if (sqlite3_db) {
+		try {
+			m_backup_ = sqlite3_db->begin_backup(partial);
+		} catch (DatabaseError &ex) {
+			_fail(ex.get_message());
+			return;
+		}
+		m_step_connection_ = Glib::signal_timeout().connect(sigc::mem_fun(*this,&BackupScheduler::on_step),
+		                                                    BACKUP_STEP_INTERVAL,
+		                                                    Glib::PRIORITY_DEFAULT_IDLE);
+		return;
+	}
+
+	// The worker gets a database of its own, RefClass counts are not
+	// atomic, so nothing the main thread uses is shared with it.
+	Glib::RefPtr<DatabaseSettings> dbsettings = m_database_->get_settings();
+	Glib::RefPtr<DatabaseModule> module = db_get_module(dbsettings->get_engine());
+	if (!module) {
+		_fail(_("No database module for the backup!"));
+		return;
+	}
+	m_thread_database_ = module->create_database(DatabaseSettings::create(dbsettings->get_engine(),
+	                                                                      dbsettings->get_dbname(),
+	                                                                      dbsettings->get_host(),
+	                                                                      dbsettings->get_port(),
+	                                                                      dbsettings->get_user(),
+	                                                                      dbsettings->get_password(),
+	                                                                      false,
+	                                                                      dbsettings->get_flags()));
+	if (!m_dispatcher_) {
+		m_dispatcher_.reset(new Glib::Dispatcher());
+		m_dispatcher_->connect(sigc::mem_fun(*this,&BackupScheduler::on_thread_done));
+	}
+	m_thread_cancel_ = false;
+	m_thread_error_.clear();
+	m_thread_ = std::thread(&BackupScheduler::_export_thread,this,partial);
+}
+
+bool
+BackupScheduler::is_running() const
+{
+	return (m_backup_ || m_thread_.joinable());
+}
+
+std::list<std::string>
+BackupScheduler::get_backups() const
+{
+	std::string dir = _get_dir();
+	std::list<std::string> names;
+	try {
+		Glib::Dir backup_dir(dir);
+		for (auto name: backup_dir) {
+			if (_has_prefix(name,BACKUP_PREFIX) && (_has_suffix(name,".db") || _has_suffix(name,".ndjson")))
+				names.push_back(name);
+		}
+	} catch (Glib::FileError &ex) {
+		return names;
+	}
+
+	// the timestamps in the names sort them by age
+	names.sort();
+	for (auto &name: names)
+		name = Glib::build_filename(dir,name);
+	return names;
+}
+
+sigc::signal<void,const std::string&>&
+BackupScheduler::signal_finished()
+{
+	return m_signal_finished_;
+}
+
+sigc::signal<void,const Glib::ustring&>&
+BackupScheduler::signal_error()
+{
+	return m_signal_error_;
+}
+
+bool
+BackupScheduler::on_check()
+{
+	if (is_running())
+		return true;
+
+	uint32_t interval = m_settings_->get_backup_interval();
+	if (!interval)
+		return false;
+
+	if (time(nullptr) - _get_last_backup_time() >= static_cast<time_t>(interval) * 60)
+		run_backup();
+	return true;
+}
+
+bool
+BackupScheduler::on_step()
+{
+	TRACE_SCOPE("backup","BackupScheduler::on_step");
+
+	if (!m_backup_)
+		return false;
+
+	try {
+		if (!m_backup_->step(BACKUP_STEP_PAGES))
+			return true;
+	} catch (DatabaseError &ex) {
+		_fail(ex.get_message());
+		return false;
+	}
+	_finish();
+	return false;
+}
+
+void
+BackupScheduler::on_thread_done()
+{
+	// a backup discarded by stop() was joined already
+	if (!m_thread_.joinable())
+		return;
+
+	m_thread_.join();
+	m_thread_database_.reset();
+	if (m_thread_error_.empty())
+		_finish();
+	else
+		_fail(m_thread_error_);
+}
+
+void
+BackupScheduler::_export_thread(std::string filename)
+{
+	trace_set_thread_name("backup");
+	TRACE_SCOPE("backup","BackupScheduler::_export_thread");
+
+	CancellableFilebuf buffer(m_thread_cancel_);
+	try {
+		if (!buffer.open(filename,std::ios::out | std::ios::binary | std::ios::trunc))
+			throw Glib::FileError(Glib::FileError::FAILED,_("Unable to open file for writing!"));
+
+		std::ostream out(&buffer);
+		out.exceptions(std::ios::badbit);
+		m_thread_database_->connect();
+		ndjson_export_database(m_thread_database_,out);
+		m_thread_database_->close();
+
+		if (!buffer.close() || out.fail())
+			throw Glib::FileError(Glib::FileError::FAILED,_("Writing file failed!"));
+	} catch (BackupCancelled &ex) {
+		return;
+	} catch (DatabaseError &ex) {
+		m_thread_error_ = ex.get_message();
+	} catch (Glib::FileError &ex) {
+		m_thread_error_ = ex.what();
+	} catch (std::ios::failure &ex) {
+		m_thread_error_ = _("Writing file failed!");
+	}
+	m_dispatcher_->emit();
+}
+
+void
+BackupScheduler::_finish()
+{
+	m_step_connection_.disconnect();
+	// closes the destination of a sqlite3 backup
+	m_backup_.reset();
+
+	std::string filename = m_filename_;
+	if (g_rename((filename + BACKUP_PARTIAL_SUFFIX).c_str(),filename.c_str()) != 0) {
+		Glib::ustring msg = _("Unable to rename the backup file!");
+		msg += "\n(";
+		msg += filename;
+		msg += ")";
+		_fail(msg);
+		return;
+	}
+	m_filename_.clear();
+
+	_rotate();
+	m_signal_finished_.emit(filename);
+}
+
+void
+BackupScheduler::_fail(const Glib::ustring &message)
+{
+	_discard();
+	m_signal_error_.emit(message);
+}
+
+void
+BackupScheduler::_discard()
+{
+	m_step_connection_.disconnect();
+	m_backup_.reset();
+	if (m_thread_.joinable()) {
+		m_thread_cancel_ = true;
+		m_thread_.join();
+	}
+	m_thread_database_.reset();
+
+	if (!m_filename_.empty()) {
+		g_unlink((m_filename_ + BACKUP_PARTIAL_SUFFIX).c_str());
+		m_filename_.clear();
+	}
+}
+
+void
+BackupScheduler::_rotate()
+{
+	uint16_t keep = m_settings_->get_backup_keep();
+	if (!keep)
+		return;
+
+	std::list<std::string> backups = get_backups();
+	while (backups.size() > keep) {
+		g_unlink(backups.front().c_str());
+		backups.pop_front();
+	}
+}
+
+// A .part file is a backup that did not complete, e.g. because GrowBook
+// was killed while writing it.
+void
+BackupScheduler::_remove_partial()
+{
+	std::string dir = _get_dir();
+	std::list<std::string> partial;
+	try {
+		Glib::Dir backup_dir(dir);
+		for (auto name: backup_dir) {
+			if (_has_prefix(name,BACKUP_PREFIX) && _has_suffix(name,BACKUP_PARTIAL_SUFFIX))
+				partial.push_back(Glib::build_filename(dir,name));
+		}
+	} catch (Glib::FileError &ex) {
+		return;
+	}
+
+	for (auto &filename: partial) {
+		fprintf(stderr,_("Discarding the interrupted backup \"%s\".\n"),filename.c_str());
+		g_unlink(filename.c_str());
+	}
+}
+
+time_t
+BackupScheduler::_get_last_backup_time() const
+{
+	std::list<std::string> backups = get_backups();
+	if (backups.empty())
+		return 0;
+
+	GStatBuf st;
+	if (g_stat(backups.back().c_str(),&st) != 0)
+		return 0;
+	return st.st_mtime;
+}
+
+// Every book has a directory of its own in the backup directory, so the
+// rotation of one book never deletes the backups of another. It is named
+// after the file or database, the checksum of where the book lives tells
+// books of the same name apart. A mirror is named after its remote book.
+std::string
+BackupScheduler::_get_dir() const
+{
+	Glib::RefPtr<const Database> database = m_database_;
+	Glib::RefPtr<const DatabaseMirror> mirror = Glib::RefPtr<const DatabaseMirror>::cast_dynamic(database);
+	if (mirror)
+		database = mirror->get_remote();
+
+	Glib::RefPtr<const DatabaseSettings> settings = database->get_settings();
+	std::string name;
+	std::string location = settings->get_engine();
+	if (settings->get_dbname_is_filename()) {
+		name = Glib::path_get_basename(settings->get_dbname());
+		size_t dot = name.rfind('.');
+		if (dot != std::string::npos && dot > 0)
+			name.erase(dot);
+		location += ":";
+		location += settings->get_dbname();
+	} else {
+		name = settings->get_dbname();
+		location += ":";
+		location += settings->get_user();
+		location += "@";
+		location += settings->get_host();
+		location += ":";
+		location += std::to_string(settings->get_port());
+		location += "/";
+		location += settings->get_dbname();
+	}
+
+	std::string checksum = Glib::Checksum::compute_checksum(Glib::Checksum::CHECKSUM_SHA1,location);
+	return Glib::build_filename(m_settings_->get_backup_dir(),
+	                            _sanitize_name(name) + "-" + checksum.substr(0,8));
+}
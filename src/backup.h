@@ -0,0 +1,136 @@
+/***************************************************************************
+ *            backup.h
+ *
+ *  Mo Oktober 19 18:42:07 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * backup.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BACKUP_H__
+#define __BACKUP_H__
+
+#include "refclass.h"
+#include "database.h"
+#include "database-sqlite3.h"
+#include "settings.h"
+
+#include <glibmm/dispatcher.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <thread>
+
+// seconds between two checks whether a backup is due
+#define BACKUP_CHECK_INTERVAL 60
+// milliseconds between two steps of a sqlite3 backup
+#define BACKUP_STEP_INTERVAL 20
+// pages copied per step, small enough to not stall the main loop
+#define BACKUP_STEP_PAGES 64
+
+/*******************************************************************************
+ * BackupScheduler
+ ******************************************************************************/
+
+/*! Writes a backup of the open book every Settings::get_backup_interval()
+ * minutes into a directory of the book in Settings::get_backup_dir() and
+ * keeps the newest Settings::get_backup_keep() of them.
+ *
+ * sqlite3 books are copied with the online backup API, BACKUP_STEP_PAGES
+ * pages at a time from a timeout source, so the backup is a .db file.
+ * Books on a database server, and the mirrors of them, are exported as
+ * NDJSON by a worker thread with a connection of its own.
+ *
+ * A backup is written to a .part file that is renamed once it is complete.
+ * .part files left behind by an interrupted backup are deleted by start().
+ *
+ * The scheduler runs in the main loop of the thread that called start(),
+ * the signals are emitted there too.
+ */
+class BackupScheduler:
+	public RefClass
+{
+	 private:
+		 Glib::RefPtr<Settings> m_settings_;
+		 Glib::RefPtr<Database> m_database_;
+
+		 sigc::connection m_check_connection_;
+		 sigc::connection m_step_connection_;
+
+		 // the running backup, either m_backup_ or m_thread_ is used
+		 std::string m_filename_;
+		 Glib::RefPtr<DatabaseSqlite3Backup> m_backup_;
+		 Glib::RefPtr<Database> m_thread_database_;
+		 std::thread m_thread_;
+		 std::atomic<bool> m_thread_cancel_;
+		 Glib::ustring m_thread_error_;
+		 std::unique_ptr<Glib::Dispatcher> m_dispatcher_;
+
+		 sigc::signal<void,const std::string&> m_signal_finished_;
+		 sigc::signal<void,const Glib::ustring&> m_signal_error_;
+
+	 private:
+		 BackupScheduler(const BackupScheduler &src) = delete;
+		 BackupScheduler& operator = (const BackupScheduler &src) = delete;
+
+	 protected:
+		 BackupScheduler(const Glib::RefPtr<Settings> &settings,
+		                 const Glib::RefPtr<Database> &database);
+
+	 public:
+		 virtual ~BackupScheduler();
+
+	 public:
+		 static Glib::RefPtr<BackupScheduler> create(const Glib::RefPtr<Settings> &settings,
+		                                             const Glib::RefPtr<Database> &database);
+
+	 public:
+		 // Starts checking for due backups, again after the settings changed.
+		 void start();
+		 // Stops the scheduler and discards a running backup.
+		 void stop();
+
+		 // Starts a backup now, unless one is running.
+		 void run_backup();
+		 bool is_running() const;
+
+		 // Backups of the book, the oldest first.
+		 std::list<std::string> get_backups() const;
+
+		 // emitted with the filename of each completed backup
+		 sigc::signal<void,const std::string&>& signal_finished();
+		 sigc::signal<void,const Glib::ustring&>& signal_error();
+
+	 private:
+		 bool on_check();
+		 bool on_step();
+		 void on_thread_done();
+
+		 void _export_thread(std::string filename);
+		 void _finish();
+		 void _fail(const Glib::ustring &message);
+		 void _discard();
+		 void _rotate();
+		 void _remove_partial();
+		 time_t _get_last_backup_time() const;
+		 std::string _get_dir() const;
+};
+
+#endif /* __BACKUP_H__ */
@@ -0,0 +1,592 @@
+//           compression.cc
+//  Mo Oktober 19 07:02:11 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// compression.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "compression.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+#ifdef HAVE_ZLIB
+# include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+# include <zstd.h>
+#endif
+
+// uncompressed data is collected in blocks of this size before it is
+// handed to the compressor
+#define COMPRESSION_BLOCK_SIZE (256 * 1024)
+
+static bool
+_has_ending(const std::string &s, const char *end)
+{
+	size_t length = strlen(end);
+	if (s.length() >= length)
+		return (0 == s.compare(s.length() - length,length,end));
+	return false;
+}
+
+CompressionType
+compression_type_for_filename(const std::string &filename)
+{
+	if (_has_ending(filename,".gz"))
+		return COMPRESSION_GZIP;
+	if (_has_ending(filename,".zst"))
+		return COMPRESSION_ZSTD;
+	return COMPRESSION_NONE;
+}
+
+CompressionType
+compression_type_for_magic(const char *data, size_t size)
+{
+	const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data);
+	if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b)
+		return COMPRESSION_GZIP;
+	if (size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd)
+		return COMPRESSION_ZSTD;
+	return COMPRESSION_NONE;
+}
+
+bool
+compression_is_available(CompressionType type)
+{
+	switch (type) {
+		case COMPRESSION_NONE:
+			return true;
+		case COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+			return true;
+#else
+			return false;
+#endif
+		case COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+			return true;
+#else
+			return false;
+#endif
+	}
+	return false;
+}
+
+const char*
+compression_type_name(CompressionType type)
+{
+	switch (type) {
+		case COMPRESSION_GZIP:
+			return "gzip";
+		case COMPRESSION_ZSTD:
+			return "zstd";
+		default:
+			break;
+	}
+	return "none";
+}
+
+/*******************************************************************************
+ * CompressOutputBuffer
+ ******************************************************************************/
+
+CompressOutputBuffer::CompressOutputBuffer(std::streambuf *sink):
+	std::streambuf{},
+	m_sink_{sink},
+	m_buffer_{new char[COMPRESSION_BLOCK_SIZE]},
+	m_buffer_size_{COMPRESSION_BLOCK_SIZE},
+	m_finished_{false},
+	m_failed_{false}
+{
+	setp(m_buffer_.get(),m_buffer_.get() + m_buffer_size_);
+}
+
+CompressOutputBuffer::~CompressOutputBuffer()
+{
+}
+
+bool
+CompressOutputBuffer::finish()
+{
+	if (!m_finished_) {
+		_compress_buffer(true);
+		m_finished_ = true;
+		if (m_sink_->pubsync() != 0)
+			m_failed_ = true;
+	}
+	return !m_failed_;
+}
+
+bool
+CompressOutputBuffer::failed() const
+{
+	return m_failed_;
+}
+
+bool
+CompressOutputBuffer::_compress_buffer(bool finish)
+{
+	if (m_failed_ || m_finished_)
+		return false;
+
+	size_t size = static_cast<size_t>(pptr() - pbase());
+	if ((size || finish) && !compress_vfunc(pbase(),size,finish))
+		m_failed_ = true;
+	setp(m_buffer_.get(),m_buffer_.get() + m_buffer_size_);
+	return !m_failed_;
+}
+
+CompressOutputBuffer::int_type
+CompressOutputBuffer::overflow(int_type c)
+{
+	if (!_compress_buffer(false))
+		return traits_type::eof();
+	if (!traits_type::eq_int_type(c,traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+std::streamsize
+CompressOutputBuffer::xsputn(const char *data, std::streamsize size)
+{
+	// small writes are collected, large blocks go to the compressor
+	// without being copied
+	if (size < static_cast<std::streamsize>(m_buffer_size_))
+		return std::streambuf::xsputn(data,size);
+
+	if (!_compress_buffer(false))
+		return 0;
+	if (!compress_vfunc(data,static_cast<size_t>(size),false)) {
+		m_failed_ = true;
+		return 0;
+	}
+	return size;
+}
+
+int
+CompressOutputBuffer::sync()
+{
+	return (_compress_buffer(false) ? 0 : -1);
+}
+
+bool
+CompressOutputBuffer::write_sink(const char *data, size_t size)
+{
+	return (m_sink_->sputn(data,size) == static_cast<std::streamsize>(size));
+}
+
+/*******************************************************************************
+ * GzipOutputBuffer
+ ******************************************************************************/
+
+#ifdef HAVE_ZLIB
+class GzipOutputBuffer:
+	public CompressOutputBuffer
+{
+	 private:
+		 z_stream m_stream_;
+		 std::unique_ptr<char[]> m_out_;
+		 bool m_initialized_;
+
+	public:
+		 GzipOutputBuffer(std::streambuf *sink);
+		 virtual ~GzipOutputBuffer();
+
+	protected:
+		 virtual bool compress_vfunc(const char *data, size_t size, bool finish) override;
+};
+
+GzipOutputBuffer::GzipOutputBuffer(std::streambuf *sink):
+	CompressOutputBuffer{sink},
+	m_stream_{},
+	m_out_{new char[COMPRESSION_BLOCK_SIZE]},
+	m_initialized_{false}
+{
+	// windowBits + 16 writes a gzip header instead of a zlib header
+	m_initialized_ = (deflateInit2(&m_stream_,
+	                               Z_DEFAULT_COMPRESSION,
+	                               Z_DEFLATED,
+	                               15 + 16,
+	                               8,
+	                               Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+GzipOutputBuffer::~GzipOutputBuffer()
+{
+	if (m_initialized_)
+		deflateEnd(&m_stream_);
+}
+
+bool
+GzipOutputBuffer::compress_vfunc(const char *data, size_t size, bool finish)
+{
+	if (!m_initialized_)
+		return false;
+
+	do {
+		uInt chunk = static_cast<uInt>(std::min(size,static_cast<size_t>(UINT_MAX)));
+		m_stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		m_stream_.avail_in = chunk;
+		data += chunk;
+		size -= chunk;
+
+		int flush = ((finish && !size) ? Z_FINISH : Z_NO_FLUSH);
+		int ret;
+		do {
+			m_stream_.next_out = reinterpret_cast<Bytef*>(m_out_.get());
+			m_stream_.avail_out = COMPRESSION_BLOCK_SIZE;
+			ret = deflate(&m_stream_,flush);
+			if (ret == Z_STREAM_ERROR)
+				return false;
+			size_t have = COMPRESSION_BLOCK_SIZE - m_stream_.avail_out;
+			if (have && !write_sink(m_out_.get(),have))
+				return false;
+		} while (m_stream_.avail_out == 0);
+
+		if (flush == Z_FINISH && ret != Z_STREAM_END)
+			return false;
+	} while (size);
+	return true;
+}
+#endif /* HAVE_ZLIB */
+
+/*******************************************************************************
+ * ZstdOutputBuffer
+ ******************************************************************************/
+
+#ifdef HAVE_ZSTD
+class ZstdOutputBuffer:
+	public CompressOutputBuffer
+{
+	 private:
+		 ZSTD_CCtx *m_cctx_;
+		 std::unique_ptr<char[]> m_out_;
+		 size_t m_out_size_;
+
+	public:
+		 ZstdOutputBuffer(std::streambuf *sink);
+		 virtual ~ZstdOutputBuffer();
+
+	protected:
+		 virtual bool compress_vfunc(const char *data, size_t size, bool finish) override;
+};
+
+ZstdOutputBuffer::ZstdOutputBuffer(std::streambuf *sink):
+	CompressOutputBuffer{sink},
+	m_cctx_{ZSTD_createCCtx()},
+	m_out_{new char[ZSTD_CStreamOutSize()]},
+	m_out_size_{ZSTD_CStreamOutSize()}
+{
+	if (m_cctx_) {
+		ZSTD_CCtx_setParameter(m_cctx_,ZSTD_c_compressionLevel,ZSTD_CLEVEL_DEFAULT);
+		ZSTD_CCtx_setParameter(m_cctx_,ZSTD_c_checksumFlag,1);
+		// fails without effect if libzstd is built without
+		// multi-threading, the stream is then compressed on this thread
+		unsigned int n_workers = std::thread::hardware_concurrency();
+		if (n_workers > 1)
+			ZSTD_CCtx_setParameter(m_cctx_,ZSTD_c_nbWorkers,static_cast<int>(n_workers));
+	}
+}
+
+ZstdOutputBuffer::~ZstdOutputBuffer()
+{
+	if (m_cctx_)
+		ZSTD_freeCCtx(m_cctx_);
+}
+
+bool
+ZstdOutputBuffer::compress_vfunc(const char *data, size_t size, bool finish)
+{
+	if (!m_cctx_)
+		return false;
+
+	ZSTD_inBuffer in{data,size,0};
+	ZSTD_EndDirective mode = (finish ? ZSTD_e_end : ZSTD_e_continue);
+	bool done;
+	do {
+		ZSTD_outBuffer out{m_out_.get(),m_out_size_,0};
+		size_t remaining = ZSTD_compressStream2(m_cctx_,&out,&in,mode);
+		if (ZSTD_isError(remaining))
+			return false;
+		if (out.pos && !write_sink(m_out_.get(),out.pos))
+			return false;
+		done = (finish ? (remaining == 0) : (in.pos == in.size));
+	} while (!done);
+	return true;
+}
+#endif /* HAVE_ZSTD */
+
+/******************************************************************************/
+
+std::unique_ptr<CompressOutputBuffer>
+CompressOutputBuffer::create(std::streambuf *sink, CompressionType type)
+{
+	switch (type) {
+#ifdef HAVE_ZLIB
+		case COMPRESSION_GZIP:
+			return std::unique_ptr<CompressOutputBuffer>(new GzipOutputBuffer(sink));
+#endif
+#ifdef HAVE_ZSTD
+		case COMPRESSION_ZSTD:
+			return std::unique_ptr<CompressOutputBuffer>(new ZstdOutputBuffer(sink));
+#endif
+		default:
+			break;
+	}
+	return std::unique_ptr<CompressOutputBuffer>();
+}
+
+/*******************************************************************************
+ * DecompressInputBuffer
+ ******************************************************************************/
+
+DecompressInputBuffer::DecompressInputBuffer(std::streambuf *source):
+	std::streambuf{},
+	m_source_{source},
+	m_buffer_{new char[COMPRESSION_BLOCK_SIZE]},
+	m_buffer_size_{COMPRESSION_BLOCK_SIZE},
+	m_failed_{false}
+{
+	setg(m_buffer_.get(),m_buffer_.get(),m_buffer_.get());
+}
+
+DecompressInputBuffer::~DecompressInputBuffer()
+{
+}
+
+bool
+DecompressInputBuffer::failed() const
+{
+	return m_failed_;
+}
+
+void
+DecompressInputBuffer::set_failed()
+{
+	m_failed_ = true;
+}
+
+DecompressInputBuffer::int_type
+DecompressInputBuffer::underflow()
+{
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+	if (m_failed_)
+		return traits_type::eof();
+
+	size_t size = decompress_vfunc(m_buffer_.get(),m_buffer_size_);
+	if (!size)
+		return traits_type::eof();
+	setg(m_buffer_.get(),m_buffer_.get(),m_buffer_.get() + size);
+	return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize
+DecompressInputBuffer::read_source(char *data, size_t size)
+{
+	return m_source_->sgetn(data,size);
+}
+
+/*******************************************************************************
+ * GzipInputBuffer
+ ******************************************************************************/
+
+#ifdef HAVE_ZLIB
+class GzipInputBuffer:
+	public DecompressInputBuffer
+{
+	 private:
+		 z_stream m_stream_;
+		 std::unique_ptr<char[]> m_in_;
+		 bool m_initialized_;
+		 bool m_member_end_;
+		 bool m_output_pending_;
+		 bool m_done_;
+
+	public:
+		 GzipInputBuffer(std::streambuf *source);
+		 virtual ~GzipInputBuffer();
+
+	protected:
+		 virtual size_t decompress_vfunc(char *data, size_t size) override;
+};
+
+GzipInputBuffer::GzipInputBuffer(std::streambuf *source):
+	DecompressInputBuffer{source},
+	m_stream_{},
+	m_in_{new char[COMPRESSION_BLOCK_SIZE]},
+	m_initialized_{false},
+	m_member_end_{false},
+	m_output_pending_{false},
+	m_done_{false}
+{
+	// windowBits + 32 accepts gzip and zlib headers
+	m_initialized_ = (inflateInit2(&m_stream_,15 + 32) == Z_OK);
+	if (!m_initialized_)
+		set_failed();
+}
+
+GzipInputBuffer::~GzipInputBuffer()
+{
+	if (m_initialized_)
+		inflateEnd(&m_stream_);
+}
+
+size_t
+GzipInputBuffer::decompress_vfunc(char *data, size_t size)
+{
+	uInt chunk = static_cast<uInt>(std::min(size,static_cast<size_t>(UINT_MAX)));
+	m_stream_.next_out = reinterpret_cast<Bytef*>(data);
+	m_stream_.avail_out = chunk;
+
+	while (m_stream_.avail_out == chunk && !m_done_) {
+		if (m_stream_.avail_in == 0 && !m_output_pending_) {
+			std::streamsize n = read_source(m_in_.get(),COMPRESSION_BLOCK_SIZE);
+			if (n <= 0) {
+				// a file that ends inside of a gzip member is truncated
+				if (!m_member_end_)
+					set_failed();
+				m_done_ = true;
+				break;
+			}
+			m_stream_.next_in = reinterpret_cast<Bytef*>(m_in_.get());
+			m_stream_.avail_in = static_cast<uInt>(n);
+		}
+		if (m_member_end_ && m_stream_.avail_in) {
+			// concatenated gzip members, as written by "cat a.gz b.gz"
+			inflateReset(&m_stream_);
+			m_member_end_ = false;
+		}
+
+		int ret = inflate(&m_stream_,Z_NO_FLUSH);
+		if (ret == Z_STREAM_END) {
+			m_member_end_ = true;
+		} else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+			set_failed();
+			m_done_ = true;
+		}
+		m_output_pending_ = (m_stream_.avail_out == 0 && !m_member_end_);
+	}
+	return chunk - m_stream_.avail_out;
+}
+#endif /* HAVE_ZLIB */
+
+/*******************************************************************************
+ * ZstdInputBuffer
+ ******************************************************************************/
+
+#ifdef HAVE_ZSTD
+class ZstdInputBuffer:
+	public DecompressInputBuffer
+{
+	 private:
+		 ZSTD_DCtx *m_dctx_;
+		 std::unique_ptr<char[]> m_in_;
+		 ZSTD_inBuffer m_in_buffer_;
+		 size_t m_last_ret_;
+		 bool m_output_pending_;
+		 bool m_done_;
+
+	public:
+		 ZstdInputBuffer(std::streambuf *source);
+		 virtual ~ZstdInputBuffer();
+
+	protected:
+		 virtual size_t decompress_vfunc(char *data, size_t size) override;
+};
+
+ZstdInputBuffer::ZstdInputBuffer(std::streambuf *source):
+	DecompressInputBuffer{source},
+	m_dctx_{ZSTD_createDCtx()},
+	m_in_{new char[ZSTD_DStreamInSize()]},
+	m_in_buffer_{m_in_.get(),0,0},
+	m_last_ret_{1},
+	m_output_pending_{false},
+	m_done_{false}
+{
+	if (!m_dctx_)
+		set_failed();
+}
+
+ZstdInputBuffer::~ZstdInputBuffer()
+{
+	if (m_dctx_)
+		ZSTD_freeDCtx(m_dctx_);
+}
+
+size_t
+ZstdInputBuffer::decompress_vfunc(char *data, size_t size)
+{
+	ZSTD_outBuffer out{data,size,0};
+
+	while (out.pos == 0 && !m_done_) {
+		if (m_in_buffer_.pos == m_in_buffer_.size && !m_output_pending_) {
+			std::streamsize n = read_source(m_in_.get(),ZSTD_DStreamInSize());
+			if (n <= 0) {
+				// ZSTD_decompressStream() returns 0 when a frame is
+				// complete, anything else at the end of the file means
+				// it is truncated
+				if (m_last_ret_ != 0)
+					set_failed();
+				m_done_ = true;
+				break;
+			}
+			m_in_buffer_.size = static_cast<size_t>(n);
+			m_in_buffer_.pos = 0;
+		}
+
+		size_t ret = ZSTD_decompressStream(m_dctx_,&out,&m_in_buffer_);
+		if (ZSTD_isError(ret)) {
+			set_failed();
+			m_done_ = true;
+			break;
+		}
+		m_last_ret_ = ret;
+		m_output_pending_ = (out.pos == out.size);
+	}
+	return out.pos;
+}
+#endif /* HAVE_ZSTD */
+
+/******************************************************************************/
+
+std::unique_ptr<DecompressInputBuffer>
+DecompressInputBuffer::create(std::streambuf *source, CompressionType type)
+{
+	switch (type) {
+#ifdef HAVE_ZLIB
+		case COMPRESSION_GZIP:
+			return std::unique_ptr<DecompressInputBuffer>(new GzipInputBuffer(source));
+#endif
+#ifdef HAVE_ZSTD
+		case COMPRESSION_ZSTD:
+			return std::unique_ptr<DecompressInputBuffer>(new ZstdInputBuffer(source));
+#endif
+		default:
+			break;
+	}
+	return std::unique_ptr<DecompressInputBuffer>();
+}
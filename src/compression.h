@@ -0,0 +1,147 @@
+/***************************************************************************
+ *            compression.h
+ *
+ *  Mo Oktober 19 07:02:11 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * compression.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __COMPRESSION_H__
+#define __COMPRESSION_H__
+
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+/*
+ * Streaming gzip (zlib) and zstd support for the file exporters and
+ * importers.
+ *
+ * CompressOutputBuffer and DecompressInputBuffer are std::streambufs that
+ * sit in front of another streambuf, usually the one of a std::fstream.
+ * Data is compressed or decompressed in fixed size blocks, so memory use
+ * does not depend on the size of the file. zstd compresses with one worker
+ * per CPU if libzstd was built with multi-threading support.
+ */
+
+enum CompressionType {
+	COMPRESSION_NONE,
+	COMPRESSION_GZIP,
+	COMPRESSION_ZSTD
+};
+
+// "*.gz" is gzip, "*.zst" is zstd, everything else is not compressed.
+CompressionType compression_type_for_filename(const std::string &filename);
+// Detects the compression from the first bytes of a file.
+CompressionType compression_type_for_magic(const char *data, size_t size);
+// Returns true if growbook was built with support for type.
+bool compression_is_available(CompressionType type);
+const char* compression_type_name(CompressionType type);
+
+/******************************************************************************/
+
+class CompressOutputBuffer:
+	public std::streambuf
+{
+	 private:
+		 std::streambuf *m_sink_;
+		 std::unique_ptr<char[]> m_buffer_;
+		 size_t m_buffer_size_;
+		 bool m_finished_;
+		 bool m_failed_;
+
+	private:
+		 CompressOutputBuffer(const CompressOutputBuffer &src) = delete;
+		 CompressOutputBuffer& operator=(const CompressOutputBuffer &src) = delete;
+
+	protected:
+		 CompressOutputBuffer(std::streambuf *sink);
+
+	public:
+		 virtual ~CompressOutputBuffer();
+
+		 // Returns nullptr if type is not available.
+		 static std::unique_ptr<CompressOutputBuffer> create(std::streambuf *sink,
+		                                                     CompressionType type);
+
+	public:
+		 // Compresses the pending data and writes the end of the stream.
+		 // Returns false if compressing or writing to the sink failed.
+		 bool finish();
+		 bool failed() const;
+
+	protected:
+		 virtual int_type overflow(int_type c) override;
+		 virtual std::streamsize xsputn(const char *data, std::streamsize size) override;
+		 virtual int sync() override;
+
+		 // Writes compressed data to the sink.
+		 bool write_sink(const char *data, size_t size);
+
+		 virtual bool compress_vfunc(const char *data, size_t size, bool finish) = 0;
+
+	private:
+		 bool _compress_buffer(bool finish);
+};
+
+/******************************************************************************/
+
+class DecompressInputBuffer:
+	public std::streambuf
+{
+	 private:
+		 std::streambuf *m_source_;
+		 std::unique_ptr<char[]> m_buffer_;
+		 size_t m_buffer_size_;
+		 bool m_failed_;
+
+	private:
+		 DecompressInputBuffer(const DecompressInputBuffer &src) = delete;
+		 DecompressInputBuffer& operator=(const DecompressInputBuffer &src) = delete;
+
+	protected:
+		 DecompressInputBuffer(std::streambuf *source);
+
+	public:
+		 virtual ~DecompressInputBuffer();
+
+		 // Returns nullptr if type is not available.
+		 static std::unique_ptr<DecompressInputBuffer> create(std::streambuf *source,
+		                                                      CompressionType type);
+
+	public:
+		 // Returns true if the compressed data was corrupt or truncated.
+		 bool failed() const;
+
+	protected:
+		 virtual int_type underflow() override;
+
+		 // Reads compressed data from the source.
+		 std::streamsize read_source(char *data, size_t size);
+		 void set_failed();
+
+		 // Decompresses into data, returns the number of bytes written
+		 // or 0 at the end of the stream.
+		 virtual size_t decompress_vfunc(char *data, size_t size) = 0;
+};
+
+#endif /* __COMPRESSION_H__ */
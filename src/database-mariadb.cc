@@ -30,18 +30,155 @@
 #include <glibmm/i18n.h>
 
 #include <cassert>
-#include <fstream>
 #include <cstring>
 #include <cstdio>
 #include <memory>
+#include <chrono>
 
 #include "error.h"
-#include "application.h"
+#include "querystats.h"
 
 #ifdef NATIVE_WINDOWS
 # include "strptime.h"
 #endif
 
+/*******************************************************************************
+ * statement helpers
+ ******************************************************************************/
+
+// mysql_query() and mysql_store_result() wrappers feeding the query
+// statistics while they are enabled. Values are written into the
+// statements, so statements built with snprintf() pass their format as
+// key, which stays the same for all values. A statement that returns rows
+// is recorded once its result has been stored, the time then includes the
+// transfer of the rows. Streamed results are recorded by their caller.
+
+static thread_local QueryStat *_mysql_last_stat = nullptr;
+static thread_local std::chrono::steady_clock::time_point _mysql_last_start;
+
+static uint64_t
+_mysql_elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+static int
+_mysql_query(MYSQL *db, const char *sql, const char *key = nullptr)
+{
+	_mysql_last_stat = nullptr;
+	if (!query_stats_get_enabled())
+		return mysql_query(db,sql);
+
+	auto start = std::chrono::steady_clock::now();
+	int ret = mysql_query(db,sql);
+
+	QueryStat *stat = query_stats_lookup_sql("mariadb",(key ? key : sql));
+	if (ret || !mysql_field_count(db)) {
+		stat->record(_mysql_elapsed_ns(start));
+	} else {
+		_mysql_last_stat = stat;
+		_mysql_last_start = start;
+	}
+	return ret;
+}
+
+static MYSQL_RES*
+_mysql_store_result(MYSQL *db)
+{
+	QueryStat *stat = _mysql_last_stat;
+	_mysql_last_stat = nullptr;
+
+	MYSQL_RES *result = mysql_store_result(db);
+	if (!stat)
+		return result;
+	if (!result) {
+		stat->record(_mysql_elapsed_ns(_mysql_last_start));
+		return result;
+	}
+
+	uint64_t ns = _mysql_elapsed_ns(_mysql_last_start);
+	uint64_t n_rows = mysql_num_rows(result);
+	uint64_t n_bytes = 0;
+	unsigned int n_fields = mysql_num_fields(result);
+	while (mysql_fetch_row(result)) {
+		unsigned long *lengths = mysql_fetch_lengths(result);
+		for (unsigned int i = 0; lengths && i < n_fields; ++i)
+			n_bytes += lengths[i];
+	}
+	mysql_data_seek(result,0);
+	stat->record(ns,n_rows,n_bytes);
+	return result;
+}
+
+static Glib::RefPtr<Strain>
+_mysql_strain(MYSQL_ROW row, int column)
+{
+	uint64_t id = std::stoull(row[column]);
+	uint64_t breeder_id = std::stoull(row[column + 1]);
+	Glib::ustring breeder_name(row[column + 2]);
+	Glib::ustring name(row[column + 3]);
+	Glib::ustring info(row[column + 4] ? row[column + 4] : "");
+	Glib::ustring desc(row[column + 5] ? row[column + 5] : "");
+	std::string homepage(row[column + 6] ? row[column + 6] : "");
+	std::string seedfinder(row[column + 7] ? row[column + 7] : "");
+
+	return Strain::create(id,breeder_id,breeder_name,name,info,desc,homepage,seedfinder);
+}
+
+static time_t
+_mysql_get_datetime(const char *str)
+{
+	tm datetime;
+	if (!str || !*str || !strptime(str,DATETIME_ISO_FORMAT,&datetime))
+		return 0;
+	datetime.tm_isdst = -1;
+	return mktime(&datetime);
+}
+
+static GrowlogStats
+_mysql_growlog_stats(MYSQL_ROW row)
+{
+	GrowlogStats stats;
+	stats.growlog_id = std::stoull(row[0]);
+	stats.entry_count = std::stoull(row[1]);
+	stats.first_entry_on = _mysql_get_datetime(row[2]);
+	stats.last_entry_on = _mysql_get_datetime(row[3]);
+	stats.text_bytes = std::stoull(row[4]);
+	return stats;
+}
+
+static StrainStats
+_mysql_strain_stats(MYSQL_ROW row)
+{
+	StrainStats stats;
+	stats.strain_id = std::stoull(row[0]);
+	stats.growlog_count = std::stoull(row[1]);
+	stats.veg_count = std::stoull(row[2]);
+	stats.veg_days = std::stoull(row[3]);
+	stats.flower_count = std::stoull(row[4]);
+	stats.flower_days = std::stoull(row[5]);
+	return stats;
+}
+
+static ChangeRecord
+_mysql_change_record(MYSQL_ROW row)
+{
+	ChangeRecord record;
+	record.seq = std::stoull(row[0]);
+	record.table = row[1];
+	record.row_id = std::stoull(row[2]);
+	if (row[3] && *row[3] == 'D')
+		record.type = CHANGE_DELETE;
+	else if (row[3] && *row[3] == 'R')
+		record.type = CHANGE_RENAME;
+	for (int i = 0; i < 3; ++i) {
+		record.key[i] = (row[4 + i] ? row[4 + i] : "");
+		record.new_key[i] = (row[7 + i] ? row[7 + i] : "");
+	}
+	return record;
+}
+
 /*******************************************************************************
  * DatabaseModuleMariaDB
  ******************************************************************************/
@@ -124,7 +261,7 @@ DatabaseMariaDB::begin_transaction()
 	assert(m_db_);
 
 	const char *sql = "BEGIN;";
-	if (mysql_query(m_db_,sql)) {
+	if (_mysql_query(m_db_,sql)) {
 		int err = mysql_errno(m_db_);
 		Glib::ustring msg = _("Unable to start a transaction!");
 		msg += "\n(";
@@ -248,25 +385,12 @@ DatabaseMariaDB::create_database_vfunc()
 {
 	assert(m_db_);
 	
-	std::string sql_file = Glib::build_filename (app->get_settings()->get_sql_dir(),
+	std::string sql_file = Glib::build_filename (db_get_sql_dir(),
 	                                             "growbook.mariadb.sql");
-	std::fstream file;
-	file.open(sql_file,std::ios::in);
-
-	std::string text, sql;
 	
-	while (std::getline(file,text)) {
-		if (text.empty())
-			continue;
-		if (!sql.empty())
-			sql+="\n";
-		sql += text;
-		if (sql[sql.size() - 1] == ';') {
-		if (mysql_query(m_db_,sql.c_str())) {
-				database_error(_("Creating database failed!"));
-			}
-			sql = "";
-		}
+	for (auto sql: db_read_sql_file(sql_file)) {
+		if (_mysql_query(m_db_,sql.c_str()))
+			database_error(_("Creating database failed!"));
 	}
 }
 
@@ -280,10 +404,10 @@ DatabaseMariaDB::get_breeders_vfunc() const
 	const char *sql = "SELECT id,name,homepage FROM breeder ORDER BY name;";
 	std::list<Glib::RefPtr<Breeder> > ret;
 
-	if (mysql_query(m_db_,sql)) {
+	if (_mysql_query(m_db_,sql)) {
 		database_error(_("Unable to fetch breeders from database!")); 
 	}
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result) {
 		database_error(_(RESULT_ERROR));
 	}
@@ -316,10 +440,10 @@ DatabaseMariaDB::get_breeder_vfunc(uint64_t id) const
 	
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get())) {
+	if (_mysql_query(m_db_,buffer.get(),sql)) {
 		database_error(_("Unable to get breeder from database!"));
 	}
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result) {
 		database_error(_(RESULT_ERROR));
 	}
@@ -347,11 +471,11 @@ DatabaseMariaDB::get_breeder_vfunc(const Glib::ustring &name) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,name_buffer.get());
 
-	if (mysql_query(m_db_,buffer.get())) {
+	if (_mysql_query(m_db_,buffer.get(),sql)) {
 		database_error(_("Unable to fetch breeder from Database!"));
 	}
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result) 
 		database_error(_(RESULT_ERROR));
 
@@ -413,7 +537,7 @@ DatabaseMariaDB::add_breeder_vfunc(const Glib::RefPtr<Breeder> &breeder)
 		sql_command = buffer.get();
 	}
 
-	if (mysql_query(m_db_,sql_command.c_str())) {
+	if (_mysql_query(m_db_,sql_command.c_str())) {
 		database_error(_("Unable to add breeder to database!"),true);
 	}
 	commit();
@@ -432,7 +556,7 @@ DatabaseMariaDB::remove_breeder_vfunc(uint64_t breeder_id)
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to delete breeder from database!"),true);
 	
 	commit();
@@ -445,7 +569,7 @@ DatabaseMariaDB::get_strains_for_breeder_vfunc(uint64_t breeder_id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT id,name,info,description,homepage,seedfinder FROM strain WHERE breeder=%s;";
+	const char *sql = "SELECT id,name,info,description,homepage,seedfinder FROM strain WHERE breeder=%s ORDER BY name;";
 	std::list<Glib::RefPtr<Strain> > ret;
 	Glib::RefPtr<Breeder> breeder = get_breeder(breeder_id);
 	if (!breeder)
@@ -456,10 +580,10 @@ DatabaseMariaDB::get_strains_for_breeder_vfunc(uint64_t breeder_id) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,breeder_id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to fetch strains for breeder from database!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -492,7 +616,7 @@ DatabaseMariaDB::get_strains_for_growlog_vfunc(uint64_t growlog_id) const
 {
 	assert(m_db_);
 	
-	const char *sql = "SELECT strain FROM growlog_strain WHERE growlog=%s;";
+	const char *sql = "SELECT strain FROM growlog_strain WHERE growlog=%s ORDER BY strain;";
 	std::list<Glib::RefPtr<Strain> > ret;
 
 	std::string growlog_id_str = std::to_string(growlog_id);
@@ -500,10 +624,10 @@ DatabaseMariaDB::get_strains_for_growlog_vfunc(uint64_t growlog_id) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,growlog_id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get())) 
+	if (_mysql_query(m_db_,buffer.get(),sql)) 
 		database_error(_("Unable to fetch strains for growlog!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -536,10 +660,10 @@ DatabaseMariaDB::get_strain_vfunc(uint64_t id) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to lookup strain!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -586,10 +710,10 @@ DatabaseMariaDB::get_strain_vfunc(const Glib::ustring &breeder_name,
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,breeder_id_str.c_str(),strain_buffer.get());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to fetch strain from database!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -700,7 +824,7 @@ DatabaseMariaDB::add_strain_vfunc(const Glib::RefPtr<Strain> &strain)
 		sql_command = buffer.get();
 	}
 
-	if (mysql_query(m_db_,sql_command.c_str()))
+	if (_mysql_query(m_db_,sql_command.c_str()))
 		database_error(_("Unable to add strain to database!"),true);
 
 	commit();
@@ -721,12 +845,56 @@ DatabaseMariaDB::remove_strain_vfunc(uint64_t strain_id)
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to delete strain!"),true);
 
 	commit();
 }
 
+std::list<Glib::RefPtr<Strain> >
+DatabaseMariaDB::get_strains_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT s.id,s.breeder,b.name,s.name,s.info,s.description,s.homepage,s.seedfinder FROM strain AS s JOIN breeder AS b ON b.id=s.breeder ORDER BY b.name,s.name;";
+	std::list<Glib::RefPtr<Strain> > ret;
+
+	if (_mysql_query(m_db_,sql))
+		database_error(_("Unable to fetch strains from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row;
+	while ((row = mysql_fetch_row(result)))
+		ret.push_back(_mysql_strain(row,0));
+	mysql_free_result(result);
+	return ret;
+}
+
+std::map<uint64_t,std::list<Glib::RefPtr<Strain> > >
+DatabaseMariaDB::get_strains_for_growlogs_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT gs.growlog,s.id,s.breeder,b.name,s.name,s.info,s.description,s.homepage,s.seedfinder FROM growlog_strain AS gs JOIN strain AS s ON s.id=gs.strain JOIN breeder AS b ON b.id=s.breeder ORDER BY gs.growlog,gs.strain;";
+	std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > ret;
+
+	if (_mysql_query(m_db_,sql))
+		database_error(_("Unable to fetch strains for growlog!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row;
+	while ((row = mysql_fetch_row(result)))
+		ret[std::stoull(row[0])].push_back(_mysql_strain(row,1));
+	mysql_free_result(result);
+	return ret;
+}
+
 /**** Growlog methods *********************************************************/
 
 std::list<Glib::RefPtr<Growlog> > 
@@ -737,10 +905,10 @@ DatabaseMariaDB::get_growlogs_vfunc() const
 	const char *sql = "SELECT id,title,description,created_on,flower_on,finished_on FROM growlog ORDER BY title;";
 	std::list<Glib::RefPtr<Growlog> > ret;
 	
-	if (mysql_query(m_db_,sql))
+	if (_mysql_query(m_db_,sql))
 		database_error(_("Unable to fetch growlogs from database!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -750,17 +918,20 @@ DatabaseMariaDB::get_growlogs_vfunc() const
 
 		tm datetime;
 		strptime(row[3],DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		time_t flower_on = 0;
 		if (row[4] && strlen(row[4])) {
 			strptime(row[4],DATE_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			flower_on = mktime(&datetime);
 		}
 
 		time_t finished_on = 0;
 		if (row[5] && strlen(row[5])) {
 			strptime(row[5],DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			finished_on = mktime(&datetime);
 		}
 		
@@ -785,10 +956,10 @@ DatabaseMariaDB::get_ongoing_growlogs_vfunc() const
 	const char *sql = "SELECT id,title,description,created_on,flower_on,finished_on FROM growlog WHERE finished_on IS NULL ORDER BY title;";
 	std::list<Glib::RefPtr<Growlog> > ret;
 	
-	if (mysql_query(m_db_,sql))
+	if (_mysql_query(m_db_,sql))
 		database_error(_("Unable to fetch growlogs from database!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -798,17 +969,20 @@ DatabaseMariaDB::get_ongoing_growlogs_vfunc() const
 
 		tm datetime;
 		strptime(row[3],DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		time_t flower_on = 0;
 		if (row[4] && strlen(row[4])) {
 			strptime(row[4],DATE_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			flower_on = mktime(&datetime);
 		}
 
 		time_t finished_on = 0;
 		if (row[5] && strlen(row[5])) {
 			strptime(row[5],DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			finished_on = mktime(&datetime);
 		}
 		
@@ -833,10 +1007,10 @@ DatabaseMariaDB::get_finished_growlogs_vfunc() const
 	const char *sql = "SELECT id,title,description,created_on,flower_on,finished_on FROM growlog WHERE finished_on IS NOT NULL ORDER BY title;";
 	std::list<Glib::RefPtr<Growlog> > ret;
 	
-	if (mysql_query(m_db_,sql))
+	if (_mysql_query(m_db_,sql))
 		database_error(_("Unable to fetch growlogs from database!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -846,17 +1020,20 @@ DatabaseMariaDB::get_finished_growlogs_vfunc() const
 
 		tm datetime;
 		strptime(row[3],DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		time_t flower_on = 0;
 		if (row[4] && strlen(row[4])) {
 			strptime(row[4],DATE_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			flower_on = mktime(&datetime);
 		}
 
 		time_t finished_on = 0;
 		if (row[5] && strlen(row[5])) {
 			strptime(row[5],DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			finished_on = mktime(&datetime);
 		}
 		
@@ -887,10 +1064,10 @@ DatabaseMariaDB::get_growlogs_for_strain_vfunc(uint64_t strain_id) const
 
 	snprintf(buffer.get(),len,sql,strain_id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to lookup growlogs for strain!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -924,10 +1101,10 @@ DatabaseMariaDB::get_growlog_vfunc(uint64_t id) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to lookup growlog by id!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -936,17 +1113,20 @@ DatabaseMariaDB::get_growlog_vfunc(uint64_t id) const
 		tm datetime;
 
 		strptime(row[2],DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		time_t flower_on = 0;
 		if (row[3] && strlen(row[3])) {
 			strptime(row[3],DATE_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			flower_on = mktime(&datetime);
 		}
 
 		time_t finished_on = 0;
 		if (row[4] && strlen(row[4])) {
 			strptime(row[4],DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			finished_on = mktime(&datetime);
 		}
 
@@ -978,10 +1158,10 @@ DatabaseMariaDB::get_growlog_vfunc(const Glib::ustring &title) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,title_buffer.get());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to lookup growlog by title!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -991,17 +1171,20 @@ DatabaseMariaDB::get_growlog_vfunc(const Glib::ustring &title) const
 
 		tm datetime;
 		strptime(row[2],DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		time_t flower_on = 0;
 		if (row[3] && strlen(row[3])) {
 			strptime(row[3],DATE_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			flower_on = mktime(&datetime);
 		}
 
 		time_t finished_on = 0;
 		if (row[4] && strlen(row[4])) {
 			strptime(row[4],DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			finished_on = mktime(&datetime);
 		}
 
@@ -1128,7 +1311,7 @@ DatabaseMariaDB::add_growlog_vfunc(const Glib::RefPtr<Growlog> &growlog)
 		sql_command = buffer.get();
 	}
 
-	if (mysql_query(m_db_,sql_command.c_str()))
+	if (_mysql_query(m_db_,sql_command.c_str()))
 		database_error(_("Unable to add growlog!"),true);
 
 	commit();
@@ -1148,7 +1331,7 @@ DatabaseMariaDB::remove_growlog_vfunc(uint64_t id)
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to delete growlog!"),true);
 
 	commit();
@@ -1161,7 +1344,7 @@ DatabaseMariaDB::get_growlog_entries_vfunc(uint64_t growlog_id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=%s ORDER BY created_on;";
+	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=%s ORDER BY created_on,id;";
 	std::list<Glib::RefPtr<GrowlogEntry> > ret;
 
 	std::string growlog_id_str = std::to_string(growlog_id);
@@ -1170,10 +1353,53 @@ DatabaseMariaDB::get_growlog_entries_vfunc(uint64_t growlog_id) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,growlog_id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to lookup growlog-entries!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row;
+	while((row = mysql_fetch_row(result))) {
+		uint64_t id = std::stoull(row[0]);
+		tm datetime;
+		strptime(row[2], DATETIME_ISO_FORMAT, &datetime);
+		datetime.tm_isdst = -1;
+		time_t created_on = mktime(&datetime);
+
+		Glib::RefPtr<GrowlogEntry> entry = GrowlogEntry::create(id,
+		                                                        growlog_id,
+		                                                        row[1],
+		                                                        created_on);
+		ret.push_back(entry);
+	}
+	mysql_free_result(result);
+	return ret;
+}
+
+std::list<Glib::RefPtr<GrowlogEntry> >
+DatabaseMariaDB::get_growlog_entries_vfunc(uint64_t growlog_id,
+                                           uint64_t offset,
+                                           uint64_t limit) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=%s ORDER BY created_on,id LIMIT %s OFFSET %s;";
+	std::list<Glib::RefPtr<GrowlogEntry> > ret;
+
+	std::string growlog_id_str = std::to_string(growlog_id);
+	std::string limit_str = std::to_string(limit);
+	std::string offset_str = std::to_string(offset);
+	
+	size_t len = strlen(sql) + growlog_id_str.size() + limit_str.size() + offset_str.size() + 1;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,growlog_id_str.c_str(),limit_str.c_str(),offset_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to lookup growlog-entries!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -1182,6 +1408,7 @@ DatabaseMariaDB::get_growlog_entries_vfunc(uint64_t growlog_id) const
 		uint64_t id = std::stoull(row[0]);
 		tm datetime;
 		strptime(row[2], DATETIME_ISO_FORMAT, &datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		Glib::RefPtr<GrowlogEntry> entry = GrowlogEntry::create(id,
@@ -1194,12 +1421,39 @@ DatabaseMariaDB::get_growlog_entries_vfunc(uint64_t growlog_id) const
 	return ret;
 }
 
+uint64_t
+DatabaseMariaDB::get_growlog_entry_count_vfunc(uint64_t growlog_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT COUNT(*) FROM growlog_entry WHERE growlog=%s;";
+	uint64_t ret = 0;
+
+	std::string growlog_id_str = std::to_string(growlog_id);
+	size_t len = strlen(sql) + growlog_id_str.size() + 1;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,growlog_id_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to count growlog-entries!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row = mysql_fetch_row(result);
+	if (row && row[0])
+		ret = std::stoull(row[0]);
+	mysql_free_result(result);
+	return ret;
+}
+
 Glib::RefPtr<GrowlogEntry> 
 DatabaseMariaDB::get_growlog_entry_vfunc(uint64_t id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT growlog_id,entry,created_on FROM growlog_entry WHERE id=%s;";
+	const char *sql = "SELECT growlog,entry,created_on FROM growlog_entry WHERE id=%s;";
 	Glib::RefPtr<GrowlogEntry> entry;
 
 	std::string id_str = std::to_string(id);
@@ -1207,10 +1461,10 @@ DatabaseMariaDB::get_growlog_entry_vfunc(uint64_t id) const
 	std::unique_ptr<char[]> buffer(new char[len]);
 	snprintf(buffer.get(),len,sql,id_str.c_str());
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to lookup growlog-entry!"));
 
-	MYSQL_RES *result = mysql_store_result(m_db_);
+	MYSQL_RES *result = _mysql_store_result(m_db_);
 	if (!result)
 		database_error(_(RESULT_ERROR));
 
@@ -1220,6 +1474,7 @@ DatabaseMariaDB::get_growlog_entry_vfunc(uint64_t id) const
 
 		tm datetime;
 		strptime(row[2],DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		entry = GrowlogEntry::create(id,growlog_id,row[1],created_on);
@@ -1274,7 +1529,7 @@ DatabaseMariaDB::add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &entry
 
 	begin_transaction ();
 	
-	if (mysql_query(m_db_,sql_command.c_str()))
+	if (_mysql_query(m_db_,sql_command.c_str()))
 		database_error(_("Unable to add growlog-entry!"),true);
 
 	commit();
@@ -1295,12 +1550,110 @@ DatabaseMariaDB::remove_growlog_entry_vfunc(uint64_t id)
 
 	begin_transaction();
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to delete growlog-entry!"),true);
 
 	commit();
 }
 
+void
+DatabaseMariaDB::foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT e.id,e.growlog,e.entry,e.created_on FROM growlog AS g JOIN growlog_entry AS e ON e.growlog=g.id ORDER BY g.title,e.created_on,e.id;";
+
+	if (_mysql_query(m_db_,sql))
+		database_error(_("Unable to lookup growlog-entries!"));
+
+	// mysql_use_result() streams the rows from the server, the statement
+	// is recorded once all rows have been read
+	QueryStat *stat = _mysql_last_stat;
+	auto start = _mysql_last_start;
+	_mysql_last_stat = nullptr;
+	MYSQL_RES *result = mysql_use_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	uint64_t n_rows = 0, n_bytes = 0;
+	MYSQL_ROW row;
+	try {
+		while ((row = mysql_fetch_row(result))) {
+			unsigned long *lengths = mysql_fetch_lengths(result);
+			uint64_t id = std::stoull(row[0]);
+			uint64_t growlog_id = std::stoull(row[1]);
+			tm datetime;
+			strptime(row[3], DATETIME_ISO_FORMAT, &datetime);
+			datetime.tm_isdst = -1;
+			time_t created_on = mktime(&datetime);
+
+			++n_rows;
+			n_bytes += (lengths ? lengths[2] : 0);
+			slot(GrowlogEntry::create(id,growlog_id,row[2],created_on));
+		}
+	} catch (...) {
+		// frees the rows that have not been fetched yet as well
+		mysql_free_result(result);
+		throw;
+	}
+	bool failed = (mysql_errno(m_db_) != 0);
+	mysql_free_result(result);
+	if (stat)
+		stat->record(_mysql_elapsed_ns(start),n_rows,n_bytes);
+	if (failed)
+		database_error(_("Unable to lookup growlog-entries!"));
+}
+
+void
+DatabaseMariaDB::add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows)
+{
+	assert(m_db_);
+
+	// Multi-row INSERTs of about 1 MiB each, well below the default
+	// max_allowed_packet.
+	const char *sql = "INSERT INTO growlog_entry (growlog,entry,created_on) VALUES ";
+	const size_t flush_size = 1024 * 1024;
+
+	std::string sql_command;
+	sql_command.reserve(flush_size + 4096);
+	std::unique_ptr<char[]> text_buffer;
+	size_t text_buffer_size = 0;
+	char created_on[32];
+
+	begin_transaction();
+
+	for (auto iter = rows.begin(); iter != rows.end(); ++iter) {
+		if (sql_command.empty()) {
+			sql_command = sql;
+		} else {
+			sql_command += ',';
+		}
+
+		if (text_buffer_size < iter->text_size * 2 + 1) {
+			text_buffer_size = iter->text_size * 2 + 1;
+			text_buffer.reset(new char[text_buffer_size]);
+		}
+		unsigned long text_len = mysql_real_escape_string(m_db_,text_buffer.get(),iter->text,iter->text_size);
+
+		sql_command += '(';
+		sql_command += std::to_string(iter->growlog_id);
+		sql_command += ",'";
+		sql_command.append(text_buffer.get(),text_len);
+		sql_command += "','";
+		sql_command.append(created_on,db_format_datetime(iter->created_on,created_on,sizeof(created_on)));
+		sql_command += "')";
+
+		if (sql_command.size() >= flush_size || iter + 1 == rows.end()) {
+			sql_command += ';';
+			if (_mysql_query(m_db_,sql_command.c_str()))
+				database_error(_("Unable to add growlog-entry!"),true);
+			sql_command.clear();
+		}
+	}
+
+	commit();
+}
+
 /**** growlog_strain methods **************************************************/
 
 void 
@@ -1319,7 +1672,7 @@ DatabaseMariaDB::add_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strai
 
 	begin_transaction();
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to insert into growlog_strain!"),true);
 
 	commit();
@@ -1341,7 +1694,7 @@ DatabaseMariaDB::remove_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t st
 
 	begin_transaction();
 	
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error("Unable to delete from 'growlog_strain'!",true);
 
 	commit();
@@ -1362,11 +1715,253 @@ DatabaseMariaDB::remove_strain_for_growlog_vfunc(uint64_t id)
 
 	begin_transaction();
 
-	if (mysql_query(m_db_,buffer.get()))
+	if (_mysql_query(m_db_,buffer.get(),sql))
 		database_error(_("Unable to delete from 'growlog_strain'!"));
 
 	commit();
 }
 
+/**** Statistics methods ******************************************************/
+
+GrowlogStats
+DatabaseMariaDB::get_growlog_stats_vfunc(uint64_t growlog_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT growlog,entry_count,first_entry_on,last_entry_on,text_bytes FROM growlog_stats WHERE growlog=%s;";
+	GrowlogStats ret;
+	ret.growlog_id = growlog_id;
+
+	std::string growlog_id_str = std::to_string(growlog_id);
+	size_t len = strlen(sql) + growlog_id_str.size() + 1;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,growlog_id_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to fetch growlog statistics from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row = mysql_fetch_row(result);
+	if (row)
+		ret = _mysql_growlog_stats(row);
+	mysql_free_result(result);
+	return ret;
+}
+
+std::list<GrowlogStats>
+DatabaseMariaDB::get_growlog_stats_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT growlog,entry_count,first_entry_on,last_entry_on,text_bytes FROM growlog_stats;";
+	std::list<GrowlogStats> ret;
+
+	if (_mysql_query(m_db_,sql))
+		database_error(_("Unable to fetch growlog statistics from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row;
+	while ((row = mysql_fetch_row(result)))
+		ret.push_back(_mysql_growlog_stats(row));
+	mysql_free_result(result);
+	return ret;
+}
+
+StrainStats
+DatabaseMariaDB::get_strain_stats_vfunc(uint64_t strain_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT strain,growlog_count,veg_count,veg_days,flower_count,flower_days FROM strain_stats WHERE strain=%s;";
+	StrainStats ret;
+	ret.strain_id = strain_id;
+
+	std::string strain_id_str = std::to_string(strain_id);
+	size_t len = strlen(sql) + strain_id_str.size() + 1;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,strain_id_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to fetch strain statistics from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row = mysql_fetch_row(result);
+	if (row)
+		ret = _mysql_strain_stats(row);
+	mysql_free_result(result);
+	return ret;
+}
+
+std::list<StrainStats>
+DatabaseMariaDB::get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT st.strain,st.growlog_count,st.veg_count,st.veg_days,st.flower_count,st.flower_days FROM strain_stats AS st JOIN strain AS s ON s.id=st.strain WHERE s.breeder=%s;";
+	std::list<StrainStats> ret;
+
+	std::string breeder_id_str = std::to_string(breeder_id);
+	size_t len = strlen(sql) + breeder_id_str.size() + 1;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,breeder_id_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to fetch strain statistics from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row;
+	while ((row = mysql_fetch_row(result)))
+		ret.push_back(_mysql_strain_stats(row));
+	mysql_free_result(result);
+	return ret;
+}
+
+void
+DatabaseMariaDB::rebuild_stats_vfunc()
+{
+	assert(m_db_);
+
+	// the connection is opened without CLIENT_MULTI_STATEMENTS
+	static const char *sql[] = {
+		"DELETE FROM growlog_stats;",
+		"INSERT INTO growlog_stats (growlog,entry_count,first_entry_on,last_entry_on,text_bytes) "
+		"SELECT g.id,COUNT(e.id),MIN(e.created_on),MAX(e.created_on),IFNULL(SUM(LENGTH(e.entry)),0) "
+		"FROM growlog AS g LEFT JOIN growlog_entry AS e ON e.growlog=g.id GROUP BY g.id;",
+		"DELETE FROM strain_stats;",
+		"INSERT INTO strain_stats (strain,growlog_count,veg_count,veg_days,flower_count,flower_days) "
+		"SELECT s.id,COUNT(g.id),COUNT(g.flower_on),"
+		"IFNULL(SUM(DATEDIFF(g.flower_on,g.created_on)),0),"
+		"COUNT(CASE WHEN g.flower_on IS NOT NULL AND g.finished_on IS NOT NULL THEN 1 END),"
+		"IFNULL(SUM(DATEDIFF(g.finished_on,g.flower_on)),0) "
+		"FROM strain AS s LEFT JOIN growlog_strain AS gs ON gs.strain=s.id "
+		"LEFT JOIN growlog AS g ON g.id=gs.growlog GROUP BY s.id;",
+		nullptr
+	};
+
+	begin_transaction();
+	for (const char **stmt = sql; *stmt; ++stmt) {
+		if (_mysql_query(m_db_,*stmt))
+			database_error(_("Rebuilding statistics failed!"),true);
+	}
+	commit();
+}
+
+/**** Change tracking methods *************************************************/
+
+uint64_t
+DatabaseMariaDB::get_change_seq_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT IFNULL(MAX(seq),0) FROM change_log;";
+	uint64_t ret = 0;
+
+	if (_mysql_query(m_db_,sql))
+		database_error(_("Unable to fetch the change sequence from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row = mysql_fetch_row(result);
+	if (row && row[0])
+		ret = std::stoull(row[0]);
+	mysql_free_result(result);
+	return ret;
+}
+
+void
+DatabaseMariaDB::foreach_change_vfunc(uint64_t after,
+                                      uint64_t upto,
+                                      const sigc::slot<void,const ChangeRecord&> &slot) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT seq,table_name,row_id,op,key1,key2,key3,new_key1,new_key2,new_key3 FROM change_log WHERE seq>%s AND seq<=%s ORDER BY seq;";
+	std::list<ChangeRecord> records;
+
+	std::string after_str = std::to_string(after);
+	std::string upto_str = std::to_string(upto);
+	size_t len = strlen(sql) + after_str.size() + upto_str.size() + 1;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,after_str.c_str(),upto_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to fetch changes from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row;
+	while ((row = mysql_fetch_row(result)))
+		records.push_back(_mysql_change_record(row));
+	mysql_free_result(result);
+
+	for (auto &record: records)
+		slot(record);
+}
+
+uint64_t
+DatabaseMariaDB::get_change_watermark_vfunc(const Glib::ustring &name) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT seq FROM change_watermark WHERE name='%s';";
+	uint64_t ret = 0;
+
+	size_t name_len = name.bytes() * 2 + 1;
+	std::unique_ptr<char[]> name_buffer(new char[name_len]);
+	mysql_real_escape_string(m_db_,name_buffer.get(),name.c_str(),name.bytes());
+
+	size_t len = strlen(sql) + name_len;
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,name_buffer.get());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Unable to fetch the change watermark from database!"));
+
+	MYSQL_RES *result = _mysql_store_result(m_db_);
+	if (!result)
+		database_error(_(RESULT_ERROR));
+
+	MYSQL_ROW row = mysql_fetch_row(result);
+	if (row && row[0])
+		ret = std::stoull(row[0]);
+	mysql_free_result(result);
+	return ret;
+}
+
+void
+DatabaseMariaDB::set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq)
+{
+	assert(m_db_);
+
+	const char *sql = "REPLACE INTO change_watermark (name,seq) VALUES ('%s',%s);";
+
+	size_t name_len = name.bytes() * 2 + 1;
+	std::unique_ptr<char[]> name_buffer(new char[name_len]);
+	mysql_real_escape_string(m_db_,name_buffer.get(),name.c_str(),name.bytes());
+
+	std::string seq_str = std::to_string(seq);
+	size_t len = strlen(sql) + name_len + seq_str.size();
+	std::unique_ptr<char[]> buffer(new char[len]);
+	snprintf(buffer.get(),len,sql,name_buffer.get(),seq_str.c_str());
+
+	if (_mysql_query(m_db_,buffer.get(),sql))
+		database_error(_("Storing the change watermark failed!"));
+}
 
 #endif /* HAVE_MARIADB */
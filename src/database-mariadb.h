@@ -101,6 +101,8 @@ class DatabaseMariaDB:
 		                                               const Glib::ustring &strain_name) const override;
 		virtual void add_strain_vfunc(const Glib::RefPtr<Strain> &strain) override;
 		virtual void remove_strain_vfunc(uint64_t strain_id) override;
+		virtual std::list<Glib::RefPtr<Strain> > get_strains_vfunc() const override;
+		virtual std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > get_strains_for_growlogs_vfunc() const override;
 
 		virtual std::list<Glib::RefPtr<Growlog> > get_growlogs_vfunc() const override;
 		virtual std::list<Glib::RefPtr<Growlog> > get_ongoing_growlogs_vfunc() const override;
@@ -112,13 +114,32 @@ class DatabaseMariaDB:
 		virtual void remove_growlog_vfunc(uint64_t id) override;
 
 		virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id) const override;
+		virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id,
+		                                                                         uint64_t offset,
+		                                                                         uint64_t limit) const override;
+		virtual uint64_t get_growlog_entry_count_vfunc(uint64_t growlog_id) const override;
 		virtual Glib::RefPtr<GrowlogEntry> get_growlog_entry_vfunc(uint64_t id) const override;
 		virtual void add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &entry) override;
 		virtual void remove_growlog_entry_vfunc(uint64_t id) override;
+		virtual void foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const override;
+		virtual void add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows) override;
 
 		virtual void add_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) override;
 		virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) override;
 		virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_strain_id) override;		
+
+		virtual GrowlogStats get_growlog_stats_vfunc(uint64_t growlog_id) const override;
+		virtual std::list<GrowlogStats> get_growlog_stats_vfunc() const override;
+		virtual StrainStats get_strain_stats_vfunc(uint64_t strain_id) const override;
+		virtual std::list<StrainStats> get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const override;
+		virtual void rebuild_stats_vfunc() override;
+
+		virtual uint64_t get_change_seq_vfunc() const override;
+		virtual void foreach_change_vfunc(uint64_t after,
+		                                  uint64_t upto,
+		                                  const sigc::slot<void,const ChangeRecord&> &slot) const override;
+		virtual uint64_t get_change_watermark_vfunc(const Glib::ustring &name) const override;
+		virtual void set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq) override;
 }; // DatabaseMariaDB class
 
 
@@ -0,0 +1,1943 @@
+//           database-mirror.cc
+//  Mo Oktober 19 18:42:07 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// database-mirror.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "database-mirror.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sqlite3.h>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <glibmm.h>
+#include <glibmm/i18n.h>
+#include <algorithm>
+#include <set>
+
+#include "error.h"
+#include "trace.h"
+
+// change_watermark name of the last remote change that was pulled
+#define MIRROR_WATERMARK "mirror-remote"
+// remote entries are fetched by id up to this number, else all are read
+#define MIRROR_ENTRY_LOOKUP_LIMIT 1000
+// seconds the sync thread waits after a write, so a burst of writes is
+// pushed at once
+#define MIRROR_WRITE_DELAY 2
+
+typedef std::lock_guard<std::recursive_mutex> MirrorLock;
+
+static sqlite3_stmt*
+_mirror_prepare(sqlite3 *db, const char *sql, const Glib::ustring &error)
+{
+	sqlite3_stmt *stmt = nullptr;
+	int err = sqlite3_prepare(db,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = error;
+		msg += "\n(";
+		msg += sqlite3_errmsg(db);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	return stmt;
+}
+
+// Steps a statement that returns no rows and finalizes it.
+static void
+_mirror_exec(sqlite3 *db, sqlite3_stmt *stmt, const Glib::ustring &error)
+{
+	int err = sqlite3_step(stmt);
+	if (err != SQLITE_OK && err != SQLITE_DONE) {
+		Glib::ustring msg = error;
+		msg += "\n(";
+		msg += sqlite3_errmsg(db);
+		msg += ")";
+		sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_finalize(stmt);
+}
+
+static std::string
+_mirror_entry_key(time_t created_on, const Glib::ustring &text)
+{
+	std::string key = std::to_string(created_on);
+	key += '\0';
+	key += text.raw();
+	return key;
+}
+
+/*******************************************************************************
+ * DatabaseMirror::PullData
+ ******************************************************************************/
+
+// The remote rows of one sync(), fetched before the replica is locked.
+struct DatabaseMirror::PullData
+{
+	uint64_t upto = 0;
+	// 'D' records in the order they happened
+	std::vector<ChangeRecord> deletes;
+	// seq of the last change of a remote row, rows that are missing here
+	// were read by a full pull and count as changed at upto
+	std::map<std::pair<std::string,uint64_t>,uint64_t> seqs;
+	std::list<Glib::RefPtr<Breeder> > breeders;
+	std::list<Glib::RefPtr<Strain> > strains;
+	std::list<Glib::RefPtr<Growlog> > growlogs;
+	std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > growlog_strains;
+	std::vector<Glib::RefPtr<GrowlogEntry> > entries;
+	uint64_t rows = 0;
+
+	uint64_t get_seq(const std::string &table, uint64_t remote_id) const
+	{
+		auto iter = seqs.find(std::make_pair(table,remote_id));
+		return (iter != seqs.end() ? iter->second : upto);
+	}
+};
+
+/*******************************************************************************
+ * DatabaseMirror
+ ******************************************************************************/
+
+DatabaseMirror::DatabaseMirror(const Glib::RefPtr<Database> &remote,
+                               const std::string &filename):
+	DatabaseSqlite3{DatabaseSettings::create("sqlite3",filename,DB_NAME_IS_FILENAME)},
+	m_remote_{remote},
+	m_mutex_{},
+	m_sync_mutex_{},
+	m_online_{false},
+	m_sync_thread_{},
+	m_thread_mutex_{},
+	m_thread_cond_{},
+	m_thread_stop_{false},
+	m_thread_wake_{false},
+	m_sync_interval_{60},
+	m_dispatcher_{},
+	m_new_conflicts_{},
+	m_pulled_rows_{0},
+	m_synced_{false},
+	m_remote_refused_{false},
+	m_signal_conflict_{},
+	m_signal_synced_{}
+{
+	assert(remote);
+}
+
+DatabaseMirror::~DatabaseMirror()
+{
+	stop_sync();
+}
+
+Glib::RefPtr<DatabaseMirror>
+DatabaseMirror::create(const Glib::RefPtr<Database> &remote,
+                       const std::string &filename)
+{
+	return Glib::RefPtr<DatabaseMirror>(new DatabaseMirror(remote,filename));
+}
+
+Glib::RefPtr<Database>
+DatabaseMirror::get_remote()
+{
+	return m_remote_;
+}
+
+Glib::RefPtr<const Database>
+DatabaseMirror::get_remote() const
+{
+	return Glib::RefPtr<const Database>::cast_const(m_remote_);
+}
+
+bool
+DatabaseMirror::is_online() const
+{
+	return m_online_;
+}
+
+sigc::signal<void,const MirrorConflict&>&
+DatabaseMirror::signal_conflict()
+{
+	return m_signal_conflict_;
+}
+
+sigc::signal<void,uint64_t>&
+DatabaseMirror::signal_synced()
+{
+	return m_signal_synced_;
+}
+
+/**** Connection methods ******************************************************/
+
+bool
+DatabaseMirror::test_connection_vfunc()
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::test_connection_vfunc();
+}
+
+void
+DatabaseMirror::create_database_vfunc()
+{
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::create_database_vfunc();
+	_create_tables();
+}
+
+// The replica works without the remote database, it is connected by
+// sync() once it can be reached.
+void
+DatabaseMirror::connect_vfunc()
+{
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::connect_vfunc();
+
+	// the sync thread and the main thread take turns, a write ahead log
+	// keeps the commits of the replica cheap
+	char *errmsg = nullptr;
+	sqlite3_exec(get_handle(),"PRAGMA journal_mode=WAL;",0,0,&errmsg);
+	sqlite3_free(errmsg);
+
+	DatabaseSqlite3::create_database_vfunc();
+	_create_tables();
+}
+
+void
+DatabaseMirror::close_vfunc()
+{
+	stop_sync();
+
+	std::lock_guard<std::mutex> sync_lock(m_sync_mutex_);
+	if (m_remote_->is_connected())
+		m_remote_->close();
+
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::close_vfunc();
+}
+
+void
+DatabaseMirror::_create_tables()
+{
+	std::string sql_file = Glib::build_filename(db_get_sql_dir(),
+	                                            "growbook.mirror.sql");
+	char *errmsg;
+	int err;
+
+	for (auto sql: db_read_sql_file(sql_file)) {
+		err = sqlite3_exec(get_handle(),sql.c_str(),0,0,&errmsg);
+		if (err != SQLITE_OK) {
+			Glib::ustring msg = _("Unable to create the tables of the mirror!");
+			msg += "\n(";
+			msg += errmsg;
+			msg += ")";
+			sqlite3_free(errmsg);
+			throw DatabaseError(err,msg);
+		}
+	}
+}
+
+/**** Sync methods ************************************************************/
+
+bool
+DatabaseMirror::sync()
+{
+	TRACE_SCOPE("mirror","DatabaseMirror::sync");
+	std::lock_guard<std::mutex> sync_lock(m_sync_mutex_);
+
+	if (!m_remote_->is_connected()) {
+		try {
+			m_remote_->connect();
+		} catch (DatabaseError &ex) {
+			m_online_ = false;
+			return false;
+		}
+		_prepare_remote();
+		if (!m_remote_->is_connected()) {
+			m_online_ = false;
+			return false;
+		}
+	}
+
+	try {
+		PullData data;
+		uint64_t after;
+		bool full;
+		{
+			MirrorLock lock(m_mutex_);
+			after = DatabaseSqlite3::get_change_watermark_vfunc(MIRROR_WATERMARK);
+			full = !_has_pulled();
+		}
+		_fetch_remote(after,full,data);
+		{
+			MirrorLock lock(m_mutex_);
+			_apply_pull(data);
+			DatabaseSqlite3::set_change_watermark_vfunc(MIRROR_WATERMARK,data.upto);
+			m_pulled_rows_ += data.rows;
+		}
+
+		for (auto &change: _outbox_get()) {
+			try {
+				_push(change);
+			} catch (DatabaseError &ex) {
+				if (!_remote_alive())
+					throw;
+				MirrorLock lock(m_mutex_);
+				_add_conflict(MIRROR_CONFLICT_REJECTED,
+				              change.table,
+				              change.row_id,
+				              _map_remote(change.table,change.row_id),
+				              _local_name(change),
+				              ex.what());
+				_outbox_remove(change.seq);
+			}
+		}
+	} catch (DatabaseError &ex) {
+		if (_remote_alive())
+			throw;
+		m_online_ = false;
+		return false;
+	}
+
+	m_online_ = true;
+	{
+		MirrorLock lock(m_mutex_);
+		m_synced_ = true;
+	}
+	_notify();
+	return true;
+}
+
+// After a failed remote call: true if the remote database still answers,
+// so the call was refused. Otherwise the connection is closed and opened
+// again by the next sync(). The probe uses a table every book has, a
+// missing change_log must not look like a dead connection.
+bool
+DatabaseMirror::_remote_alive()
+{
+	try {
+		m_remote_->get_growlog_entry_count(0);
+		return true;
+	} catch (DatabaseError &ex) {
+		try {
+			m_remote_->close();
+		} catch (DatabaseError &ex) {
+		}
+		return false;
+	}
+}
+
+// Called after the remote database has been connected. Books created
+// before change tracking was added do not have change_log yet,
+// rebuild_stats() installs it along with the statistics.
+void
+DatabaseMirror::_prepare_remote()
+{
+	try {
+		m_remote_->get_change_seq();
+		m_remote_refused_ = false;
+		return;
+	} catch (DatabaseError &ex) {
+	}
+
+	try {
+		m_remote_->rebuild_stats();
+		m_remote_refused_ = false;
+	} catch (DatabaseError &ex) {
+		if (!_remote_alive())
+			return;
+
+		Glib::ustring msg = _("The remote database has no change tracking and refused to install it, run \"growbook-cli rebuild-stats\" on it with a user that may create tables and triggers!");
+		msg += "\n(";
+		msg += ex.what();
+		msg += ")";
+		if (!m_remote_refused_) {
+			m_remote_refused_ = true;
+			{
+				MirrorLock lock(m_mutex_);
+				_add_conflict(MIRROR_CONFLICT_REJECTED,
+				              "change_log",
+				              0,
+				              0,
+				              m_remote_->get_settings()->get_dbname(),
+				              msg);
+			}
+			_notify();
+		}
+		// the next sync() connects and tries again
+		try {
+			m_remote_->close();
+		} catch (DatabaseError &ex) {
+		}
+		m_online_ = false;
+		throw DatabaseError(msg);
+	}
+}
+
+void
+DatabaseMirror::start_sync(unsigned int interval)
+{
+	if (m_sync_thread_.joinable())
+		return;
+
+	if (!m_dispatcher_) {
+		m_dispatcher_.reset(new Glib::Dispatcher());
+		m_dispatcher_->connect(sigc::mem_fun(*this,&DatabaseMirror::_emit_results));
+	}
+	m_sync_interval_ = (interval ? interval : 1);
+	m_thread_stop_ = false;
+	m_thread_wake_ = false;
+	m_sync_thread_ = std::thread(&DatabaseMirror::_sync_thread,this);
+}
+
+void
+DatabaseMirror::stop_sync()
+{
+	if (!m_sync_thread_.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_thread_mutex_);
+		m_thread_stop_ = true;
+	}
+	m_thread_cond_.notify_all();
+	m_sync_thread_.join();
+}
+
+void
+DatabaseMirror::_sync_thread()
+{
+	trace_set_thread_name("mirror");
+
+	std::unique_lock<std::mutex> lock(m_thread_mutex_);
+	while (!m_thread_stop_) {
+		lock.unlock();
+		try {
+			sync();
+		} catch (DatabaseError &ex) {
+			fprintf(stderr,"%s\n",ex.what());
+		}
+		lock.lock();
+
+		m_thread_cond_.wait_for(lock,
+		                        std::chrono::seconds(m_sync_interval_),
+		                        [this]() { return m_thread_stop_ || m_thread_wake_; });
+		if (m_thread_wake_ && !m_thread_stop_) {
+			m_thread_wake_ = false;
+			m_thread_cond_.wait_for(lock,
+			                        std::chrono::seconds(MIRROR_WRITE_DELAY),
+			                        [this]() { return m_thread_stop_; });
+		}
+	}
+}
+
+void
+DatabaseMirror::_wake_sync_thread()
+{
+	if (!m_sync_thread_.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_thread_mutex_);
+		m_thread_wake_ = true;
+	}
+	m_thread_cond_.notify_all();
+}
+
+void
+DatabaseMirror::_notify()
+{
+	if (m_dispatcher_ && m_sync_thread_.joinable())
+		m_dispatcher_->emit();
+	else
+		_emit_results();
+}
+
+void
+DatabaseMirror::_emit_results()
+{
+	std::list<MirrorConflict> conflicts;
+	uint64_t pulled_rows;
+	bool synced;
+	{
+		MirrorLock lock(m_mutex_);
+		conflicts.swap(m_new_conflicts_);
+		pulled_rows = m_pulled_rows_;
+		synced = m_synced_;
+		m_pulled_rows_ = 0;
+		m_synced_ = false;
+	}
+
+	for (auto &conflict: conflicts)
+		m_signal_conflict_.emit(conflict);
+	if (synced)
+		m_signal_synced_.emit(pulled_rows);
+}
+
+/**** Pull methods ************************************************************/
+
+// The watermark is 0 for a mirror that never pulled, but also for one of
+// a remote book whose change log is still empty.
+bool
+DatabaseMirror::_has_pulled() const
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT COUNT(*) FROM change_watermark WHERE name=?;",
+	                                     _("Unable to read the change watermark!"));
+	sqlite3_bind_text(stmt,1,MIRROR_WATERMARK,-1,0);
+	bool pulled = false;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		pulled = (sqlite3_column_int64(stmt,0) > 0);
+	sqlite3_finalize(stmt);
+	return pulled;
+}
+
+void
+DatabaseMirror::_fetch_remote(uint64_t after, bool full, PullData &data)
+{
+	TRACE_SCOPE("mirror","DatabaseMirror::_fetch_remote");
+
+	// changes made while the rows are read are pulled again next time
+	data.upto = m_remote_->get_change_seq();
+	if (after > data.upto)
+		full = true;
+
+	if (full) {
+		data.breeders = m_remote_->get_breeders();
+		data.strains = m_remote_->get_strains();
+		data.growlogs = m_remote_->get_growlogs();
+		data.growlog_strains = m_remote_->get_strains_for_growlogs();
+		for (auto &growlog: data.growlogs)
+			data.growlog_strains[growlog->get_id()];
+		m_remote_->foreach_growlog_entry([&data](const Glib::RefPtr<GrowlogEntry> &entry) {
+			data.entries.push_back(entry);
+		});
+		return;
+	}
+
+	std::set<uint64_t> breeder_ids,strain_ids,growlog_ids,growlog_strain_ids,entry_ids;
+	m_remote_->foreach_change(after,data.upto,[&data,&breeder_ids,&strain_ids,&growlog_ids,&growlog_strain_ids,&entry_ids](const ChangeRecord &change) {
+		if (change.type == CHANGE_RENAME)
+			return;
+		data.seqs[std::make_pair(change.table,change.row_id)] = change.seq;
+		if (change.table == "growlog_strain")
+			growlog_strain_ids.insert(change.row_id);
+		else if (change.type == CHANGE_DELETE)
+			data.deletes.push_back(change);
+		else if (change.table == "breeder")
+			breeder_ids.insert(change.row_id);
+		else if (change.table == "strain")
+			strain_ids.insert(change.row_id);
+		else if (change.table == "growlog")
+			growlog_ids.insert(change.row_id);
+		else if (change.table == "growlog_entry")
+			entry_ids.insert(change.row_id);
+	});
+
+	// rows that are gone by now have a 'D' record after upto
+	for (auto id: breeder_ids) {
+		Glib::RefPtr<Breeder> breeder = m_remote_->get_breeder(id);
+		if (breeder)
+			data.breeders.push_back(breeder);
+	}
+	for (auto id: strain_ids) {
+		Glib::RefPtr<Strain> strain = m_remote_->get_strain(id);
+		if (strain)
+			data.strains.push_back(strain);
+	}
+	for (auto id: growlog_ids) {
+		Glib::RefPtr<Growlog> growlog = m_remote_->get_growlog(id);
+		if (growlog)
+			data.growlogs.push_back(growlog);
+	}
+	for (auto id: growlog_strain_ids) {
+		if (m_remote_->get_growlog(id))
+			data.growlog_strains[id] = m_remote_->get_strains_for_growlog(id);
+	}
+	if (entry_ids.size() <= MIRROR_ENTRY_LOOKUP_LIMIT) {
+		for (auto id: entry_ids) {
+			Glib::RefPtr<GrowlogEntry> entry = m_remote_->get_growlog_entry(id);
+			if (entry)
+				data.entries.push_back(entry);
+		}
+	} else {
+		m_remote_->foreach_growlog_entry([&data,&entry_ids](const Glib::RefPtr<GrowlogEntry> &entry) {
+			if (entry_ids.count(entry->get_id()))
+				data.entries.push_back(entry);
+		});
+	}
+}
+
+void
+DatabaseMirror::_apply_pull(PullData &data)
+{
+	TRACE_SCOPE("mirror","DatabaseMirror::_apply_pull");
+
+	for (auto &change: data.deletes)
+		_apply_remote_delete(change);
+	for (auto &breeder: data.breeders)
+		_pull_breeder(breeder,data.get_seq("breeder",breeder->get_id()));
+	for (auto &strain: data.strains)
+		_pull_strain(strain,data.get_seq("strain",strain->get_id()));
+	for (auto &growlog: data.growlogs)
+		_pull_growlog(growlog,data.get_seq("growlog",growlog->get_id()));
+	for (auto &iter: data.growlog_strains)
+		_pull_growlog_strains(iter.first,iter.second,data.get_seq("growlog_strain",iter.first));
+	_pull_entries(data);
+
+	data.rows += (data.deletes.size() + data.breeders.size() + data.strains.size()
+	              + data.growlogs.size() + data.growlog_strains.size());
+}
+
+void
+DatabaseMirror::_apply_remote_delete(const ChangeRecord &change)
+{
+	uint64_t local_id = _map_local(change.table,change.row_id);
+	if (!local_id)
+		return;
+
+	_map_remove_local(change.table,local_id);
+	char op = _outbox_op(change.table,local_id);
+	if (op == 'U') {
+		// pushed again as a new row
+		_add_conflict(MIRROR_CONFLICT_DELETED_REMOTE,
+		              change.table,
+		              local_id,
+		              change.row_id,
+		              _local_name(change.table,local_id));
+		return;
+	} else if (op == 'D') {
+		return;
+	}
+
+	if (change.table == "breeder") {
+		DatabaseSqlite3::remove_breeder_vfunc(local_id);
+	} else if (change.table == "strain") {
+		DatabaseSqlite3::remove_strain_vfunc(local_id);
+	} else if (change.table == "growlog") {
+		for (auto &strain: DatabaseSqlite3::get_strains_for_growlog_vfunc(local_id))
+			DatabaseSqlite3::remove_strain_for_growlog_vfunc(local_id,strain->get_id());
+		DatabaseSqlite3::remove_growlog_vfunc(local_id);
+		_map_remove_local("growlog_strain",local_id);
+	} else if (change.table == "growlog_entry") {
+		DatabaseSqlite3::remove_growlog_entry_vfunc(local_id);
+	}
+}
+
+// Returns true if a remote change must not be applied to the row: it is
+// the echo of our own write or the row has changes in the outbox.
+bool
+DatabaseMirror::_skip_pulled(const std::string &table,
+                             uint64_t local_id,
+                             uint64_t remote_id,
+                             uint64_t seq)
+{
+	// pushed_seq 0 is a row that was never pushed, rows of a remote book
+	// without change records come with seq 0 as well
+	uint64_t pushed_seq = _map_pushed_seq(table,remote_id);
+	if (pushed_seq && pushed_seq >= seq)
+		return true;
+	if (!local_id)
+		return false;
+
+	char op = _outbox_op(table,local_id);
+	if (!op)
+		return false;
+	_add_conflict((op == 'D' ? MIRROR_CONFLICT_DELETED_LOCAL : MIRROR_CONFLICT_MODIFIED),
+	              table,
+	              local_id,
+	              remote_id,
+	              _local_name(table,local_id));
+	return true;
+}
+
+void
+DatabaseMirror::_pull_breeder(const Glib::RefPtr<Breeder> &remote, uint64_t seq)
+{
+	uint64_t local_id = _map_local("breeder",remote->get_id());
+	Glib::RefPtr<Breeder> local;
+	if (local_id)
+		local = DatabaseSqlite3::get_breeder_vfunc(local_id);
+	if (!local && !(local_id && _outbox_op("breeder",local_id)))
+		local = DatabaseSqlite3::get_breeder_vfunc(remote->get_name());
+	if (local)
+		local_id = local->get_id();
+	if (_skip_pulled("breeder",local_id,remote->get_id(),seq)) {
+		if (local)
+			_map_set("breeder",local_id,remote->get_id());
+		return;
+	}
+
+	if (!local) {
+		uint64_t before = DatabaseSqlite3::get_change_seq_vfunc();
+		DatabaseSqlite3::add_breeder_vfunc(Breeder::create(remote->get_name(),remote->get_homepage()));
+		local_id = _last_local_insert(before,"breeder");
+	} else if (local->get_name() != remote->get_name()
+	           || local->get_homepage() != remote->get_homepage()) {
+		DatabaseSqlite3::add_breeder_vfunc(Breeder::create(local_id,remote->get_name(),remote->get_homepage()));
+	}
+	if (local_id)
+		_map_set("breeder",local_id,remote->get_id());
+}
+
+// Strains can not be moved to another breeder, a strain that changed its
+// breeder keeps the old one in the replica.
+void
+DatabaseMirror::_pull_strain(const Glib::RefPtr<Strain> &remote, uint64_t seq)
+{
+	uint64_t breeder_id = _map_local("breeder",remote->get_breeder_id());
+	Glib::RefPtr<Breeder> breeder;
+	if (breeder_id)
+		breeder = DatabaseSqlite3::get_breeder_vfunc(breeder_id);
+	if (!breeder)
+		breeder = DatabaseSqlite3::get_breeder_vfunc(remote->get_breeder_name());
+	if (!breeder)
+		return;
+
+	uint64_t local_id = _map_local("strain",remote->get_id());
+	Glib::RefPtr<Strain> local;
+	if (local_id)
+		local = DatabaseSqlite3::get_strain_vfunc(local_id);
+	if (!local && !(local_id && _outbox_op("strain",local_id)))
+		local = DatabaseSqlite3::get_strain_vfunc(breeder->get_name(),remote->get_name());
+	if (local)
+		local_id = local->get_id();
+	if (_skip_pulled("strain",local_id,remote->get_id(),seq)) {
+		if (local)
+			_map_set("strain",local_id,remote->get_id());
+		return;
+	}
+
+	if (!local) {
+		uint64_t before = DatabaseSqlite3::get_change_seq_vfunc();
+		DatabaseSqlite3::add_strain_vfunc(Strain::create(breeder->get_id(),
+		                                                 breeder->get_name(),
+		                                                 remote->get_name(),
+		                                                 remote->get_info(),
+		                                                 remote->get_description(),
+		                                                 remote->get_homepage(),
+		                                                 remote->get_seedfinder()));
+		local_id = _last_local_insert(before,"strain");
+	} else if (local->get_name() != remote->get_name()
+	           || local->get_info() != remote->get_info()
+	           || local->get_description() != remote->get_description()
+	           || local->get_homepage() != remote->get_homepage()
+	           || local->get_seedfinder() != remote->get_seedfinder()) {
+		DatabaseSqlite3::add_strain_vfunc(Strain::create(local_id,
+		                                                 local->get_breeder_id(),
+		                                                 local->get_breeder_name(),
+		                                                 remote->get_name(),
+		                                                 remote->get_info(),
+		                                                 remote->get_description(),
+		                                                 remote->get_homepage(),
+		                                                 remote->get_seedfinder()));
+	}
+	if (local_id)
+		_map_set("strain",local_id,remote->get_id());
+}
+
+void
+DatabaseMirror::_pull_growlog(const Glib::RefPtr<Growlog> &remote, uint64_t seq)
+{
+	uint64_t local_id = _map_local("growlog",remote->get_id());
+	Glib::RefPtr<Growlog> local;
+	if (local_id)
+		local = DatabaseSqlite3::get_growlog_vfunc(local_id);
+	if (!local && !(local_id && _outbox_op("growlog",local_id)))
+		local = DatabaseSqlite3::get_growlog_vfunc(remote->get_title());
+	if (local)
+		local_id = local->get_id();
+	if (_skip_pulled("growlog",local_id,remote->get_id(),seq)) {
+		if (local)
+			_map_set("growlog",local_id,remote->get_id());
+		return;
+	}
+
+	if (!local) {
+		uint64_t before = DatabaseSqlite3::get_change_seq_vfunc();
+		DatabaseSqlite3::add_growlog_vfunc(Growlog::create(remote->get_title(),
+		                                                   remote->get_description(),
+		                                                   remote->get_created_on(),
+		                                                   remote->get_flower_on(),
+		                                                   remote->get_finished_on()));
+		local_id = _last_local_insert(before,"growlog");
+	} else if (local->get_title() != remote->get_title()
+	           || local->get_description() != remote->get_description()
+	           || local->get_created_on() != remote->get_created_on()
+	           || local->get_flower_on() != remote->get_flower_on()
+	           || local->get_finished_on() != remote->get_finished_on()) {
+		DatabaseSqlite3::add_growlog_vfunc(Growlog::create(local_id,
+		                                                   remote->get_title(),
+		                                                   remote->get_description(),
+		                                                   remote->get_created_on(),
+		                                                   remote->get_flower_on(),
+		                                                   remote->get_finished_on()));
+	}
+	if (local_id)
+		_map_set("growlog",local_id,remote->get_id());
+}
+
+// The strains of a growlog are made equal to the remote ones.
+void
+DatabaseMirror::_pull_growlog_strains(uint64_t remote_growlog_id,
+                                      const std::list<Glib::RefPtr<Strain> > &remote_strains,
+                                      uint64_t seq)
+{
+	uint64_t growlog_id = _map_local("growlog",remote_growlog_id);
+	if (!growlog_id)
+		return;
+	if (_skip_pulled("growlog_strain",growlog_id,remote_growlog_id,seq))
+		return;
+
+	std::set<uint64_t> strain_ids;
+	for (auto &strain: remote_strains) {
+		uint64_t strain_id = _map_local("strain",strain->get_id());
+		if (strain_id)
+			strain_ids.insert(strain_id);
+	}
+	for (auto &strain: DatabaseSqlite3::get_strains_for_growlog_vfunc(growlog_id)) {
+		if (!strain_ids.erase(strain->get_id()))
+			DatabaseSqlite3::remove_strain_for_growlog_vfunc(growlog_id,strain->get_id());
+	}
+	for (auto strain_id: strain_ids)
+		DatabaseSqlite3::add_strain_for_growlog_vfunc(growlog_id,strain_id);
+	_map_set("growlog_strain",growlog_id,remote_growlog_id);
+}
+
+// New entries are inserted with a single add_growlog_entries(). Entries
+// that were created on both sides are matched by time and text.
+void
+DatabaseMirror::_pull_entries(PullData &data)
+{
+	TRACE_SCOPE("mirror","DatabaseMirror::_pull_entries");
+
+	std::stable_sort(data.entries.begin(),
+	                 data.entries.end(),
+	                 [](const Glib::RefPtr<GrowlogEntry> &a, const Glib::RefPtr<GrowlogEntry> &b) {
+		return a->get_growlog_id() < b->get_growlog_id();
+	});
+
+	// a full pull looks up the id map once instead of once per entry
+	std::unordered_map<uint64_t,uint64_t> id_map;
+	bool preload = (data.entries.size() > MIRROR_ENTRY_LOOKUP_LIMIT);
+	if (preload)
+		_map_load("growlog_entry",id_map);
+
+	uint64_t remote_growlog_id = 0;
+	uint64_t growlog_id = 0;
+	bool cache_loaded = false;
+	std::unordered_multimap<std::string,uint64_t> cache;
+	std::vector<GrowlogEntryRow> rows;
+	std::vector<uint64_t> remote_ids;
+
+	for (auto &remote: data.entries) {
+		if (remote->get_growlog_id() != remote_growlog_id) {
+			remote_growlog_id = remote->get_growlog_id();
+			growlog_id = _map_local("growlog",remote_growlog_id);
+			cache.clear();
+			cache_loaded = false;
+		}
+		if (!growlog_id)
+			continue;
+
+		uint64_t local_id = 0;
+		if (preload) {
+			auto iter = id_map.find(remote->get_id());
+			if (iter != id_map.end())
+				local_id = iter->second;
+		} else {
+			local_id = _map_local("growlog_entry",remote->get_id());
+		}
+		if (local_id || !preload) {
+			if (_skip_pulled("growlog_entry",local_id,remote->get_id(),data.get_seq("growlog_entry",remote->get_id())))
+				continue;
+		}
+		++data.rows;
+
+		if (local_id) {
+			Glib::RefPtr<GrowlogEntry> local = DatabaseSqlite3::get_growlog_entry_vfunc(local_id);
+			if (local) {
+				if (local->get_text() != remote->get_text())
+					DatabaseSqlite3::add_growlog_entry_vfunc(GrowlogEntry::create(local_id,
+					                                                              growlog_id,
+					                                                              remote->get_text(),
+					                                                              local->get_created_on()));
+				continue;
+			}
+			_map_remove_local("growlog_entry",local_id);
+		}
+
+		if (!cache_loaded) {
+			for (auto &entry: DatabaseSqlite3::get_growlog_entries_vfunc(growlog_id))
+				cache.emplace(_mirror_entry_key(entry->get_created_on(),entry->get_text()),entry->get_id());
+			cache_loaded = true;
+		}
+		auto range = cache.equal_range(_mirror_entry_key(remote->get_created_on(),remote->get_text()));
+		auto match = range.first;
+		while (match != range.second && _map_remote("growlog_entry",match->second))
+			++match;
+		if (match != range.second) {
+			_map_set("growlog_entry",match->second,remote->get_id());
+			cache.erase(match);
+			continue;
+		}
+
+		const Glib::ustring &text = remote->get_text();
+		rows.push_back(GrowlogEntryRow{growlog_id,text.data(),text.bytes(),remote->get_created_on()});
+		remote_ids.push_back(remote->get_id());
+	}
+	if (rows.empty())
+		return;
+
+	uint64_t before = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_growlog_entries_vfunc(rows);
+
+	// the 'U' records of the new entries are in the order of rows
+	std::vector<uint64_t> local_ids;
+	local_ids.reserve(rows.size());
+	DatabaseSqlite3::foreach_change_vfunc(before,
+	                                      DatabaseSqlite3::get_change_seq_vfunc(),
+	                                      [&local_ids](const ChangeRecord &change) {
+		if (change.type == CHANGE_UPDATE && change.table == "growlog_entry")
+			local_ids.push_back(change.row_id);
+	});
+	local_ids.resize(std::min(local_ids.size(),remote_ids.size()));
+	remote_ids.resize(local_ids.size());
+	_map_set_many("growlog_entry",local_ids,remote_ids);
+}
+
+/**** Push methods ************************************************************/
+
+void
+DatabaseMirror::_push(const ChangeRecord &change)
+{
+	if (change.type == CHANGE_DELETE) {
+		_push_delete(change);
+	} else if (change.table == "breeder") {
+		_push_breeder(change.row_id);
+	} else if (change.table == "strain") {
+		_push_strain(change.row_id);
+	} else if (change.table == "growlog") {
+		_push_growlog(change.row_id);
+	} else if (change.table == "growlog_strain") {
+		_push_growlog_strains(change.row_id);
+	} else if (change.table == "growlog_entry") {
+		_push_entry(change.row_id);
+	}
+
+	MirrorLock lock(m_mutex_);
+	_outbox_remove(change.seq);
+}
+
+// Records the remote seq after a row was written, so the change is not
+// pulled back.
+void
+DatabaseMirror::_pushed(const std::string &table, uint64_t local_id, uint64_t remote_id)
+{
+	uint64_t seq = m_remote_->get_change_seq();
+	MirrorLock lock(m_mutex_);
+	_map_set(table,local_id,remote_id,seq);
+}
+
+// The _push_*() methods return the remote id of the row, 0 if it is gone
+// from the replica.
+uint64_t
+DatabaseMirror::_push_breeder(uint64_t local_id)
+{
+	Glib::RefPtr<Breeder> local;
+	uint64_t remote_id;
+	{
+		MirrorLock lock(m_mutex_);
+		local = DatabaseSqlite3::get_breeder_vfunc(local_id);
+		remote_id = _map_remote("breeder",local_id);
+	}
+	if (!local)
+		return 0;
+
+	Glib::RefPtr<Breeder> remote;
+	if (remote_id)
+		remote = m_remote_->get_breeder(remote_id);
+	if (!remote)
+		remote = m_remote_->get_breeder(local->get_name());
+	if (remote) {
+		m_remote_->add_breeder(Breeder::create(remote->get_id(),local->get_name(),local->get_homepage()));
+	} else {
+		m_remote_->add_breeder(Breeder::create(local->get_name(),local->get_homepage()));
+		remote = m_remote_->get_breeder(local->get_name());
+		if (!remote)
+			throw DatabaseError(_("Breeder is missing after it was added!"));
+	}
+	_pushed("breeder",local_id,remote->get_id());
+	return remote->get_id();
+}
+
+uint64_t
+DatabaseMirror::_push_strain(uint64_t local_id)
+{
+	Glib::RefPtr<Strain> local;
+	uint64_t remote_id,remote_breeder_id;
+	{
+		MirrorLock lock(m_mutex_);
+		local = DatabaseSqlite3::get_strain_vfunc(local_id);
+		remote_id = _map_remote("strain",local_id);
+		remote_breeder_id = (local ? _map_remote("breeder",local->get_breeder_id()) : 0);
+	}
+	if (!local)
+		return 0;
+
+	Glib::RefPtr<Breeder> breeder;
+	if (remote_breeder_id)
+		breeder = m_remote_->get_breeder(remote_breeder_id);
+	if (!breeder && _push_breeder(local->get_breeder_id()))
+		breeder = m_remote_->get_breeder(local->get_breeder_name());
+	if (!breeder)
+		return 0;
+
+	Glib::RefPtr<Strain> remote;
+	if (remote_id)
+		remote = m_remote_->get_strain(remote_id);
+	if (!remote)
+		remote = m_remote_->get_strain(breeder->get_name(),local->get_name());
+	if (remote) {
+		m_remote_->add_strain(Strain::create(remote->get_id(),
+		                                     remote->get_breeder_id(),
+		                                     remote->get_breeder_name(),
+		                                     local->get_name(),
+		                                     local->get_info(),
+		                                     local->get_description(),
+		                                     local->get_homepage(),
+		                                     local->get_seedfinder()));
+	} else {
+		m_remote_->add_strain(Strain::create(breeder->get_id(),
+		                                     breeder->get_name(),
+		                                     local->get_name(),
+		                                     local->get_info(),
+		                                     local->get_description(),
+		                                     local->get_homepage(),
+		                                     local->get_seedfinder()));
+		remote = m_remote_->get_strain(breeder->get_name(),local->get_name());
+		if (!remote)
+			throw DatabaseError(_("Strain is missing after it was added!"));
+	}
+	_pushed("strain",local_id,remote->get_id());
+	return remote->get_id();
+}
+
+uint64_t
+DatabaseMirror::_push_growlog(uint64_t local_id)
+{
+	Glib::RefPtr<Growlog> local;
+	uint64_t remote_id;
+	{
+		MirrorLock lock(m_mutex_);
+		local = DatabaseSqlite3::get_growlog_vfunc(local_id);
+		remote_id = _map_remote("growlog",local_id);
+	}
+	if (!local)
+		return 0;
+
+	Glib::RefPtr<Growlog> remote;
+	if (remote_id)
+		remote = m_remote_->get_growlog(remote_id);
+	if (!remote)
+		remote = m_remote_->get_growlog(local->get_title());
+	if (remote) {
+		m_remote_->add_growlog(Growlog::create(remote->get_id(),
+		                                       local->get_title(),
+		                                       local->get_description(),
+		                                       local->get_created_on(),
+		                                       local->get_flower_on(),
+		                                       local->get_finished_on()));
+	} else {
+		m_remote_->add_growlog(Growlog::create(local->get_title(),
+		                                       local->get_description(),
+		                                       local->get_created_on(),
+		                                       local->get_flower_on(),
+		                                       local->get_finished_on()));
+		remote = m_remote_->get_growlog(local->get_title());
+		if (!remote)
+			throw DatabaseError(_("Growlog is missing after it was added!"));
+	}
+	_pushed("growlog",local_id,remote->get_id());
+	return remote->get_id();
+}
+
+// The remote strains of a growlog are made equal to the local ones.
+void
+DatabaseMirror::_push_growlog_strains(uint64_t local_growlog_id)
+{
+	Glib::RefPtr<Growlog> local;
+	std::list<Glib::RefPtr<Strain> > local_strains;
+	uint64_t remote_growlog_id;
+	std::map<uint64_t,uint64_t> remote_strain_ids;
+	{
+		MirrorLock lock(m_mutex_);
+		local = DatabaseSqlite3::get_growlog_vfunc(local_growlog_id);
+		if (!local)
+			return;
+		local_strains = DatabaseSqlite3::get_strains_for_growlog_vfunc(local_growlog_id);
+		remote_growlog_id = _map_remote("growlog",local_growlog_id);
+		for (auto &strain: local_strains)
+			remote_strain_ids[strain->get_id()] = _map_remote("strain",strain->get_id());
+	}
+
+	if (!remote_growlog_id || !m_remote_->get_growlog(remote_growlog_id))
+		remote_growlog_id = _push_growlog(local_growlog_id);
+	if (!remote_growlog_id)
+		return;
+
+	std::set<uint64_t> strain_ids;
+	for (auto &strain: local_strains) {
+		uint64_t remote_id = remote_strain_ids[strain->get_id()];
+		if (!remote_id || !m_remote_->get_strain(remote_id))
+			remote_id = _push_strain(strain->get_id());
+		if (remote_id)
+			strain_ids.insert(remote_id);
+	}
+	for (auto &strain: m_remote_->get_strains_for_growlog(remote_growlog_id)) {
+		if (!strain_ids.erase(strain->get_id()))
+			m_remote_->remove_strain_for_growlog(remote_growlog_id,strain->get_id());
+	}
+	for (auto strain_id: strain_ids)
+		m_remote_->add_strain_for_growlog(remote_growlog_id,strain_id);
+	_pushed("growlog_strain",local_growlog_id,remote_growlog_id);
+}
+
+// add_growlog_entry() does not tell the new id, it is taken from the
+// remote change_log.
+uint64_t
+DatabaseMirror::_push_entry(uint64_t local_id)
+{
+	Glib::RefPtr<GrowlogEntry> local;
+	uint64_t remote_id,remote_growlog_id;
+	{
+		MirrorLock lock(m_mutex_);
+		local = DatabaseSqlite3::get_growlog_entry_vfunc(local_id);
+		remote_id = _map_remote("growlog_entry",local_id);
+		remote_growlog_id = (local ? _map_remote("growlog",local->get_growlog_id()) : 0);
+	}
+	if (!local)
+		return 0;
+	if (!remote_growlog_id)
+		remote_growlog_id = _push_growlog(local->get_growlog_id());
+	if (!remote_growlog_id)
+		return 0;
+
+	if (remote_id && m_remote_->get_growlog_entry(remote_id)) {
+		m_remote_->add_growlog_entry(GrowlogEntry::create(remote_id,
+		                                                  remote_growlog_id,
+		                                                  local->get_text(),
+		                                                  local->get_created_on()));
+		_pushed("growlog_entry",local_id,remote_id);
+		return remote_id;
+	}
+
+	uint64_t before = m_remote_->get_change_seq();
+	m_remote_->add_growlog_entry(GrowlogEntry::create(remote_growlog_id,
+	                                                  local->get_text(),
+	                                                  local->get_created_on()));
+	std::vector<uint64_t> candidates;
+	m_remote_->foreach_change(before,
+	                          m_remote_->get_change_seq(),
+	                          [&candidates](const ChangeRecord &change) {
+		if (change.type == CHANGE_UPDATE && change.table == "growlog_entry")
+			candidates.push_back(change.row_id);
+	});
+
+	// other clients may have added entries in the meantime
+	remote_id = 0;
+	for (auto iter = candidates.rbegin(); iter != candidates.rend(); ++iter) {
+		Glib::RefPtr<GrowlogEntry> remote = m_remote_->get_growlog_entry(*iter);
+		if (remote
+		    && remote->get_growlog_id() == remote_growlog_id
+		    && remote->get_created_on() == local->get_created_on()
+		    && remote->get_text() == local->get_text()) {
+			remote_id = remote->get_id();
+			break;
+		}
+	}
+	if (!remote_id)
+		throw DatabaseError(_("Growlog-entry is missing after it was added!"));
+	_pushed("growlog_entry",local_id,remote_id);
+	return remote_id;
+}
+
+void
+DatabaseMirror::_push_delete(const ChangeRecord &change)
+{
+	uint64_t remote_id;
+	{
+		MirrorLock lock(m_mutex_);
+		remote_id = _map_remote(change.table,change.row_id);
+	}
+	// rows that never reached the remote database are not deleted there
+	if (!remote_id)
+		return;
+
+	if (change.table == "breeder") {
+		m_remote_->remove_breeder(remote_id);
+	} else if (change.table == "strain") {
+		m_remote_->remove_strain(remote_id);
+	} else if (change.table == "growlog") {
+		for (auto &strain: m_remote_->get_strains_for_growlog(remote_id))
+			m_remote_->remove_strain_for_growlog(remote_id,strain->get_id());
+		m_remote_->remove_growlog(remote_id);
+	} else if (change.table == "growlog_entry") {
+		m_remote_->remove_growlog_entry(remote_id);
+	}
+
+	MirrorLock lock(m_mutex_);
+	_map_remove_local(change.table,change.row_id);
+	if (change.table == "growlog")
+		_map_remove_local("growlog_strain",change.row_id);
+}
+
+/**** Outbox methods **********************************************************/
+
+// Copies the change_log records of a write to the outbox.
+void
+DatabaseMirror::_queue_changes(uint64_t after)
+{
+	std::list<ChangeRecord> changes;
+	DatabaseSqlite3::foreach_change_vfunc(after,
+	                                      DatabaseSqlite3::get_change_seq_vfunc(),
+	                                      [&changes](const ChangeRecord &change) {
+		changes.push_back(change);
+	});
+	if (changes.empty())
+		return;
+
+	for (auto &change: changes) {
+		if (change.type == CHANGE_RENAME)
+			continue;
+
+		// deleting links of a growlog is pushed by comparing the links
+		if (change.type == CHANGE_DELETE && change.table == "growlog_strain") {
+			ChangeRecord update = change;
+			update.type = CHANGE_UPDATE;
+			_outbox_add(update);
+		} else {
+			_outbox_add(change);
+		}
+	}
+	_wake_sync_thread();
+}
+
+void
+DatabaseMirror::_outbox_add(const ChangeRecord &change)
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "DELETE FROM mirror_outbox WHERE table_name=? AND row_id=? AND op='U';",
+	                                     _("Unable to update the outbox!"));
+	sqlite3_bind_text(stmt,1,change.table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(change.row_id));
+	_mirror_exec(db,stmt,_("Updating the outbox failed!"));
+
+	// a row that never reached the remote database has nothing to delete
+	if (change.type == CHANGE_DELETE && !_map_remote(change.table,change.row_id))
+		return;
+
+	stmt = _mirror_prepare(db,
+	                       "INSERT INTO mirror_outbox (table_name,row_id,op,key1,key2,key3) VALUES (?,?,?,?,?,?);",
+	                       _("Unable to update the outbox!"));
+	sqlite3_bind_text(stmt,1,change.table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(change.row_id));
+	sqlite3_bind_text(stmt,3,(change.type == CHANGE_DELETE ? "D" : "U"),-1,0);
+	for (int i = 0; i < 3; ++i)
+		sqlite3_bind_text(stmt,4 + i,change.key[i].c_str(),-1,0);
+	_mirror_exec(db,stmt,_("Updating the outbox failed!"));
+}
+
+std::list<ChangeRecord>
+DatabaseMirror::_outbox_get() const
+{
+	MirrorLock lock(m_mutex_);
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT seq,table_name,row_id,op,key1,key2,key3 FROM mirror_outbox ORDER BY seq;",
+	                                     _("Unable to read the outbox!"));
+	std::list<ChangeRecord> changes;
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		ChangeRecord change;
+		change.seq = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+		change.table = (const char*) sqlite3_column_text(stmt,1);
+		change.row_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,2));
+		const char *op = (const char*) sqlite3_column_text(stmt,3);
+		change.type = ((op && *op == 'D') ? CHANGE_DELETE : CHANGE_UPDATE);
+		for (int i = 0; i < 3; ++i) {
+			const char *key = (const char*) sqlite3_column_text(stmt,4 + i);
+			change.key[i] = (key ? key : "");
+		}
+		changes.push_back(change);
+	}
+	sqlite3_finalize(stmt);
+	return changes;
+}
+
+// Returns 'U' or 'D' for a row that has changes in the outbox, else 0.
+char
+DatabaseMirror::_outbox_op(const std::string &table, uint64_t local_id) const
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT op FROM mirror_outbox WHERE table_name=? AND row_id=? ORDER BY seq DESC LIMIT 1;",
+	                                     _("Unable to read the outbox!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(local_id));
+	char op = 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW) {
+		const char *c_op = (const char*) sqlite3_column_text(stmt,0);
+		op = (c_op ? *c_op : 0);
+	}
+	sqlite3_finalize(stmt);
+	return op;
+}
+
+void
+DatabaseMirror::_outbox_remove(uint64_t seq)
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "DELETE FROM mirror_outbox WHERE seq=?;",
+	                                     _("Unable to update the outbox!"));
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(seq));
+	_mirror_exec(db,stmt,_("Updating the outbox failed!"));
+}
+
+uint64_t
+DatabaseMirror::get_outbox_size() const
+{
+	MirrorLock lock(m_mutex_);
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT COUNT(*) FROM mirror_outbox;",
+	                                     _("Unable to read the outbox!"));
+	uint64_t size = 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		size = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return size;
+}
+
+/**** Id map methods **********************************************************/
+
+uint64_t
+DatabaseMirror::_map_local(const std::string &table, uint64_t remote_id) const
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT local_id FROM mirror_id_map WHERE table_name=? AND remote_id=?;",
+	                                     _("Unable to read the id map of the mirror!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(remote_id));
+	uint64_t id = 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return id;
+}
+
+uint64_t
+DatabaseMirror::_map_remote(const std::string &table, uint64_t local_id) const
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT remote_id FROM mirror_id_map WHERE table_name=? AND local_id=?;",
+	                                     _("Unable to read the id map of the mirror!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(local_id));
+	uint64_t id = 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return id;
+}
+
+uint64_t
+DatabaseMirror::_map_pushed_seq(const std::string &table, uint64_t remote_id) const
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT pushed_seq FROM mirror_id_map WHERE table_name=? AND remote_id=?;",
+	                                     _("Unable to read the id map of the mirror!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(remote_id));
+	uint64_t seq = 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		seq = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return seq;
+}
+
+// remote id -> local id of every row of table
+void
+DatabaseMirror::_map_load(const std::string &table, std::unordered_map<uint64_t,uint64_t> &id_map) const
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT remote_id,local_id FROM mirror_id_map WHERE table_name=?;",
+	                                     _("Unable to read the id map of the mirror!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	while (sqlite3_step(stmt) == SQLITE_ROW)
+		id_map[static_cast<uint64_t>(sqlite3_column_int64(stmt,0))] = static_cast<uint64_t>(sqlite3_column_int64(stmt,1));
+	sqlite3_finalize(stmt);
+}
+
+// pushed_seq 0 keeps the one that is stored.
+void
+DatabaseMirror::_map_set(const std::string &table,
+                         uint64_t local_id,
+                         uint64_t remote_id,
+                         uint64_t pushed_seq)
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "INSERT OR REPLACE INTO mirror_id_map (table_name,local_id,remote_id,pushed_seq) "
+	                                     "VALUES (?1,?2,?3,MAX(?4,IFNULL((SELECT pushed_seq FROM mirror_id_map "
+	                                     "WHERE table_name=?1 AND local_id=?2 AND remote_id=?3),0)));",
+	                                     _("Unable to update the id map of the mirror!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(local_id));
+	sqlite3_bind_int64(stmt,3,static_cast<sqlite3_int64>(remote_id));
+	sqlite3_bind_int64(stmt,4,static_cast<sqlite3_int64>(pushed_seq));
+	_mirror_exec(db,stmt,_("Updating the id map of the mirror failed!"));
+}
+
+void
+DatabaseMirror::_map_set_many(const std::string &table,
+                              const std::vector<uint64_t> &local_ids,
+                              const std::vector<uint64_t> &remote_ids)
+{
+	assert(local_ids.size() == remote_ids.size());
+
+	sqlite3 *db = get_handle();
+	begin_transaction();
+	sqlite3_stmt *stmt = nullptr;
+	try {
+		stmt = _mirror_prepare(db,
+		                       "INSERT OR REPLACE INTO mirror_id_map (table_name,local_id,remote_id) VALUES (?,?,?);",
+		                       _("Unable to update the id map of the mirror!"));
+	} catch (DatabaseError &ex) {
+		rollback();
+		throw;
+	}
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,SQLITE_TRANSIENT);
+	for (size_t i = 0; i < local_ids.size(); ++i) {
+		sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(local_ids[i]));
+		sqlite3_bind_int64(stmt,3,static_cast<sqlite3_int64>(remote_ids[i]));
+		int err = sqlite3_step(stmt);
+		if (err != SQLITE_OK && err != SQLITE_DONE) {
+			Glib::ustring msg = _("Updating the id map of the mirror failed!");
+			msg += "\n(";
+			msg += sqlite3_errmsg(db);
+			msg += ")";
+			sqlite3_finalize(stmt);
+			rollback();
+			throw DatabaseError(err,msg);
+		}
+		sqlite3_reset(stmt);
+	}
+	sqlite3_finalize(stmt);
+	commit();
+}
+
+void
+DatabaseMirror::_map_remove_local(const std::string &table, uint64_t local_id)
+{
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "DELETE FROM mirror_id_map WHERE table_name=? AND local_id=?;",
+	                                     _("Unable to update the id map of the mirror!"));
+	sqlite3_bind_text(stmt,1,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(local_id));
+	_mirror_exec(db,stmt,_("Updating the id map of the mirror failed!"));
+}
+
+// The id of the row of table that the last write after seq inserted.
+uint64_t
+DatabaseMirror::_last_local_insert(uint64_t after, const std::string &table)
+{
+	uint64_t id = 0;
+	DatabaseSqlite3::foreach_change_vfunc(after,
+	                                      DatabaseSqlite3::get_change_seq_vfunc(),
+	                                      [&id,&table](const ChangeRecord &change) {
+		if (change.type == CHANGE_UPDATE && change.table == table)
+			id = change.row_id;
+	});
+	return id;
+}
+
+/**** Conflict methods ********************************************************/
+
+void
+DatabaseMirror::_add_conflict(MirrorConflictType type,
+                              const std::string &table,
+                              uint64_t local_id,
+                              uint64_t remote_id,
+                              const Glib::ustring &name,
+                              const Glib::ustring &message)
+{
+	MirrorConflict conflict;
+	conflict.type = type;
+	conflict.table = table;
+	conflict.local_id = local_id;
+	conflict.remote_id = remote_id;
+	conflict.name = name;
+	conflict.message = message;
+	conflict.created_on = time(nullptr);
+
+	char created_on[64];
+	db_format_datetime(conflict.created_on,created_on,sizeof(created_on));
+
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "INSERT INTO mirror_conflict (type,table_name,local_id,remote_id,name,message,created_on) "
+	                                     "VALUES (?,?,?,?,?,?,?);",
+	                                     _("Unable to store a conflict of the mirror!"));
+	sqlite3_bind_int(stmt,1,static_cast<int>(type));
+	sqlite3_bind_text(stmt,2,table.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,3,static_cast<sqlite3_int64>(local_id));
+	sqlite3_bind_int64(stmt,4,static_cast<sqlite3_int64>(remote_id));
+	sqlite3_bind_text(stmt,5,name.c_str(),-1,0);
+	sqlite3_bind_text(stmt,6,message.c_str(),-1,0);
+	sqlite3_bind_text(stmt,7,created_on,-1,0);
+	_mirror_exec(db,stmt,_("Storing a conflict of the mirror failed!"));
+
+	conflict.id = static_cast<uint64_t>(sqlite3_last_insert_rowid(db));
+	m_new_conflicts_.push_back(conflict);
+}
+
+// A name the user knows the row by.
+Glib::ustring
+DatabaseMirror::_local_name(const std::string &table, uint64_t local_id) const
+{
+	if (table == "breeder") {
+		Glib::RefPtr<Breeder> breeder = DatabaseSqlite3::get_breeder_vfunc(local_id);
+		if (breeder)
+			return breeder->get_name();
+	} else if (table == "strain") {
+		Glib::RefPtr<Strain> strain = DatabaseSqlite3::get_strain_vfunc(local_id);
+		if (strain)
+			return strain->get_breeder_name() + " - " + strain->get_name();
+	} else if (table == "growlog" || table == "growlog_strain") {
+		Glib::RefPtr<Growlog> growlog = DatabaseSqlite3::get_growlog_vfunc(local_id);
+		if (growlog)
+			return growlog->get_title();
+	} else if (table == "growlog_entry") {
+		Glib::RefPtr<GrowlogEntry> entry = DatabaseSqlite3::get_growlog_entry_vfunc(local_id);
+		if (entry) {
+			Glib::RefPtr<Growlog> growlog = DatabaseSqlite3::get_growlog_vfunc(entry->get_growlog_id());
+			return (growlog ? growlog->get_title() + " - " : Glib::ustring()) + entry->get_created_on_format();
+		}
+	}
+	return Glib::ustring();
+}
+
+Glib::ustring
+DatabaseMirror::_local_name(const ChangeRecord &change) const
+{
+	MirrorLock lock(m_mutex_);
+	if (change.type != CHANGE_DELETE)
+		return _local_name(change.table,change.row_id);
+
+	Glib::ustring name = change.key[0];
+	for (int i = 1; i < 3 && !change.key[i].empty(); ++i) {
+		name += " - ";
+		name += change.key[i];
+	}
+	return name;
+}
+
+std::list<MirrorConflict>
+DatabaseMirror::get_conflicts() const
+{
+	MirrorLock lock(m_mutex_);
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "SELECT id,type,table_name,local_id,remote_id,name,message,created_on "
+	                                     "FROM mirror_conflict ORDER BY id;",
+	                                     _("Unable to read the conflicts of the mirror!"));
+	std::list<MirrorConflict> conflicts;
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		MirrorConflict conflict;
+		conflict.id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+		conflict.type = static_cast<MirrorConflictType>(sqlite3_column_int(stmt,1));
+		conflict.table = (const char*) sqlite3_column_text(stmt,2);
+		conflict.local_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,3));
+		conflict.remote_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,4));
+		const char *name = (const char*) sqlite3_column_text(stmt,5);
+		const char *message = (const char*) sqlite3_column_text(stmt,6);
+		const char *created_on = (const char*) sqlite3_column_text(stmt,7);
+		conflict.name = (name ? name : "");
+		conflict.message = (message ? message : "");
+		tm datetime;
+		if (created_on && strptime(created_on,DATETIME_ISO_FORMAT,&datetime)) {
+			datetime.tm_isdst = -1;
+			conflict.created_on = mktime(&datetime);
+		}
+		conflicts.push_back(conflict);
+	}
+	sqlite3_finalize(stmt);
+	return conflicts;
+}
+
+void
+DatabaseMirror::clear_conflicts()
+{
+	MirrorLock lock(m_mutex_);
+	sqlite3 *db = get_handle();
+	sqlite3_stmt *stmt = _mirror_prepare(db,
+	                                     "DELETE FROM mirror_conflict;",
+	                                     _("Unable to delete the conflicts of the mirror!"));
+	_mirror_exec(db,stmt,_("Deleting the conflicts of the mirror failed!"));
+}
+
+/**** Breeder methods *********************************************************/
+
+std::list<Glib::RefPtr<Breeder> >
+DatabaseMirror::get_breeders_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_breeders_vfunc();
+}
+
+Glib::RefPtr<Breeder>
+DatabaseMirror::get_breeder_vfunc(uint64_t id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_breeder_vfunc(id);
+}
+
+Glib::RefPtr<Breeder>
+DatabaseMirror::get_breeder_vfunc(const Glib::ustring &name) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_breeder_vfunc(name);
+}
+
+void
+DatabaseMirror::add_breeder_vfunc(const Glib::RefPtr<Breeder> &breeder)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_breeder_vfunc(breeder);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::remove_breeder_vfunc(uint64_t id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::remove_breeder_vfunc(id);
+	_queue_changes(seq);
+}
+
+/**** Strain methods **********************************************************/
+
+std::list<Glib::RefPtr<Strain> >
+DatabaseMirror::get_strains_for_breeder_vfunc(uint64_t breeder_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strains_for_breeder_vfunc(breeder_id);
+}
+
+std::list<Glib::RefPtr<Strain> >
+DatabaseMirror::get_strains_for_growlog_vfunc(uint64_t growlog_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strains_for_growlog_vfunc(growlog_id);
+}
+
+Glib::RefPtr<Strain>
+DatabaseMirror::get_strain_vfunc(uint64_t id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strain_vfunc(id);
+}
+
+Glib::RefPtr<Strain>
+DatabaseMirror::get_strain_vfunc(const Glib::ustring &breeder_name,
+                                 const Glib::ustring &strain_name) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strain_vfunc(breeder_name,strain_name);
+}
+
+void
+DatabaseMirror::add_strain_vfunc(const Glib::RefPtr<Strain> &strain)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_strain_vfunc(strain);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::remove_strain_vfunc(uint64_t id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::remove_strain_vfunc(id);
+	_queue_changes(seq);
+}
+
+std::list<Glib::RefPtr<Strain> >
+DatabaseMirror::get_strains_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strains_vfunc();
+}
+
+std::map<uint64_t,std::list<Glib::RefPtr<Strain> > >
+DatabaseMirror::get_strains_for_growlogs_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strains_for_growlogs_vfunc();
+}
+
+/**** Growlog methods *********************************************************/
+
+std::list<Glib::RefPtr<Growlog> >
+DatabaseMirror::get_growlogs_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlogs_vfunc();
+}
+
+std::list<Glib::RefPtr<Growlog> >
+DatabaseMirror::get_ongoing_growlogs_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_ongoing_growlogs_vfunc();
+}
+
+std::list<Glib::RefPtr<Growlog> >
+DatabaseMirror::get_finished_growlogs_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_finished_growlogs_vfunc();
+}
+
+std::list<Glib::RefPtr<Growlog> >
+DatabaseMirror::get_growlogs_for_strain_vfunc(uint64_t strain_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlogs_for_strain_vfunc(strain_id);
+}
+
+Glib::RefPtr<Growlog>
+DatabaseMirror::get_growlog_vfunc(uint64_t id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_vfunc(id);
+}
+
+Glib::RefPtr<Growlog>
+DatabaseMirror::get_growlog_vfunc(const Glib::ustring &title) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_vfunc(title);
+}
+
+void
+DatabaseMirror::add_growlog_vfunc(const Glib::RefPtr<Growlog> &growlog)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_growlog_vfunc(growlog);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::remove_growlog_vfunc(uint64_t id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::remove_growlog_vfunc(id);
+	_queue_changes(seq);
+}
+
+/**** GrowlogEntry methods ****************************************************/
+
+std::list<Glib::RefPtr<GrowlogEntry> >
+DatabaseMirror::get_growlog_entries_vfunc(uint64_t growlog_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_entries_vfunc(growlog_id);
+}
+
+std::list<Glib::RefPtr<GrowlogEntry> >
+DatabaseMirror::get_growlog_entries_vfunc(uint64_t growlog_id,
+                                          uint64_t offset,
+                                          uint64_t limit) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_entries_vfunc(growlog_id,offset,limit);
+}
+
+uint64_t
+DatabaseMirror::get_growlog_entry_count_vfunc(uint64_t growlog_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_entry_count_vfunc(growlog_id);
+}
+
+Glib::RefPtr<GrowlogEntry>
+DatabaseMirror::get_growlog_entry_vfunc(uint64_t id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_entry_vfunc(id);
+}
+
+void
+DatabaseMirror::add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &entry)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_growlog_entry_vfunc(entry);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::remove_growlog_entry_vfunc(uint64_t id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::remove_growlog_entry_vfunc(id);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const
+{
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::foreach_growlog_entry_vfunc(slot);
+}
+
+void
+DatabaseMirror::add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_growlog_entries_vfunc(rows);
+	_queue_changes(seq);
+}
+
+/**** Growlog strain methods **************************************************/
+
+void
+DatabaseMirror::add_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::add_strain_for_growlog_vfunc(growlog_id,strain_id);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::remove_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::remove_strain_for_growlog_vfunc(growlog_id,strain_id);
+	_queue_changes(seq);
+}
+
+void
+DatabaseMirror::remove_strain_for_growlog_vfunc(uint64_t growlog_strain_id)
+{
+	MirrorLock lock(m_mutex_);
+	uint64_t seq = DatabaseSqlite3::get_change_seq_vfunc();
+	DatabaseSqlite3::remove_strain_for_growlog_vfunc(growlog_strain_id);
+	_queue_changes(seq);
+}
+
+/**** Statistics methods ******************************************************/
+
+GrowlogStats
+DatabaseMirror::get_growlog_stats_vfunc(uint64_t growlog_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_stats_vfunc(growlog_id);
+}
+
+std::list<GrowlogStats>
+DatabaseMirror::get_growlog_stats_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_growlog_stats_vfunc();
+}
+
+StrainStats
+DatabaseMirror::get_strain_stats_vfunc(uint64_t strain_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strain_stats_vfunc(strain_id);
+}
+
+std::list<StrainStats>
+DatabaseMirror::get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_strain_stats_for_breeder_vfunc(breeder_id);
+}
+
+void
+DatabaseMirror::rebuild_stats_vfunc()
+{
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::rebuild_stats_vfunc();
+}
+
+/**** Change tracking methods *************************************************/
+
+uint64_t
+DatabaseMirror::get_change_seq_vfunc() const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_change_seq_vfunc();
+}
+
+void
+DatabaseMirror::foreach_change_vfunc(uint64_t after,
+                                     uint64_t upto,
+                                     const sigc::slot<void,const ChangeRecord&> &slot) const
+{
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::foreach_change_vfunc(after,upto,slot);
+}
+
+uint64_t
+DatabaseMirror::get_change_watermark_vfunc(const Glib::ustring &name) const
+{
+	MirrorLock lock(m_mutex_);
+	return DatabaseSqlite3::get_change_watermark_vfunc(name);
+}
+
+void
+DatabaseMirror::set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq)
+{
+	MirrorLock lock(m_mutex_);
+	DatabaseSqlite3::set_change_watermark_vfunc(name,seq);
+}
@@ -0,0 +1,294 @@
+/***************************************************************************
+ *            database-mirror.h
+ *
+ *  Mo Oktober 19 18:42:07 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * database-mirror.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DATABASE_MIRROR_H__
+#define __DATABASE_MIRROR_H__
+
+#include "database-sqlite3.h"
+
+#include <glibmm/dispatcher.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// default seconds between two syncs of a running DatabaseMirror
+#define MIRROR_SYNC_INTERVAL 60
+
+/*******************************************************************************
+ * MirrorConflict
+ ******************************************************************************/
+
+enum MirrorConflictType {
+	// changed in the mirror and in the remote database, the mirror wins
+	MIRROR_CONFLICT_MODIFIED,
+	// changed in the mirror and deleted in the remote database, the row
+	// is created again
+	MIRROR_CONFLICT_DELETED_REMOTE,
+	// deleted in the mirror and changed in the remote database, the row
+	// is deleted
+	MIRROR_CONFLICT_DELETED_LOCAL,
+	// the remote database refused a change, it stays in the mirror only
+	MIRROR_CONFLICT_REJECTED
+};
+
+struct MirrorConflict
+{
+	uint64_t id = 0;
+	MirrorConflictType type = MIRROR_CONFLICT_MODIFIED;
+	std::string table;
+	uint64_t local_id = 0;
+	uint64_t remote_id = 0;
+	Glib::ustring name;
+	Glib::ustring message;
+	time_t created_on = 0;
+};
+
+/*******************************************************************************
+ * DatabaseMirror
+ ******************************************************************************/
+
+/*! A local sqlite3 replica of a remote database, so GrowBook keeps working
+ * while the remote database can not be reached.
+ *
+ * All reads are served by the replica. Writes go to the replica and are
+ * queued in an outbox. sync() pulls the changes of the remote database,
+ * see Database::foreach_change(), and pushes the outbox. Rows have other
+ * ids in both databases; they are related by an id map and, for rows that
+ * were created on both sides, by their names.
+ *
+ * Conflicting changes are resolved in favour of the mirror, recorded and
+ * reported by signal_conflict().
+ *
+ * The remote database needs the change_log of Database::foreach_change();
+ * books created before it existed get it from Database::create_database().
+ *
+ * The methods may be called from any thread. start_sync() runs sync() in
+ * a background thread; the signals are emitted in the thread that called
+ * start_sync(), which needs a running main loop.
+ */
+class DatabaseMirror:
+	public DatabaseSqlite3
+{
+	 private:
+		 Glib::RefPtr<Database> m_remote_;
+
+		 // guards the replica, the remote database is only used by sync()
+		 mutable std::recursive_mutex m_mutex_;
+		 std::mutex m_sync_mutex_;
+		 std::atomic<bool> m_online_;
+
+		 std::thread m_sync_thread_;
+		 std::mutex m_thread_mutex_;
+		 std::condition_variable m_thread_cond_;
+		 bool m_thread_stop_;
+		 bool m_thread_wake_;
+		 unsigned int m_sync_interval_;
+		 std::unique_ptr<Glib::Dispatcher> m_dispatcher_;
+
+		 // results of sync() waiting to be emitted, guarded by m_mutex_
+		 std::list<MirrorConflict> m_new_conflicts_;
+		 uint64_t m_pulled_rows_;
+		 bool m_synced_;
+		 // the remote database refused change tracking, reported once
+		 // until it has been installed
+		 bool m_remote_refused_;
+
+		 sigc::signal<void,const MirrorConflict&> m_signal_conflict_;
+		 sigc::signal<void,uint64_t> m_signal_synced_;
+
+	 private:
+		 DatabaseMirror(const DatabaseMirror &src) = delete;
+		 DatabaseMirror& operator = (const DatabaseMirror &src) = delete;
+
+	 protected:
+		 DatabaseMirror(const Glib::RefPtr<Database> &remote,
+		                const std::string &filename);
+
+	 public:
+		 virtual ~DatabaseMirror();
+
+		 static Glib::RefPtr<DatabaseMirror> create(const Glib::RefPtr<Database> &remote,
+		                                            const std::string &filename);
+
+	 public:
+		 Glib::RefPtr<Database> get_remote();
+		 Glib::RefPtr<const Database> get_remote() const;
+
+		 /*! false if the last sync() could not reach the remote database.
+		  */
+		 bool is_online() const;
+		 /*! Number of writes waiting to be pushed.
+		  */
+		 uint64_t get_outbox_size() const;
+
+		 /*! Exchange the changes with the remote database. Returns false if
+		  * it can not be reached; the outbox is kept for the next try.
+		  * Remote books created before change tracking was added get it
+		  * from Database::rebuild_stats(), if the remote database refuses
+		  * that a conflict is reported and DatabaseError is thrown.
+		  * Called outside of start_sync(), the signals are emitted before
+		  * sync() returns.
+		  */
+		 bool sync();
+		 /*! Call sync() every interval seconds and soon after a write.
+		  */
+		 void start_sync(unsigned int interval);
+		 void stop_sync();
+
+		 std::list<MirrorConflict> get_conflicts() const;
+		 void clear_conflicts();
+
+		 /*! Emitted for every conflict sync() found.
+		  */
+		 sigc::signal<void,const MirrorConflict&>& signal_conflict();
+		 /*! Emitted after a sync() that reached the remote database, with
+		  * the number of rows that were pulled.
+		  */
+		 sigc::signal<void,uint64_t>& signal_synced();
+
+	 private:
+		 struct PullData;
+
+		 void _sync_thread();
+		 void _emit_results();
+		 void _notify();
+		 void _create_tables();
+		 void _queue_changes(uint64_t after);
+		 void _wake_sync_thread();
+		 bool _remote_alive();
+		 void _prepare_remote();
+
+		 void _outbox_add(const ChangeRecord &change);
+		 std::list<ChangeRecord> _outbox_get() const;
+		 char _outbox_op(const std::string &table, uint64_t local_id) const;
+		 void _outbox_remove(uint64_t seq);
+
+		 uint64_t _map_local(const std::string &table, uint64_t remote_id) const;
+		 uint64_t _map_remote(const std::string &table, uint64_t local_id) const;
+		 uint64_t _map_pushed_seq(const std::string &table, uint64_t remote_id) const;
+		 void _map_load(const std::string &table, std::unordered_map<uint64_t,uint64_t> &id_map) const;
+		 void _map_set(const std::string &table, uint64_t local_id, uint64_t remote_id, uint64_t pushed_seq=0);
+		 void _map_set_many(const std::string &table,
+		                    const std::vector<uint64_t> &local_ids,
+		                    const std::vector<uint64_t> &remote_ids);
+		 void _map_remove_local(const std::string &table, uint64_t local_id);
+
+		 void _add_conflict(MirrorConflictType type,
+		                    const std::string &table,
+		                    uint64_t local_id,
+		                    uint64_t remote_id,
+		                    const Glib::ustring &name,
+		                    const Glib::ustring &message=Glib::ustring());
+		 Glib::ustring _local_name(const std::string &table, uint64_t local_id) const;
+		 Glib::ustring _local_name(const ChangeRecord &change) const;
+		 uint64_t _last_local_insert(uint64_t after, const std::string &table);
+
+		 bool _has_pulled() const;
+		 void _fetch_remote(uint64_t after, bool full, PullData &data);
+		 void _apply_pull(PullData &data);
+		 void _apply_remote_delete(const ChangeRecord &change);
+		 bool _skip_pulled(const std::string &table, uint64_t local_id, uint64_t remote_id, uint64_t seq);
+		 void _pull_breeder(const Glib::RefPtr<Breeder> &remote, uint64_t seq);
+		 void _pull_strain(const Glib::RefPtr<Strain> &remote, uint64_t seq);
+		 void _pull_growlog(const Glib::RefPtr<Growlog> &remote, uint64_t seq);
+		 void _pull_growlog_strains(uint64_t remote_growlog_id,
+		                            const std::list<Glib::RefPtr<Strain> > &remote_strains,
+		                            uint64_t seq);
+		 void _pull_entries(PullData &data);
+
+		 void _push(const ChangeRecord &change);
+		 uint64_t _push_breeder(uint64_t local_id);
+		 uint64_t _push_strain(uint64_t local_id);
+		 uint64_t _push_growlog(uint64_t local_id);
+		 void _push_growlog_strains(uint64_t local_growlog_id);
+		 uint64_t _push_entry(uint64_t local_id);
+		 void _push_delete(const ChangeRecord &change);
+		 void _pushed(const std::string &table, uint64_t local_id, uint64_t remote_id);
+
+	 protected:
+		 bool test_connection_vfunc() override;
+		 void create_database_vfunc() override;
+		 void connect_vfunc() override;
+		 void close_vfunc() override;
+
+		 virtual std::list<Glib::RefPtr<Breeder> > get_breeders_vfunc() const override;
+		 virtual Glib::RefPtr<Breeder> get_breeder_vfunc(uint64_t id) const override;
+		 virtual Glib::RefPtr<Breeder> get_breeder_vfunc(const Glib::ustring &name) const override;
+		 virtual void add_breeder_vfunc(const Glib::RefPtr<Breeder> &breeder) override;
+		 virtual void remove_breeder_vfunc(uint64_t id) override;
+
+		 virtual std::list<Glib::RefPtr<Strain> > get_strains_for_breeder_vfunc(uint64_t breeder_id) const override;
+		 virtual std::list<Glib::RefPtr<Strain> > get_strains_for_growlog_vfunc(uint64_t growlog_id) const override;
+		 virtual Glib::RefPtr<Strain> get_strain_vfunc(uint64_t id) const override;
+		 virtual Glib::RefPtr<Strain> get_strain_vfunc(const Glib::ustring &breeder_name,
+		                                               const Glib::ustring &strain_name) const override;
+		 virtual void add_strain_vfunc(const Glib::RefPtr<Strain> &strain) override;
+		 virtual void remove_strain_vfunc(uint64_t id) override;
+		 virtual std::list<Glib::RefPtr<Strain> > get_strains_vfunc() const override;
+		 virtual std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > get_strains_for_growlogs_vfunc() const override;
+
+		 virtual std::list<Glib::RefPtr<Growlog> > get_growlogs_vfunc() const override;
+		 virtual std::list<Glib::RefPtr<Growlog> > get_ongoing_growlogs_vfunc() const override;
+		 virtual std::list<Glib::RefPtr<Growlog> > get_finished_growlogs_vfunc() const override;
+		 virtual std::list<Glib::RefPtr<Growlog> > get_growlogs_for_strain_vfunc(uint64_t strain_id) const override;
+		 virtual Glib::RefPtr<Growlog> get_growlog_vfunc(uint64_t id) const override;
+		 virtual Glib::RefPtr<Growlog> get_growlog_vfunc(const Glib::ustring &title) const override;
+		 virtual void add_growlog_vfunc(const Glib::RefPtr<Growlog> &growlog) override;
+		 virtual void remove_growlog_vfunc(uint64_t id) override;
+
+		 virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id) const override;
+		 virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id,
+		                                                                          uint64_t offset,
+		                                                                          uint64_t limit) const override;
+		 virtual uint64_t get_growlog_entry_count_vfunc(uint64_t growlog_id) const override;
+		 virtual Glib::RefPtr<GrowlogEntry> get_growlog_entry_vfunc(uint64_t id) const override;
+		 virtual void add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &entry) override;
+		 virtual void remove_growlog_entry_vfunc(uint64_t id) override;
+		 virtual void foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const override;
+		 virtual void add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows) override;
+
+		 virtual void add_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) override;
+		 virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) override;
+		 virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_strain_id) override;
+
+		 virtual GrowlogStats get_growlog_stats_vfunc(uint64_t growlog_id) const override;
+		 virtual std::list<GrowlogStats> get_growlog_stats_vfunc() const override;
+		 virtual StrainStats get_strain_stats_vfunc(uint64_t strain_id) const override;
+		 virtual std::list<StrainStats> get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const override;
+		 virtual void rebuild_stats_vfunc() override;
+
+		 virtual uint64_t get_change_seq_vfunc() const override;
+		 virtual void foreach_change_vfunc(uint64_t after,
+		                                   uint64_t upto,
+		                                   const sigc::slot<void,const ChangeRecord&> &slot) const override;
+		 virtual uint64_t get_change_watermark_vfunc(const Glib::ustring &name) const override;
+		 virtual void set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq) override;
+};
+
+#endif /* __DATABASE_MIRROR_H__ */
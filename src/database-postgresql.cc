@@ -37,13 +37,159 @@
 #include <glibmm/i18n.h>
 #include <glibmm.h>
 #include <string>
-#include <fstream>
 #include <cassert>
+#include <chrono>
 
 #include <iostream>
 
 #include "error.h"
-#include "application.h"
+#include "querystats.h"
+
+/*******************************************************************************
+ * statement helpers
+ ******************************************************************************/
+
+// PQexec() and PQexecParams() wrappers feeding the query statistics while
+// they are enabled.
+
+static void
+_pq_record(const char *sql, uint64_t ns, PGresult *result)
+{
+	uint64_t n_rows = 0, n_bytes = 0;
+	
+	if (result && PQresultStatus(result) == PGRES_TUPLES_OK) {
+		int n_tuples = PQntuples(result);
+		int n_fields = PQnfields(result);
+		n_rows = n_tuples;
+		for (int i = 0; i < n_tuples; ++i) {
+			for (int j = 0; j < n_fields; ++j)
+				n_bytes += PQgetlength(result,i,j);
+		}
+	}
+	query_stats_lookup_sql("postgresql",sql)->record(ns,n_rows,n_bytes);
+}
+
+static PGresult*
+_pq_exec(PGconn *conn, const char *sql)
+{
+	if (!query_stats_get_enabled())
+		return PQexec(conn,sql);
+
+	auto start = std::chrono::steady_clock::now();
+	PGresult *result = PQexec(conn,sql);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	
+	_pq_record(sql,std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),result);
+	return result;
+}
+
+static PGresult*
+_pq_exec_params(PGconn *conn,
+                const char *sql,
+                int n_params,
+                const Oid *param_types,
+                const char * const *param_values,
+                const int *param_lengths,
+                const int *param_formats,
+                int result_format)
+{
+	if (!query_stats_get_enabled())
+		return PQexecParams(conn,
+		                    sql,
+		                    n_params,
+		                    param_types,
+		                    param_values,
+		                    param_lengths,
+		                    param_formats,
+		                    result_format);
+
+	auto start = std::chrono::steady_clock::now();
+	PGresult *result = PQexecParams(conn,
+	                                sql,
+	                                n_params,
+	                                param_types,
+	                                param_values,
+	                                param_lengths,
+	                                param_formats,
+	                                result_format);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	_pq_record(sql,std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),result);
+	return result;
+}
+
+static Glib::RefPtr<Strain>
+_pq_strain(PGresult *result, int row, int column)
+{
+	uint64_t id = std::stoull(PQgetvalue(result,row,column));
+	uint64_t breeder_id = std::stoull(PQgetvalue(result,row,column + 1));
+	Glib::ustring breeder_name = PQgetvalue(result,row,column + 2);
+	Glib::ustring name = PQgetvalue(result,row,column + 3);
+	Glib::ustring info = PQgetvalue(result,row,column + 4);
+	Glib::ustring desc = PQgetvalue(result,row,column + 5);
+	std::string homepage = PQgetvalue(result,row,column + 6);
+	std::string seedfinder = PQgetvalue(result,row,column + 7);
+
+	return Strain::create(id,breeder_id,breeder_name,name,info,desc,homepage,seedfinder);
+}
+
+static time_t
+_pq_get_datetime(PGresult *result, int row, int column)
+{
+	if (PQgetisnull(result,row,column))
+		return 0;
+
+	tm datetime;
+	const char *str = PQgetvalue(result,row,column);
+	if (!str || !*str || !strptime(str,DATETIME_ISO_FORMAT,&datetime))
+		return 0;
+	datetime.tm_isdst = -1;
+	return mktime(&datetime);
+}
+
+static GrowlogStats
+_pq_growlog_stats(PGresult *result, int row)
+{
+	GrowlogStats stats;
+	stats.growlog_id = std::stoull(PQgetvalue(result,row,0));
+	stats.entry_count = std::stoull(PQgetvalue(result,row,1));
+	stats.first_entry_on = _pq_get_datetime(result,row,2);
+	stats.last_entry_on = _pq_get_datetime(result,row,3);
+	stats.text_bytes = std::stoull(PQgetvalue(result,row,4));
+	return stats;
+}
+
+static StrainStats
+_pq_strain_stats(PGresult *result, int row)
+{
+	StrainStats stats;
+	stats.strain_id = std::stoull(PQgetvalue(result,row,0));
+	stats.growlog_count = std::stoull(PQgetvalue(result,row,1));
+	stats.veg_count = std::stoull(PQgetvalue(result,row,2));
+	stats.veg_days = std::stoull(PQgetvalue(result,row,3));
+	stats.flower_count = std::stoull(PQgetvalue(result,row,4));
+	stats.flower_days = std::stoull(PQgetvalue(result,row,5));
+	return stats;
+}
+
+static ChangeRecord
+_pq_change_record(PGresult *result, int row)
+{
+	ChangeRecord record;
+	record.seq = std::stoull(PQgetvalue(result,row,0));
+	record.table = PQgetvalue(result,row,1);
+	record.row_id = std::stoull(PQgetvalue(result,row,2));
+	const char *op = PQgetvalue(result,row,3);
+	if (*op == 'D')
+		record.type = CHANGE_DELETE;
+	else if (*op == 'R')
+		record.type = CHANGE_RENAME;
+	for (int i = 0; i < 3; ++i) {
+		record.key[i] = PQgetvalue(result,row,4 + i);
+		record.new_key[i] = PQgetvalue(result,row,7 + i);
+	}
+	return record;
+}
 
 /*******************************************************************************
  * DatabaseModulePostgresql
@@ -171,33 +317,21 @@ DatabasePostgresql::close_vfunc()
 void
 DatabasePostgresql::create_database_vfunc()
 {
-	std::string sql_file = Glib::build_filename(app->get_settings()->get_sql_dir (),
+	std::string sql_file = Glib::build_filename(db_get_sql_dir(),
 	                                            "growbook.postgresql.sql");
-	std::string sql,text;
-	std::fstream file;
 	
-	file.open(sql_file,std::ios::in);
-	while (getline(file,text)) {
-		if (text.empty())
-			continue;
-		if (!sql.empty())
-			sql+="\n";
-
-		sql+=text;
-		if (sql[sql.size() - 1] == ';') {
-			PGresult *result = PQexec(m_db_,sql.c_str());
-			if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-				rollback();
-				Glib::ustring msg = _("Unable to create GrowBook database!");
-				msg += "\n(";
-				msg += PQresultErrorMessage(result);
-				msg += ")";
-				PQclear(result);
-				throw DatabaseError(msg);
-			}
+	for (auto sql: db_read_sql_file(sql_file)) {
+		PGresult *result = _pq_exec(m_db_,sql.c_str());
+		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+			rollback();
+			Glib::ustring msg = _("Unable to create GrowBook database!");
+			msg += "\n(";
+			msg += PQresultErrorMessage(result);
+			msg += ")";
 			PQclear(result);
-			sql = "";
+			throw DatabaseError(msg);
 		}
+		PQclear(result);
 	}
 }
 
@@ -206,7 +340,7 @@ DatabasePostgresql::begin_transaction()
 {
 	assert(m_db_);
 
-	PGresult *result = PQexec(m_db_,"BEGIN;");
+	PGresult *result = _pq_exec(m_db_,"BEGIN;");
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Unable to start a transaction!");
 		msg += "\n(";
@@ -223,7 +357,7 @@ DatabasePostgresql::commit()
 {
 	assert(m_db_);
 
-	PGresult *result = PQexec(m_db_,"COMMIT;");
+	PGresult *result = _pq_exec(m_db_,"COMMIT;");
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Unable to commit changes!");
 		msg += "\n(";
@@ -241,7 +375,7 @@ DatabasePostgresql::rollback()
 {
 	assert(m_db_);
 
-	PGresult *result = PQexec(m_db_,"ROLLBACK;");
+	PGresult *result = _pq_exec(m_db_,"ROLLBACK;");
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Unable to rollback changes!");
 		msg += "\n(";
@@ -263,7 +397,7 @@ DatabasePostgresql::get_breeders_vfunc() const
 	const char *sql="SELECT id,name,homepage FROM breeder ORDER BY name";
 	std::list<Glib::RefPtr<Breeder> > breeders;
 
-	PGresult *result = PQexec(m_db_,sql);
+	PGresult *result = _pq_exec(m_db_,sql);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int rows = PQntuples(result);
 		for (int i = 0; i < rows; ++i) {
@@ -290,7 +424,7 @@ DatabasePostgresql::get_breeder_vfunc(uint64_t id) const
 	std::string str = std::to_string(id);
 	values[0] = str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {			
@@ -317,7 +451,7 @@ DatabasePostgresql::get_breeder_vfunc(const Glib::ustring &name) const
 	const char *values[1];
 	values[0] = name.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {
 			uint64_t id = std::stoull(PQgetvalue(result,0,0));
@@ -350,7 +484,7 @@ DatabasePostgresql::add_breeder_vfunc(const Glib::RefPtr<Breeder> &breeder)
 		values[1] = homepage.c_str();
 		values[2] = id_str.c_str();
 
-		PGresult *result = PQexecParams(m_db_,sql,3,NULL,values,NULL,NULL,0);
+		PGresult *result = _pq_exec_params(m_db_,sql,3,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Unable to update breeder!");
 			msg += "\n(";
@@ -369,7 +503,7 @@ DatabasePostgresql::add_breeder_vfunc(const Glib::RefPtr<Breeder> &breeder)
 		values[0] = name.c_str();
 		values[1] = homepage.c_str();
 
-		PGresult *result = PQexecParams(m_db_,sql,2,NULL,values,NULL,NULL,0);
+		PGresult *result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Unable to insert breeder!");
 			msg += "\n(";
@@ -396,7 +530,7 @@ DatabasePostgresql::remove_breeder_vfunc(uint64_t id)
 	std::string id_str = std::to_string(id);
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Unable to delete breeder from database!");
 		msg += "\n)";
@@ -424,7 +558,7 @@ DatabasePostgresql::get_strains_for_breeder_vfunc(uint64_t breeder_id) const
 	std::string breeder_id_str = std::to_string(breeder_id);
 	values[0] = breeder_id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	int status = PQresultStatus(result);
 	if (status == PGRES_TUPLES_OK) {
 		int rows = PQntuples(result);
@@ -464,13 +598,13 @@ DatabasePostgresql::get_strains_for_growlog_vfunc(uint64_t growlog_id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT strain FROM growlog_strain WHERE growlog=$1;";
+	const char *sql = "SELECT strain FROM growlog_strain WHERE growlog=$1 ORDER BY strain;";
 	std::list<Glib::RefPtr<Strain> > ret;
 	const char* values[1];
 	std::string growlog_id_str = std::to_string(growlog_id);
 	values[0] = growlog_id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int rows = PQntuples(result);
 		for (int i=0; i<rows; ++i) {
@@ -495,7 +629,7 @@ DatabasePostgresql::get_strain_vfunc(uint64_t id) const
 	std::string id_str = std::to_string(id);
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {
 			uint64_t breeder_id = std::stoull(PQgetvalue(result,0,0));
@@ -525,7 +659,7 @@ DatabasePostgresql::get_strain_vfunc(const Glib::ustring &breeder_name,
 	values[0] = breeder_name.c_str();
 	values[1] = strain_name.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,2,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {
 			uint64_t id = std::stoull(PQgetvalue(result,0,0));
@@ -574,7 +708,7 @@ DatabasePostgresql::add_strain_vfunc(const Glib::RefPtr<Strain> &strain)
 		values[4] = seedfinder.c_str();
 		values[5] = id_str.c_str();
 
-		PGresult *result = PQexecParams(m_db_,sql,6,NULL,values,NULL,NULL,0);
+		PGresult *result = _pq_exec_params(m_db_,sql,6,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Unable to update strain!");
 			msg += "\n(";
@@ -602,7 +736,7 @@ DatabasePostgresql::add_strain_vfunc(const Glib::RefPtr<Strain> &strain)
 		values[4] = homepage.c_str();
 		values[5] = seedfinder.c_str();
 
-		PGresult *result = PQexecParams(m_db_,sql,6,NULL,values,NULL,NULL,0);
+		PGresult *result = _pq_exec_params(m_db_,sql,6,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Unable to insert strain into database!");
 			msg += "\n(";
@@ -627,7 +761,7 @@ DatabasePostgresql::remove_strain_vfunc(uint64_t id)
 	std::string id_str = std::to_string(id);
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Unable to delete strain from database!");
 		msg += "\n)";
@@ -641,6 +775,58 @@ DatabasePostgresql::remove_strain_vfunc(uint64_t id)
 	commit();
 }
 
+std::list<Glib::RefPtr<Strain> >
+DatabasePostgresql::get_strains_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT id,breeder_id,breeder_name,name,info,description,homepage,seedfinder FROM strain_view ORDER BY breeder_name,name;";
+	std::list<Glib::RefPtr<Strain> > ret;
+
+	PGresult *result = _pq_exec(m_db_,sql);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		int rows = PQntuples(result);
+		for (int i = 0; i < rows; ++i)
+			ret.push_back(_pq_strain(result,i,0));
+	} else {
+		Glib::ustring msg = _("Looking up strains failed!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+std::map<uint64_t,std::list<Glib::RefPtr<Strain> > >
+DatabasePostgresql::get_strains_for_growlogs_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT gs.growlog,s.id,s.breeder_id,s.breeder_name,s.name,s.info,s.description,s.homepage,s.seedfinder FROM growlog_strain AS gs JOIN strain_view AS s ON s.id=gs.strain ORDER BY gs.growlog,gs.strain;";
+	std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > ret;
+
+	PGresult *result = _pq_exec(m_db_,sql);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		int rows = PQntuples(result);
+		for (int i = 0; i < rows; ++i)
+			ret[std::stoull(PQgetvalue(result,i,0))].push_back(_pq_strain(result,i,1));
+	} else {
+		Glib::ustring msg = _("Looking up strains for growlogs failed!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
 /**** Growlog methods *********************************************************/
 
 std::list<Glib::RefPtr<Growlog> >
@@ -651,7 +837,7 @@ DatabasePostgresql::get_growlogs_vfunc() const
 	const char *sql = "SELECT id,title,description,created_on,flower_on,finished_on FROM growlog ORDER BY title;";
 	std::list<Glib::RefPtr<Growlog> > ret;
 	
-	PGresult *result = PQexec(m_db_,sql);
+	PGresult *result = _pq_exec(m_db_,sql);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int n_rows = PQntuples(result);
 		for (int i=0; i<n_rows; ++i) {
@@ -662,6 +848,7 @@ DatabasePostgresql::get_growlogs_vfunc() const
 			Glib::ustring desc = PQgetvalue(result,i,2);
 			Glib::ustring created_on_str = PQgetvalue(result,i,3);
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 			time_t flower_on = 0;
 			time_t finished_on = 0;
@@ -670,6 +857,7 @@ DatabasePostgresql::get_growlogs_vfunc() const
 				Glib::ustring flower_on_str = PQgetvalue(result,i,4);
 				if (!flower_on_str.empty()) {
 					strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					flower_on = mktime(&datetime);
 				}
 			}
@@ -678,6 +866,7 @@ DatabasePostgresql::get_growlogs_vfunc() const
 				Glib::ustring finished_on_str = PQgetvalue(result,i,5);
 				if (!finished_on_str.empty()) {
 					strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					finished_on = mktime(&datetime);
 				}
 			}
@@ -698,7 +887,7 @@ DatabasePostgresql::get_ongoing_growlogs_vfunc() const
 	const char *sql = "SELECT id,title,description,created_on,flower_on,finished_on FROM growlog WHERE finished_on IS NULL ORDER BY title;";
 	std::list<Glib::RefPtr<Growlog> > ret;
 
-	PGresult *result = PQexec(m_db_,sql);
+	PGresult *result = _pq_exec(m_db_,sql);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int n_rows = PQntuples(result);
 		for (int i=0; i<n_rows; ++i) {
@@ -708,6 +897,7 @@ DatabasePostgresql::get_ongoing_growlogs_vfunc() const
 			Glib::ustring created_on_str = PQgetvalue(result,i,3);
 			tm datetime;
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 			time_t flower_on = 0;
 			time_t finished_on = 0;
@@ -716,6 +906,7 @@ DatabasePostgresql::get_ongoing_growlogs_vfunc() const
 				Glib::ustring flower_on_str = PQgetvalue(result,i,4);
 				if (!flower_on_str.empty()) {
 					strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					flower_on = mktime(&datetime);
 				}
 			}
@@ -736,7 +927,7 @@ DatabasePostgresql::get_finished_growlogs_vfunc() const
 	const char *sql = "SELECT id,title,description,created_on,flower_on,finished_on FROM growlog WHERE finished_on IS NOT NULL ORDER BY title;";
 	std::list<Glib::RefPtr<Growlog> > ret;
 
-	PGresult *result = PQexec(m_db_,sql);
+	PGresult *result = _pq_exec(m_db_,sql);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int n_rows = PQntuples(result);
 		for (int i=0; i<n_rows; ++i) {
@@ -746,6 +937,7 @@ DatabasePostgresql::get_finished_growlogs_vfunc() const
 			Glib::ustring created_on_str = PQgetvalue(result,i,3);
 			tm datetime;
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 			time_t flower_on = 0;
 			time_t finished_on = 0;
@@ -754,12 +946,14 @@ DatabasePostgresql::get_finished_growlogs_vfunc() const
 				Glib::ustring flower_on_str = PQgetvalue(result,i,4);
 				if (!flower_on_str.empty()) {
 					strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					flower_on = mktime(&datetime);
 				}
 			}
 			Glib::ustring finished_on_str = PQgetvalue(result,i,5);
 			if (!finished_on_str.empty()) {
 				strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				finished_on = mktime(&datetime);
 			}
 			Glib::RefPtr<Growlog> growlog = Growlog::create(id,title,desc,created_on,flower_on,finished_on);
@@ -782,7 +976,7 @@ DatabasePostgresql::get_growlogs_for_strain_vfunc(uint64_t strain_id) const
 	const char *values[1];
 	values[0] = strain_id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int n_rows = PQntuples(result);
 		for (int i=0; i<n_rows; ++i) {
@@ -809,7 +1003,7 @@ DatabasePostgresql::get_growlog_vfunc(uint64_t id) const
 	const char *values[1];
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {
 			Glib::ustring title = PQgetvalue(result,0,0);
@@ -817,6 +1011,7 @@ DatabasePostgresql::get_growlog_vfunc(uint64_t id) const
 			Glib::ustring created_on_str = PQgetvalue(result,0,2);
 			tm datetime;
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 			time_t flower_on = 0;
 			time_t finished_on = 0;
@@ -825,6 +1020,7 @@ DatabasePostgresql::get_growlog_vfunc(uint64_t id) const
 				Glib::ustring flower_on_str = PQgetvalue(result,0,3);
 				if (!flower_on_str.empty()) {
 					strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					flower_on = mktime(&datetime);
 				}
 			}
@@ -832,6 +1028,7 @@ DatabasePostgresql::get_growlog_vfunc(uint64_t id) const
 				Glib::ustring finished_on_str = PQgetvalue(result,0,4);
 				if (!finished_on_str.empty()) {
 					strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					finished_on = mktime(&datetime);
 				}
 			}
@@ -850,7 +1047,7 @@ DatabasePostgresql::get_growlog_vfunc(const Glib::ustring &title) const
 	const char *values[1];
 	values[0] = title.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {
 			tm datetime;
@@ -858,6 +1055,7 @@ DatabasePostgresql::get_growlog_vfunc(const Glib::ustring &title) const
 			Glib::ustring desc = PQgetvalue(result,0,1);
 			Glib::ustring created_on_str = PQgetvalue(result,0,2);
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 			time_t flower_on = 0;
 			time_t finished_on = 0;
@@ -866,6 +1064,7 @@ DatabasePostgresql::get_growlog_vfunc(const Glib::ustring &title) const
 				Glib::ustring flower_on_str = PQgetvalue(result,0,3);
 				if (!flower_on_str.empty()) {
 					strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					flower_on = mktime(&datetime);
 				}
 			}
@@ -873,6 +1072,7 @@ DatabasePostgresql::get_growlog_vfunc(const Glib::ustring &title) const
 				Glib::ustring finished_on_str = PQgetvalue(result,0,4);
 				if (!finished_on_str.empty()) {
 					strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					finished_on = mktime(&datetime);
 				}
 			}
@@ -921,7 +1121,7 @@ DatabasePostgresql::add_growlog_vfunc(const Glib::RefPtr<Growlog> &growlog)
 		}
 		values[4] = id_str.c_str();
 
-		result = PQexecParams(m_db_,sql,5,NULL,values,NULL,NULL,0);
+		result = _pq_exec_params(m_db_,sql,5,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Updating growlog failed!");
 			msg += "\n(";
@@ -958,7 +1158,7 @@ DatabasePostgresql::add_growlog_vfunc(const Glib::RefPtr<Growlog> &growlog)
 			values[4] = finished_on_str.c_str();
 		}
 
-		result = PQexecParams(m_db_,sql,5,NULL,values,NULL,NULL,0);
+		result = _pq_exec_params(m_db_,sql,5,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Inserting growlog into database failed!");
 			msg += "\n(";
@@ -985,7 +1185,7 @@ DatabasePostgresql::remove_growlog_vfunc(uint64_t id)
 	const char *values[1];
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Deleting growlog failed!");
 		msg += "\n(";
@@ -1006,13 +1206,13 @@ DatabasePostgresql::get_growlog_entries_vfunc(uint64_t growlog_id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=$1 ORDER BY created_on;";
+	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=$1 ORDER BY created_on,id;";
 	std::string growlog_id_str = std::to_string(growlog_id);
 	std::list<Glib::RefPtr<GrowlogEntry> > ret;
 	const char *values[1];
 	values[0] = growlog_id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		int n_rows = PQntuples(result);
 		for (int i = 0; i < n_rows; ++i) {
@@ -1021,12 +1221,87 @@ DatabasePostgresql::get_growlog_entries_vfunc(uint64_t growlog_id) const
 			Glib::ustring created_on_str = PQgetvalue(result,i,2);
 			tm datetime;
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
+			time_t created_on = mktime(&datetime);
+
+			Glib::RefPtr<GrowlogEntry> entry = GrowlogEntry::create(id,growlog_id,text,created_on);
+			if (entry)
+				ret.push_back(entry);
+		}
+	}
+	PQclear(result);
+	return ret;
+}
+
+std::list<Glib::RefPtr<GrowlogEntry> >
+DatabasePostgresql::get_growlog_entries_vfunc(uint64_t growlog_id,
+                                              uint64_t offset,
+                                              uint64_t limit) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=$1 ORDER BY created_on,id LIMIT $2 OFFSET $3;";
+	std::string growlog_id_str = std::to_string(growlog_id);
+	std::string limit_str = std::to_string(limit);
+	std::string offset_str = std::to_string(offset);
+	std::list<Glib::RefPtr<GrowlogEntry> > ret;
+	const char *values[3];
+	values[0] = growlog_id_str.c_str();
+	values[1] = limit_str.c_str();
+	values[2] = offset_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,3,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		int n_rows = PQntuples(result);
+		for (int i = 0; i < n_rows; ++i) {
+			uint64_t id = std::stoull(PQgetvalue(result,i,0));
+			Glib::ustring text = PQgetvalue(result,i,1);
+			Glib::ustring created_on_str = PQgetvalue(result,i,2);
+			tm datetime;
+			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 
 			Glib::RefPtr<GrowlogEntry> entry = GrowlogEntry::create(id,growlog_id,text,created_on);
 			if (entry)
 				ret.push_back(entry);
 		}
+	} else {
+		Glib::ustring msg = _("Unable to fetch growlog-entries from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+uint64_t
+DatabasePostgresql::get_growlog_entry_count_vfunc(uint64_t growlog_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT COUNT(*) FROM growlog_entry WHERE growlog=$1;";
+	std::string growlog_id_str = std::to_string(growlog_id);
+	uint64_t ret = 0;
+	const char *values[1];
+	values[0] = growlog_id_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		if (PQntuples(result) > 0)
+			ret = std::stoull(PQgetvalue(result,0,0));
+	} else {
+		Glib::ustring msg = _("Unable to count growlog-entries!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
 	}
 	PQclear(result);
 	return ret;
@@ -1037,22 +1312,24 @@ DatabasePostgresql::get_growlog_entry_vfunc(uint64_t id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT entry,created_on FROM growlog_entry WHERE id=$1;";
+	const char *sql = "SELECT growlog,entry,created_on FROM growlog_entry WHERE id=$1;";
 	Glib::RefPtr<GrowlogEntry> entry;
 	const char *values[1];
 	std::string id_str = std::to_string(id);
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) == PGRES_TUPLES_OK) {
 		if (PQntuples(result) > 0) {
-			Glib::ustring text = PQgetvalue(result,0,0);
-			Glib::ustring created_on_str = PQgetvalue(result,0,1);
+			uint64_t growlog_id = std::stoull(PQgetvalue(result,0,0));
+			Glib::ustring text = PQgetvalue(result,0,1);
+			Glib::ustring created_on_str = PQgetvalue(result,0,2);
 			tm datetime;
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 
-			entry = GrowlogEntry::create(id,text,created_on);
+			entry = GrowlogEntry::create(id,growlog_id,text,created_on);
 		}
 	}
 	PQclear(result);
@@ -1078,7 +1355,7 @@ DatabasePostgresql::add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &en
 		values[0] = text.c_str();
 		values[1] = id_str.c_str();
 
-		result = PQexecParams(m_db_,sql,2,NULL,values,NULL,NULL,0);
+		result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Updating growlog-entry failed!");
 			msg += "\n(";
@@ -1098,7 +1375,7 @@ DatabasePostgresql::add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &en
 		values[1] = text.c_str();
 		values[2] = created_on_str.c_str();
 
-		result = PQexecParams(m_db_,sql,3,NULL,values,NULL,NULL,0);
+		result = _pq_exec_params(m_db_,sql,3,NULL,values,NULL,NULL,0);
 		if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 			Glib::ustring msg = _("Inserting growlog-entry failed!");
 			msg += "\n(";
@@ -1125,7 +1402,7 @@ DatabasePostgresql::remove_growlog_entry_vfunc(uint64_t id)
 	const char *values[1];
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Deleting growlog-entry failed!");
 		msg += "\n(";
@@ -1140,6 +1417,170 @@ DatabasePostgresql::remove_growlog_entry_vfunc(uint64_t id)
 	commit();
 }
 
+void
+DatabasePostgresql::foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const
+{
+	assert(m_db_);
+
+	// Rows are fetched one at a time instead of materializing the whole
+	// result in client memory.
+	const char *sql = "SELECT e.id,e.growlog,e.entry,e.created_on FROM growlog AS g JOIN growlog_entry AS e ON e.growlog=g.id ORDER BY g.title,e.created_on,e.id;";
+
+	auto start = std::chrono::steady_clock::now();
+	if (!PQsendQuery(m_db_,sql) || !PQsetSingleRowMode(m_db_)) {
+		Glib::ustring msg = _("Unable to fetch growlog-entries from database!");
+		msg += "\n(";
+		msg += PQerrorMessage(m_db_);
+		msg += ")";
+		throw DatabaseError(msg);
+	}
+
+	uint64_t n_rows = 0, n_bytes = 0;
+	int status = PGRES_TUPLES_OK;
+	Glib::ustring errmsg;
+	PGresult *result;
+	while ((result = PQgetResult(m_db_))) {
+		int result_status = PQresultStatus(result);
+		if (result_status == PGRES_SINGLE_TUPLE) {
+			uint64_t id = std::stoull(PQgetvalue(result,0,0));
+			uint64_t growlog_id = std::stoull(PQgetvalue(result,0,1));
+			Glib::ustring text = PQgetvalue(result,0,2);
+			tm datetime;
+			strptime(PQgetvalue(result,0,3),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
+			time_t created_on = mktime(&datetime);
+
+			++n_rows;
+			n_bytes += PQgetlength(result,0,2);
+			try {
+				slot(GrowlogEntry::create(id,growlog_id,text,created_on));
+			} catch (...) {
+				PQclear(result);
+				PGcancel *cancel = PQgetCancel(m_db_);
+				if (cancel) {
+					char errbuf[256];
+					PQcancel(cancel,errbuf,sizeof(errbuf));
+					PQfreeCancel(cancel);
+				}
+				while ((result = PQgetResult(m_db_)))
+					PQclear(result);
+				throw;
+			}
+		} else if (result_status != PGRES_TUPLES_OK && errmsg.empty()) {
+			status = result_status;
+			errmsg = PQresultErrorMessage(result);
+		}
+		PQclear(result);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	if (query_stats_get_enabled())
+		query_stats_lookup_sql("postgresql",sql)->record(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),n_rows,n_bytes);
+
+	if (!errmsg.empty()) {
+		Glib::ustring msg = _("Unable to fetch growlog-entries from database!");
+		msg += "\n(";
+		msg += errmsg;
+		msg += ")";
+		throw DatabaseError(status,msg);
+	}
+}
+
+void
+DatabasePostgresql::add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows)
+{
+	assert(m_db_);
+
+	// The rows are sent with COPY in the text format, which saves a round
+	// trip per row.
+	const char *sql = "COPY growlog_entry (growlog,entry,created_on) FROM STDIN;";
+	const size_t flush_size = 1024 * 1024;
+
+	begin_transaction();
+
+	auto start = std::chrono::steady_clock::now();
+	PGresult *result = PQexec(m_db_,sql);
+	if (PQresultStatus(result) != PGRES_COPY_IN) {
+		Glib::ustring msg = _("Unable to insert growlog-entry into database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		rollback();
+		throw DatabaseError(msg);
+	}
+	PQclear(result);
+
+	std::string buffer;
+	buffer.reserve(flush_size + 4096);
+	uint64_t n_bytes = 0;
+	bool failed = false;
+	char created_on[32];
+	for (const GrowlogEntryRow &row: rows) {
+		buffer += std::to_string(row.growlog_id);
+		buffer += '\t';
+		for (size_t i = 0; i < row.text_size; ++i) {
+			char c = row.text[i];
+			switch (c) {
+				case '\\':
+					buffer += "\\\\";
+					break;
+				case '\t':
+					buffer += "\\t";
+					break;
+				case '\n':
+					buffer += "\\n";
+					break;
+				case '\r':
+					buffer += "\\r";
+					break;
+				default:
+					buffer += c;
+					break;
+			}
+		}
+		buffer += '\t';
+		buffer.append(created_on,db_format_datetime(row.created_on,created_on,sizeof(created_on)));
+		buffer += '\n';
+		n_bytes += row.text_size;
+
+		if (buffer.size() >= flush_size) {
+			if (PQputCopyData(m_db_,buffer.data(),static_cast<int>(buffer.size())) != 1) {
+				failed = true;
+				break;
+			}
+			buffer.clear();
+		}
+	}
+	if (!failed && !buffer.empty())
+		failed = (PQputCopyData(m_db_,buffer.data(),static_cast<int>(buffer.size())) != 1);
+	PQputCopyEnd(m_db_,failed ? "growbook: sending rows failed" : nullptr);
+
+	Glib::ustring errmsg;
+	while ((result = PQgetResult(m_db_))) {
+		if (PQresultStatus(result) != PGRES_COMMAND_OK && errmsg.empty())
+			errmsg = PQresultErrorMessage(result);
+		PQclear(result);
+	}
+	if (failed && errmsg.empty())
+		errmsg = PQerrorMessage(m_db_);
+
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	if (query_stats_get_enabled())
+		query_stats_lookup_sql("postgresql",sql)->record(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),rows.size(),n_bytes);
+
+	if (!errmsg.empty()) {
+		Glib::ustring msg = _("Inserting growlog-entry failed!");
+		msg += "\n(";
+		msg += errmsg;
+		msg += ")";
+		rollback();
+		throw DatabaseError(msg);
+	}
+	commit();
+}
+
 /**** Grwolog-strain methods **************************************************/
 
 void
@@ -1157,7 +1598,7 @@ DatabasePostgresql::add_strain_for_growlog_vfunc(uint64_t growlog_id,
 	values[0] = growlog.c_str();
 	values[1] = strain.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,2,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("INSERTING into growlog_strain failed!");
 		msg += "\n(";
@@ -1186,7 +1627,7 @@ DatabasePostgresql::remove_strain_for_growlog_vfunc(uint64_t growlog_id,
 	values[0] = growlog.c_str();
 	values[1] = strain.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,2,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Deleting from 'growlog_strain' failed!");
 		msg += "\n(";
@@ -1212,7 +1653,7 @@ DatabasePostgresql::remove_strain_for_growlog_vfunc(uint64_t id)
 	const char *values[1];
 	values[0] = id_str.c_str();
 
-	PGresult *result = PQexecParams(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
 	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
 		Glib::ustring msg = _("Deleting from 'growlog_strain' failed!");
 		msg += "\n(";
@@ -1226,4 +1667,262 @@ DatabasePostgresql::remove_strain_for_growlog_vfunc(uint64_t id)
 	commit();
 }
 
+/**** Statistics methods ******************************************************/
+
+GrowlogStats
+DatabasePostgresql::get_growlog_stats_vfunc(uint64_t growlog_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT growlog,entry_count,first_entry_on,last_entry_on,text_bytes FROM growlog_stats WHERE growlog=$1;";
+	std::string growlog_id_str = std::to_string(growlog_id);
+	GrowlogStats ret;
+	ret.growlog_id = growlog_id;
+	const char *values[1];
+	values[0] = growlog_id_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		if (PQntuples(result) > 0)
+			ret = _pq_growlog_stats(result,0);
+	} else {
+		Glib::ustring msg = _("Unable to fetch growlog statistics from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+std::list<GrowlogStats>
+DatabasePostgresql::get_growlog_stats_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT growlog,entry_count,first_entry_on,last_entry_on,text_bytes FROM growlog_stats;";
+	std::list<GrowlogStats> ret;
+
+	PGresult *result = _pq_exec(m_db_,sql);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		for (int i = 0; i < PQntuples(result); ++i)
+			ret.push_back(_pq_growlog_stats(result,i));
+	} else {
+		Glib::ustring msg = _("Unable to fetch growlog statistics from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+StrainStats
+DatabasePostgresql::get_strain_stats_vfunc(uint64_t strain_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT strain,growlog_count,veg_count,veg_days,flower_count,flower_days FROM strain_stats WHERE strain=$1;";
+	std::string strain_id_str = std::to_string(strain_id);
+	StrainStats ret;
+	ret.strain_id = strain_id;
+	const char *values[1];
+	values[0] = strain_id_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		if (PQntuples(result) > 0)
+			ret = _pq_strain_stats(result,0);
+	} else {
+		Glib::ustring msg = _("Unable to fetch strain statistics from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+std::list<StrainStats>
+DatabasePostgresql::get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT st.strain,st.growlog_count,st.veg_count,st.veg_days,st.flower_count,st.flower_days FROM strain_stats AS st JOIN strain AS s ON s.id=st.strain WHERE s.breeder=$1;";
+	std::string breeder_id_str = std::to_string(breeder_id);
+	std::list<StrainStats> ret;
+	const char *values[1];
+	values[0] = breeder_id_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		for (int i = 0; i < PQntuples(result); ++i)
+			ret.push_back(_pq_strain_stats(result,i));
+	} else {
+		Glib::ustring msg = _("Unable to fetch strain statistics from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+void
+DatabasePostgresql::rebuild_stats_vfunc()
+{
+	assert(m_db_);
+
+	const char *sql =
+		"DELETE FROM growlog_stats;"
+		"INSERT INTO growlog_stats (growlog,entry_count,first_entry_on,last_entry_on,text_bytes) "
+		"SELECT g.id,COUNT(e.id),MIN(e.created_on),MAX(e.created_on),COALESCE(SUM(octet_length(e.entry)),0) "
+		"FROM growlog AS g LEFT JOIN growlog_entry AS e ON e.growlog=g.id GROUP BY g.id;"
+		"DELETE FROM strain_stats;"
+		"INSERT INTO strain_stats (strain,growlog_count,veg_count,veg_days,flower_count,flower_days) "
+		"SELECT s.id,COUNT(g.id),COUNT(g.flower_on),"
+		"COALESCE(SUM(g.flower_on-g.created_on::date),0),"
+		"COUNT(CASE WHEN g.flower_on IS NOT NULL AND g.finished_on IS NOT NULL THEN 1 END),"
+		"COALESCE(SUM(g.finished_on::date-g.flower_on),0) "
+		"FROM strain AS s LEFT JOIN growlog_strain AS gs ON gs.strain=s.id "
+		"LEFT JOIN growlog AS g ON g.id=gs.growlog GROUP BY s.id;";
+
+	begin_transaction();
+	PGresult *result = _pq_exec(m_db_,sql);
+	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+		Glib::ustring msg = _("Rebuilding statistics failed!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		rollback();
+		throw DatabaseError(msg);
+	}
+	PQclear(result);
+	commit();
+}
+
+/**** Change tracking methods *************************************************/
+
+uint64_t
+DatabasePostgresql::get_change_seq_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT COALESCE(MAX(seq),0) FROM change_log;";
+	uint64_t ret = 0;
+
+	PGresult *result = _pq_exec(m_db_,sql);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		if (PQntuples(result) > 0)
+			ret = std::stoull(PQgetvalue(result,0,0));
+	} else {
+		Glib::ustring msg = _("Unable to fetch the change sequence from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+void
+DatabasePostgresql::foreach_change_vfunc(uint64_t after,
+                                         uint64_t upto,
+                                         const sigc::slot<void,const ChangeRecord&> &slot) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT seq,table_name,row_id,op,key1,key2,key3,new_key1,new_key2,new_key3 FROM change_log WHERE seq>$1 AND seq<=$2 ORDER BY seq;";
+	std::string after_str = std::to_string(after);
+	std::string upto_str = std::to_string(upto);
+	std::list<ChangeRecord> records;
+	const char *values[2];
+	values[0] = after_str.c_str();
+	values[1] = upto_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		for (int i = 0; i < PQntuples(result); ++i)
+			records.push_back(_pq_change_record(result,i));
+	} else {
+		Glib::ustring msg = _("Unable to fetch changes from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+
+	for (auto &record: records)
+		slot(record);
+}
+
+uint64_t
+DatabasePostgresql::get_change_watermark_vfunc(const Glib::ustring &name) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT seq FROM change_watermark WHERE name=$1;";
+	uint64_t ret = 0;
+	const char *values[1];
+	values[0] = name.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,1,NULL,values,NULL,NULL,0);
+	int status = PQresultStatus(result);
+	if (status == PGRES_TUPLES_OK) {
+		if (PQntuples(result) > 0)
+			ret = std::stoull(PQgetvalue(result,0,0));
+	} else {
+		Glib::ustring msg = _("Unable to fetch the change watermark from database!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(status,msg);
+	}
+	PQclear(result);
+	return ret;
+}
+
+void
+DatabasePostgresql::set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq)
+{
+	assert(m_db_);
+
+	const char *sql = "INSERT INTO change_watermark (name,seq) VALUES ($1,$2) ON CONFLICT (name) DO UPDATE SET seq=EXCLUDED.seq;";
+	std::string seq_str = std::to_string(seq);
+	const char *values[2];
+	values[0] = name.c_str();
+	values[1] = seq_str.c_str();
+
+	PGresult *result = _pq_exec_params(m_db_,sql,2,NULL,values,NULL,NULL,0);
+	if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+		Glib::ustring msg = _("Storing the change watermark failed!");
+		msg += "\n(";
+		msg += PQresultErrorMessage(result);
+		msg += ")";
+		PQclear(result);
+		throw DatabaseError(msg);
+	}
+	PQclear(result);
+}
+
 #endif /* HAVE_LIBPQ */
@@ -30,16 +30,101 @@
 #include <glibmm.h>
 #include <glibmm/i18n.h>
 #include <unistd.h>
-#include <fstream>
 #include <time.h>
 
+// pages copied by one sqlite3_backup_step(), 4 MB with the default page size
+#define SQLITE3_BACKUP_STEP_PAGES 1024
+
 #include "error.h"
-#include "application.h"
+#include "querystats.h"
+#include "trace.h"
 
 #ifdef NATIVE_WINDOWS
 # include "strptime.h"
 #endif
 
+static time_t
+_sqlite3_column_datetime(sqlite3_stmt *stmt, int column)
+{
+	if (sqlite3_column_type(stmt,column) == SQLITE_NULL)
+		return 0;
+
+	tm datetime;
+	const char *str = (const char*) sqlite3_column_text(stmt,column);
+	if (!str || !*str || !strptime(str,DATETIME_ISO_FORMAT,&datetime))
+		return 0;
+	datetime.tm_isdst = -1;
+	return mktime(&datetime);
+}
+
+static Glib::RefPtr<Strain>
+_sqlite3_strain(sqlite3_stmt *stmt, int column)
+{
+	uint64_t id = static_cast<uint64_t>(sqlite3_column_int64(stmt,column));
+	uint64_t breeder_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,column + 1));
+	Glib::ustring breeder_name = (const char*) sqlite3_column_text(stmt,column + 2);
+	Glib::ustring name = (const char*) sqlite3_column_text(stmt,column + 3);
+	const char *info = (const char*) sqlite3_column_text(stmt,column + 4);
+	const char *desc = (const char*) sqlite3_column_text(stmt,column + 5);
+	const char *homepage = (const char*) sqlite3_column_text(stmt,column + 6);
+	const char *seedfinder = (const char*) sqlite3_column_text(stmt,column + 7);
+
+	return Strain::create(id,
+	                      breeder_id,
+	                      breeder_name,
+	                      name,
+	                      (info ? info : ""),
+	                      (desc ? desc : ""),
+	                      (homepage ? homepage : ""),
+	                      (seedfinder ? seedfinder : ""));
+}
+
+static GrowlogStats
+_sqlite3_growlog_stats(sqlite3_stmt *stmt)
+{
+	GrowlogStats stats;
+	stats.growlog_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	stats.entry_count = static_cast<uint64_t>(sqlite3_column_int64(stmt,1));
+	stats.first_entry_on = _sqlite3_column_datetime(stmt,2);
+	stats.last_entry_on = _sqlite3_column_datetime(stmt,3);
+	stats.text_bytes = static_cast<uint64_t>(sqlite3_column_int64(stmt,4));
+	return stats;
+}
+
+static StrainStats
+_sqlite3_strain_stats(sqlite3_stmt *stmt)
+{
+	StrainStats stats;
+	stats.strain_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	stats.growlog_count = static_cast<uint64_t>(sqlite3_column_int64(stmt,1));
+	stats.veg_count = static_cast<uint64_t>(sqlite3_column_int64(stmt,2));
+	stats.veg_days = static_cast<uint64_t>(sqlite3_column_int64(stmt,3));
+	stats.flower_count = static_cast<uint64_t>(sqlite3_column_int64(stmt,4));
+	stats.flower_days = static_cast<uint64_t>(sqlite3_column_int64(stmt,5));
+	return stats;
+}
+
+static ChangeRecord
+_sqlite3_change_record(sqlite3_stmt *stmt)
+{
+	ChangeRecord record;
+	record.seq = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	record.table = (const char*) sqlite3_column_text(stmt,1);
+	record.row_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,2));
+	const char *op = (const char*) sqlite3_column_text(stmt,3);
+	if (op && *op == 'D')
+		record.type = CHANGE_DELETE;
+	else if (op && *op == 'R')
+		record.type = CHANGE_RENAME;
+	for (int i = 0; i < 3; ++i) {
+		const char *key = (const char*) sqlite3_column_text(stmt,4 + i);
+		const char *new_key = (const char*) sqlite3_column_text(stmt,7 + i);
+		record.key[i] = (key ? key : "");
+		record.new_key[i] = (new_key ? new_key : "");
+	}
+	return record;
+}
+
 /*******************************************************************************
  * DatabaseModuleSqlite3
  ******************************************************************************/
@@ -140,6 +225,116 @@ DatabaseSqlite3::connect_vfunc()
 		Glib::ustring msg=_("Unable to connect to database!");
 		throw DatabaseError(err,msg);
 	}
+	sqlite3_trace_v2(m_db_,
+	                 SQLITE_TRACE_PROFILE|SQLITE_TRACE_ROW,
+	                 &DatabaseSqlite3::_trace_callback,
+	                 this);
+	_upgrade_database();
+}
+
+void
+DatabaseSqlite3::_upgrade_database()
+{
+	// books written before the statistics and change tracking were added
+	// lack some of these tables, new files have none of them yet
+	const char *sql = "SELECT COUNT(*) FROM sqlite_master WHERE type='table' AND name IN "
+		"('growlog','growlog_stats','strain_stats','change_log','change_watermark');";
+	sqlite3_stmt *stmt = nullptr;
+	int n_tables = 0;
+
+	if (sqlite3_prepare(m_db_,sql,-1,&stmt,0) != SQLITE_OK)
+		return;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		n_tables = sqlite3_column_int(stmt,0);
+	sqlite3_finalize(stmt);
+	if (n_tables == 0 || n_tables == 5)
+		return;
+
+	// the schema only adds what is missing, the statistics are counted once
+	// and kept up to date by its triggers from now on. A book that can not
+	// be written stays as it is until 'growbook-cli rebuild-stats' is run.
+	try {
+		DatabaseSqlite3::create_database_vfunc();
+		DatabaseSqlite3::rebuild_stats_vfunc();
+	} catch (DatabaseError &ex) {
+		if (!sqlite3_get_autocommit(m_db_))
+			sqlite3_exec(m_db_,"ROLLBACK;",0,0,nullptr);
+	}
+}
+
+// Rows and bytes of the statements the calling thread is stepping, taken
+// out again when the statement is profiled. Only a few statements are open
+// at the same time, so a linear scan beats any map.
+#define SQLITE3_TRACE_STATEMENTS 8
+
+struct Sqlite3TraceRows {
+	sqlite3_stmt *stmt;
+	uint64_t rows;
+	uint64_t bytes;
+};
+
+static thread_local Sqlite3TraceRows _trace_rows[SQLITE3_TRACE_STATEMENTS];
+static thread_local unsigned int _trace_n_rows = 0;
+
+static inline Sqlite3TraceRows*
+_trace_find_rows(sqlite3_stmt *stmt)
+{
+	for (unsigned int i = 0; i < _trace_n_rows; ++i) {
+		if (_trace_rows[i].stmt == stmt)
+			return &_trace_rows[i];
+	}
+	return nullptr;
+}
+
+int
+DatabaseSqlite3::_trace_callback(unsigned int type, void *data, void *p, void *x)
+{
+	sqlite3_stmt *stmt = static_cast<sqlite3_stmt*>(p);
+
+	if (type == SQLITE_TRACE_ROW) {
+		if (!query_stats_get_enabled())
+			return 0;
+
+		Sqlite3TraceRows *rows = _trace_find_rows(stmt);
+		if (!rows) {
+			// a statement that was never profiled gives its slot away
+			if (_trace_n_rows < SQLITE3_TRACE_STATEMENTS)
+				++_trace_n_rows;
+			rows = &_trace_rows[_trace_n_rows - 1];
+			rows->stmt = stmt;
+			rows->rows = 0;
+			rows->bytes = 0;
+		}
+		++rows->rows;
+		int n_columns = sqlite3_column_count(stmt);
+		for (int i = 0; i < n_columns; ++i) {
+			switch (sqlite3_column_type(stmt,i)) {
+				case SQLITE_TEXT:
+				case SQLITE_BLOB:
+					rows->bytes += sqlite3_column_bytes(stmt,i);
+					break;
+				case SQLITE_NULL:
+					break;
+				default:
+					rows->bytes += 8;
+					break;
+			}
+		}
+	} else if (type == SQLITE_TRACE_PROFILE) {
+		uint64_t ns = static_cast<uint64_t>(*static_cast<sqlite3_int64*>(x));
+		uint64_t n_rows = 0, n_bytes = 0;
+
+		Sqlite3TraceRows *rows = _trace_find_rows(stmt);
+		if (rows) {
+			n_rows = rows->rows;
+			n_bytes = rows->bytes;
+			*rows = _trace_rows[--_trace_n_rows];
+		}
+		const char *sql = sqlite3_sql(stmt);
+		if (sql && query_stats_get_enabled())
+			query_stats_lookup_sql("sqlite3",sql)->record(ns,n_rows,n_bytes);
+	}
+	return 0;
 }
 
 void
@@ -154,34 +349,20 @@ DatabaseSqlite3::close_vfunc()
 void
 DatabaseSqlite3::create_database_vfunc()
 {
-	std::string sql_file = Glib::build_filename(app->get_settings()->get_sql_dir(),
+	std::string sql_file = Glib::build_filename(db_get_sql_dir(),
 	                                            "growbook.sqlite3.sql");
-	std::fstream file;
-	
-	file.open(sql_file,std::ios::in);
-	std::string text,sql;
-
 	char *errmsg;
 	int err;
 	
-	while (std::getline(file,text)) {
-		if (text.empty())
-			continue;
-		if (!sql.empty())
-			sql+="\n";
-		sql+=text;
-
-		if (sql[sql.size() - 1] == ';') {
-			err = sqlite3_exec(m_db_,sql.c_str(),0,0,&errmsg);
-			if (err != SQLITE_OK) {
-				Glib::ustring msg = _("Unable to create GrowBook sqlite3-database!");
-				msg += "\n(";
-				msg += errmsg;
-				msg += ")";
-				sqlite3_free(errmsg);
-				throw DatabaseError(err,msg);
-			}
-			sql = "";
+	for (auto sql: db_read_sql_file(sql_file)) {
+		err = sqlite3_exec(m_db_,sql.c_str(),0,0,&errmsg);
+		if (err != SQLITE_OK) {
+			Glib::ustring msg = _("Unable to create GrowBook sqlite3-database!");
+			msg += "\n(";
+			msg += errmsg;
+			msg += ")";
+			sqlite3_free(errmsg);
+			throw DatabaseError(err,msg);
 		}
 	}
 }
@@ -203,6 +384,185 @@ DatabaseSqlite3::begin_transaction()
 	}
 }
 
+void
+DatabaseSqlite3::set_synchronous(bool synchronous)
+{
+	assert(m_db_);
+	
+	const char *sql = (synchronous ? "PRAGMA synchronous=FULL;" : "PRAGMA synchronous=OFF;");
+	char *errmsg;
+	int err = sqlite3_exec(m_db_,sql,0,0,&errmsg);
+
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to set synchronous mode!");
+		msg += "\n(";
+		msg += errmsg;
+		msg += ")";
+		sqlite3_free(errmsg);
+		throw DatabaseError(err,msg);
+	}
+}
+
+void
+DatabaseSqlite3::backup(const std::string &filename,
+                        const sigc::slot<void,uint64_t,uint64_t> &progress)
+{
+	TRACE_SCOPE("database","DatabaseSqlite3::backup");
+
+	Glib::RefPtr<DatabaseSqlite3Backup> backup = begin_backup(filename);
+	bool done;
+	do {
+		uint64_t remaining = backup->get_remaining();
+		done = backup->step(SQLITE3_BACKUP_STEP_PAGES);
+		if (!done && remaining == backup->get_remaining())
+			sqlite3_sleep(50);
+		if (!progress.empty())
+			progress(backup->get_page_count() - backup->get_remaining(),backup->get_page_count());
+	} while (!done);
+}
+
+Glib::RefPtr<DatabaseSqlite3Backup>
+DatabaseSqlite3::begin_backup(const std::string &filename)
+{
+	assert(m_db_);
+	return Glib::RefPtr<DatabaseSqlite3Backup>(new DatabaseSqlite3Backup(m_db_,filename));
+}
+
+void
+DatabaseSqlite3::merge_database(const std::string &filename,
+                                const std::set<Glib::ustring> &update_breeders,
+                                const std::map<uint64_t,Glib::ustring> &growlogs)
+{
+	assert(m_db_);
+	TRACE_SCOPE("database","DatabaseSqlite3::merge_database");
+
+	// ATTACH is not allowed inside a transaction
+	const char *sql = "ATTACH DATABASE ? AS merge_source;";
+	sqlite3_stmt *stmt = nullptr;
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err == SQLITE_OK) {
+		sqlite3_bind_text(stmt,1,filename.c_str(),-1,SQLITE_TRANSIENT);
+		err = sqlite3_step(stmt);
+	}
+	if ((err != SQLITE_OK) && (err != SQLITE_DONE)) {
+		Glib::ustring msg = _("Unable to attach the database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_finalize(stmt);
+
+	try {
+		_merge_attached(update_breeders,growlogs);
+	} catch (DatabaseError &ex) {
+		sqlite3_exec(m_db_,"DETACH DATABASE merge_source;",0,0,0);
+		throw;
+	}
+	sqlite3_exec(m_db_,"DETACH DATABASE merge_source;",0,0,0);
+}
+
+// The rows are matched by their names in temp mapping tables, the ids of
+// both books are unrelated.
+void
+DatabaseSqlite3::_merge_attached(const std::set<Glib::ustring> &update_breeders,
+                                 const std::map<uint64_t,Glib::ustring> &growlogs)
+{
+	const char *create_sql =
+		"CREATE TEMP TABLE merge_breeder_update (name TEXT PRIMARY KEY);"
+		"CREATE TEMP TABLE merge_growlog (import_id INTEGER PRIMARY KEY, title TEXT NOT NULL);"
+		"CREATE TEMP TABLE merge_breeder_map (import_id INTEGER PRIMARY KEY, id INTEGER NOT NULL);"
+		"CREATE TEMP TABLE merge_strain_map (import_id INTEGER PRIMARY KEY, id INTEGER NOT NULL);"
+		"CREATE INDEX temp.idx_merge_strain_map_id ON merge_strain_map (id);"
+		"CREATE TEMP TABLE merge_growlog_map (import_id INTEGER PRIMARY KEY, id INTEGER NOT NULL);";
+
+	const char *merge_sql =
+		// breeders and strains
+		"INSERT INTO main.breeder (name,homepage) "
+		"SELECT name,homepage FROM merge_source.breeder "
+		"WHERE name NOT IN (SELECT name FROM main.breeder) ORDER BY id;"
+		"UPDATE main.breeder SET homepage=(SELECT s.homepage FROM merge_source.breeder AS s WHERE s.name=main.breeder.name) "
+		"WHERE name IN (SELECT name FROM temp.merge_breeder_update);"
+		"INSERT INTO temp.merge_breeder_map (import_id,id) "
+		"SELECT s.id,b.id FROM merge_source.breeder AS s JOIN main.breeder AS b ON b.name=s.name;"
+		"INSERT INTO main.strain (breeder,name,info,description,homepage,seedfinder) "
+		"SELECT m.id,s.name,s.info,s.description,s.homepage,s.seedfinder "
+		"FROM merge_source.strain AS s JOIN temp.merge_breeder_map AS m ON m.import_id=s.breeder "
+		"WHERE NOT EXISTS (SELECT 1 FROM main.strain AS t WHERE t.breeder=m.id AND t.name=s.name) ORDER BY s.id;"
+		"INSERT INTO temp.merge_strain_map (import_id,id) "
+		"SELECT s.id,t.id FROM merge_source.strain AS s JOIN temp.merge_breeder_map AS m ON m.import_id=s.breeder "
+		"JOIN main.strain AS t ON t.breeder=m.id AND t.name=s.name;"
+		"UPDATE main.strain SET "
+		"info=(SELECT s.info FROM temp.merge_strain_map AS m JOIN merge_source.strain AS s ON s.id=m.import_id WHERE m.id=main.strain.id),"
+		"description=(SELECT s.description FROM temp.merge_strain_map AS m JOIN merge_source.strain AS s ON s.id=m.import_id WHERE m.id=main.strain.id),"
+		"homepage=(SELECT s.homepage FROM temp.merge_strain_map AS m JOIN merge_source.strain AS s ON s.id=m.import_id WHERE m.id=main.strain.id),"
+		"seedfinder=(SELECT s.seedfinder FROM temp.merge_strain_map AS m JOIN merge_source.strain AS s ON s.id=m.import_id WHERE m.id=main.strain.id) "
+		"WHERE id IN (SELECT id FROM temp.merge_strain_map) "
+		"AND breeder IN (SELECT b.id FROM main.breeder AS b JOIN temp.merge_breeder_update AS u ON u.name=b.name);"
+		// growlogs with their entries and strains
+		"INSERT INTO main.growlog (title,description,created_on,flower_on,finished_on) "
+		"SELECT m.title,g.description,g.created_on,g.flower_on,g.finished_on "
+		"FROM merge_source.growlog AS g JOIN temp.merge_growlog AS m ON m.import_id=g.id ORDER BY g.id;"
+		"INSERT INTO temp.merge_growlog_map (import_id,id) "
+		"SELECT m.import_id,g.id FROM temp.merge_growlog AS m JOIN main.growlog AS g ON g.title=m.title;"
+		"INSERT INTO main.growlog_entry (growlog,entry,created_on) "
+		"SELECT m.id,e.entry,e.created_on FROM merge_source.growlog_entry AS e "
+		"JOIN temp.merge_growlog_map AS m ON m.import_id=e.growlog;"
+		"INSERT OR IGNORE INTO main.growlog_strain (growlog,strain) "
+		"SELECT gm.id,sm.id FROM merge_source.growlog_strain AS gs "
+		"JOIN temp.merge_growlog_map AS gm ON gm.import_id=gs.growlog "
+		"JOIN temp.merge_strain_map AS sm ON sm.import_id=gs.strain;"
+		"DROP TABLE temp.merge_breeder_update;"
+		"DROP TABLE temp.merge_growlog;"
+		"DROP TABLE temp.merge_breeder_map;"
+		"DROP TABLE temp.merge_strain_map;"
+		"DROP TABLE temp.merge_growlog_map;";
+
+	char *errmsg = nullptr;
+	sqlite3_stmt *stmt = nullptr;
+
+	begin_transaction();
+	int err = sqlite3_exec(m_db_,create_sql,0,0,&errmsg);
+	if (err == SQLITE_OK) {
+		err = sqlite3_prepare(m_db_,"INSERT INTO temp.merge_breeder_update (name) VALUES (?);",-1,&stmt,0);
+		for (auto iter = update_breeders.begin(); err == SQLITE_OK && iter != update_breeders.end(); ++iter) {
+			sqlite3_bind_text(stmt,1,iter->c_str(),-1,SQLITE_STATIC);
+			err = sqlite3_step(stmt);
+			if (err == SQLITE_DONE)
+				err = SQLITE_OK;
+			sqlite3_reset(stmt);
+		}
+		sqlite3_finalize(stmt);
+	}
+	if (err == SQLITE_OK) {
+		err = sqlite3_prepare(m_db_,"INSERT INTO temp.merge_growlog (import_id,title) VALUES (?,?);",-1,&stmt,0);
+		for (auto iter = growlogs.begin(); err == SQLITE_OK && iter != growlogs.end(); ++iter) {
+			sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(iter->first));
+			sqlite3_bind_text(stmt,2,iter->second.c_str(),-1,SQLITE_STATIC);
+			err = sqlite3_step(stmt);
+			if (err == SQLITE_DONE)
+				err = SQLITE_OK;
+			sqlite3_reset(stmt);
+		}
+		sqlite3_finalize(stmt);
+	}
+	if (err == SQLITE_OK)
+		err = sqlite3_exec(m_db_,merge_sql,0,0,&errmsg);
+
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Merging the database failed!");
+		msg += "\n(";
+		msg += (errmsg ? errmsg : sqlite3_errmsg(m_db_));
+		msg += ")";
+		sqlite3_free(errmsg);
+		rollback();
+		throw DatabaseError(err,msg);
+	}
+	commit();
+}
+
 void
 DatabaseSqlite3::rollback()
 {
@@ -237,6 +597,12 @@ DatabaseSqlite3::commit()
 	}
 }
 
+sqlite3*
+DatabaseSqlite3::get_handle() const
+{
+	return m_db_;
+}
+
 /**** Breeder methods *********************************************************/
 
 std::list<Glib::RefPtr<Breeder> >
@@ -495,7 +861,7 @@ DatabaseSqlite3::get_strains_for_growlog_vfunc(uint64_t growlog_id) const
 {
 	assert(m_db_);
 	
-	const char *sql = "SELECT strain FROM growlog_strain WHERE growlog=?;";
+	const char *sql = "SELECT strain FROM growlog_strain WHERE growlog=? ORDER BY strain;";
 	sqlite3_stmt *stmt = nullptr;
 	std::list<Glib::RefPtr<Strain> > ret;
 	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
@@ -714,6 +1080,58 @@ DatabaseSqlite3::remove_strain_vfunc (uint64_t id)
 	commit();
 }
 
+std::list<Glib::RefPtr<Strain> >
+DatabaseSqlite3::get_strains_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT id,breeder_id,breeder_name,name,info,description,homepage,seedfinder FROM strain_view ORDER BY breeder_name,name;";
+	sqlite3_stmt *stmt = nullptr;
+	std::list<Glib::RefPtr<Strain> > ret;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to lookup strains from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	while (sqlite3_step(stmt) == SQLITE_ROW)
+		ret.push_back(_sqlite3_strain(stmt,0));
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+std::map<uint64_t,std::list<Glib::RefPtr<Strain> > >
+DatabaseSqlite3::get_strains_for_growlogs_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT gs.growlog,s.id,s.breeder_id,s.breeder_name,s.name,s.info,s.description,s.homepage,s.seedfinder FROM growlog_strain AS gs JOIN strain_view AS s ON s.id=gs.strain ORDER BY gs.growlog,gs.strain;";
+	sqlite3_stmt *stmt = nullptr;
+	std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > ret;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to lookup strains for growlog!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		uint64_t growlog_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+		ret[growlog_id].push_back(_sqlite3_strain(stmt,1));
+	}
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
 /**** Growlog methods *********************************************************/
 
 std::list<Glib::RefPtr<Growlog> > 
@@ -743,6 +1161,7 @@ DatabaseSqlite3::get_growlogs_vfunc() const
 		Glib::ustring description = (const char*) sqlite3_column_text(stmt,2);
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,3);
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 		time_t flower_on = 0;
 		time_t finished_on = 0;
@@ -751,6 +1170,7 @@ DatabaseSqlite3::get_growlogs_vfunc() const
 			Glib::ustring flower_on_str = (const char*) sqlite3_column_text(stmt,4);
 			if (!flower_on_str.empty()) {
 				strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				flower_on = mktime(&datetime);
 			}
 		}
@@ -759,6 +1179,7 @@ DatabaseSqlite3::get_growlogs_vfunc() const
 			Glib::ustring finished_on_str = (const char*) sqlite3_column_text(stmt,5);
 			if (!finished_on_str.empty()) {
 				strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				finished_on = mktime(&datetime);
 			}
 		}
@@ -797,6 +1218,7 @@ DatabaseSqlite3::get_ongoing_growlogs_vfunc() const
 		Glib::ustring description = (const char*) sqlite3_column_text(stmt,2);
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,3);
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 		time_t flower_on = 0;
 		time_t finished_on = 0;
@@ -805,6 +1227,7 @@ DatabaseSqlite3::get_ongoing_growlogs_vfunc() const
 			Glib::ustring flower_on_str = (const char*) sqlite3_column_text(stmt,4);
 			if (!flower_on_str.empty()) {
 				strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				flower_on = mktime(&datetime);
 			}
 		}
@@ -813,6 +1236,7 @@ DatabaseSqlite3::get_ongoing_growlogs_vfunc() const
 			Glib::ustring finished_on_str = (const char*) sqlite3_column_text(stmt,5);
 			if (!finished_on_str.empty()) {
 				strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				finished_on = mktime(&datetime);
 			}
 		}
@@ -851,6 +1275,7 @@ DatabaseSqlite3::get_finished_growlogs_vfunc() const
 		Glib::ustring description = (const char*) sqlite3_column_text(stmt,2);
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,3);
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 		time_t flower_on = 0;
 		time_t finished_on = 0;
@@ -859,6 +1284,7 @@ DatabaseSqlite3::get_finished_growlogs_vfunc() const
 			Glib::ustring flower_on_str = (const char*) sqlite3_column_text(stmt,4);
 			if (!flower_on_str.empty()) {
 				strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				flower_on = mktime(&datetime);
 			}
 		}
@@ -867,6 +1293,7 @@ DatabaseSqlite3::get_finished_growlogs_vfunc() const
 			Glib::ustring finished_on_str = (const char*) sqlite3_column_text(stmt,5);
 			if (!finished_on_str.empty()) {
 				strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				finished_on = mktime(&datetime);
 			}
 		}
@@ -921,6 +1348,7 @@ DatabaseSqlite3::get_growlogs_for_strain_vfunc(uint64_t strain_id) const
 			Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt1,2);
 			tm datetime;
 			strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
 			time_t created_on = mktime(&datetime);
 			time_t flower_on = 0;
 			time_t finished_on = 0;
@@ -929,6 +1357,7 @@ DatabaseSqlite3::get_growlogs_for_strain_vfunc(uint64_t strain_id) const
 				Glib::ustring flower_on_str = (const char*) sqlite3_column_text(stmt1,3);
 				if (!flower_on_str.empty()) {
 					strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					flower_on = mktime(&datetime);
 				}
 			}
@@ -937,6 +1366,7 @@ DatabaseSqlite3::get_growlogs_for_strain_vfunc(uint64_t strain_id) const
 				Glib::ustring finished_on_str = (const char*) sqlite3_column_text(stmt1,4);
 				if (!finished_on_str.empty()) {
 					strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+					datetime.tm_isdst = -1;
 					finished_on = mktime(&datetime);
 				}
 			}
@@ -982,6 +1412,7 @@ DatabaseSqlite3::get_growlog_vfunc(uint64_t id) const
 		Glib::ustring desc = (const char*) sqlite3_column_text(stmt,1);
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,2);
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 		time_t flower_on = 0;
 		time_t finished_on = 0;
@@ -989,6 +1420,7 @@ DatabaseSqlite3::get_growlog_vfunc(uint64_t id) const
 			Glib::ustring flower_on_str = (const char*) sqlite3_column_text(stmt,3);
 			if (!flower_on_str.empty()) {
 				strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				flower_on = mktime(&datetime);
 			}
 		}
@@ -996,6 +1428,7 @@ DatabaseSqlite3::get_growlog_vfunc(uint64_t id) const
 			Glib::ustring finished_on_str = (const char*) sqlite3_column_text(stmt,4);
 			if (!finished_on_str.empty()) {
 				strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				finished_on = mktime(&datetime);
 			}
 		}
@@ -1033,6 +1466,7 @@ DatabaseSqlite3::get_growlog_vfunc(const Glib::ustring &title) const
 		Glib::ustring desc = (const char*) sqlite3_column_text(stmt,1);
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,2);
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 		time_t flower_on = 0;
 		time_t finished_on = 0;
@@ -1040,6 +1474,7 @@ DatabaseSqlite3::get_growlog_vfunc(const Glib::ustring &title) const
 			Glib::ustring flower_on_str = (const char*) sqlite3_column_text(stmt,3);
 			if (!flower_on_str.empty()) {
 				strptime(flower_on_str.c_str(),DATE_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				flower_on = mktime(&datetime);
 			}
 		}
@@ -1047,6 +1482,7 @@ DatabaseSqlite3::get_growlog_vfunc(const Glib::ustring &title) const
 			Glib::ustring finished_on_str = (const char*) sqlite3_column_text(stmt,4);
 			if (!finished_on_str.empty()) {
 				strptime(finished_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+				datetime.tm_isdst = -1;
 				finished_on = mktime(&datetime);
 			}
 		}
@@ -1202,7 +1638,47 @@ DatabaseSqlite3::get_growlog_entries_vfunc(uint64_t growlog_id) const
 {
 	assert(m_db_);
 
-	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=? ORDER BY created_on;";
+	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=? ORDER BY created_on,id;";
+	sqlite3_stmt *stmt = nullptr;
+	std::list<Glib::RefPtr<GrowlogEntry> > ret;
+	
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch growlog-entries from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(growlog_id));
+
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		uint64_t id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+		Glib::ustring text = (const char*) sqlite3_column_text(stmt,1);
+		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,2);
+		tm datetime;
+		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
+		time_t created_on = mktime(&datetime);
+
+		Glib::RefPtr<GrowlogEntry> entry = GrowlogEntry::create(id,growlog_id,text,created_on);
+		if (entry)
+			ret.push_back(entry);
+	}
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+std::list<Glib::RefPtr<GrowlogEntry> >
+DatabaseSqlite3::get_growlog_entries_vfunc(uint64_t growlog_id,
+                                           uint64_t offset,
+                                           uint64_t limit) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT id,entry,created_on FROM growlog_entry WHERE growlog=? ORDER BY created_on,id LIMIT ? OFFSET ?;";
 	sqlite3_stmt *stmt = nullptr;
 	std::list<Glib::RefPtr<GrowlogEntry> > ret;
 	
@@ -1217,6 +1693,8 @@ DatabaseSqlite3::get_growlog_entries_vfunc(uint64_t growlog_id) const
 		throw DatabaseError(err,msg);
 	}
 	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(growlog_id));
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(limit));
+	sqlite3_bind_int64(stmt,3,static_cast<sqlite3_int64>(offset));
 
 	while (sqlite3_step(stmt) == SQLITE_ROW) {
 		uint64_t id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
@@ -1224,6 +1702,7 @@ DatabaseSqlite3::get_growlog_entries_vfunc(uint64_t growlog_id) const
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,2);
 		tm datetime;
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 
 		Glib::RefPtr<GrowlogEntry> entry = GrowlogEntry::create(id,growlog_id,text,created_on);
@@ -1234,6 +1713,32 @@ DatabaseSqlite3::get_growlog_entries_vfunc(uint64_t growlog_id) const
 	return ret;
 }
 
+uint64_t
+DatabaseSqlite3::get_growlog_entry_count_vfunc(uint64_t growlog_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT COUNT(*) FROM growlog_entry WHERE growlog=?;";
+	sqlite3_stmt *stmt = nullptr;
+	uint64_t ret = 0;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to count growlog-entries!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(growlog_id));
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		ret = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
 Glib::RefPtr<GrowlogEntry>
 DatabaseSqlite3::get_growlog_entry_vfunc(uint64_t id) const
 {
@@ -1260,6 +1765,7 @@ DatabaseSqlite3::get_growlog_entry_vfunc(uint64_t id) const
 		Glib::ustring created_on_str = (const char*) sqlite3_column_text(stmt,2);
 		tm datetime;
 		strptime(created_on_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		datetime.tm_isdst = -1;
 		time_t created_on = mktime(&datetime);
 		ret = GrowlogEntry::create(id,growlog_id,text,created_on);
 	}
@@ -1376,6 +1882,93 @@ DatabaseSqlite3::remove_growlog_entry_vfunc(uint64_t id)
 	commit();
 }
 
+void
+DatabaseSqlite3::foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const
+{
+	assert(m_db_);
+
+	// walks idx_growlog_title and idx_growlog_entry_created_on, no sorting
+	const char *sql = "SELECT e.id,e.growlog,e.entry,e.created_on FROM growlog AS g JOIN growlog_entry AS e ON e.growlog=g.id ORDER BY g.title,e.created_on,e.id;";
+	sqlite3_stmt *stmt = nullptr;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch growlog-entries from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+
+	try {
+		while (sqlite3_step(stmt) == SQLITE_ROW) {
+			uint64_t id = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+			uint64_t growlog_id = static_cast<uint64_t>(sqlite3_column_int64(stmt,1));
+			Glib::ustring text = (const char*) sqlite3_column_text(stmt,2);
+			tm datetime;
+			strptime((const char*) sqlite3_column_text(stmt,3),DATETIME_ISO_FORMAT,&datetime);
+			datetime.tm_isdst = -1;
+			time_t created_on = mktime(&datetime);
+
+			slot(GrowlogEntry::create(id,growlog_id,text,created_on));
+		}
+	} catch (...) {
+		sqlite3_finalize(stmt);
+		throw;
+	}
+	sqlite3_finalize(stmt);
+}
+
+void
+DatabaseSqlite3::add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows)
+{
+	assert(m_db_);
+
+	// One transaction and one prepared statement for all rows. The texts
+	// are bound without copying them.
+	const char *sql = "INSERT INTO growlog_entry (growlog,entry,created_on) VALUES (?,?,?);";
+	sqlite3_stmt *stmt = nullptr;
+
+	begin_transaction();
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to insert growlog-entry into database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		rollback();
+		throw DatabaseError(err,msg);
+	}
+
+	char created_on[32];
+	for (const GrowlogEntryRow &row: rows) {
+		size_t created_on_len = db_format_datetime(row.created_on,created_on,sizeof(created_on));
+
+		sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(row.growlog_id));
+		sqlite3_bind_text(stmt,2,row.text,static_cast<int>(row.text_size),SQLITE_STATIC);
+		sqlite3_bind_text(stmt,3,created_on,static_cast<int>(created_on_len),SQLITE_STATIC);
+
+		err = sqlite3_step(stmt);
+		if ((err != SQLITE_OK) && (err != SQLITE_DONE)) {
+			Glib::ustring msg = _("Inserting growlog-entry failed!");
+			msg += "\n(";
+			msg += sqlite3_errmsg(m_db_);
+			msg += ")";
+			sqlite3_finalize(stmt);
+			rollback();
+			throw DatabaseError(err,msg);
+		}
+		sqlite3_reset(stmt);
+	}
+	sqlite3_finalize(stmt);
+	commit();
+}
+
 /**** growlog_strain methods **************************************************/
 
 void
@@ -1495,3 +2088,343 @@ DatabaseSqlite3::remove_strain_for_growlog_vfunc(uint64_t growlog_strain_id)
 	sqlite3_finalize(stmt);
 	commit();
 }
+
+/**** Statistics methods ******************************************************/
+
+GrowlogStats
+DatabaseSqlite3::get_growlog_stats_vfunc(uint64_t growlog_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT growlog,entry_count,first_entry_on,last_entry_on,text_bytes FROM growlog_stats WHERE growlog=?;";
+	sqlite3_stmt *stmt = nullptr;
+	GrowlogStats ret;
+	ret.growlog_id = growlog_id;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch growlog statistics from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(growlog_id));
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		ret = _sqlite3_growlog_stats(stmt);
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+std::list<GrowlogStats>
+DatabaseSqlite3::get_growlog_stats_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT growlog,entry_count,first_entry_on,last_entry_on,text_bytes FROM growlog_stats;";
+	sqlite3_stmt *stmt = nullptr;
+	std::list<GrowlogStats> ret;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch growlog statistics from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	while (sqlite3_step(stmt) == SQLITE_ROW)
+		ret.push_back(_sqlite3_growlog_stats(stmt));
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+StrainStats
+DatabaseSqlite3::get_strain_stats_vfunc(uint64_t strain_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT strain,growlog_count,veg_count,veg_days,flower_count,flower_days FROM strain_stats WHERE strain=?;";
+	sqlite3_stmt *stmt = nullptr;
+	StrainStats ret;
+	ret.strain_id = strain_id;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch strain statistics from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(strain_id));
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		ret = _sqlite3_strain_stats(stmt);
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+std::list<StrainStats>
+DatabaseSqlite3::get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT st.strain,st.growlog_count,st.veg_count,st.veg_days,st.flower_count,st.flower_days FROM strain_stats AS st JOIN strain AS s ON s.id=st.strain WHERE s.breeder=?;";
+	sqlite3_stmt *stmt = nullptr;
+	std::list<StrainStats> ret;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch strain statistics from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(breeder_id));
+	while (sqlite3_step(stmt) == SQLITE_ROW)
+		ret.push_back(_sqlite3_strain_stats(stmt));
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+void
+DatabaseSqlite3::rebuild_stats_vfunc()
+{
+	assert(m_db_);
+
+	const char *sql =
+		"DELETE FROM growlog_stats;"
+		"INSERT INTO growlog_stats (growlog,entry_count,first_entry_on,last_entry_on,text_bytes) "
+		"SELECT g.id,COUNT(e.id),MIN(e.created_on),MAX(e.created_on),IFNULL(SUM(length(CAST(e.entry AS BLOB))),0) "
+		"FROM growlog AS g LEFT JOIN growlog_entry AS e ON e.growlog=g.id GROUP BY g.id;"
+		"DELETE FROM strain_stats;"
+		"INSERT INTO strain_stats (strain,growlog_count,veg_count,veg_days,flower_count,flower_days) "
+		"SELECT s.id,COUNT(g.id),COUNT(g.flower_on),"
+		"IFNULL(SUM(julianday(date(g.flower_on))-julianday(date(g.created_on))),0),"
+		"COUNT(CASE WHEN g.flower_on IS NOT NULL AND g.finished_on IS NOT NULL THEN 1 END),"
+		"IFNULL(SUM(julianday(date(g.finished_on))-julianday(date(g.flower_on))),0) "
+		"FROM strain AS s LEFT JOIN growlog_strain AS gs ON gs.strain=s.id "
+		"LEFT JOIN growlog AS g ON g.id=gs.growlog GROUP BY s.id;";
+	char *errmsg;
+
+	begin_transaction();
+	int err = sqlite3_exec(m_db_,sql,0,0,&errmsg);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Rebuilding statistics failed!");
+		msg += "\n(";
+		msg += errmsg;
+		msg += ")";
+		sqlite3_free(errmsg);
+		rollback();
+		throw DatabaseError(err,msg);
+	}
+	commit();
+}
+
+/**** Change tracking methods *************************************************/
+
+uint64_t
+DatabaseSqlite3::get_change_seq_vfunc() const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT MAX(seq) FROM change_log;";
+	sqlite3_stmt *stmt = nullptr;
+	uint64_t ret = 0;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch the change sequence from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		ret = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+void
+DatabaseSqlite3::foreach_change_vfunc(uint64_t after,
+                                      uint64_t upto,
+                                      const sigc::slot<void,const ChangeRecord&> &slot) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT seq,table_name,row_id,op,key1,key2,key3,new_key1,new_key2,new_key3 FROM change_log WHERE seq>? AND seq<=? ORDER BY seq;";
+	sqlite3_stmt *stmt = nullptr;
+	std::list<ChangeRecord> records;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch changes from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_int64(stmt,1,static_cast<sqlite3_int64>(after));
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(upto));
+	while (sqlite3_step(stmt) == SQLITE_ROW)
+		records.push_back(_sqlite3_change_record(stmt));
+	sqlite3_finalize(stmt);
+
+	for (auto &record: records)
+		slot(record);
+}
+
+uint64_t
+DatabaseSqlite3::get_change_watermark_vfunc(const Glib::ustring &name) const
+{
+	assert(m_db_);
+
+	const char *sql = "SELECT seq FROM change_watermark WHERE name=?;";
+	sqlite3_stmt *stmt = nullptr;
+	uint64_t ret = 0;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to fetch the change watermark from database!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_text(stmt,1,name.c_str(),-1,0);
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		ret = static_cast<uint64_t>(sqlite3_column_int64(stmt,0));
+	sqlite3_finalize(stmt);
+	return ret;
+}
+
+void
+DatabaseSqlite3::set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq)
+{
+	assert(m_db_);
+
+	const char *sql = "INSERT OR REPLACE INTO change_watermark (name,seq) VALUES (?,?);";
+	sqlite3_stmt *stmt = nullptr;
+
+	int err = sqlite3_prepare(m_db_,sql,-1,&stmt,0);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to store the change watermark!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		if (stmt)
+			sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_bind_text(stmt,1,name.c_str(),-1,0);
+	sqlite3_bind_int64(stmt,2,static_cast<sqlite3_int64>(seq));
+
+	err = sqlite3_step(stmt);
+	if (err != SQLITE_OK && err != SQLITE_DONE) {
+		Glib::ustring msg = _("Storing the change watermark failed!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_db_);
+		msg += ")";
+		sqlite3_finalize(stmt);
+		throw DatabaseError(err,msg);
+	}
+	sqlite3_finalize(stmt);
+}
+
+/*******************************************************************************
+ * DatabaseSqlite3Backup
+ ******************************************************************************/
+
+DatabaseSqlite3Backup::DatabaseSqlite3Backup(sqlite3 *source, const std::string &filename):
+	RefClass{},
+	m_dest_{nullptr},
+	m_backup_{nullptr},
+	m_done_{false}
+{
+	int err = sqlite3_open(filename.c_str(),&m_dest_);
+	if (err != SQLITE_OK) {
+		Glib::ustring msg = _("Unable to open the backup file!");
+		msg += "\n(";
+		msg += (m_dest_ ? sqlite3_errmsg(m_dest_) : sqlite3_errstr(err));
+		msg += ")";
+		sqlite3_close(m_dest_);
+		throw DatabaseError(err,msg);
+	}
+
+	m_backup_ = sqlite3_backup_init(m_dest_,"main",source,"main");
+	if (!m_backup_) {
+		Glib::ustring msg = _("Unable to start the backup!");
+		msg += "\n(";
+		msg += sqlite3_errmsg(m_dest_);
+		msg += ")";
+		err = sqlite3_errcode(m_dest_);
+		sqlite3_close(m_dest_);
+		throw DatabaseError(err,msg);
+	}
+}
+
+DatabaseSqlite3Backup::~DatabaseSqlite3Backup()
+{
+	if (m_backup_)
+		sqlite3_backup_finish(m_backup_);
+	sqlite3_close(m_dest_);
+}
+
+bool
+DatabaseSqlite3Backup::step(int pages)
+{
+	if (m_done_)
+		return true;
+
+	int err = sqlite3_backup_step(m_backup_,pages);
+	if (err == SQLITE_OK || err == SQLITE_BUSY || err == SQLITE_LOCKED)
+		return false;
+
+	// the page counts are kept for get_remaining()
+	if (err == SQLITE_DONE) {
+		m_done_ = true;
+		return true;
+	}
+
+	sqlite3_backup_finish(m_backup_);
+	m_backup_ = nullptr;
+	Glib::ustring msg = _("Backup of the database failed!");
+	msg += "\n(";
+	msg += sqlite3_errmsg(m_dest_);
+	msg += ")";
+	throw DatabaseError(err,msg);
+}
+
+bool
+DatabaseSqlite3Backup::is_done() const
+{
+	return m_done_;
+}
+
+uint64_t
+DatabaseSqlite3Backup::get_page_count() const
+{
+	return (m_backup_ ? static_cast<uint64_t>(sqlite3_backup_pagecount(m_backup_)) : 0);
+}
+
+uint64_t
+DatabaseSqlite3Backup::get_remaining() const
+{
+	return (m_backup_ ? static_cast<uint64_t>(sqlite3_backup_remaining(m_backup_)) : 0);
+}
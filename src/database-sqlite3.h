@@ -29,6 +29,10 @@
 
 #include "database.h"
 #include <sqlite3.h>
+#include <set>
+
+class DatabaseSqlite3Backup;
+
 /*******************************************************************************
  * DatabaseModuleSqlite3
  ******************************************************************************/
@@ -77,11 +81,43 @@ class DatabaseSqlite3:
 
 	public:
 		static Glib::RefPtr<DatabaseSqlite3> create(const Glib::RefPtr<DatabaseSettings> &settings);
+
+		// Switches PRAGMA synchronous between FULL and OFF. Only meant for
+		// tools filling scratch databases, a crash leaves the file corrupted
+		// while synchronous is off.
+		void set_synchronous(bool synchronous);
+
+		// Copies the database file to filename with the online backup API,
+		// a few MB at a time so writers are not locked out for long.
+		// progress is called with the pages copied so far and the total.
+		void backup(const std::string &filename,
+		            const sigc::slot<void,uint64_t,uint64_t> &progress = sigc::slot<void,uint64_t,uint64_t>());
+		// Starts a backup to filename that the caller copies with
+		// DatabaseSqlite3Backup::step(), e.g. from a main loop source.
+		Glib::RefPtr<DatabaseSqlite3Backup> begin_backup(const std::string &filename);
+
+		// Merges the sqlite3 book filename into this one with set based
+		// statements on the attached file, in one transaction. All breeders
+		// and strains are merged by name; those of the breeders in
+		// update_breeders overwrite the existing rows. growlogs maps the ids
+		// of the growlogs to copy to their titles in this book, the titles
+		// must be free. Entries and strains of the growlogs come along.
+		void merge_database(const std::string &filename,
+		                    const std::set<Glib::ustring> &update_breeders,
+		                    const std::map<uint64_t,Glib::ustring> &growlogs);
+		
+	private:
+		static int _trace_callback(unsigned int type, void *data, void *p, void *x);
+		void _upgrade_database();
+		void _merge_attached(const std::set<Glib::ustring> &update_breeders,
+		                     const std::map<uint64_t,Glib::ustring> &growlogs);
 		
 	protected:
 		void begin_transaction();
 		void commit();
 		void rollback();
+		// For subclasses that keep tables of their own in the file.
+		sqlite3* get_handle() const;
 		
 	protected:
 		bool is_connected_vfunc() const override;
@@ -103,6 +139,8 @@ class DatabaseSqlite3:
 		                                              const Glib::ustring &strain_name) const override;
 		virtual void add_strain_vfunc(const Glib::RefPtr<Strain> &strain) override;
 		virtual void remove_strain_vfunc(uint64_t id) override;
+		virtual std::list<Glib::RefPtr<Strain> > get_strains_vfunc() const override;
+		virtual std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > get_strains_for_growlogs_vfunc() const override;
 
 		virtual std::list<Glib::RefPtr<Growlog> > get_growlogs_vfunc() const override;
 		virtual std::list<Glib::RefPtr<Growlog> > get_ongoing_growlogs_vfunc() const override;
@@ -114,13 +152,69 @@ class DatabaseSqlite3:
 		virtual void remove_growlog_vfunc(uint64_t id) override;
 
 		virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id) const override;
+		virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id,
+		                                                                         uint64_t offset,
+		                                                                         uint64_t limit) const override;
+		virtual uint64_t get_growlog_entry_count_vfunc(uint64_t growlog_id) const override;
 		virtual Glib::RefPtr<GrowlogEntry> get_growlog_entry_vfunc(uint64_t id) const override;
 		virtual void add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &entry) override;
 		virtual void remove_growlog_entry_vfunc(uint64_t id) override;
+		virtual void foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const override;
+		virtual void add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows) override;
 
 		virtual void add_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) override;
 		virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) override;
 		virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_strain_id) override;
+
+		virtual GrowlogStats get_growlog_stats_vfunc(uint64_t growlog_id) const override;
+		virtual std::list<GrowlogStats> get_growlog_stats_vfunc() const override;
+		virtual StrainStats get_strain_stats_vfunc(uint64_t strain_id) const override;
+		virtual std::list<StrainStats> get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const override;
+		virtual void rebuild_stats_vfunc() override;
+
+		virtual uint64_t get_change_seq_vfunc() const override;
+		virtual void foreach_change_vfunc(uint64_t after,
+		                                  uint64_t upto,
+		                                  const sigc::slot<void,const ChangeRecord&> &slot) const override;
+		virtual uint64_t get_change_watermark_vfunc(const Glib::ustring &name) const override;
+		virtual void set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq) override;
+};
+
+/*******************************************************************************
+ * DatabaseSqlite3Backup
+ ******************************************************************************/
+
+// A running sqlite3 online backup. The destination file is complete once
+// step() returned true, a backup released before that leaves a partial
+// file behind. The source database must stay connected meanwhile.
+class DatabaseSqlite3Backup:
+	public RefClass
+{
+	private:
+		sqlite3 *m_dest_;
+		sqlite3_backup *m_backup_;
+		bool m_done_;
+
+	private:
+		DatabaseSqlite3Backup(const DatabaseSqlite3Backup &src) = delete;
+		DatabaseSqlite3Backup& operator = (const DatabaseSqlite3Backup &src) = delete;
+
+	protected:
+		DatabaseSqlite3Backup(sqlite3 *source, const std::string &filename);
+
+		friend class DatabaseSqlite3;
+
+	public:
+		virtual ~DatabaseSqlite3Backup();
+
+	public:
+		// Copies up to pages pages, returns true when the backup is complete.
+		// A source that is locked by a writer is retried by the next call.
+		bool step(int pages);
+		bool is_done() const;
+
+		uint64_t get_page_count() const;
+		uint64_t get_remaining() const;
 };
 
 #endif /* __DATABASE_SQLITE3_H__ */
@@ -26,7 +26,17 @@
 #endif
 
 #include <cassert>
-
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <glibmm/miscutils.h>
+#include <glibmm/i18n.h>
+
+#include "querystats.h"
+#include "trace.h"
 #include "database-sqlite3.h"
 
 #ifdef HAVE_LIBPQ
@@ -44,6 +54,9 @@
 static std::list<Glib::RefPtr<DatabaseModule> > _db_modules;
 
 void db_init() {
+	query_stats_init();
+	trace_init();
+	
 	if (_db_modules.empty()) {
 		db_add_module(DatabaseModuleSqlite3::create());
 #ifdef HAVE_LIBPQ
@@ -82,13 +95,196 @@ void db_add_module(const Glib::RefPtr<DatabaseModule> &module) {
 	_db_modules.push_back(module);
 }
 
+static std::string _db_sql_dir;
+
+std::string db_get_sql_dir()
+{
+	const char *env_dir = getenv("GROWBOOK_SQL_DIR");
+	if (env_dir && *env_dir)
+		return std::string(env_dir);
+	if (_db_sql_dir.empty())
+		return Glib::build_filename(PACKAGE_DATA_DIR,"sql");
+	return _db_sql_dir;
+}
+
+void db_set_sql_dir(const std::string &sql_dir)
+{
+	_db_sql_dir = sql_dir;
+}
+
+static bool
+_sql_is_word_char(char c)
+{
+	return (isalnum(static_cast<unsigned char>(c)) || c == '_');
+}
+
+static void
+_sql_push_statement(std::list<std::string> &statements,std::string &statement)
+{
+	std::string::size_type begin = statement.find_first_not_of(" \t\r\n");
+	if (begin != std::string::npos && statement[begin] != ';') {
+		std::string::size_type end = statement.find_last_not_of(" \t\r\n");
+		statements.push_back(statement.substr(begin,end - begin + 1));
+	}
+	statement.clear();
+}
+
+std::list<std::string>
+db_split_sql(const std::string &script)
+{
+	std::list<std::string> statements;
+	std::string statement;
+
+	// Trigger and routine bodies are only recognized in statements that
+	// start with CREATE and name TRIGGER, FUNCTION or PROCEDURE among
+	// their first words. Inside them BEGIN and CASE open a block and END
+	// closes one, END IF, END LOOP, END WHILE and END REPEAT close nothing
+	// that has been counted.
+	std::vector<std::string> head;
+	bool has_body = false;
+	bool pending_end = false;
+	int depth = 0;
+
+	auto handle_word = [&](const std::string &word) {
+		if (head.size() < 6) {
+			head.push_back(word);
+			if (head.front() == "CREATE"
+			    && (word == "TRIGGER" || word == "FUNCTION" || word == "PROCEDURE"))
+				has_body = true;
+		}
+		if (!has_body)
+			return;
+		if (pending_end) {
+			pending_end = false;
+			if (word == "IF" || word == "LOOP" || word == "WHILE" || word == "REPEAT")
+				return;
+			if (depth > 0)
+				--depth;
+			if (word == "CASE")
+				return;
+		}
+		if (word == "BEGIN" || word == "CASE")
+			++depth;
+		else if (word == "END")
+			pending_end = true;
+	};
+
+	std::string::size_type i = 0;
+	std::string::size_type n = script.size();
+	while (i < n) {
+		char c = script[i];
+
+		if (_sql_is_word_char(c)) {
+			std::string word;
+			while (i < n && _sql_is_word_char(script[i])) {
+				word += static_cast<char>(toupper(static_cast<unsigned char>(script[i])));
+				statement += script[i];
+				++i;
+			}
+			handle_word(word);
+		} else if (c == '\'' || c == '"' || c == '`') {
+			// quotes are escaped by doubling them
+			statement += c;
+			++i;
+			while (i < n) {
+				statement += script[i];
+				if (script[i++] == c) {
+					if (i < n && script[i] == c) {
+						statement += script[i++];
+						continue;
+					}
+					break;
+				}
+			}
+		} else if (c == '-' && i + 1 < n && script[i + 1] == '-') {
+			i = script.find('\n',i);
+			if (i == std::string::npos)
+				i = n;
+		} else if (c == '/' && i + 1 < n && script[i + 1] == '*') {
+			i = script.find("*/",i + 2);
+			i = (i == std::string::npos ? n : i + 2);
+			statement += ' ';
+		} else if (c == '$') {
+			// PostgreSQL dollar quoting, $$ or $tag$
+			std::string::size_type tag_end = i + 1;
+			while (tag_end < n && _sql_is_word_char(script[tag_end]))
+				++tag_end;
+			if (tag_end < n && script[tag_end] == '$'
+			    && (tag_end == i + 1 || !isdigit(static_cast<unsigned char>(script[i + 1])))) {
+				std::string tag = script.substr(i,tag_end - i + 1);
+				std::string::size_type close = script.find(tag,tag_end + 1);
+				close = (close == std::string::npos ? n : close + tag.size());
+				statement += script.substr(i,close - i);
+				i = close;
+			} else {
+				statement += c;
+				++i;
+			}
+		} else if (c == ';') {
+			if (pending_end) {
+				pending_end = false;
+				if (depth > 0)
+					--depth;
+			}
+			statement += c;
+			++i;
+			if (depth == 0) {
+				_sql_push_statement(statements,statement);
+				head.clear();
+				has_body = false;
+			}
+		} else {
+			statement += c;
+			++i;
+		}
+	}
+	_sql_push_statement(statements,statement);
+	return statements;
+}
+
+std::list<std::string>
+db_read_sql_file(const std::string &filename)
+{
+	std::ifstream file{filename};
+	if (!file.is_open()) {
+		Glib::ustring msg = _("Unable to read SQL file!");
+		msg += "\n(";
+		msg += filename;
+		msg += ")";
+		throw DatabaseError(msg);
+	}
+	std::stringstream script;
+	script << file.rdbuf();
+	return db_split_sql(script.str());
+}
+
+size_t
+db_format_datetime(time_t t, char *buffer, size_t size)
+{
+#ifdef NATIVE_WINDOWS
+	tm *datetime = localtime(&t);
+	if (!datetime)
+		return 0;
+	return strftime(buffer,size,DATETIME_ISO_FORMAT,datetime);
+#else
+	tm datetime;
+	if (localtime_r(&t,&datetime) != &datetime)
+		return 0;
+	return strftime(buffer,size,DATETIME_ISO_FORMAT,&datetime);
+#endif
+}
+
 /*******************************************************************************
  * Database
  ******************************************************************************/
 
 Database::Database(const Glib::RefPtr<DatabaseSettings> &settings) noexcept:
 	RefClass{},
-	m_settings_{settings}
+	m_settings_{settings},
+	m_signal_breeder_changed_{},
+	m_signal_breeder_removed_{},
+	m_signal_strain_changed_{},
+	m_signal_strain_removed_{}
 {
 }
 
@@ -111,256 +307,685 @@ Database::get_settings() const
 bool
 Database::is_connected() const
 {
+	static QueryStat *stat = query_stats_get_method("is_connected()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::is_connected");
+
 	return this->is_connected_vfunc();
 }
 
 bool
 Database::test_connection()
 {
+	static QueryStat *stat = query_stats_get_method("test_connection()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::test_connection");
+
 	return this->test_connection_vfunc();
 }
 
 void
 Database::create_database()
 {
+	static QueryStat *stat = query_stats_get_method("create_database()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::create_database");
+
 	this->create_database_vfunc();
 }
 
 void
 Database::connect()
 {
+	static QueryStat *stat = query_stats_get_method("connect()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::connect");
+
 	this->connect_vfunc();
 }
 
 void
 Database::close()
 {
+	static QueryStat *stat = query_stats_get_method("close()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::close");
+
 	this->close_vfunc();
 }
 
 std::list<Glib::RefPtr<Breeder > >
 Database::get_breeders() const
 {
-	return this->get_breeders_vfunc();
+	static QueryStat *stat = query_stats_get_method("get_breeders()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_breeders");
+
+	std::list<Glib::RefPtr<Breeder > > ret = this->get_breeders_vfunc();
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 Glib::RefPtr<Breeder>
 Database::get_breeder(uint64_t id) const
 {
-	return this->get_breeder_vfunc (id);
+	static QueryStat *stat = query_stats_get_method("get_breeder(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_breeder");
+
+	Glib::RefPtr<Breeder> ret = this->get_breeder_vfunc (id);
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
 Glib::RefPtr<Breeder>
 Database::get_breeder(const Glib::ustring &name) const
 {
-	return this->get_breeder_vfunc(name);
+	static QueryStat *stat = query_stats_get_method("get_breeder(name)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_breeder");
+
+	Glib::RefPtr<Breeder> ret = this->get_breeder_vfunc(name);
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
 void
 Database::add_breeder(const Glib::RefPtr<Breeder> &breeder)
 {
+	static QueryStat *stat = query_stats_get_method("add_breeder(breeder)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_breeder");
+
+	// a renamed breeder must not hand out its old name to new strains
+	if (breeder->get_id())
+		breeder_name_invalidate(breeder->get_id());
 	this->add_breeder_vfunc(breeder);
+	if (breeder->get_id())
+		m_signal_breeder_changed_.emit(breeder);
 }
 
 void
 Database::remove_breeder(uint64_t id)
 {
+	static QueryStat *stat = query_stats_get_method("remove_breeder(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_breeder");
+
+	breeder_name_invalidate(id);
 	this->remove_breeder_vfunc (id);
+	m_signal_breeder_removed_.emit(id);
 }
 
 void
 Database::remove_breeder(const Glib::RefPtr<Breeder> &breeder)
 {
+	static QueryStat *stat = query_stats_get_method("remove_breeder(breeder)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_breeder");
+
+	breeder_name_invalidate(breeder->get_id());
 	this->remove_breeder_vfunc(breeder->get_id());
+	m_signal_breeder_removed_.emit(breeder->get_id());
 }
 
 
 std::list<Glib::RefPtr<Strain> >
 Database::get_strains_for_breeder(uint64_t breeder_id) const
 {
-	return this->get_strains_for_breeder_vfunc(breeder_id);
+	static QueryStat *stat = query_stats_get_method("get_strains_for_breeder(breeder_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strains_for_breeder");
+
+	std::list<Glib::RefPtr<Strain> > ret = this->get_strains_for_breeder_vfunc(breeder_id);
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 std::list<Glib::RefPtr<Strain> >
 Database::get_strains_for_breeder(const Glib::RefPtr<Breeder> &breeder) const
 {
-	return this->get_strains_for_breeder_vfunc(breeder->get_id());
+	static QueryStat *stat = query_stats_get_method("get_strains_for_breeder(breeder)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strains_for_breeder");
+
+	std::list<Glib::RefPtr<Strain> > ret = this->get_strains_for_breeder_vfunc(breeder->get_id());
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 std::list<Glib::RefPtr<Strain> >
 Database::get_strains_for_growlog(uint64_t growlog_id) const
 {
-	return this->get_strains_for_growlog_vfunc(growlog_id);
+	static QueryStat *stat = query_stats_get_method("get_strains_for_growlog(growlog_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strains_for_growlog");
+
+	std::list<Glib::RefPtr<Strain> > ret = this->get_strains_for_growlog_vfunc(growlog_id);
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 
 std::list<Glib::RefPtr<Strain> >
 Database::get_strains_for_growlog(const Glib::RefPtr<Growlog> &growlog) const
 {
-	return this->get_strains_for_growlog_vfunc(growlog->get_id());
+	static QueryStat *stat = query_stats_get_method("get_strains_for_growlog(growlog)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strains_for_growlog");
+
+	std::list<Glib::RefPtr<Strain> > ret = this->get_strains_for_growlog_vfunc(growlog->get_id());
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 
 Glib::RefPtr<Strain>
 Database::get_strain(uint64_t id) const
 {
-	return this->get_strain_vfunc(id);
+	static QueryStat *stat = query_stats_get_method("get_strain(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strain");
+
+	Glib::RefPtr<Strain> ret = this->get_strain_vfunc(id);
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
 Glib::RefPtr<Strain>
 Database::get_strain(const Glib::ustring &breeder_name,
                      const Glib::ustring &strain_name) const
 {
-	return this->get_strain_vfunc(breeder_name,strain_name);	                              
+	static QueryStat *stat = query_stats_get_method("get_strain(breeder_name,strain_name)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strain");
+
+	Glib::RefPtr<Strain> ret = this->get_strain_vfunc(breeder_name,strain_name);	                              
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
 void
 Database::add_strain(const Glib::RefPtr<Strain> &strain)
 {
+	static QueryStat *stat = query_stats_get_method("add_strain(strain)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_strain");
+
 	this->add_strain_vfunc(strain);
+	if (m_signal_strain_changed_.empty())
+		return;
+
+	// new strains do not learn their id from the insert
+	if (strain->get_id()) {
+		m_signal_strain_changed_.emit(strain);
+	} else {
+		Glib::RefPtr<Strain> stored = this->get_strain_vfunc(strain->get_breeder_name(),strain->get_name());
+		if (stored)
+			m_signal_strain_changed_.emit(stored);
+	}
 }
 
 void
 Database::remove_strain(uint64_t id)
 {
+	static QueryStat *stat = query_stats_get_method("remove_strain(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_strain");
+
 	this->remove_strain_vfunc(id);
+	m_signal_strain_removed_.emit(id);
 }
 
 void
 Database::remove_strain(const Glib::RefPtr<Strain> &strain)
 {
+	static QueryStat *stat = query_stats_get_method("remove_strain(strain)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_strain");
+
 	this->remove_strain_vfunc(strain->get_id());
+	m_signal_strain_removed_.emit(strain->get_id());
+}
+
+std::list<Glib::RefPtr<Strain> >
+Database::get_strains() const
+{
+	static QueryStat *stat = query_stats_get_method("get_strains()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strains");
+
+	std::list<Glib::RefPtr<Strain> > ret = this->get_strains_vfunc();
+	scope.set_rows(ret.size());
+	return ret;
+}
+
+std::map<uint64_t,std::list<Glib::RefPtr<Strain> > >
+Database::get_strains_for_growlogs() const
+{
+	static QueryStat *stat = query_stats_get_method("get_strains_for_growlogs()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strains_for_growlogs");
+
+	std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > ret = this->get_strains_for_growlogs_vfunc();
+	uint64_t n_rows = 0;
+	for (auto &item: ret)
+		n_rows += item.second.size();
+	scope.set_rows(n_rows);
+	return ret;
 }
 
-std::list<Glib::RefPtr<Growlog> > 
+std::list<Glib::RefPtr<Growlog> >
 Database::get_growlogs() const
 {
-	return this->get_growlogs_vfunc();
+	static QueryStat *stat = query_stats_get_method("get_growlogs()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlogs");
+
+	std::list<Glib::RefPtr<Growlog> > ret = this->get_growlogs_vfunc();
+	scope.set_rows(ret.size());
+	return ret;
 }
 
-std::list<Glib::RefPtr<Growlog> > 
+std::list<Glib::RefPtr<Growlog> >
 Database::get_ongoing_growlogs() const
 {
-	return this->get_ongoing_growlogs_vfunc();
+	static QueryStat *stat = query_stats_get_method("get_ongoing_growlogs()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_ongoing_growlogs");
+
+	std::list<Glib::RefPtr<Growlog> > ret = this->get_ongoing_growlogs_vfunc();
+	scope.set_rows(ret.size());
+	return ret;
 }
 
-std::list<Glib::RefPtr<Growlog> > 
+std::list<Glib::RefPtr<Growlog> >
 Database::get_finished_growlogs() const
 {
-	return this->get_finished_growlogs_vfunc();
+	static QueryStat *stat = query_stats_get_method("get_finished_growlogs()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_finished_growlogs");
+
+	std::list<Glib::RefPtr<Growlog> > ret = this->get_finished_growlogs_vfunc();
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 std::list<Glib::RefPtr<Growlog> >
 Database::get_growlogs_for_strain(uint64_t strain_id) const
 {
-	return this->get_growlogs_for_strain_vfunc (strain_id);
+	static QueryStat *stat = query_stats_get_method("get_growlogs_for_strain(strain_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlogs_for_strain");
+
+	std::list<Glib::RefPtr<Growlog> > ret = this->get_growlogs_for_strain_vfunc (strain_id);
+	scope.set_rows(ret.size());
+	return ret;
 }
 
 std::list<Glib::RefPtr<Growlog> >
 Database::get_growlogs_for_strain(const Glib::RefPtr<Strain> &strain) const
 {
-	return this->get_growlogs_for_strain_vfunc (strain->get_id());
+	static QueryStat *stat = query_stats_get_method("get_growlogs_for_strain(strain)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlogs_for_strain");
+
+	std::list<Glib::RefPtr<Growlog> > ret = this->get_growlogs_for_strain_vfunc (strain->get_id());
+	scope.set_rows(ret.size());
+	return ret;
 }
 
-Glib::RefPtr<Growlog> 
+Glib::RefPtr<Growlog>
 Database::get_growlog(uint64_t id) const
 {
-	return this->get_growlog_vfunc(id);
+	static QueryStat *stat = query_stats_get_method("get_growlog(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog");
+
+	Glib::RefPtr<Growlog> ret = this->get_growlog_vfunc(id);
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
-Glib::RefPtr<Growlog> 
+Glib::RefPtr<Growlog>
 Database::get_growlog(const Glib::ustring &title) const
 {
-	return this->get_growlog_vfunc(title);
+	static QueryStat *stat = query_stats_get_method("get_growlog(title)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog");
+
+	Glib::RefPtr<Growlog> ret = this->get_growlog_vfunc(title);
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
-void 
+void
 Database::add_growlog(const Glib::RefPtr<Growlog> &growlog)
 {
+	static QueryStat *stat = query_stats_get_method("add_growlog(growlog)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_growlog");
+
 	return this->add_growlog_vfunc(growlog);
 }
 
-void 
+void
 Database::remove_growlog(uint64_t id)
 {
+	static QueryStat *stat = query_stats_get_method("remove_growlog(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_growlog");
+
 	return this->remove_growlog_vfunc(id);
 }
 
-void 
+void
 Database::remove_growlog(const Glib::RefPtr<Growlog> &growlog)
 {
+	static QueryStat *stat = query_stats_get_method("remove_growlog(growlog)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_growlog");
+
 	return this->remove_growlog_vfunc(growlog->get_id());
 }
 
-std::list<Glib::RefPtr<GrowlogEntry> > 
+std::list<Glib::RefPtr<GrowlogEntry> >
 Database::get_growlog_entries(uint64_t growlog_id) const
 {
-	return this->get_growlog_entries_vfunc(growlog_id);
+	static QueryStat *stat = query_stats_get_method("get_growlog_entries(growlog_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_entries");
+
+	std::list<Glib::RefPtr<GrowlogEntry> > ret = this->get_growlog_entries_vfunc(growlog_id);
+	scope.set_rows(ret.size());
+	return ret;
 }
 
-std::list<Glib::RefPtr<GrowlogEntry> > 
+std::list<Glib::RefPtr<GrowlogEntry> >
 Database::get_growlog_entries(const Glib::RefPtr<Growlog> &growlog) const
 {
-	return this->get_growlog_entries_vfunc(growlog->get_id());
+	static QueryStat *stat = query_stats_get_method("get_growlog_entries(growlog)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_entries");
+
+	std::list<Glib::RefPtr<GrowlogEntry> > ret = this->get_growlog_entries_vfunc(growlog->get_id());
+	scope.set_rows(ret.size());
+	return ret;
+}
+
+std::list<Glib::RefPtr<GrowlogEntry> >
+Database::get_growlog_entries(uint64_t growlog_id,uint64_t offset,uint64_t limit) const
+{
+	static QueryStat *stat = query_stats_get_method("get_growlog_entries(growlog_id,offset,limit)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_entries");
+
+	std::list<Glib::RefPtr<GrowlogEntry> > ret = this->get_growlog_entries_vfunc(growlog_id,offset,limit);
+	scope.set_rows(ret.size());
+	return ret;
+}
+
+uint64_t
+Database::get_growlog_entry_count(uint64_t growlog_id) const
+{
+	static QueryStat *stat = query_stats_get_method("get_growlog_entry_count(growlog_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_entry_count");
+
+	return this->get_growlog_entry_count_vfunc(growlog_id);
 }
 
-Glib::RefPtr<GrowlogEntry> 
+Glib::RefPtr<GrowlogEntry>
 Database::get_growlog_entry(uint64_t id) const
 {
-	return this->get_growlog_entry_vfunc(id);
+	static QueryStat *stat = query_stats_get_method("get_growlog_entry(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_entry");
+
+	Glib::RefPtr<GrowlogEntry> ret = this->get_growlog_entry_vfunc(id);
+	scope.set_rows(ret ? 1 : 0);
+	return ret;
 }
 
-void 
+void
 Database::add_growlog_entry(const Glib::RefPtr<GrowlogEntry> &entry)
 {
+	static QueryStat *stat = query_stats_get_method("add_growlog_entry(entry)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_growlog_entry");
+
 	return this->add_growlog_entry_vfunc(entry);
 }
 
-void 
+void
 Database::remove_growlog_entry(uint64_t id)
 {
+	static QueryStat *stat = query_stats_get_method("remove_growlog_entry(id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_growlog_entry");
+
 	return this->remove_growlog_entry_vfunc(id);
 }
 
-void 
+void
 Database::remove_growlog_entry(const Glib::RefPtr<GrowlogEntry> &entry)
 {
+	static QueryStat *stat = query_stats_get_method("remove_growlog_entry(entry)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_growlog_entry");
+
 	return this->remove_growlog_entry_vfunc(entry->get_id());
 }
 
-void 
+void
+Database::foreach_growlog_entry(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const
+{
+	static QueryStat *stat = query_stats_get_method("foreach_growlog_entry(slot)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::foreach_growlog_entry");
+
+	uint64_t n_rows = 0;
+	this->foreach_growlog_entry_vfunc([&n_rows,&slot](const Glib::RefPtr<GrowlogEntry> &entry) {
+		++n_rows;
+		slot(entry);
+	});
+	scope.set_rows(n_rows);
+}
+
+void
+Database::add_growlog_entries(const std::vector<GrowlogEntryRow> &rows)
+{
+	static QueryStat *stat = query_stats_get_method("add_growlog_entries(rows)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_growlog_entries");
+
+	if (rows.empty())
+		return;
+	this->add_growlog_entries_vfunc(rows);
+	scope.set_rows(rows.size());
+}
+
+void
 Database::add_strain_for_growlog(uint64_t growlog_id,uint64_t strain_id)
 {
+	static QueryStat *stat = query_stats_get_method("add_strain_for_growlog(growlog_id,strain_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_strain_for_growlog");
+
 	return this->add_strain_for_growlog_vfunc(growlog_id,strain_id);
 }
 
-void 
+void
 Database::add_strain_for_growlog(const Glib::RefPtr<Growlog> &growlog,
                                  const Glib::RefPtr<Strain> &strain)
 {
+	static QueryStat *stat = query_stats_get_method("add_strain_for_growlog(growlog,strain)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::add_strain_for_growlog");
+
 	return this->add_strain_for_growlog_vfunc(growlog->get_id(),strain->get_id());
 }
 
-void 
+void
 Database::remove_strain_for_growlog(uint64_t growlog_id,
                                     uint64_t strain_id)
 {
+	static QueryStat *stat = query_stats_get_method("remove_strain_for_growlog(growlog_id,strain_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_strain_for_growlog");
+
 	return this->remove_strain_for_growlog_vfunc(growlog_id,strain_id);
 }
 
-void 
+void
 Database::remove_strain_for_growlog(const Glib::RefPtr<Growlog> &growlog,
                                     const Glib::RefPtr<Strain> &strain)
 {
+	static QueryStat *stat = query_stats_get_method("remove_strain_for_growlog(growlog,strain)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_strain_for_growlog");
+
 	return this->remove_strain_for_growlog_vfunc(growlog->get_id(),strain->get_id());
 }
 
-void 
+void
 Database::remove_strain_for_growlog(uint64_t growlog_strain_id)
 {
+	static QueryStat *stat = query_stats_get_method("remove_strain_for_growlog(growlog_strain_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::remove_strain_for_growlog");
+
 	return this->remove_strain_for_growlog_vfunc(growlog_strain_id);
 }
 
+GrowlogStats
+Database::get_growlog_stats(uint64_t growlog_id) const
+{
+	static QueryStat *stat = query_stats_get_method("get_growlog_stats(growlog_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_stats");
+
+	return this->get_growlog_stats_vfunc(growlog_id);
+}
+
+std::list<GrowlogStats>
+Database::get_growlog_stats() const
+{
+	static QueryStat *stat = query_stats_get_method("get_growlog_stats()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_growlog_stats");
+
+	std::list<GrowlogStats> ret = this->get_growlog_stats_vfunc();
+	scope.set_rows(ret.size());
+	return ret;
+}
+
+StrainStats
+Database::get_strain_stats(uint64_t strain_id) const
+{
+	static QueryStat *stat = query_stats_get_method("get_strain_stats(strain_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strain_stats");
+
+	return this->get_strain_stats_vfunc(strain_id);
+}
+
+std::list<StrainStats>
+Database::get_strain_stats_for_breeder(uint64_t breeder_id) const
+{
+	static QueryStat *stat = query_stats_get_method("get_strain_stats_for_breeder(breeder_id)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_strain_stats_for_breeder");
+
+	std::list<StrainStats> ret = this->get_strain_stats_for_breeder_vfunc(breeder_id);
+	scope.set_rows(ret.size());
+	return ret;
+}
+
+void
+Database::rebuild_stats()
+{
+	static QueryStat *stat = query_stats_get_method("rebuild_stats()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::rebuild_stats");
+
+	// the schema only uses CREATE ... IF NOT EXISTS and CREATE OR REPLACE,
+	// running it again adds what an older database is missing
+	this->create_database_vfunc();
+	this->rebuild_stats_vfunc();
+}
+
+uint64_t
+Database::get_change_seq() const
+{
+	static QueryStat *stat = query_stats_get_method("get_change_seq()");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_change_seq");
+
+	return this->get_change_seq_vfunc();
+}
+
+void
+Database::foreach_change(uint64_t after,
+                         uint64_t upto,
+                         const sigc::slot<void,const ChangeRecord&> &slot) const
+{
+	static QueryStat *stat = query_stats_get_method("foreach_change(after,upto,slot)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::foreach_change");
+
+	uint64_t n_rows = 0;
+	this->foreach_change_vfunc(after,upto,[&n_rows,&slot](const ChangeRecord &record) {
+		++n_rows;
+		slot(record);
+	});
+	scope.set_rows(n_rows);
+}
+
+uint64_t
+Database::get_change_watermark(const Glib::ustring &name) const
+{
+	static QueryStat *stat = query_stats_get_method("get_change_watermark(name)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::get_change_watermark");
+
+	return this->get_change_watermark_vfunc(name);
+}
+
+void
+Database::set_change_watermark(const Glib::ustring &name, uint64_t seq)
+{
+	static QueryStat *stat = query_stats_get_method("set_change_watermark(name,seq)");
+	QueryStatScope scope(stat);
+	TRACE_SCOPE("database","Database::set_change_watermark");
+
+	this->set_change_watermark_vfunc(name,seq);
+}
+
+sigc::signal<void,const Glib::RefPtr<Breeder>&>&
+Database::signal_breeder_changed()
+{
+	return m_signal_breeder_changed_;
+}
+
+sigc::signal<void,uint64_t>&
+Database::signal_breeder_removed()
+{
+	return m_signal_breeder_removed_;
+}
+
+sigc::signal<void,const Glib::RefPtr<Strain>&>&
+Database::signal_strain_changed()
+{
+	return m_signal_strain_changed_;
+}
+
+sigc::signal<void,uint64_t>&
+Database::signal_strain_removed()
+{
+	return m_signal_strain_removed_;
+}
+
 /*******************************************************************************
  * DatabaseModule
  ******************************************************************************/
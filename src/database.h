@@ -30,12 +30,31 @@
 #include "settings.h"
 
 #include <glibmm/ustring.h>
+#include <sigc++/sigc++.h>
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
+#include <ctime>
 
 #include "datatypes.h"
 #include "error.h"
 
+/*******************************************************************************
+ * GrowlogEntryRow
+ ******************************************************************************/
+
+/*! A new growlog entry for Database::add_growlog_entries(). The text is not
+ * copied, it has to stay valid until add_growlog_entries() returns.
+ */
+struct GrowlogEntryRow
+{
+	uint64_t growlog_id;
+	const char *text;
+	size_t text_size;
+	time_t created_on;
+};
+
 /*******************************************************************************
  * Database
  ******************************************************************************/
@@ -45,6 +64,11 @@ class Database:
 {
 	 private:
 		 Glib::RefPtr<DatabaseSettings> m_settings_;
+
+		 sigc::signal<void,const Glib::RefPtr<Breeder>&> m_signal_breeder_changed_;
+		 sigc::signal<void,uint64_t> m_signal_breeder_removed_;
+		 sigc::signal<void,const Glib::RefPtr<Strain>&> m_signal_strain_changed_;
+		 sigc::signal<void,uint64_t> m_signal_strain_removed_;
 		 
 	 private:
 		 Database(const Database &src) = delete;
@@ -101,6 +125,14 @@ class Database:
 		 void add_strain(const Glib::RefPtr<Strain> &strain);
 		 void remove_strain(uint64_t id);
 		 void remove_strain(const Glib::RefPtr<Strain> &strain);
+		 /*! All strains, ordered like get_breeders() and
+		  * get_strains_for_breeder().
+		  */
+		 std::list<Glib::RefPtr<Strain> > get_strains() const;
+		 /*! The strains of all growlogs that have any, keyed by growlog id
+		  * and ordered like get_strains_for_growlog().
+		  */
+		 std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > get_strains_for_growlogs() const;
 
 		 std::list<Glib::RefPtr<Growlog> > get_growlogs() const;
 		 std::list<Glib::RefPtr<Growlog> > get_ongoing_growlogs() const;
@@ -115,10 +147,27 @@ class Database:
 
 		 std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries(uint64_t growlog_id) const;
 		 std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries(const Glib::RefPtr<Growlog> &growlog) const;
+		 /*! Get at most limit entries of a growlog, ordered by creation time,
+		  * starting with the entry at position offset.
+		  */
+		 std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries(uint64_t growlog_id,
+		                                                            uint64_t offset,
+		                                                            uint64_t limit) const;
+		 uint64_t get_growlog_entry_count(uint64_t growlog_id) const;
 		 Glib::RefPtr<GrowlogEntry> get_growlog_entry(uint64_t id) const;
 		 void add_growlog_entry(const Glib::RefPtr<GrowlogEntry> &entry);
 		 void remove_growlog_entry(uint64_t id);
 		 void remove_growlog_entry(const Glib::RefPtr<GrowlogEntry> &entry);
+		 /*! Call slot for every growlog entry, fetched with a single query.
+		  * Entries are grouped by growlog in the order of get_growlogs() and
+		  * ordered like get_growlog_entries() within a growlog. The rows are
+		  * streamed, so slot must not use the database.
+		  */
+		 void foreach_growlog_entry(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const;
+		 /*! Insert new entries in a single transaction, for importers
+		  * that restore many entries at once.
+		  */
+		 void add_growlog_entries(const std::vector<GrowlogEntryRow> &rows);
 
 		 void add_strain_for_growlog(uint64_t growlog_id,uint64_t strain_id);
 		 void add_strain_for_growlog(const Glib::RefPtr<Growlog> &growlog,
@@ -127,6 +176,46 @@ class Database:
 		 void remove_strain_for_growlog(const Glib::RefPtr<Growlog> &growlog,
 		                                const Glib::RefPtr<Strain> &strain);
 		 void remove_strain_for_growlog(uint64_t growlog_strain_id);
+
+		 /*! Statistics of a growlog. A growlog without entries has zero
+		  * counts.
+		  */
+		 GrowlogStats get_growlog_stats(uint64_t growlog_id) const;
+		 std::list<GrowlogStats> get_growlog_stats() const;
+		 StrainStats get_strain_stats(uint64_t strain_id) const;
+		 std::list<StrainStats> get_strain_stats_for_breeder(uint64_t breeder_id) const;
+		 /*! Create the statistics and change tracking tables and triggers
+		  * if the database predates them and compute all statistics from
+		  * scratch.
+		  */
+		 void rebuild_stats();
+
+		 /*! The seq of the last change in change_log, 0 if nothing has
+		  * been recorded yet.
+		  */
+		 uint64_t get_change_seq() const;
+		 /*! Call slot for every change_log record with after < seq <= upto,
+		  * ordered by seq. The records are fetched before slot is called
+		  * for the first one, so slot may use the database.
+		  */
+		 void foreach_change(uint64_t after,
+		                     uint64_t upto,
+		                     const sigc::slot<void,const ChangeRecord&> &slot) const;
+		 /*! The seq stored under name by set_change_watermark(), 0 if there
+		  * is none.
+		  */
+		 uint64_t get_change_watermark(const Glib::ustring &name) const;
+		 void set_change_watermark(const Glib::ustring &name, uint64_t seq);
+
+		 /*! Emitted after add_breeder() updated an existing breeder.
+		  */
+		 sigc::signal<void,const Glib::RefPtr<Breeder>&>& signal_breeder_changed();
+		 sigc::signal<void,uint64_t>& signal_breeder_removed();
+		 /*! Emitted after add_strain() stored a strain. The strain passed to
+		  * the handlers always carries its id.
+		  */
+		 sigc::signal<void,const Glib::RefPtr<Strain>&>& signal_strain_changed();
+		 sigc::signal<void,uint64_t>& signal_strain_removed();
 		 
 	protected:
 		 virtual bool is_connected_vfunc() const = 0;
@@ -148,6 +237,8 @@ class Database:
 		                                               const Glib::ustring &strain_name) const = 0;
 		 virtual void add_strain_vfunc(const Glib::RefPtr<Strain> &strain) = 0;
 		 virtual void remove_strain_vfunc(uint64_t strain_id) = 0;
+		 virtual std::list<Glib::RefPtr<Strain> > get_strains_vfunc() const = 0;
+		 virtual std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > get_strains_for_growlogs_vfunc() const = 0;
 
 		 virtual std::list<Glib::RefPtr<Growlog> > get_growlogs_vfunc() const = 0;
 		 virtual std::list<Glib::RefPtr<Growlog> > get_ongoing_growlogs_vfunc() const = 0;
@@ -159,13 +250,32 @@ class Database:
 		 virtual void remove_growlog_vfunc(uint64_t id) = 0;
 
 		 virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id) const = 0;
+		 virtual std::list<Glib::RefPtr<GrowlogEntry> > get_growlog_entries_vfunc(uint64_t growlog_id,
+		                                                                         uint64_t offset,
+		                                                                         uint64_t limit) const = 0;
+		 virtual uint64_t get_growlog_entry_count_vfunc(uint64_t growlog_id) const = 0;
 		 virtual Glib::RefPtr<GrowlogEntry> get_growlog_entry_vfunc(uint64_t id) const = 0;
 		 virtual void add_growlog_entry_vfunc(const Glib::RefPtr<GrowlogEntry> &entry) = 0;
 		 virtual void remove_growlog_entry_vfunc(uint64_t id) = 0;
+		 virtual void foreach_growlog_entry_vfunc(const sigc::slot<void,const Glib::RefPtr<GrowlogEntry>&> &slot) const = 0;
+		 virtual void add_growlog_entries_vfunc(const std::vector<GrowlogEntryRow> &rows) = 0;
 
 		 virtual void add_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) = 0;
 		 virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_id,uint64_t strain_id) = 0;
 		 virtual void remove_strain_for_growlog_vfunc(uint64_t growlog_strain_id) = 0;
+
+		 virtual GrowlogStats get_growlog_stats_vfunc(uint64_t growlog_id) const = 0;
+		 virtual std::list<GrowlogStats> get_growlog_stats_vfunc() const = 0;
+		 virtual StrainStats get_strain_stats_vfunc(uint64_t strain_id) const = 0;
+		 virtual std::list<StrainStats> get_strain_stats_for_breeder_vfunc(uint64_t breeder_id) const = 0;
+		 virtual void rebuild_stats_vfunc() = 0;
+
+		 virtual uint64_t get_change_seq_vfunc() const = 0;
+		 virtual void foreach_change_vfunc(uint64_t after,
+		                                   uint64_t upto,
+		                                   const sigc::slot<void,const ChangeRecord&> &slot) const = 0;
+		 virtual uint64_t get_change_watermark_vfunc(const Glib::ustring &name) const = 0;
+		 virtual void set_change_watermark_vfunc(const Glib::ustring &name, uint64_t seq) = 0;
 }; // Database class
 
 /*******************************************************************************
@@ -209,4 +319,25 @@ std::list<Glib::RefPtr<DatabaseModule> > db_get_modules();
 Glib::RefPtr<DatabaseModule> db_get_module(const Glib::ustring &engine);
 void db_add_module(const Glib::RefPtr<DatabaseModule> &module);
 
+/*! Directory holding the growbook.<engine>.sql files used by
+ * Database::create_database(). The environment variable GROWBOOK_SQL_DIR
+ * overrides both db_set_sql_dir() and the installed sql directory.
+ */
+std::string db_get_sql_dir();
+void db_set_sql_dir(const std::string &sql_dir);
+
+/*! Split an SQL script into statements. Semicolons inside quotes,
+ * comments, dollar quoted bodies and the BEGIN ... END body of a
+ * CREATE TRIGGER, FUNCTION or PROCEDURE do not end a statement.
+ */
+std::list<std::string> db_split_sql(const std::string &script);
+/*! Read an SQL file and split it into statements.
+ */
+std::list<std::string> db_read_sql_file(const std::string &filename);
+
+/*! Format t as local time in DATETIME_ISO_FORMAT, the way the backends
+ * store timestamps. Returns the length of the string or 0 on failure.
+ */
+size_t db_format_datetime(time_t t, char *buffer, size_t size);
+
 #endif
@@ -0,0 +1,266 @@
+//           databaselistmodel.cc
+//  Di Oktober 20 09:12:44 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// databaselistmodel.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "databaselistmodel.h"
+#include "trace.h"
+
+#include <cassert>
+
+/*******************************************************************************
+ * DatabaseListModel
+ ******************************************************************************/
+
+DatabaseListModel::DatabaseListModel(const Gtk::TreeModelColumnRecord &columns,
+                                     size_t page_size,
+                                     size_t max_pages):
+	Glib::ObjectBase{typeid(DatabaseListModel)},
+	Glib::Object{},
+	Gtk::TreeModel{},
+	m_column_types_{},
+	m_stamp_{static_cast<int>(g_random_int())},
+	m_page_size_{page_size},
+	m_max_pages_{max_pages},
+	m_reversed_{false},
+	m_n_rows_valid_{false},
+	m_n_rows_{0},
+	m_pages_{},
+	m_page_lru_{}
+{
+	assert(m_page_size_ > 0);
+	assert(m_max_pages_ > 0);
+
+	const GType *types = columns.types();
+	for (unsigned int i = 0; i < columns.size(); ++i)
+		m_column_types_.push_back(types[i]);
+}
+
+DatabaseListModel::~DatabaseListModel()
+{
+}
+
+bool
+DatabaseListModel::_index_is_valid(size_t index) const
+{
+	return (index < get_n_rows());
+}
+
+const Glib::RefPtr<RefClass>&
+DatabaseListModel::_get_item(size_t index) const
+{
+	static const Glib::RefPtr<RefClass> none;
+
+	if (m_reversed_)
+		index = get_n_rows() - 1 - index;
+
+	size_t page_index = index / m_page_size_;
+	auto page = m_pages_.find(page_index);
+	if (page == m_pages_.end()) {
+		TRACE_SCOPE("ui","DatabaseListModel::fetch_page");
+		if (m_pages_.size() >= m_max_pages_) {
+			m_pages_.erase(m_page_lru_.back());
+			m_page_lru_.pop_back();
+		}
+		std::list<Glib::RefPtr<RefClass> > rows{fetch_rows_vfunc(page_index * m_page_size_,m_page_size_)};
+		page = m_pages_.emplace(page_index,std::vector<Glib::RefPtr<RefClass> >(rows.begin(),rows.end())).first;
+		m_page_lru_.push_front(page_index);
+	} else if (m_page_lru_.front() != page_index) {
+		m_page_lru_.remove(page_index);
+		m_page_lru_.push_front(page_index);
+	}
+
+	size_t row = index % m_page_size_;
+	if (row >= page->second.size())
+		return none;
+	return page->second[row];
+}
+
+size_t
+DatabaseListModel::_get_index(const iterator &iter) const
+{
+	return GPOINTER_TO_SIZE(iter.gobj()->user_data);
+}
+
+void
+DatabaseListModel::_set_iter(iterator &iter,size_t index) const
+{
+	iter.set_stamp(m_stamp_);
+	iter.gobj()->user_data = GSIZE_TO_POINTER(index);
+}
+
+size_t
+DatabaseListModel::get_n_rows() const
+{
+	if (!m_n_rows_valid_) {
+		m_n_rows_ = count_rows_vfunc();
+		m_n_rows_valid_ = true;
+	}
+	return m_n_rows_;
+}
+
+Glib::RefPtr<RefClass>
+DatabaseListModel::get_item(const iterator &iter) const
+{
+	if (!iter_is_valid(iter))
+		return Glib::RefPtr<RefClass>();
+	return _get_item(_get_index(iter));
+}
+
+void
+DatabaseListModel::set_reversed(bool reversed)
+{
+	m_reversed_ = reversed;
+}
+
+bool
+DatabaseListModel::get_reversed() const
+{
+	return m_reversed_;
+}
+
+void
+DatabaseListModel::clear_cache()
+{
+	m_pages_.clear();
+	m_page_lru_.clear();
+}
+
+Gtk::TreeModelFlags
+DatabaseListModel::get_flags_vfunc() const
+{
+	return Gtk::TREE_MODEL_LIST_ONLY;
+}
+
+int
+DatabaseListModel::get_n_columns_vfunc() const
+{
+	return static_cast<int>(m_column_types_.size());
+}
+
+GType
+DatabaseListModel::get_column_type_vfunc(int index) const
+{
+	if (index < 0 || static_cast<size_t>(index) >= m_column_types_.size())
+		return G_TYPE_INVALID;
+	return m_column_types_[index];
+}
+
+void
+DatabaseListModel::get_value_vfunc(const iterator &iter,
+                                   int column,
+                                   Glib::ValueBase &value) const
+{
+	if (!iter_is_valid(iter) || column < 0 || static_cast<size_t>(column) >= m_column_types_.size())
+		return;
+
+	const Glib::RefPtr<RefClass> &item = _get_item(_get_index(iter));
+	if (item) {
+		get_item_value_vfunc(item,column,value);
+	} else {
+		// The row vanished from the database after it was counted.
+		value.init(m_column_types_[column]);
+	}
+}
+
+bool
+DatabaseListModel::iter_next_vfunc(const iterator &iter,iterator &iter_next) const
+{
+	if (!iter_is_valid(iter))
+		return false;
+
+	size_t index = _get_index(iter) + 1;
+	if (!_index_is_valid(index))
+		return false;
+	_set_iter(iter_next,index);
+	return true;
+}
+
+bool
+DatabaseListModel::iter_children_vfunc(const iterator &parent,iterator &iter) const
+{
+	return false;
+}
+
+bool
+DatabaseListModel::iter_has_child_vfunc(const iterator &iter) const
+{
+	return false;
+}
+
+int
+DatabaseListModel::iter_n_children_vfunc(const iterator &iter) const
+{
+	return 0;
+}
+
+int
+DatabaseListModel::iter_n_root_children_vfunc() const
+{
+	return static_cast<int>(get_n_rows());
+}
+
+bool
+DatabaseListModel::iter_nth_child_vfunc(const iterator &parent,int n,iterator &iter) const
+{
+	return false;
+}
+
+bool
+DatabaseListModel::iter_nth_root_child_vfunc(int n,iterator &iter) const
+{
+	if (n < 0 || !_index_is_valid(static_cast<size_t>(n)))
+		return false;
+	_set_iter(iter,static_cast<size_t>(n));
+	return true;
+}
+
+bool
+DatabaseListModel::iter_parent_vfunc(const iterator &child,iterator &iter) const
+{
+	return false;
+}
+
+Gtk::TreeModel::Path
+DatabaseListModel::get_path_vfunc(const iterator &iter) const
+{
+	Path path;
+	if (iter_is_valid(iter))
+		path.push_back(static_cast<int>(_get_index(iter)));
+	return path;
+}
+
+bool
+DatabaseListModel::get_iter_vfunc(const Path &path,iterator &iter) const
+{
+	if (path.size() != 1 || path[0] < 0)
+		return false;
+
+	size_t index = static_cast<size_t>(path[0]);
+	if (!_index_is_valid(index))
+		return false;
+	_set_iter(iter,index);
+	return true;
+}
+
+bool
+DatabaseListModel::iter_is_valid(const iterator &iter) const
+{
+	return (iter.get_stamp() == m_stamp_ && _index_is_valid(_get_index(iter)));
+}
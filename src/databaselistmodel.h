@@ -0,0 +1,142 @@
+/***************************************************************************
+ *            databaselistmodel.h
+ *
+ *  Di Oktober 20 09:12:44 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * databaselistmodel.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DATABASELISTMODEL_H__
+#define __DATABASELISTMODEL_H__
+
+#include <glibmm/object.h>
+#include <gtkmm/treemodel.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "refclass.h"
+
+/*******************************************************************************
+ * DatabaseListModel
+ ******************************************************************************/
+
+/*
+ * A flat Gtk::TreeModel that does not copy its rows. Only the number of rows
+ * is queried up front. The rows themselves are fetched page by page through
+ * fetch_rows_vfunc() the first time GTK asks for a value of one of them. At
+ * most max_pages pages are kept in memory; the least recently used page is
+ * dropped first.
+ *
+ * The model is read-only and does not track changes in the database. Views
+ * create a new model when they refresh. Use it with a Gtk::TreeView in fixed
+ * height mode, otherwise the view measures (and so fetches) every row.
+ */
+class DatabaseListModel:
+	public Glib::Object,
+	public Gtk::TreeModel
+{
+	private:
+		std::vector<GType> m_column_types_;
+		int m_stamp_;
+		size_t m_page_size_;
+		size_t m_max_pages_;
+		bool m_reversed_;
+
+		mutable bool m_n_rows_valid_;
+		mutable size_t m_n_rows_;
+		mutable std::map<size_t,std::vector<Glib::RefPtr<RefClass> > > m_pages_;
+		mutable std::list<size_t> m_page_lru_;
+
+	private:
+		DatabaseListModel(const DatabaseListModel &src) = delete;
+		DatabaseListModel& operator=(const DatabaseListModel &src) = delete;
+
+	protected:
+		DatabaseListModel(const Gtk::TreeModelColumnRecord &columns,
+		                  size_t page_size = 256,
+		                  size_t max_pages = 8);
+
+	public:
+		virtual ~DatabaseListModel();
+
+	private:
+		bool _index_is_valid(size_t index) const;
+		const Glib::RefPtr<RefClass>& _get_item(size_t index) const;
+		size_t _get_index(const iterator &iter) const;
+		void _set_iter(iterator &iter,size_t index) const;
+
+	public:
+		size_t get_n_rows() const;
+
+		/*! Get the item shown in the row iter points to. */
+		Glib::RefPtr<RefClass> get_item(const iterator &iter) const;
+
+		/*! Show the rows in reverse order. Has to be called before the
+		 * model is set on a view.
+		 */
+		void set_reversed(bool reversed);
+		bool get_reversed() const;
+
+		/*! Drop all cached pages. They are fetched again when needed. */
+		void clear_cache();
+
+	protected:
+		virtual size_t count_rows_vfunc() const = 0;
+		virtual std::list<Glib::RefPtr<RefClass> > fetch_rows_vfunc(size_t offset,size_t limit) const = 0;
+		virtual void get_item_value_vfunc(const Glib::RefPtr<RefClass> &item,
+		                                  int column,
+		                                  Glib::ValueBase &value) const = 0;
+
+		template <class T>
+		static void set_value(Glib::ValueBase &value,const T &data)
+		{
+			Glib::Value<T> value_specific;
+			value_specific.init(Glib::Value<T>::value_type());
+			value_specific.set(data);
+
+			value.init(Glib::Value<T>::value_type());
+			value = value_specific;
+		}
+
+	protected:
+		virtual Gtk::TreeModelFlags get_flags_vfunc() const override;
+		virtual int get_n_columns_vfunc() const override;
+		virtual GType get_column_type_vfunc(int index) const override;
+		virtual void get_value_vfunc(const iterator &iter,
+		                             int column,
+		                             Glib::ValueBase &value) const override;
+
+		virtual bool iter_next_vfunc(const iterator &iter,iterator &iter_next) const override;
+		virtual bool iter_children_vfunc(const iterator &parent,iterator &iter) const override;
+		virtual bool iter_has_child_vfunc(const iterator &iter) const override;
+		virtual int iter_n_children_vfunc(const iterator &iter) const override;
+		virtual int iter_n_root_children_vfunc() const override;
+		virtual bool iter_nth_child_vfunc(const iterator &parent,int n,iterator &iter) const override;
+		virtual bool iter_nth_root_child_vfunc(int n,iterator &iter) const override;
+		virtual bool iter_parent_vfunc(const iterator &child,iterator &iter) const override;
+		virtual Path get_path_vfunc(const iterator &iter) const override;
+		virtual bool get_iter_vfunc(const Path &path,iterator &iter) const override;
+		virtual bool iter_is_valid(const iterator &iter) const override;
+}; // DatabaseListModel class
+
+#endif /* __DATABASELISTMODEL_H__ */
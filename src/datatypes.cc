@@ -20,12 +20,15 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "datatypes.h"
+#include "pool.h"
 
 #ifdef HAVE_CONFIG_H
 # include "config.h"
 #endif
 
 #include <cassert>
+#include <mutex>
+#include <unordered_map>
 
 /*******************************************************************************
  * Breeder
@@ -56,6 +59,18 @@ Breeder::Breeder(uint64_t id,
 Breeder::~Breeder()
 {}
 
+void*
+Breeder::operator new(size_t size)
+{
+	return pool_allocate(size);
+}
+
+void
+Breeder::operator delete(void *ptr, size_t size)
+{
+	pool_deallocate(ptr, size);
+}
+
 Glib::RefPtr<Breeder>
 Breeder::create(const Glib::ustring &name,
                 const std::string &homepage)
@@ -103,6 +118,69 @@ Breeder::set_homepage(const std::string &homepage)
 	m_homepage_ = homepage;
 }
 
+/*******************************************************************************
+ * breeder name table
+ ******************************************************************************/
+
+static std::mutex _breeder_name_mutex;
+static std::unordered_map<uint64_t,std::shared_ptr<const Glib::ustring> > _breeder_names;
+static uint64_t _breeder_name_lookups = 0;
+static uint64_t _breeder_name_hits = 0;
+static uint64_t _breeder_name_bytes_shared = 0;
+
+std::shared_ptr<const Glib::ustring>
+breeder_name_intern(uint64_t breeder_id, const Glib::ustring &name)
+{
+	// unsaved strains have no breeder id to key the table with
+	if (!breeder_id)
+		return std::make_shared<const Glib::ustring>(name);
+
+	std::lock_guard<std::mutex> lock(_breeder_name_mutex);
+	++_breeder_name_lookups;
+	
+	auto iter = _breeder_names.find(breeder_id);
+	if (iter != _breeder_names.end() && *(iter->second) == name) {
+		++_breeder_name_hits;
+		_breeder_name_bytes_shared += name.bytes();
+		return iter->second;
+	}
+
+	std::shared_ptr<const Glib::ustring> ret = std::make_shared<const Glib::ustring>(name);
+	_breeder_names[breeder_id] = ret;
+	return ret;
+}
+
+void
+breeder_name_invalidate(uint64_t breeder_id)
+{
+	std::lock_guard<std::mutex> lock(_breeder_name_mutex);
+	_breeder_names.erase(breeder_id);
+}
+
+void
+breeder_name_table_clear()
+{
+	std::lock_guard<std::mutex> lock(_breeder_name_mutex);
+	_breeder_names.clear();
+}
+
+BreederNameTableStats
+breeder_name_table_get_stats()
+{
+	BreederNameTableStats stats;
+	
+	std::lock_guard<std::mutex> lock(_breeder_name_mutex);
+	stats.entries = _breeder_names.size();
+	stats.bytes = 0;
+	for (auto iter = _breeder_names.begin(); iter != _breeder_names.end(); ++iter)
+		stats.bytes += iter->second->bytes();
+	stats.lookups = _breeder_name_lookups;
+	stats.hits = _breeder_name_hits;
+	stats.bytes_shared = _breeder_name_bytes_shared;
+
+	return stats;
+}
+
 /*******************************************************************************
  * Strain
  ******************************************************************************/
@@ -117,7 +195,7 @@ Strain::Strain(uint64_t breeder_id,
 	RefClass{},
 	m_id_{0},
 	m_breeder_id_{breeder_id},
-	m_breeder_name_{breeder_name},
+	m_breeder_name_{breeder_name_intern(breeder_id,breeder_name)},
 	m_name_{name},
 	m_info_{info},
 	m_description_{desc},
@@ -136,7 +214,7 @@ Strain::Strain(uint64_t id,
 	RefClass{},
 	m_id_{id},
 	m_breeder_id_{breeder_id},
-	m_breeder_name_{breeder_name},
+	m_breeder_name_{breeder_name_intern(breeder_id,breeder_name)},
 	m_name_{name},
 	m_info_{info},
 	m_description_{desc},
@@ -147,6 +225,18 @@ Strain::Strain(uint64_t id,
 Strain::~Strain()
 {}
 
+void*
+Strain::operator new(size_t size)
+{
+	return pool_allocate(size);
+}
+
+void
+Strain::operator delete(void *ptr, size_t size)
+{
+	pool_deallocate(ptr, size);
+}
+
 Glib::RefPtr<Strain>
 Strain::create(uint64_t breeder_id,
                const Glib::ustring &breeder_name,
@@ -184,16 +274,16 @@ Strain::get_breeder_id() const
 	return m_breeder_id_;
 }
 
-Glib::ustring
+const Glib::ustring&
 Strain::get_breeder_name() const
 {
-	return m_breeder_name_;
+	return *m_breeder_name_;
 }
 
 void
 Strain::set_breeder_name(const Glib::ustring &name)
 {
-	m_breeder_name_ = name;
+	m_breeder_name_ = breeder_name_intern(m_breeder_id_,name);
 }
 
 Glib::ustring
@@ -295,6 +385,18 @@ Growlog::~Growlog()
 {
 }
 
+void*
+Growlog::operator new(size_t size)
+{
+	return pool_allocate(size);
+}
+
+void
+Growlog::operator delete(void *ptr, size_t size)
+{
+	pool_deallocate(ptr, size);
+}
+
 Glib::RefPtr<Growlog>
 Growlog::create(const Glib::ustring &title,
                 const Glib::ustring &desc,
@@ -550,6 +652,18 @@ GrowlogEntry::GrowlogEntry(uint64_t id,
 GrowlogEntry::~GrowlogEntry()
 {}
 
+void*
+GrowlogEntry::operator new(size_t size)
+{
+	return pool_allocate(size);
+}
+
+void
+GrowlogEntry::operator delete(void *ptr, size_t size)
+{
+	pool_deallocate(ptr, size);
+}
+
 Glib::RefPtr<GrowlogEntry>
 GrowlogEntry::create(uint64_t growlog_id,
                      const Glib::ustring &text,
@@ -579,7 +693,7 @@ GrowlogEntry::get_growlog_id() const
 	return m_growlog_id_;
 }
 
-Glib::ustring
+const Glib::ustring&
 GrowlogEntry::get_text() const
 {
 	return m_text_;
@@ -637,3 +751,19 @@ GrowlogEntry::get_created_on_format(const Glib::ustring &format) const
 	return ret;
 #endif // !NATIVE_WINDOWS
 }
+
+/*******************************************************************************
+ * StrainStats
+ ******************************************************************************/
+
+double
+StrainStats::get_avg_veg_days() const
+{
+	return (veg_count ? static_cast<double>(veg_days) / veg_count : 0.0);
+}
+
+double
+StrainStats::get_avg_flower_days() const
+{
+	return (flower_count ? static_cast<double>(flower_days) / flower_count : 0.0);
+}
@@ -31,6 +31,8 @@
 #include <glibmm/ustring.h>
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <memory>
 #include <time.h>
 
 class Breeder:
@@ -54,6 +56,9 @@ class Breeder:
 	 public:
 		 virtual ~Breeder();
 
+		 static void* operator new(size_t size);
+		 static void operator delete(void *ptr, size_t size);
+
 	 public:
 		 static Glib::RefPtr<Breeder> create(const Glib::ustring &name,
 		                                     const std::string &homepage = "");
@@ -71,13 +76,38 @@ class Breeder:
 }; // Breeder class
 
 
+/*
+ * Interned breeder names.
+ *
+ * Strain objects share one immutable copy of their breeder's name instead of
+ * carrying their own. The table is keyed by breeder id; an entry is replaced
+ * if the name stored for an id does not match (the breeder has been renamed
+ * or the strain comes from another database), strings already handed out stay
+ * valid for the strains referencing them.
+ */
+
+struct BreederNameTableStats
+{
+	uint64_t entries;
+	uint64_t bytes;
+	uint64_t lookups;
+	uint64_t hits;
+	uint64_t bytes_shared;
+};
+
+std::shared_ptr<const Glib::ustring> breeder_name_intern(uint64_t breeder_id,
+                                                         const Glib::ustring &name);
+void breeder_name_invalidate(uint64_t breeder_id);
+void breeder_name_table_clear();
+BreederNameTableStats breeder_name_table_get_stats();
+
 class Strain:
 	public RefClass
 {
 	private:
 		uint64_t m_id_;
 		uint64_t m_breeder_id_;
-		Glib::ustring m_breeder_name_;
+		std::shared_ptr<const Glib::ustring> m_breeder_name_;
 		Glib::ustring m_name_;
 		Glib::ustring m_info_;
 		Glib::ustring m_description_;
@@ -108,6 +138,9 @@ class Strain:
 	public:
 		virtual ~Strain();
 
+		static void* operator new(size_t size);
+		static void operator delete(void *ptr, size_t size);
+
 	public:
 		static Glib::RefPtr<Strain> create(uint64_t breeder_id,
 		                                   const Glib::ustring &breeder_name,
@@ -129,7 +162,7 @@ class Strain:
 		uint64_t get_id() const;
 		uint64_t get_breeder_id() const;
 
-		Glib::ustring get_breeder_name() const;
+		const Glib::ustring& get_breeder_name() const;
 		void set_breeder_name(const Glib::ustring &breeder_name);
 
 		Glib::ustring get_name() const;
@@ -182,6 +215,9 @@ class Growlog:
 	public:
 		virtual ~Growlog();
 
+		static void* operator new(size_t size);
+		static void operator delete(void *ptr, size_t size);
+
 	public:
 		static Glib::RefPtr<Growlog> create(const Glib::ustring &title,
 		                                    const Glib::ustring &description = Glib::ustring(),
@@ -240,6 +276,9 @@ class GrowlogEntry:
 	public:
 		virtual ~GrowlogEntry();
 
+		static void* operator new(size_t size);
+		static void operator delete(void *ptr, size_t size);
+
 	public:
 		static Glib::RefPtr<GrowlogEntry> create(uint64_t growlog_id,
 		                                         const Glib::ustring &text,
@@ -254,11 +293,63 @@ class GrowlogEntry:
 
 		uint64_t get_growlog_id() const;
 
-		Glib::ustring get_text() const;
+		const Glib::ustring& get_text() const;
 		void set_text(const Glib::ustring &text);
 
 		time_t get_created_on() const;
 		Glib::ustring get_created_on_format(const Glib::ustring &format = DATETIME_ISO_FORMAT) const;
 };
 
+/*
+ * Statistics read from the growlog_stats and strain_stats tables. The
+ * tables are kept current by triggers, so reading them is a single row
+ * lookup instead of a scan of growlog_entry or growlog_strain.
+ */
+
+struct GrowlogStats
+{
+	uint64_t growlog_id = 0;
+	uint64_t entry_count = 0;
+	time_t first_entry_on = 0; // 0 if the growlog has no entries
+	time_t last_entry_on = 0;
+	uint64_t text_bytes = 0;
+};
+
+struct StrainStats
+{
+	uint64_t strain_id = 0;
+	uint64_t growlog_count = 0;
+	uint64_t veg_count = 0;    // growlogs with a flowering date
+	uint64_t veg_days = 0;
+	uint64_t flower_count = 0; // finished growlogs with a flowering date
+	uint64_t flower_days = 0;
+
+	double get_avg_veg_days() const;
+	double get_avg_flower_days() const;
+};
+
+/*
+ * A record of the change_log table, see the database schema. Updates only
+ * carry the row id, the current values have to be read from the table.
+ * Deletes carry the natural key the row had and renames the old and the
+ * new natural key, so both can be applied to other books.
+ */
+
+enum ChangeType
+{
+	CHANGE_UPDATE,
+	CHANGE_DELETE,
+	CHANGE_RENAME
+};
+
+struct ChangeRecord
+{
+	uint64_t seq = 0;
+	ChangeType type = CHANGE_UPDATE;
+	std::string table;   // breeder, strain, growlog, growlog_strain or growlog_entry
+	uint64_t row_id = 0; // the growlog id for growlog_strain
+	Glib::ustring key[3];
+	Glib::ustring new_key[3];
+};
+
 #endif /* __DATATYPES_H__ */
@@ -0,0 +1,218 @@
+//           diagnosticsdialog.cc
+//  Mo Oktober 19 14:21:10 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// diagnosticsdialog.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "diagnosticsdialog.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <glibmm/i18n.h>
+
+#include <gtkmm/box.h>
+#include <gtkmm/buttonbox.h>
+#include <gtkmm/scrolledwindow.h>
+
+#include "querystats.h"
+
+/*******************************************************************************
+ * DiagnosticsDialogColumns
+ ******************************************************************************/
+
+DiagnosticsDialogColumns::DiagnosticsDialogColumns():
+	Gtk::TreeModelColumnRecord{},
+	column_kind{},
+	column_engine{},
+	column_statement{},
+	column_count{},
+	column_total_ms{},
+	column_average_ms{},
+	column_p95_ms{},
+	column_max_ms{},
+	column_rows{},
+	column_bytes{}
+{
+	add(column_kind);
+	add(column_engine);
+	add(column_statement);
+	add(column_count);
+	add(column_total_ms);
+	add(column_average_ms);
+	add(column_p95_ms);
+	add(column_max_ms);
+	add(column_rows);
+	add(column_bytes);
+}
+
+DiagnosticsDialogColumns::~DiagnosticsDialogColumns()
+{}
+
+/*******************************************************************************
+ * DiagnosticsDialog
+ ******************************************************************************/
+
+const char DiagnosticsDialog::TITLE[] = N_("GrowBook: Diagnostics");
+
+DiagnosticsDialog::DiagnosticsDialog():
+	Gtk::Dialog{_(TITLE)},
+	m_columns_{},
+	m_model_{Gtk::ListStore::create(m_columns_)},
+	m_treeview_{},
+	m_refresh_button_{_("Refresh")},
+	m_reset_button_{_("Reset")},
+	m_enabled_button_{_("Collect statistics")}
+{
+	_add_buttons();
+	_add_widgets();
+	refresh();
+
+	set_default_size(800,500);
+	show_all();
+}
+
+DiagnosticsDialog::DiagnosticsDialog(Gtk::Window &parent):
+	Gtk::Dialog{_(TITLE),parent},
+	m_columns_{},
+	m_model_{Gtk::ListStore::create(m_columns_)},
+	m_treeview_{},
+	m_refresh_button_{_("Refresh")},
+	m_reset_button_{_("Reset")},
+	m_enabled_button_{_("Collect statistics")}
+{
+	_add_buttons();
+	_add_widgets();
+	refresh();
+
+	set_default_size(800,500);
+	show_all();
+}
+
+DiagnosticsDialog::~DiagnosticsDialog()
+{}
+
+void
+DiagnosticsDialog::_add_buttons()
+{
+	add_button(_("Close"),Gtk::RESPONSE_CLOSE);
+}
+
+void
+DiagnosticsDialog::_add_widgets()
+{
+	Gtk::Box *box = get_content_area();
+
+	Gtk::ButtonBox *buttonbox = Gtk::manage(new Gtk::ButtonBox(Gtk::ORIENTATION_HORIZONTAL));
+	buttonbox->set_layout(Gtk::BUTTONBOX_START);
+	m_refresh_button_.signal_clicked().connect(sigc::mem_fun(*this,&DiagnosticsDialog::on_refresh_clicked));
+	buttonbox->pack_start(m_refresh_button_,false,false,0);
+	m_reset_button_.signal_clicked().connect(sigc::mem_fun(*this,&DiagnosticsDialog::on_reset_clicked));
+	buttonbox->pack_start(m_reset_button_,false,false,0);
+	m_enabled_button_.set_active(query_stats_get_enabled());
+	m_enabled_button_.signal_toggled().connect(sigc::mem_fun(*this,&DiagnosticsDialog::on_enabled_toggled));
+	buttonbox->pack_start(m_enabled_button_,false,false,0);
+	box->pack_start(*buttonbox,false,false,3);
+
+	Gtk::ScrolledWindow *scrolled = Gtk::manage(new Gtk::ScrolledWindow());
+	scrolled->set_policy(Gtk::POLICY_AUTOMATIC,Gtk::POLICY_AUTOMATIC);
+
+	m_treeview_.set_model(m_model_);
+	m_treeview_.append_column(_("Kind"),m_columns_.column_kind);
+	m_treeview_.append_column(_("Engine"),m_columns_.column_engine);
+	m_treeview_.append_column(_("Statement"),m_columns_.column_statement);
+	m_treeview_.append_column(_("Count"),m_columns_.column_count);
+	m_treeview_.append_numeric_column(_("Total [ms]"),m_columns_.column_total_ms,"%.3f");
+	m_treeview_.append_numeric_column(_("Avg [ms]"),m_columns_.column_average_ms,"%.3f");
+	m_treeview_.append_numeric_column(_("p95 [ms]"),m_columns_.column_p95_ms,"%.3f");
+	m_treeview_.append_numeric_column(_("Max [ms]"),m_columns_.column_max_ms,"%.3f");
+	m_treeview_.append_column(_("Rows"),m_columns_.column_rows);
+	m_treeview_.append_column(_("Bytes"),m_columns_.column_bytes);
+
+	Gtk::TreeViewColumn *column = m_treeview_.get_column(2);
+	if (column) {
+		column->set_expand(true);
+		column->set_resizable(true);
+	}
+	
+	// sort by column
+	Gtk::TreeModelColumnBase *sort_columns[] = {
+		&m_columns_.column_kind,
+		&m_columns_.column_engine,
+		&m_columns_.column_statement,
+		&m_columns_.column_count,
+		&m_columns_.column_total_ms,
+		&m_columns_.column_average_ms,
+		&m_columns_.column_p95_ms,
+		&m_columns_.column_max_ms,
+		&m_columns_.column_rows,
+		&m_columns_.column_bytes
+	};
+	for (unsigned int i = 0; i < sizeof(sort_columns) / sizeof(sort_columns[0]); ++i) {
+		column = m_treeview_.get_column(i);
+		if (column)
+			column->set_sort_column(*(sort_columns[i]));
+	}
+	m_model_->set_sort_column(m_columns_.column_total_ms,Gtk::SORT_DESCENDING);
+
+	scrolled->add(m_treeview_);
+	box->pack_start(*scrolled,true,true,0);
+}
+
+void
+DiagnosticsDialog::refresh()
+{
+	m_model_->clear();
+
+	std::list<QueryStatSnapshot> snapshots = query_stats_get_snapshots();
+	for (auto iter = snapshots.begin(); iter != snapshots.end(); ++iter) {
+		if (!iter->count)
+			continue;
+		
+		Gtk::TreeModel::Row row = *(m_model_->append());
+		row[m_columns_.column_kind] = (iter->kind == QUERY_STAT_METHOD ? _("Method") : _("SQL"));
+		row[m_columns_.column_engine] = iter->engine;
+		row[m_columns_.column_statement] = iter->key;
+		row[m_columns_.column_count] = iter->count;
+		row[m_columns_.column_total_ms] = static_cast<double>(iter->total_ns) / 1000000.0;
+		row[m_columns_.column_average_ms] = iter->get_average_ms();
+		row[m_columns_.column_p95_ms] = iter->get_percentile_ms(95.0);
+		row[m_columns_.column_max_ms] = static_cast<double>(iter->max_ns) / 1000000.0;
+		row[m_columns_.column_rows] = iter->rows;
+		row[m_columns_.column_bytes] = iter->bytes;
+	}
+}
+
+void
+DiagnosticsDialog::on_refresh_clicked()
+{
+	refresh();
+}
+
+void
+DiagnosticsDialog::on_reset_clicked()
+{
+	query_stats_reset();
+	refresh();
+}
+
+void
+DiagnosticsDialog::on_enabled_toggled()
+{
+	query_stats_set_enabled(m_enabled_button_.get_active());
+}
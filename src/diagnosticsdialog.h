@@ -0,0 +1,93 @@
+/***************************************************************************
+ *            diagnosticsdialog.h
+ *
+ *  Mo Oktober 19 14:21:10 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * diagnosticsdialog.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DIAGNOSTICSDIALOG_H__
+#define __DIAGNOSTICSDIALOG_H__
+
+#include <gtkmm/dialog.h>
+#include <gtkmm/treeview.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/button.h>
+#include <gtkmm/checkbutton.h>
+
+#include <cstdint>
+
+class DiagnosticsDialogColumns:
+	public Gtk::TreeModelColumnRecord
+{
+	public:
+		Gtk::TreeModelColumn<Glib::ustring> column_kind;
+		Gtk::TreeModelColumn<Glib::ustring> column_engine;
+		Gtk::TreeModelColumn<Glib::ustring> column_statement;
+		Gtk::TreeModelColumn<uint64_t> column_count;
+		Gtk::TreeModelColumn<double> column_total_ms;
+		Gtk::TreeModelColumn<double> column_average_ms;
+		Gtk::TreeModelColumn<double> column_p95_ms;
+		Gtk::TreeModelColumn<double> column_max_ms;
+		Gtk::TreeModelColumn<uint64_t> column_rows;
+		Gtk::TreeModelColumn<uint64_t> column_bytes;
+
+	public:
+		DiagnosticsDialogColumns();
+		virtual ~DiagnosticsDialogColumns();
+};
+
+class DiagnosticsDialog:
+	public Gtk::Dialog
+{
+	public:
+		using Columns=DiagnosticsDialogColumns;
+
+	private:
+		static const char TITLE[];
+
+	private:
+		Columns m_columns_;
+		Glib::RefPtr<Gtk::ListStore> m_model_;
+		Gtk::TreeView m_treeview_;
+		Gtk::Button m_refresh_button_;
+		Gtk::Button m_reset_button_;
+		Gtk::CheckButton m_enabled_button_;
+
+	public:
+		DiagnosticsDialog();
+		DiagnosticsDialog(Gtk::Window &parent);
+		virtual ~DiagnosticsDialog();
+
+	private:
+		void _add_buttons();
+		void _add_widgets();
+
+	public:
+		void refresh();
+
+	private:
+		void on_refresh_clicked();
+		void on_reset_clicked();
+		void on_enabled_toggled();
+};
+
+#endif /* __DIAGNOSTICSDIALOG_H__ */
@@ -25,36 +25,25 @@
 
 #include "export.h"
 
-#ifdef HAVE_CONFIG_H
-# include "config.h"
-#endif
-
 #include <glibmm/i18n.h>
 #include <glibmm.h>
 
-#include <gtkmm/messagedialog.h>
-
 #include <cassert>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <time.h>
 
 #include <unistd.h>
 
-#include "application.h"
-
-struct indent {
-	unsigned depth;
-	inline indent(unsigned i):depth(i) {};
-};
-
-std::fstream& operator<<(std::fstream &f,  const indent &in)
-{
-	for (unsigned i=0; i<in.depth; ++i) {
-		f << "  ";
-	}
-	return f;
-}
+#include "compression.h"
+#include "database-mirror.h"
+#include "database-sqlite3.h"
+#include "error.h"
+#include "ndjson.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "xml_exporter.h"
 
 /*******************************************************************************
  * Exporter
@@ -106,13 +95,8 @@ Exporter::file_exists() const
 void
 Exporter::export_db()
 {
-	export_vfunc(*app->get_appwindow());
-}
-
-void
-Exporter::export_db(Gtk::Window &parent)
-{
-	export_vfunc(parent);
+	TRACE_SCOPE("export","Exporter::export_db");
+	export_vfunc();
 }
 
 /*******************************************************************************
@@ -137,157 +121,158 @@ XML_Exporter::create(const Glib::RefPtr<Database> &database,
 }
 
 void
-XML_Exporter::export_vfunc(Gtk::Window &parent)
+XML_Exporter::export_vfunc()
 {
+	TRACE_SCOPE("export","XML_Exporter::export_vfunc");
+
+	// the file is compressed if its name ends with ".gz" or ".zst"
+	CompressionType compression = compression_type_for_filename(get_filename());
+	if (!compression_is_available(compression)) {
+		Glib::ustring msg = _("Compression is not supported by this build!");
+		msg += "\n(";
+		msg += compression_type_name(compression);
+		msg += ")";
+		throw Glib::FileError(Glib::FileError::FAILED,msg);
+	}
 	
 	std::fstream of;
+	std::ios_base::openmode mode = std::fstream::out;
+	if (compression != COMPRESSION_NONE)
+		mode |= std::fstream::binary;
 	if (Glib::file_test(get_filename(),Glib::FILE_TEST_EXISTS)) { 
-		of.open(get_filename(), std::fstream::out | std::fstream::trunc);
+		of.open(get_filename(), mode | std::fstream::trunc);
 	} else {
-		of.open(get_filename(), std::fstream::out);
+		of.open(get_filename(), mode);
 	}
 	
-	if (!of.is_open()) {
-		Gtk::MessageDialog dialog(parent,
-		                   		  _("Unable to open file for writing!"),
-		                          false,
-		                          Gtk::MESSAGE_ERROR,
-		                          Gtk::BUTTONS_OK,
-		                          true);
-		dialog.run();
-		dialog.hide();
-		return;		                   
+	if (!of.is_open())
+		throw Glib::FileError(Glib::FileError::FAILED,_("Unable to open file for writing!"));
+
+	bool failed = false;
+	if (compression == COMPRESSION_NONE) {
+		xml_export_database(get_database(),of);
+	} else {
+		std::unique_ptr<CompressOutputBuffer> buffer = CompressOutputBuffer::create(of.rdbuf(),compression);
+		std::ostream out(buffer.get());
+		xml_export_database(get_database(),out);
+		failed = (out.fail() || !buffer->finish());
 	}
 
-	of << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-	of << "<growbook>\n";
-
-	// Export Breeder;
-	of << indent(1) << "<breeders>\n";
-	std::list<Glib::RefPtr<Breeder> > breeders(get_database()->get_breeders());
-	for (auto iter = breeders.begin(); iter != breeders.end(); ++iter) {
-		Glib::RefPtr<Breeder> b = *iter;
-		of << indent(2) << "<breeder>\n";
-		of << indent(3) << "<name>" << escape_text(b->get_name())<< "</name>\n";
-		if (!b->get_homepage().empty()) {
-			of << indent(3) << "<homepage>" << escape_text(b->get_homepage()) << "</homepage>\n";
-		}
+	of.close();
+	if (failed || of.fail())
+		throw Glib::FileError(Glib::FileError::FAILED,_("Writing file failed!"));
+}
 
-		of << indent(3) << "<strains>\n";
-		std::list<Glib::RefPtr<Strain> > strains(get_database()->get_strains_for_breeder(b->get_id()));
-		// export strains
-		for (auto iter = strains.begin(); iter != strains.end(); ++iter) {
-			Glib::RefPtr<Strain> s = *iter;
-			of << indent(4) << "<strain>\n";
-			of << indent(5) << "<name>" << escape_text(s->get_name()) << "</name>\n";
-			if (!s->get_homepage().empty()) {
-				of << indent(5) << "<homepage>" << escape_text(s->get_homepage()) << "</homepage>\n";
-			}			
-			if (!s->get_seedfinder().empty()) {
-				of << indent(5) << "<seedfinder>" << escape_text(s->get_seedfinder()) << "</seedfinder>\n";
-			}
-			if (!s->get_info().empty()) {
-				of << indent(5) << "<info><![CDATA[" << s->get_info() << "]]></info>\n";
-			}
-			if (!s->get_description().empty()) {
-				of << indent(5) << "<description><![CDATA[" 
-					<< s->get_description() 
-					<< "]]></description>\n";
-			}
-			// end strain
-			of << indent(4) << "</strain>\n";
-		}
-		of << indent(3) << "</strains>\n";
+/*******************************************************************************
+ * Snapshot_Exporter
+ ******************************************************************************/
 
-		// end breeder
-		of << indent(2) << "</breeder>\n";
-	}
-	// end breeders
-	breeders.clear();
-	of << indent(1) << "</breeders>" << std::endl;
-	
-	// export growlogs
-	
-	of << indent(1) << "<growlogs>\n";
-	std::list<Glib::RefPtr<Growlog> > growlogs(get_database()->get_growlogs());
-	for (auto iter = growlogs.begin(); iter != growlogs.end(); ++iter) {
-		Glib::RefPtr<Growlog> gl = *iter;
-		
-		of << indent(2) << "<growlog>\n";
-		of << indent(3) << "<title>" << escape_text(gl->get_title()) << "</title>\n";
-		of << indent(3) << "<created_on>" 
-			<< escape_text(gl->get_created_on_format()) 
-			<< "</created_on>\n";
-
-		if (gl->get_flower_on()) {
-			of << indent(3) << "<flower_on>" 
-				<< escape_text(gl->get_flower_on_format()) 
-				<< "</flower_on>\n";
-		}
-			
-		if (gl->get_finished_on()) {
-			of << indent(3) << "<finished_on>" 
-				<< escape_text(gl->get_finished_on_format()) 
-				<< "</finished_on>\n";
-		}
-		
-		if (!gl->get_description().empty()) { 
-			of << indent(3) << "<description><![CDATA[" 
-				<< gl->get_description() 
-				<< "]]></description>\n";
-		}
+Snapshot_Exporter::Snapshot_Exporter(const Glib::RefPtr<Database> &database,
+                                     const std::string &filename):
+	Exporter(database,filename)
+{
+}
 
-		of << indent(3) << "<strains>\n";
-		std::list<Glib::RefPtr<Strain> > strains 
-			= get_database()->get_strains_for_growlog(gl->get_id());
-		for (auto iter = strains.begin(); iter != strains.end(); ++iter) {
-			Glib::RefPtr<Strain> strain = *iter;
-			of << indent(4) << "<strain>\n";
+Snapshot_Exporter::~Snapshot_Exporter()
+{
+}
 
-			of << indent(5) << "<breeder>" 
-				<< escape_text(strain->get_breeder_name())
-				<< "</breeder>\n";
+Glib::RefPtr<Snapshot_Exporter>
+Snapshot_Exporter::create(const Glib::RefPtr<Database> &database,
+                          const std::string &filename)
+{
+	return Glib::RefPtr<Snapshot_Exporter>(new Snapshot_Exporter(database,filename));
+}
 
-			of << indent(5) << "<name>"
-				<< escape_text(strain->get_name())
-				<< "</name>\n";
-			
-			of << indent(4) << "</strain>\n";
-		}
-		of << indent(3) << "</strains>\n";
+void
+Snapshot_Exporter::export_vfunc()
+{
+	TRACE_SCOPE("export","Snapshot_Exporter::export_vfunc");
+
+	std::fstream of(get_filename(),std::fstream::out | std::fstream::binary | std::fstream::trunc);
+	if (!of.is_open())
+		throw Glib::FileError(Glib::FileError::FAILED,_("Unable to open file for writing!"));
+
+	snapshot_export_database(get_database(),of);
+
+	of.close();
+	if (of.fail())
+		throw Glib::FileError(Glib::FileError::FAILED,_("Writing file failed!"));
+}
+
+/*******************************************************************************
+ * NDJSON_Exporter
+ ******************************************************************************/
 
-		of << indent(3) << "<entries>\n";
-		std::list<Glib::RefPtr<GrowlogEntry> > entries 
-			= get_database()->get_growlog_entries(gl);
-		for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
-			Glib::RefPtr<GrowlogEntry> entry = *iter;
-			of << indent(4) << "<entry>\n";
+NDJSON_Exporter::NDJSON_Exporter(const Glib::RefPtr<Database> &database,
+                                 const std::string &filename):
+	Exporter(database,filename),
+	m_incremental_{}
+{
+}
 
-			of << indent(5) << "<created_on>"
-				<< escape_text(entry->get_created_on_format())
-				<< "</created_on>\n";
+NDJSON_Exporter::~NDJSON_Exporter()
+{
+}
 
-			of << indent(5) << "<text><![CDATA["
-				<< entry->get_text()
-				<< "]]></text>\n";
+Glib::RefPtr<NDJSON_Exporter>
+NDJSON_Exporter::create(const Glib::RefPtr<Database> &database,
+                        const std::string &filename)
+{
+	return Glib::RefPtr<NDJSON_Exporter>(new NDJSON_Exporter(database,filename));
+}
 
-			of << indent(4) << "</entry>\n";
+void
+NDJSON_Exporter::set_incremental(const Glib::ustring &watermark_name)
+{
+	m_incremental_ = watermark_name;
+}
+
+const Glib::ustring&
+NDJSON_Exporter::get_incremental() const
+{
+	return m_incremental_;
+}
+
+void
+NDJSON_Exporter::export_vfunc()
+{
+	TRACE_SCOPE("export","NDJSON_Exporter::export_vfunc");
+
+	// server books get their change log from 'growbook-cli rebuild-stats',
+	// the file is left alone when it is missing
+	uint64_t upto = 0;
+	if (!m_incremental_.empty()) {
+		try {
+			upto = get_database()->get_change_seq();
+		} catch (DatabaseError &ex) {
+			Glib::ustring msg = _("The database has no change log, run 'growbook-cli rebuild-stats' to add it!");
+			msg += "\n(";
+			msg += ex.what();
+			msg += ")";
+			throw DatabaseError(msg);
 		}
-		of << indent(3) << "</entries>\n";
-		
-		of << indent(2) << "</growlog>\n";
 	}
-	of << indent(1) << "</growlogs>\n";
 
-	of << "</growbook>" << std::endl;
+	std::fstream of(get_filename(),std::fstream::out | std::fstream::binary | std::fstream::trunc);
+	if (!of.is_open())
+		throw Glib::FileError(Glib::FileError::FAILED,_("Unable to open file for writing!"));
+
+	if (m_incremental_.empty()) {
+		ndjson_export_database(get_database(),of);
+	} else {
+		ndjson_export_changes(get_database(),
+		                      get_database()->get_change_watermark(m_incremental_),
+		                      upto,
+		                      of);
+	}
 
 	of.close();
-}
+	if (of.fail())
+		throw Glib::FileError(Glib::FileError::FAILED,_("Writing file failed!"));
 
-Glib::ustring
-XML_Exporter::escape_text(const Glib::ustring &txt) const
-{
-	return Glib::Markup::escape_text(txt); 
+	if (!m_incremental_.empty())
+		get_database()->set_change_watermark(m_incremental_,upto);
 }
 
 /*******************************************************************************
@@ -296,7 +281,8 @@ XML_Exporter::escape_text(const Glib::ustring &txt) const
 
 DB_Exporter::DB_Exporter(const Glib::RefPtr<Database> &database,
                    const std::string &filename):
-	Exporter(database,filename)
+	Exporter(database,filename),
+	m_signal_progress_{}
 {
 }
 
@@ -310,12 +296,19 @@ DB_Exporter::create(const Glib::RefPtr<Database> &db,
 {
 	return Glib::RefPtr<DB_Exporter>(new DB_Exporter(db,filename));
 }
+
+sigc::signal<void,uint64_t,uint64_t>&
+DB_Exporter::signal_progress()
+{
+	return m_signal_progress_;
+}
                               
 
 
 void
-DB_Exporter::export_vfunc(Gtk::Window &parent)
+DB_Exporter::export_vfunc()
 {
+	TRACE_SCOPE("export","DB_Exporter::export_vfunc");
 	m_strain_map_.clear();
 	m_breeder_map_.clear();
 
@@ -326,27 +319,45 @@ DB_Exporter::export_vfunc(Gtk::Window &parent)
 		unlink(get_filename().c_str());
 #endif
 
+	if (_export_backup())
+		return;
+
 	Glib::RefPtr<DatabaseModule> dbmodule = db_get_module("sqlite3");
 	Glib::RefPtr<DatabaseSettings> settings = DatabaseSettings::create("sqlite3",
 	                                                                   get_filename(),
 	                                                                   DB_NAME_IS_FILENAME);
 	Glib::RefPtr<Database> db = dbmodule->create_database(settings);
+	db->connect();
+	db->create_database();
+	
+	_export_strains(db);
+	_export_growlogs(db);
+}
+
+// Returns false if the database can not be copied as a whole.
+bool
+DB_Exporter::_export_backup()
+{
+	Glib::RefPtr<DatabaseSqlite3> db = Glib::RefPtr<DatabaseSqlite3>::cast_dynamic(get_database());
+	// a mirror holds its outbox and id map, the export gets the rows only
+	if (!db || Glib::RefPtr<DatabaseMirror>::cast_dynamic(get_database()))
+		return false;
+
 	try {
-		db->connect();
-		db->create_database();
-	} catch (DatabaseError ex) {
-		Gtk::MessageDialog dialog(parent,ex.what(),false,Gtk::MESSAGE_ERROR,Gtk::BUTTONS_OK,true);
-		dialog.run();
-		dialog.hide();
+		db->backup(get_filename(),m_signal_progress_.make_slot());
+	} catch (DatabaseError &ex) {
+#ifdef NATIVE_WINDOWS
+		_unlink(get_filename().c_str());
+#else
+		unlink(get_filename().c_str());
+#endif
+		throw;
 	}
-	
-	_export_strains(parent,db);
-	_export_growlogs(parent,db);
+	return true;
 }
 
 void
-DB_Exporter::_export_strains(Gtk::Window &parent,
-                          const Glib::RefPtr<Database> &dbexport)
+DB_Exporter::_export_strains(const Glib::RefPtr<Database> &dbexport)
 {
 	std::list<Glib::RefPtr<Breeder> > breeder_list{get_database()->get_breeders()};
 
@@ -380,10 +391,10 @@ DB_Exporter::_export_strains(Gtk::Window &parent,
 }
 
 void
-DB_Exporter::_export_growlogs(Gtk::Window &parent,
-                           const Glib::RefPtr<Database> &dbexport)
+DB_Exporter::_export_growlogs(const Glib::RefPtr<Database> &dbexport)
 {
 	std::list<Glib::RefPtr<Growlog> > growlog_list{get_database()->get_growlogs()};
+	uint64_t n_growlogs = 0;
 
 	for (auto growlog_iter = growlog_list.begin(); growlog_iter != growlog_list.end(); ++growlog_iter) {
 		Glib::RefPtr<Growlog> growlog0 = *growlog_iter;
@@ -416,137 +427,6 @@ DB_Exporter::_export_growlogs(Gtk::Window &parent,
 			                                                         entry0->get_created_on());
 			dbexport->add_growlog_entry(entry1);
 		}
+		m_signal_progress_.emit(++n_growlogs,growlog_list.size());
 	}
 }
-
-/*******************************************************************************
- * ExportDialog
- ******************************************************************************/
-
-const char ExportDialog::TITLE[] = N_("GrowBook: Export");
-
-ExportDialog::ExportDialog(const Glib::RefPtr<Database> &db):
-	Gtk::FileChooserDialog{_(TITLE),Gtk::FILE_CHOOSER_ACTION_SAVE},
-	m_database_{db}
-{
-	_add_buttons();
-	_configure();
-
-	show_all();
-}
-
-ExportDialog::ExportDialog(Gtk::Window &parent,
-                           const Glib::RefPtr<Database> &db):
-	Gtk::FileChooserDialog{parent,_(TITLE),Gtk::FILE_CHOOSER_ACTION_SAVE},
-	m_database_{db}
-{
-	_add_buttons();
-	_configure();
-
-	show_all();
-}
-
-ExportDialog::~ExportDialog()
-{
-}
-
-void
-ExportDialog::_add_buttons()
-{
-	add_button(_("Apply"), Gtk::RESPONSE_APPLY);
-	add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
-}
-
-enum ExportFilter {
-	EXPORT_FILTER_XML,
-	EXPORT_FILTER_DB
-};
-
-static const char *EXPORT_FILTER[] {
-	N_("Growbook File"),
-	N_("SQLite3 Database")
-};
-
-void
-ExportDialog::_configure()
-{
-	set_create_folders(true);
-
-	Glib::RefPtr<Gtk::FileFilter> filter = Gtk::FileFilter::create();
-	filter->set_name(_(EXPORT_FILTER[EXPORT_FILTER_XML]));
-	filter->add_pattern("*.growbook");
-	add_filter(filter);
-
-	filter = Gtk::FileFilter::create();
-	filter->set_name(EXPORT_FILTER[EXPORT_FILTER_DB]);
-	filter->add_pattern("*.db");
-	add_filter(filter);
-	
-	time_t t = time(nullptr);
-	tm *datetime;
-	
-#ifdef NATIVE_WINDOWS
-	datetime = localtime(&t);
-#else
-	datetime = new tm;
-	if (!localtime_r(&t,datetime))
-		std::cerr << "Time conversion failed!" << std::endl;
-#endif
-	char date[12];
-	strftime(date,12,DATE_ISO_FORMAT,datetime);
-	
-	std::string filename = date;
-	filename += ".growbook";
-
-	
-	set_filename(Glib::build_filename(Glib::get_user_special_dir (Glib::USER_DIRECTORY_DOCUMENTS),
-	                                  filename));
-	set_current_name(filename);
-}
-
-static bool _has_ending(const std::string &s, const std::string &end) {
-	if (s.length() >= end.length())
-		return (0 == s.compare(s.length() - end.length(), end.length(), end));
-		
-	return false;
-}
-
-Glib::RefPtr<Exporter>
-ExportDialog::get_exporter()
-{
-	std::string filename = get_filename();
-	Glib::RefPtr<Exporter> exporter{};
-	if (filename.empty())
-		return exporter;
-
-	if (Glib::file_test(filename, Glib::FILE_TEST_EXISTS)) {
-		Glib::ustring msg = _("File already exists!");
-		Gtk::MessageDialog dialog(*this,
-		                          msg,
-		                          false,
-		                          Gtk::MESSAGE_QUESTION,
-		                          Gtk::BUTTONS_YES_NO,
-		                          true);
-		dialog.set_secondary_text(_("Do you want to overwrite the file?"));
-		if (dialog.run() == Gtk::RESPONSE_YES) {
-#ifdef NATIVE_WINDOWS
-			_unlink(filename.c_str());
-#else
-			unlink(filename.c_str());
-#endif // NATIVE_WINDOWS
-		} else {
-			return exporter;
-		}
-	}
-	Glib::RefPtr<Gtk::FileFilter> filter = get_filter();
-	if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_XML])) {
-		if (!_has_ending(filename, ".growbook"))
-			filename += ".growbook";
-		exporter = XML_Exporter::create(m_database_,filename);
-	} else if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_DB])) {
-		if (!_has_ending(filename, ".db"))
-			filename += ".db";
-		exporter = DB_Exporter::create(m_database_, filename);		
-	}
-	return exporter;
-}
@@ -27,7 +27,7 @@
 #ifndef __EXPORT_H__
 #define __EXPORT_H__
 
-#include <gtkmm/filechooserdialog.h>
+#include <map>
 #include <string>
 #include <cstdint>
 
@@ -60,11 +60,11 @@ class Exporter:
 		 Glib::RefPtr<Database> get_database();
 		 Glib::RefPtr<const Database> get_database() const;
 
+		 // Errors are thrown as DatabaseError or Glib::FileError.
 		 void export_db();
-		 void export_db(Gtk::Window &parent);
 
 	protected:
-		 virtual void export_vfunc(Gtk::Window &parent) = 0;
+		 virtual void export_vfunc() = 0;
 		 
 };
 
@@ -92,13 +92,73 @@ class XML_Exporter:
 		                                          const std::string &filename);
 
 	protected:
-		virtual void export_vfunc(Gtk::Window &parent);
+		virtual void export_vfunc();
+};
+
+/******************************************************************************/
 
+// Writes a binary snapshot, see snapshot.h.
+class Snapshot_Exporter:
+	public Exporter
+{
 	private:
-		Glib::ustring escape_text(const Glib::ustring &text) const;
+		 Snapshot_Exporter(const Snapshot_Exporter &src) = delete;
+		 Snapshot_Exporter& operator = (const Snapshot_Exporter &src) = delete;
+
+	protected:
+		 Snapshot_Exporter(const Glib::RefPtr<Database> &db,
+		                   const std::string &filename);
+
+	public:
+		 virtual ~Snapshot_Exporter();
+
+		 static Glib::RefPtr<Snapshot_Exporter> create(const Glib::RefPtr<Database> &db,
+		                                               const std::string &filename);
+
+	protected:
+		virtual void export_vfunc();
 };
 
 /******************************************************************************/
+
+// Writes newline delimited JSON, see ndjson.h.
+//
+// With set_incremental() only the changes since the last export under
+// the same name are written as a delta. The first one writes every row.
+// The watermark is moved on only after the file was written.
+class NDJSON_Exporter:
+	public Exporter
+{
+	 private:
+		 Glib::ustring m_incremental_;
+
+	private:
+		 NDJSON_Exporter(const NDJSON_Exporter &src) = delete;
+		 NDJSON_Exporter& operator = (const NDJSON_Exporter &src) = delete;
+
+	protected:
+		 NDJSON_Exporter(const Glib::RefPtr<Database> &db,
+		                 const std::string &filename);
+
+	public:
+		 virtual ~NDJSON_Exporter();
+
+		 static Glib::RefPtr<NDJSON_Exporter> create(const Glib::RefPtr<Database> &db,
+		                                             const std::string &filename);
+
+	public:
+		 // An empty name writes the whole database.
+		 void set_incremental(const Glib::ustring &watermark_name);
+		 const Glib::ustring& get_incremental() const;
+
+	protected:
+		virtual void export_vfunc();
+};
+
+/******************************************************************************/
+
+// Writes a sqlite3 book. A sqlite3 source is copied page by page with the
+// online backup API, other databases row by row.
 class DB_Exporter:
 	public Exporter
 {
@@ -107,6 +167,8 @@ class DB_Exporter:
 		 std::map<uint64_t,Glib::RefPtr<Strain> > m_strain_map_;
 		 std::map<uint64_t,Glib::RefPtr<Growlog> > m_growlog_map_;
 		 
+	 private:
+		 sigc::signal<void,uint64_t,uint64_t> m_signal_progress_;
 
 	private:
 		 DB_Exporter(const Exporter &src) = delete;
@@ -121,39 +183,19 @@ class DB_Exporter:
 	public:
 		 static Glib::RefPtr<DB_Exporter> create(const Glib::RefPtr<Database> &database,
 		                        	             const std::string &filename);
+
+		 // Emitted with the work done and the total, in pages for a
+		 // sqlite3 source and in growlogs otherwise.
+		 sigc::signal<void,uint64_t,uint64_t>& signal_progress();
 	
 	protected:
-		virtual void export_vfunc(Gtk::Window &parent);
+		virtual void export_vfunc();
 		
 	private:
-		 void _export_strains(Gtk::Window &parent,
-		                      const Glib::RefPtr<Database> &export_database);
-		 void _export_growlogs(Gtk::Window &parent,
-		                       const Glib::RefPtr<Database> &export_database);
+		 bool _export_backup();
+		 void _export_strains(const Glib::RefPtr<Database> &export_database);
+		 void _export_growlogs(const Glib::RefPtr<Database> &export_database);
 };
 	
 
-class ExportDialog:
-	public Gtk::FileChooserDialog
-{
-	 private:
-		 static const char TITLE[];
-
-	 private:
-			Glib::RefPtr<Database> m_database_;
-		
-	 public:
-		 ExportDialog(const Glib::RefPtr<Database> &database);
-		 ExportDialog(Gtk::Window &parent,
-		              const Glib::RefPtr<Database> &database);
-		 virtual ~ExportDialog();
-
-	 private:
-		 void _add_buttons();
-		 void _configure();
-
-	public:
-		Glib::RefPtr<Exporter> get_exporter();
-};
-
 #endif /* __EXPORT_H__ */
@@ -0,0 +1,221 @@
+//           exportdialog.cc
+//  Di Oktober 20 18:14:22 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// exportdialog.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "exportdialog.h"
+
+#include <glibmm/i18n.h>
+#include <glibmm.h>
+
+#include <gtkmm/messagedialog.h>
+
+#include <iostream>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "compression.h"
+
+/*******************************************************************************
+ * ExportDialog
+ ******************************************************************************/
+
+const char ExportDialog::TITLE[] = N_("GrowBook: Export");
+
+ExportDialog::ExportDialog(const Glib::RefPtr<Database> &db):
+	Gtk::FileChooserDialog{_(TITLE),Gtk::FILE_CHOOSER_ACTION_SAVE},
+	m_database_{db}
+{
+	_add_buttons();
+	_configure();
+
+	show_all();
+}
+
+ExportDialog::ExportDialog(Gtk::Window &parent,
+                           const Glib::RefPtr<Database> &db):
+	Gtk::FileChooserDialog{parent,_(TITLE),Gtk::FILE_CHOOSER_ACTION_SAVE},
+	m_database_{db}
+{
+	_add_buttons();
+	_configure();
+
+	show_all();
+}
+
+ExportDialog::~ExportDialog()
+{
+}
+
+void
+ExportDialog::_add_buttons()
+{
+	add_button(_("Apply"), Gtk::RESPONSE_APPLY);
+	add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
+}
+
+enum ExportFilter {
+	EXPORT_FILTER_XML,
+	EXPORT_FILTER_DB,
+	EXPORT_FILTER_XML_GZIP,
+	EXPORT_FILTER_XML_ZSTD,
+	EXPORT_FILTER_SNAPSHOT,
+	EXPORT_FILTER_NDJSON
+};
+
+static const char *EXPORT_FILTER[] {
+	N_("Growbook File"),
+	N_("SQLite3 Database"),
+	N_("Growbook File (gzip compressed)"),
+	N_("Growbook File (zstd compressed)"),
+	N_("Growbook Snapshot"),
+	N_("Newline delimited JSON")
+};
+
+void
+ExportDialog::_configure()
+{
+	set_create_folders(true);
+
+	Glib::RefPtr<Gtk::FileFilter> filter = Gtk::FileFilter::create();
+	filter->set_name(_(EXPORT_FILTER[EXPORT_FILTER_XML]));
+	filter->add_pattern("*.growbook");
+	add_filter(filter);
+
+	if (compression_is_available(COMPRESSION_GZIP)) {
+		filter = Gtk::FileFilter::create();
+		filter->set_name(_(EXPORT_FILTER[EXPORT_FILTER_XML_GZIP]));
+		filter->add_pattern("*.growbook.gz");
+		add_filter(filter);
+	}
+	if (compression_is_available(COMPRESSION_ZSTD)) {
+		filter = Gtk::FileFilter::create();
+		filter->set_name(_(EXPORT_FILTER[EXPORT_FILTER_XML_ZSTD]));
+		filter->add_pattern("*.growbook.zst");
+		add_filter(filter);
+	}
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(EXPORT_FILTER[EXPORT_FILTER_DB]);
+	filter->add_pattern("*.db");
+	add_filter(filter);
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_(EXPORT_FILTER[EXPORT_FILTER_SNAPSHOT]));
+	filter->add_pattern("*.gbsnap");
+	add_filter(filter);
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_(EXPORT_FILTER[EXPORT_FILTER_NDJSON]));
+	filter->add_pattern("*.ndjson");
+	add_filter(filter);
+	
+	time_t t = time(nullptr);
+	tm *datetime;
+	
+#ifdef NATIVE_WINDOWS
+	datetime = localtime(&t);
+#else
+	datetime = new tm;
+	if (!localtime_r(&t,datetime))
+		std::cerr << "Time conversion failed!" << std::endl;
+#endif
+	char date[12];
+	strftime(date,12,DATE_ISO_FORMAT,datetime);
+	
+	std::string filename = date;
+	filename += ".growbook";
+
+	
+	set_filename(Glib::build_filename(Glib::get_user_special_dir (Glib::USER_DIRECTORY_DOCUMENTS),
+	                                  filename));
+	set_current_name(filename);
+}
+
+static bool _has_ending(const std::string &s, const std::string &end) {
+	if (s.length() >= end.length())
+		return (0 == s.compare(s.length() - end.length(), end.length(), end));
+		
+	return false;
+}
+
+Glib::RefPtr<Exporter>
+ExportDialog::get_exporter()
+{
+	std::string filename = get_filename();
+	Glib::RefPtr<Exporter> exporter{};
+	if (filename.empty())
+		return exporter;
+
+	if (Glib::file_test(filename, Glib::FILE_TEST_EXISTS)) {
+		Glib::ustring msg = _("File already exists!");
+		Gtk::MessageDialog dialog(*this,
+		                          msg,
+		                          false,
+		                          Gtk::MESSAGE_QUESTION,
+		                          Gtk::BUTTONS_YES_NO,
+		                          true);
+		dialog.set_secondary_text(_("Do you want to overwrite the file?"));
+		if (dialog.run() == Gtk::RESPONSE_YES) {
+#ifdef NATIVE_WINDOWS
+			_unlink(filename.c_str());
+#else
+			unlink(filename.c_str());
+#endif // NATIVE_WINDOWS
+		} else {
+			return exporter;
+		}
+	}
+	Glib::RefPtr<Gtk::FileFilter> filter = get_filter();
+	if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_XML])) {
+		if (!_has_ending(filename, ".growbook"))
+			filename += ".growbook";
+		exporter = XML_Exporter::create(m_database_,filename);
+	} else if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_XML_GZIP])) {
+		if (_has_ending(filename, ".growbook"))
+			filename += ".gz";
+		else if (!_has_ending(filename, ".growbook.gz"))
+			filename += ".growbook.gz";
+		exporter = XML_Exporter::create(m_database_,filename);
+	} else if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_XML_ZSTD])) {
+		if (_has_ending(filename, ".growbook"))
+			filename += ".zst";
+		else if (!_has_ending(filename, ".growbook.zst"))
+			filename += ".growbook.zst";
+		exporter = XML_Exporter::create(m_database_,filename);
+	} else if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_DB])) {
+		if (!_has_ending(filename, ".db"))
+			filename += ".db";
+		exporter = DB_Exporter::create(m_database_, filename);		
+	} else if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_SNAPSHOT])) {
+		if (!_has_ending(filename, ".gbsnap"))
+			filename += ".gbsnap";
+		exporter = Snapshot_Exporter::create(m_database_,filename);
+	} else if (filter->get_name() == _(EXPORT_FILTER[EXPORT_FILTER_NDJSON])) {
+		if (!_has_ending(filename, ".ndjson"))
+			filename += ".ndjson";
+		exporter = NDJSON_Exporter::create(m_database_,filename);
+	}
+	return exporter;
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+ *            exportdialog.h
+ *
+ *  Di Oktober 20 18:14:22 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * exportdialog.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __EXPORTDIALOG_H__
+#define __EXPORTDIALOG_H__
+
+#include <gtkmm/filechooserdialog.h>
+
+#include "export.h"
+
+class ExportDialog:
+	public Gtk::FileChooserDialog
+{
+	 private:
+		 static const char TITLE[];
+
+	 private:
+			Glib::RefPtr<Database> m_database_;
+		
+	 public:
+		 ExportDialog(const Glib::RefPtr<Database> &database);
+		 ExportDialog(Gtk::Window &parent,
+		              const Glib::RefPtr<Database> &database);
+		 virtual ~ExportDialog();
+
+	 private:
+		 void _add_buttons();
+		 void _configure();
+
+	public:
+		Glib::RefPtr<Exporter> get_exporter();
+};
+
+#endif /* __EXPORTDIALOG_H__ */
@@ -0,0 +1,799 @@
+//           growbook-bench.cc
+//  Di Oktober 20 15:08:51 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// growbook-bench.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+// growbook-bench populates a database with a synthetic catalogue and times
+// every public Database method on it. The results are written as JSON, so
+// runs can be compared across commits.
+//
+// Usage:
+//   growbook-bench [--breeders=N] [--strains=M] [--growlogs=K] [--entries=E]
+//                  [--iterations=I] [--seed=S] [--sqlite3=FILE]
+//                  [--postgresql=USER:PASSWORD@HOST:PORT/DBNAME]
+//                  [--mariadb=USER:PASSWORD@HOST:PORT/DBNAME]
+//                  [--output=FILE]
+//
+// M is the total number of strains and E the number of entries per growlog.
+// The sqlite3 book is written to FILE, FILE.import and FILE.target, which
+// must not exist, and deleted afterwards.
+// The server backends are only benchmarked if a connection is given (or
+// GROWBOOK_BENCH_POSTGRESQL/GROWBOOK_BENCH_MARIADB is set); they need an
+// empty database, the schema is created by the benchmark.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <glibmm.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "database.h"
+#include "datatypes.h"
+#include "error.h"
+#include "export.h"
+#include "import.h"
+#include "pool.h"
+#include "querystats.h"
+#include "random.h"
+#include "strainindex.h"
+#include "snapshot.h"
+#include "xml_exporter.h"
+
+/*******************************************************************************
+ * BenchConfig
+ ******************************************************************************/
+
+struct BenchConfig
+{
+	unsigned int breeders;
+	unsigned int strains;
+	unsigned int growlogs;
+	unsigned int entries;
+	unsigned int iterations;
+	uint64_t seed;
+	std::string sqlite3_file;
+	std::string postgresql;
+	std::string mariadb;
+	std::string output;
+};
+
+struct BenchResult
+{
+	std::string method;
+	std::vector<double> samples_us;
+};
+
+/*******************************************************************************
+ * helpers
+ ******************************************************************************/
+
+// the benchmark has to pick the same rows on every run
+static std::string
+_random_text(Random &random, size_t length)
+{
+	static const char *words[] = {
+		"watered", "topped", "trained", "nutrients", "ph", "ec", "leaves",
+		"yellowing", "stretch", "buds", "trichomes", "defoliated", "flush",
+		"humidity", "temperature", "light", "cycle", "roots", "transplant"
+	};
+	std::string text;
+	while (text.size() < length) {
+		if (!text.empty())
+			text += ' ';
+		text += words[random.below(sizeof(words) / sizeof(words[0]))];
+	}
+	return text;
+}
+
+static double
+_percentile(const std::vector<double> &sorted, double p)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t rank = static_cast<size_t>((p / 100.0) * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(rank,sorted.size() - 1)];
+}
+
+static bool
+_parse_server(const std::string &spec,
+              std::string &user,
+              std::string &password,
+              std::string &host,
+              uint16_t &port,
+              std::string &dbname)
+{
+	// USER:PASSWORD@HOST:PORT/DBNAME
+	size_t at = spec.rfind('@');
+	size_t slash = spec.find('/',(at == std::string::npos ? 0 : at));
+	if (at == std::string::npos || slash == std::string::npos)
+		return false;
+
+	std::string credentials = spec.substr(0,at);
+	std::string address = spec.substr(at + 1,slash - at - 1);
+	dbname = spec.substr(slash + 1);
+
+	size_t colon = credentials.find(':');
+	user = credentials.substr(0,colon);
+	password = (colon == std::string::npos ? "" : credentials.substr(colon + 1));
+
+	colon = address.rfind(':');
+	host = address.substr(0,colon);
+	port = (colon == std::string::npos ? 0 : static_cast<uint16_t>(std::stoul(address.substr(colon + 1))));
+
+	return !(user.empty() || host.empty() || dbname.empty());
+}
+
+// discards everything, the export benchmark should not measure the disk
+class NullStreamBuffer: public std::streambuf
+{
+	protected:
+		virtual int_type overflow(int_type c) override
+		{
+			return traits_type::not_eof(c);
+		}
+		virtual std::streamsize xsputn(const char*, std::streamsize n) override
+		{
+			return n;
+		}
+};
+
+/*******************************************************************************
+ * Bench
+ ******************************************************************************/
+
+class Bench
+{
+	private:
+		const BenchConfig &m_config_;
+		Glib::RefPtr<Database> m_database_;
+		Random m_random_;
+		std::vector<BenchResult> m_results_;
+		double m_populate_seconds_;
+		double m_export_mb_per_s_;
+		double m_export_serial_mb_per_s_;
+		double m_snapshot_export_mb_per_s_;
+
+		std::vector<Glib::RefPtr<Breeder> > m_breeders_;
+		std::vector<Glib::RefPtr<Strain> > m_strains_;
+		std::vector<Glib::RefPtr<Growlog> > m_growlogs_;
+		std::vector<Glib::RefPtr<GrowlogEntry> > m_entries_;
+		
+	public:
+		Bench(const BenchConfig &config,
+		      const Glib::RefPtr<Database> &database);
+		~Bench();
+
+	private:
+		BenchResult& _result(const std::string &method);
+		void _time(const std::string &method, const std::function<void()> &func);
+		void _repeat(const std::string &method, unsigned int n, const std::function<void(unsigned int)> &func);
+		size_t _pick(size_t n);
+
+		void _populate();
+		void _run_reads();
+		void _run_export();
+		void _run_import();
+		void _run_writes();
+		void _run_connection();
+
+	public:
+		void run();
+		void write_json(std::ostream &out) const;
+};
+
+Bench::Bench(const BenchConfig &config,
+             const Glib::RefPtr<Database> &database):
+	m_config_{config},
+	m_database_{database},
+	m_random_{config.seed ? config.seed : 1},
+	m_results_{},
+	m_populate_seconds_{0.0},
+	m_export_mb_per_s_{0.0},
+	m_export_serial_mb_per_s_{0.0},
+	m_snapshot_export_mb_per_s_{0.0}
+{}
+
+Bench::~Bench()
+{}
+
+BenchResult&
+Bench::_result(const std::string &method)
+{
+	for (auto &result: m_results_) {
+		if (result.method == method)
+			return result;
+	}
+	m_results_.push_back(BenchResult{method,{}});
+	return m_results_.back();
+}
+
+void
+Bench::_time(const std::string &method, const std::function<void()> &func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	_result(method).samples_us.push_back(std::chrono::duration<double,std::micro>(elapsed).count());
+}
+
+void
+Bench::_repeat(const std::string &method, unsigned int n, const std::function<void(unsigned int)> &func)
+{
+	BenchResult &result = _result(method);
+	result.samples_us.reserve(result.samples_us.size() + n);
+	for (unsigned int i = 0; i < n; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		func(i);
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		result.samples_us.push_back(std::chrono::duration<double,std::micro>(elapsed).count());
+	}
+}
+
+size_t
+Bench::_pick(size_t n)
+{
+	return m_random_.below(n);
+}
+
+void
+Bench::_populate()
+{
+	auto start = std::chrono::steady_clock::now();
+	Glib::RefPtr<Database> db = m_database_;
+	
+	for (unsigned int i = 0; i < m_config_.breeders; ++i) {
+		std::string name = "Bench Breeder " + std::to_string(i + 1);
+		_time("add_breeder(breeder)",[&](){
+			db->add_breeder(Breeder::create(name,"https://breeder" + std::to_string(i + 1) + ".example.org"));
+		});
+		m_breeders_.push_back(db->get_breeder(name));
+	}
+
+	for (unsigned int i = 0; i < m_config_.strains && !m_breeders_.empty(); ++i) {
+		Glib::RefPtr<Breeder> breeder = m_breeders_[i % m_breeders_.size()];
+		std::string name = "Bench Strain " + std::to_string(i + 1);
+		_time("add_strain(strain)",[&](){
+			db->add_strain(Strain::create(breeder->get_id(),
+			                              breeder->get_name(),
+			                              name,
+			                              _random_text(m_random_,40),
+			                              _random_text(m_random_,400),
+			                              "",
+			                              ""));
+		});
+		m_strains_.push_back(db->get_strain(breeder->get_name(),name));
+	}
+
+	time_t now = time(nullptr);
+	for (unsigned int i = 0; i < m_config_.growlogs; ++i) {
+		std::string title = "Bench Growlog " + std::to_string(i + 1);
+		time_t created_on = now - ((m_config_.growlogs - i) * 86400 * 7);
+		// every third growlog is still running
+		time_t flower_on = (i % 3 ? created_on + 30 * 86400 : 0);
+		time_t finished_on = (i % 3 ? created_on + 100 * 86400 : 0);
+		_time("add_growlog(growlog)",[&](){
+			db->add_growlog(Growlog::create(title,_random_text(m_random_,200),created_on,flower_on,finished_on));
+		});
+		Glib::RefPtr<Growlog> growlog = db->get_growlog(title);
+		m_growlogs_.push_back(growlog);
+
+		if (!m_strains_.empty()) {
+			for (unsigned int j = 0; j < 2; ++j) {
+				Glib::RefPtr<Strain> strain = m_strains_[_pick(m_strains_.size())];
+				_time("add_strain_for_growlog(growlog,strain)",[&](){
+					try {
+						db->add_strain_for_growlog(growlog,strain);
+					} catch (DatabaseError &ex) {
+						// the same strain picked twice
+					}
+				});
+			}
+		}
+
+		for (unsigned int j = 0; j < m_config_.entries; ++j) {
+			std::string text = _random_text(m_random_,100 + _pick(900));
+			_time("add_growlog_entry(entry)",[&](){
+				db->add_growlog_entry(GrowlogEntry::create(growlog->get_id(),text,created_on + j * 3600));
+			});
+		}
+	}
+	for (auto &growlog: m_growlogs_) {
+		std::list<Glib::RefPtr<GrowlogEntry> > entries = db->get_growlog_entries(growlog);
+		m_entries_.insert(m_entries_.end(),entries.begin(),entries.end());
+	}
+
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	m_populate_seconds_ = std::chrono::duration<double>(elapsed).count();
+}
+
+void
+Bench::_run_reads()
+{
+	Glib::RefPtr<Database> db = m_database_;
+	unsigned int n = m_config_.iterations;
+	
+	_repeat("get_breeders()",n,[&](unsigned int){ db->get_breeders(); });
+	if (!m_breeders_.empty()) {
+		_repeat("get_breeder(id)",n,[&](unsigned int){
+			db->get_breeder(m_breeders_[_pick(m_breeders_.size())]->get_id());
+		});
+		_repeat("get_breeder(name)",n,[&](unsigned int){
+			db->get_breeder(m_breeders_[_pick(m_breeders_.size())]->get_name());
+		});
+		_repeat("get_strains_for_breeder(breeder_id)",n,[&](unsigned int){
+			db->get_strains_for_breeder(m_breeders_[_pick(m_breeders_.size())]->get_id());
+		});
+	}
+	if (!m_strains_.empty()) {
+		_repeat("get_strain(id)",n,[&](unsigned int){
+			db->get_strain(m_strains_[_pick(m_strains_.size())]->get_id());
+		});
+		_repeat("get_strain(breeder_name,strain_name)",n,[&](unsigned int){
+			Glib::RefPtr<Strain> strain = m_strains_[_pick(m_strains_.size())];
+			db->get_strain(strain->get_breeder_name(),strain->get_name());
+		});
+		_repeat("get_growlogs_for_strain(strain_id)",n,[&](unsigned int){
+			db->get_growlogs_for_strain(m_strains_[_pick(m_strains_.size())]->get_id());
+		});
+
+		// type-ahead search of the strain chooser
+		Glib::RefPtr<StrainIndex> index = StrainIndex::create();
+		_time("StrainIndex::build(database)",[&](){ index->build(db); });
+		_repeat("StrainIndex::lookup(query)",n,[&](unsigned int){
+			Glib::ustring name = m_strains_[_pick(m_strains_.size())]->get_name();
+			index->lookup(name.substr(0,3));
+		});
+	}
+	_repeat("get_growlogs()",n,[&](unsigned int){ db->get_growlogs(); });
+	_repeat("get_ongoing_growlogs()",n,[&](unsigned int){ db->get_ongoing_growlogs(); });
+	_repeat("get_finished_growlogs()",n,[&](unsigned int){ db->get_finished_growlogs(); });
+	if (!m_growlogs_.empty()) {
+		_repeat("get_growlog(id)",n,[&](unsigned int){
+			db->get_growlog(m_growlogs_[_pick(m_growlogs_.size())]->get_id());
+		});
+		_repeat("get_growlog(title)",n,[&](unsigned int){
+			db->get_growlog(m_growlogs_[_pick(m_growlogs_.size())]->get_title());
+		});
+		_repeat("get_strains_for_growlog(growlog_id)",n,[&](unsigned int){
+			db->get_strains_for_growlog(m_growlogs_[_pick(m_growlogs_.size())]->get_id());
+		});
+		_repeat("get_growlog_entries(growlog_id)",n,[&](unsigned int){
+			db->get_growlog_entries(m_growlogs_[_pick(m_growlogs_.size())]->get_id());
+		});
+		_repeat("get_growlog_entry_count(growlog_id)",n,[&](unsigned int){
+			db->get_growlog_entry_count(m_growlogs_[_pick(m_growlogs_.size())]->get_id());
+		});
+		// one page of the entry view, as fetched by GrowlogViewEntryModel
+		_repeat("get_growlog_entries(growlog_id,offset,limit)",n,[&](unsigned int){
+			db->get_growlog_entries(m_growlogs_[_pick(m_growlogs_.size())]->get_id(),0,256);
+		});
+	}
+	if (!m_entries_.empty()) {
+		_repeat("get_growlog_entry(id)",n,[&](unsigned int){
+			db->get_growlog_entry(m_entries_[_pick(m_entries_.size())]->get_id());
+		});
+	}
+}
+
+void
+Bench::_run_export()
+{
+	NullStreamBuffer buffer;
+	std::ostream out(&buffer);
+	uint64_t bytes = 0;
+
+	// one thread and one thread per CPU, the output is the same
+	auto start = std::chrono::steady_clock::now();
+	_time("xml_export_database(database,out,1)",[&](){
+		bytes = xml_export_database(m_database_,out,1);
+	});
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (seconds > 0.0)
+		m_export_serial_mb_per_s_ = (bytes / (1024.0 * 1024.0)) / seconds;
+
+	start = std::chrono::steady_clock::now();
+	_time("xml_export_database(database,out)",[&](){
+		bytes = xml_export_database(m_database_,out);
+	});
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (seconds > 0.0)
+		m_export_mb_per_s_ = (bytes / (1024.0 * 1024.0)) / seconds;
+
+	start = std::chrono::steady_clock::now();
+	_time("snapshot_export_database(database,out)",[&](){
+		bytes = snapshot_export_database(m_database_,out);
+	});
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (seconds > 0.0)
+		m_snapshot_export_mb_per_s_ = (bytes / (1024.0 * 1024.0)) / seconds;
+}
+
+// Scans a copy of the catalogue against the catalogue, where every item
+// conflicts, and imports it into empty sqlite3 books, merged by sqlite3
+// and object by object.
+void
+Bench::_run_import()
+{
+	std::string source = m_config_.sqlite3_file + ".import";
+	std::string target = m_config_.sqlite3_file + ".target";
+	unlink(source.c_str());
+	DB_Exporter::create(m_database_,source)->export_db();
+
+	_time("DB_Importer::scan()",[&](){
+		DB_Importer::create(m_database_,source)->scan();
+	});
+
+	Glib::RefPtr<DatabaseModule> sqlite3_module = db_get_module("sqlite3");
+	for (int merge_in_engine = 1; merge_in_engine >= 0; --merge_in_engine) {
+		unlink(target.c_str());
+		Glib::RefPtr<Database> db = sqlite3_module->create_database(DatabaseSettings::create("sqlite3",
+		                                                                                     target,
+		                                                                                     DB_NAME_IS_FILENAME));
+		db->connect();
+		db->create_database();
+
+		Glib::RefPtr<DB_Importer> importer = DB_Importer::create(db,source);
+		importer->set_merge_in_engine(merge_in_engine);
+		_time((merge_in_engine ? "DB_Importer::import_db()[sqlite3 merge]" : "DB_Importer::import_db()[objects]"),[&](){
+			importer->import_db();
+		});
+		db->close();
+	}
+	unlink(target.c_str());
+	unlink(source.c_str());
+}
+
+void
+Bench::_run_writes()
+{
+	Glib::RefPtr<Database> db = m_database_;
+	unsigned int n = m_config_.iterations;
+
+	// updates go through the add_* methods with an id
+	if (!m_breeders_.empty()) {
+		_repeat("add_breeder(breeder)[update]",n,[&](unsigned int){
+			Glib::RefPtr<Breeder> breeder = m_breeders_[_pick(m_breeders_.size())];
+			db->add_breeder(breeder);
+		});
+	}
+	if (!m_growlogs_.empty()) {
+		_repeat("add_growlog(growlog)[update]",n,[&](unsigned int){
+			db->add_growlog(m_growlogs_[_pick(m_growlogs_.size())]);
+		});
+	}
+
+	// removal works on rows created for that purpose, so the catalogue
+	// stays the same for the next backend
+	Glib::RefPtr<Breeder> breeder;
+	std::vector<Glib::RefPtr<Strain> > strains;
+	std::vector<Glib::RefPtr<Growlog> > growlogs;
+	
+	db->add_breeder(Breeder::create("Bench Remove Breeder"));
+	breeder = db->get_breeder("Bench Remove Breeder");
+	for (unsigned int i = 0; i < n; ++i) {
+		std::string name = "Bench Remove Strain " + std::to_string(i + 1);
+		db->add_strain(Strain::create(breeder->get_id(),breeder->get_name(),name,"","","",""));
+		strains.push_back(db->get_strain(breeder->get_name(),name));
+
+		std::string title = "Bench Remove Growlog " + std::to_string(i + 1);
+		db->add_growlog(Growlog::create(title));
+		growlogs.push_back(db->get_growlog(title));
+		db->add_growlog_entry(GrowlogEntry::create(growlogs.back()->get_id(),"remove me"));
+		db->add_strain_for_growlog(growlogs.back(),strains.back());
+	}
+
+	_repeat("remove_strain_for_growlog(growlog,strain)",n,[&](unsigned int i){
+		db->remove_strain_for_growlog(growlogs[i],strains[i]);
+	});
+	_repeat("remove_growlog_entry(entry)",n,[&](unsigned int i){
+		std::list<Glib::RefPtr<GrowlogEntry> > entries = db->get_growlog_entries(growlogs[i]);
+		if (!entries.empty())
+			db->remove_growlog_entry(entries.front());
+	});
+	_repeat("remove_growlog(growlog)",n,[&](unsigned int i){
+		db->remove_growlog(growlogs[i]);
+	});
+	_repeat("remove_strain(strain)",n,[&](unsigned int i){
+		db->remove_strain(strains[i]);
+	});
+	_time("remove_breeder(breeder)",[&](){
+		db->remove_breeder(breeder);
+	});
+}
+
+void
+Bench::_run_connection()
+{
+	Glib::RefPtr<Database> db = m_database_;
+	unsigned int n = m_config_.iterations;
+	
+	_repeat("is_connected()",n,[&](unsigned int){ db->is_connected(); });
+	_repeat("test_connection()",n,[&](unsigned int){ db->test_connection(); });
+	_repeat("close()+connect()",std::min(n,20u),[&](unsigned int){
+		db->close();
+		db->connect();
+	});
+}
+
+void
+Bench::run()
+{
+	_populate();
+	_run_reads();
+	_run_export();
+	_run_import();
+	_run_writes();
+	_run_connection();
+}
+
+void
+Bench::write_json(std::ostream &out) const
+{
+	out << "      \"populate_seconds\": " << m_populate_seconds_ << ",\n";
+	out << "      \"xml_export_mb_per_s\": " << m_export_mb_per_s_ << ",\n";
+	out << "      \"xml_export_serial_mb_per_s\": " << m_export_serial_mb_per_s_ << ",\n";
+	out << "      \"snapshot_export_mb_per_s\": " << m_snapshot_export_mb_per_s_ << ",\n";
+	out << "      \"methods\": [";
+	bool first = true;
+	for (auto &result: m_results_) {
+		std::vector<double> sorted = result.samples_us;
+		std::sort(sorted.begin(),sorted.end());
+		double total = 0.0;
+		for (auto sample: sorted)
+			total += sample;
+
+		out << (first ? "\n" : ",\n") << "        {\"method\": ";
+		query_stats_write_json_string(out,result.method);
+		out << ", \"count\": " << sorted.size()
+			<< ", \"ops_per_s\": " << (total > 0.0 ? (sorted.size() * 1000000.0) / total : 0.0)
+			<< ", \"p50_us\": " << _percentile(sorted,50.0)
+			<< ", \"p90_us\": " << _percentile(sorted,90.0)
+			<< ", \"p99_us\": " << _percentile(sorted,99.0)
+			<< ", \"max_us\": " << (sorted.empty() ? 0.0 : sorted.back())
+			<< "}";
+		first = false;
+	}
+	out << "\n      ]";
+}
+
+/*******************************************************************************
+ * main
+ ******************************************************************************/
+
+static Glib::RefPtr<Database>
+_create_server_database(const Glib::ustring &engine_prefix, const std::string &spec)
+{
+	Glib::RefPtr<DatabaseModule> module;
+	std::list<Glib::RefPtr<DatabaseModule> > modules = db_get_modules();
+	for (auto iter = modules.begin(); iter != modules.end(); ++iter) {
+		if ((*iter)->get_engine().compare(0,engine_prefix.bytes(),engine_prefix) == 0) {
+			module = *iter;
+			break;
+		}
+	}
+	if (!module) {
+		fprintf(stderr,"growbook-bench: %s support is not compiled in, skipping.\n",engine_prefix.c_str());
+		return Glib::RefPtr<Database>();
+	}
+
+	std::string user,password,host,dbname;
+	uint16_t port = 0;
+	if (!_parse_server(spec,user,password,host,port,dbname)) {
+		fprintf(stderr,"growbook-bench: invalid connection \"%s\" for %s!\n",spec.c_str(),engine_prefix.c_str());
+		return Glib::RefPtr<Database>();
+	}
+	if (!port)
+		port = module->get_defaults()->get_port();
+
+	Glib::RefPtr<DatabaseSettings> settings = DatabaseSettings::create(module->get_engine(),
+	                                                                   dbname,
+	                                                                   host,
+	                                                                   port,
+	                                                                   user,
+	                                                                   password,
+	                                                                   false,
+	                                                                   module->get_defaults()->get_flags());
+	return module->create_database(settings);
+}
+
+static void
+_usage()
+{
+	fprintf(stderr,
+	        "Usage: growbook-bench [--breeders=N] [--strains=M] [--growlogs=K] [--entries=E]\n"
+	        "                      [--iterations=I] [--seed=S] [--sqlite3=FILE]\n"
+	        "                      [--postgresql=USER:PASSWORD@HOST:PORT/DBNAME]\n"
+	        "                      [--mariadb=USER:PASSWORD@HOST:PORT/DBNAME]\n"
+	        "                      [--output=FILE]\n");
+}
+
+static bool
+_parse_option(const char *arg, const char *name, std::string &value)
+{
+	size_t len = strlen(name);
+	if (strncmp(arg,name,len) != 0 || arg[len] != '=')
+		return false;
+	value = arg + len + 1;
+	return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+	BenchConfig config{20,400,100,50,200,42,"","","",""};
+
+	const char *env = getenv("GROWBOOK_BENCH_POSTGRESQL");
+	if (env)
+		config.postgresql = env;
+	env = getenv("GROWBOOK_BENCH_MARIADB");
+	if (env)
+		config.mariadb = env;
+	
+	for (int i = 1; i < argc; ++i) {
+		std::string value;
+		if (_parse_option(argv[i],"--breeders",value)) {
+			config.breeders = std::stoul(value);
+		} else if (_parse_option(argv[i],"--strains",value)) {
+			config.strains = std::stoul(value);
+		} else if (_parse_option(argv[i],"--growlogs",value)) {
+			config.growlogs = std::stoul(value);
+		} else if (_parse_option(argv[i],"--entries",value)) {
+			config.entries = std::stoul(value);
+		} else if (_parse_option(argv[i],"--iterations",value)) {
+			config.iterations = std::stoul(value);
+		} else if (_parse_option(argv[i],"--seed",value)) {
+			config.seed = std::stoull(value);
+		} else if (_parse_option(argv[i],"--sqlite3",value)) {
+			config.sqlite3_file = value;
+		} else if (_parse_option(argv[i],"--postgresql",value)) {
+			config.postgresql = value;
+		} else if (_parse_option(argv[i],"--mariadb",value)) {
+			config.mariadb = value;
+		} else if (_parse_option(argv[i],"--output",value)) {
+			config.output = value;
+		} else {
+			_usage();
+			return (strcmp(argv[i],"--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (config.sqlite3_file.empty()) {
+		config.sqlite3_file = Glib::build_filename(Glib::get_tmp_dir(),
+		                                           "growbook-bench-" + std::to_string(getpid()) + ".db");
+	}
+	// the benchmark deletes its files when it is done, so it only
+	// writes files that do not exist yet
+	for (const char *suffix: {"",".import",".target"}) {
+		std::string filename = config.sqlite3_file + suffix;
+		if (Glib::file_test(filename,Glib::FILE_TEST_EXISTS)) {
+			fprintf(stderr,"growbook-bench: \"%s\" exists, the benchmark needs a new file!\n",filename.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	
+	db_init();
+
+	std::vector<std::pair<std::string,Glib::RefPtr<Database> > > databases;
+
+	Glib::RefPtr<DatabaseModule> sqlite3_module = db_get_module("sqlite3");
+	databases.push_back(std::make_pair("sqlite3",
+	                                   sqlite3_module->create_database(DatabaseSettings::create("sqlite3",
+	                                                                                            config.sqlite3_file,
+	                                                                                            DB_NAME_IS_FILENAME))));
+	if (!config.postgresql.empty()) {
+		Glib::RefPtr<Database> db = _create_server_database("postgresql",config.postgresql);
+		if (db)
+			databases.push_back(std::make_pair("postgresql",db));
+	}
+	if (!config.mariadb.empty()) {
+		Glib::RefPtr<Database> db = _create_server_database("MariaDB",config.mariadb);
+		if (db)
+			databases.push_back(std::make_pair("mariadb",db));
+	}
+
+	std::ofstream file;
+	if (!config.output.empty()) {
+		file.open(config.output);
+		if (!file.is_open()) {
+			fprintf(stderr,"growbook-bench: unable to open \"%s\"!\n",config.output.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	std::ostream &out = (file.is_open() ? static_cast<std::ostream&>(file) : std::cout);
+
+	out << "{\n  \"version\": ";
+	query_stats_write_json_string(out,PACKAGE_VERSION);
+	out << ",\n  \"config\": {\"breeders\": " << config.breeders
+		<< ", \"strains\": " << config.strains
+		<< ", \"growlogs\": " << config.growlogs
+		<< ", \"entries_per_growlog\": " << config.entries
+		<< ", \"iterations\": " << config.iterations
+		<< ", \"seed\": " << config.seed << "},\n";
+	out << "  \"backends\": [";
+
+	int ret = EXIT_SUCCESS;
+	bool first = true;
+	for (auto &entry: databases) {
+		Glib::RefPtr<Database> db = entry.second;
+		out << (first ? "\n" : ",\n") << "    {\n      \"engine\": ";
+		query_stats_write_json_string(out,entry.first);
+		out << ",\n";
+		first = false;
+		
+		try {
+			db->connect();
+			db->create_database();
+			Bench bench(config,db);
+			bench.run();
+			bench.write_json(out);
+			db->close();
+		} catch (DatabaseError &ex) {
+			fprintf(stderr,"growbook-bench: %s: %s\n",entry.first.c_str(),ex.what());
+			out << "      \"error\": ";
+			query_stats_write_json_string(out,ex.what());
+			ret = EXIT_FAILURE;
+		} catch (Glib::FileError &ex) {
+			Glib::ustring message = ex.what();
+			fprintf(stderr,"growbook-bench: %s: %s\n",entry.first.c_str(),message.c_str());
+			out << "      \"error\": ";
+			query_stats_write_json_string(out,message.raw());
+			ret = EXIT_FAILURE;
+		}
+		out << "\n    }";
+	}
+	out << "\n  ],\n";
+
+	BreederNameTableStats names = breeder_name_table_get_stats();
+	out << "  \"breeder_names\": {\"entries\": " << names.entries
+		<< ", \"bytes\": " << names.bytes
+		<< ", \"lookups\": " << names.lookups
+		<< ", \"hits\": " << names.hits
+		<< ", \"bytes_shared\": " << names.bytes_shared << "},\n";
+
+	out << "  \"pools\": [";
+	first = true;
+	for (auto &stats: pool_get_stats()) {
+		out << (first ? "\n" : ",\n") << "    {\"object_size\": " << stats.object_size
+			<< ", \"slabs\": " << stats.slabs
+			<< ", \"allocations\": " << stats.allocations
+			<< ", \"deallocations\": " << stats.deallocations
+			<< ", \"in_use\": " << stats.in_use
+			<< ", \"reserved_bytes\": " << stats.get_reserved_bytes()
+			<< ", \"fragmentation\": " << stats.get_fragmentation() << "}";
+		first = false;
+	}
+	out << "\n  ]\n}\n";
+
+	for (const char *suffix: {"",".import",".target"})
+		unlink((config.sqlite3_file + suffix).c_str());
+	return ret;
+}
@@ -0,0 +1,647 @@
+//           growbook-cli.cc
+//  Di Oktober 20 20:31:45 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// growbook-cli.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+// growbook-cli works on the database configured in the GrowBook settings
+// without GTK, so cron jobs and sensor scripts can use it.
+//
+// Usage:
+//   growbook-cli [--database=FILE] [--password=PASSWORD] [--mirror=FILE] COMMAND [ARGS]
+//
+// Commands:
+//   export [--format=xml|sqlite|snapshot|ndjson] [--incremental=NAME] FILE
+//   import [--breeders=merge|update] [--growlogs=skip|rename] [--offset=BYTES] [--dry-run] FILE
+//   add-entry [--time="YYYY-MM-DD HH:MM:SS"] GROWLOG [TEXT|-]
+//   list-growlogs [--ongoing|--finished]
+//   stats
+//   rebuild-stats
+//   sync
+//
+// GROWLOG is an id or a title. Without TEXT, or with "-", the text is
+// read from stdin. The password may also be given in GROWBOOK_DB_PASSWORD.
+// XML exports to a FILE ending in ".gz" or ".zst" are compressed with gzip
+// or zstd, import recognizes compressed files by their content. Files ending
+// in ".gbsnap" are binary snapshots, see snapshot.h, files ending in
+// ".ndjson" are newline delimited JSON, see ndjson.h. Importing NDJSON
+// starts at --offset and prints the offset behind the last imported line,
+// so a file that is appended to can be imported again from there.
+// "import --dry-run" prints what an import of a .db or XML file would do
+// with the given options and leaves the database alone.
+// "export --incremental=NAME" writes NDJSON with only the changes since
+// the last export with the same NAME, importing it applies the changes.
+// --mirror keeps a local sqlite3 copy of the database in FILE, see
+// database-mirror.h. Commands work on the copy and their changes are sent
+// to the database by a sync at the end when it can be reached; "sync" only
+// syncs and reports the changes that are still waiting and the conflicts.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <glibmm.h>
+#include <glibmm/i18n.h>
+
+#include <cerrno>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef NATIVE_WINDOWS
+# include "strptime.h"
+#endif
+
+#include "database.h"
+#include "database-mirror.h"
+#include "datatypes.h"
+#include "error.h"
+#include "export.h"
+#include "import.h"
+#include "ndjson_importer.h"
+#include "settings.h"
+#include "snapshot_importer.h"
+#include "xml_importer.h"
+
+typedef std::vector<std::string> ArgList;
+
+/*******************************************************************************
+ * helpers
+ ******************************************************************************/
+
+static void
+_usage()
+{
+	fprintf(stderr,
+	        "%s",
+	        _("Usage: growbook-cli [--database=FILE] [--password=PASSWORD] [--mirror=FILE] COMMAND [ARGS]\n"
+	          "\n"
+	          "Commands:\n"
+	          "  export [--format=xml|sqlite|snapshot|ndjson] [--incremental=NAME] FILE\n"
+	          "  import [--breeders=merge|update] [--growlogs=skip|rename] [--offset=BYTES] [--dry-run] FILE\n"
+	          "  add-entry [--time=\"YYYY-MM-DD HH:MM:SS\"] GROWLOG [TEXT|-]\n"
+	          "  list-growlogs [--ongoing|--finished]\n"
+	          "  stats\n"
+	          "  rebuild-stats\n"
+	          "  sync\n"));
+}
+
+static void
+_error(const Glib::ustring &message)
+{
+	fprintf(stderr,"growbook-cli: %s\n",message.c_str());
+}
+
+static bool
+_parse_option(const std::string &arg, const char *name, std::string &value)
+{
+	size_t len = strlen(name);
+	if (arg.compare(0,len,name) != 0 || arg.size() <= len || arg[len] != '=')
+		return false;
+	value = arg.substr(len + 1);
+	return true;
+}
+
+// Accepts decimal digits only, strtoull() would take signs and garbage.
+static bool
+_parse_uint64(const std::string &s, uint64_t &value)
+{
+	if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos)
+		return false;
+
+	errno = 0;
+	unsigned long long n = strtoull(s.c_str(),nullptr,10);
+	if (errno == ERANGE)
+		return false;
+	value = static_cast<uint64_t>(n);
+	return true;
+}
+
+static bool
+_has_ending(const std::string &s, const std::string &end)
+{
+	if (s.length() >= end.length())
+		return (0 == s.compare(s.length() - end.length(), end.length(), end));
+	return false;
+}
+
+static Glib::RefPtr<Database>
+_open_database(const Glib::RefPtr<Settings> &settings,
+               const std::string &filename,
+               const std::string &password,
+               const std::string &mirror)
+{
+	Glib::RefPtr<DatabaseSettings> dbsettings;
+	if (!filename.empty()) {
+		dbsettings = DatabaseSettings::create("sqlite3",filename,DB_NAME_IS_FILENAME);
+	} else {
+		dbsettings = settings->get_database_settings();
+	}
+
+	if (dbsettings->get_ask_password() && dbsettings->get_password().empty()) {
+		if (password.empty()) {
+			_error(_("The database needs a password, use --password or GROWBOOK_DB_PASSWORD!"));
+			return Glib::RefPtr<Database>();
+		}
+		dbsettings->set_password(password);
+	}
+
+	Glib::RefPtr<DatabaseModule> module = db_get_module(dbsettings->get_engine());
+	if (!module) {
+		Glib::ustring msg = _("No database engine!");
+		msg += " (";
+		msg += dbsettings->get_engine();
+		msg += ")";
+		_error(msg);
+		return Glib::RefPtr<Database>();
+	}
+
+	bool create_db = (dbsettings->get_dbname_is_filename()
+	                  && !Glib::file_test(dbsettings->get_dbname(),Glib::FILE_TEST_EXISTS));
+	
+	Glib::RefPtr<Database> db = module->create_database(dbsettings);
+	if (!mirror.empty()) {
+		// the database itself is connected by DatabaseMirror::sync()
+		Glib::RefPtr<DatabaseMirror> db_mirror = DatabaseMirror::create(db,mirror);
+		db_mirror->connect();
+		return db_mirror;
+	}
+	db->connect();
+	if (create_db)
+		db->create_database();
+	return db;
+}
+
+static Glib::RefPtr<Growlog>
+_find_growlog(const Glib::RefPtr<Database> &db, const std::string &growlog)
+{
+	Glib::RefPtr<Growlog> ret = db->get_growlog(Glib::ustring(growlog));
+	if (ret)
+		return ret;
+	
+	uint64_t id = 0;
+	if (_parse_uint64(growlog,id))
+		ret = db->get_growlog(id);
+	return ret;
+}
+
+/*******************************************************************************
+ * commands
+ ******************************************************************************/
+
+static int
+_cmd_export(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	std::string format,filename,incremental;
+	for (auto &arg: args) {
+		std::string value;
+		if (_parse_option(arg,"--format",value)) {
+			format = value;
+		} else if (_parse_option(arg,"--incremental",value)) {
+			incremental = value;
+			if (format.empty())
+				format = "ndjson";
+		} else if (filename.empty()) {
+			filename = arg;
+		} else {
+			_usage();
+			return EXIT_FAILURE;
+		}
+	}
+	if (filename.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+	if (format.empty()) {
+		if (_has_ending(filename,".db"))
+			format = "sqlite";
+		else if (_has_ending(filename,".gbsnap"))
+			format = "snapshot";
+		else if (_has_ending(filename,".ndjson"))
+			format = "ndjson";
+		else
+			format = "xml";
+	}
+
+	Glib::RefPtr<Exporter> exporter;
+	if (format == "xml") {
+		exporter = XML_Exporter::create(db,filename);
+	} else if (format == "sqlite" || format == "sqlite3") {
+		exporter = DB_Exporter::create(db,filename);
+	} else if (format == "snapshot") {
+		exporter = Snapshot_Exporter::create(db,filename);
+	} else if (format == "ndjson") {
+		Glib::RefPtr<NDJSON_Exporter> ndjson_exporter = NDJSON_Exporter::create(db,filename);
+		ndjson_exporter->set_incremental(incremental);
+		exporter = ndjson_exporter;
+	} else {
+		_error(_("Unknown export format!"));
+		return EXIT_FAILURE;
+	}
+	if (!incremental.empty() && format != "ndjson") {
+		_error(_("Incremental exports are only written as NDJSON!"));
+		return EXIT_FAILURE;
+	}
+	exporter->export_db();
+	return EXIT_SUCCESS;
+}
+
+static void
+_print_import_plan(const Glib::RefPtr<const ImportPlan> &plan)
+{
+	printf("breeders\t%llu\n",static_cast<unsigned long long>(plan->get_breeders().size()));
+	printf("existing-breeders\t%llu\n",static_cast<unsigned long long>(plan->get_breeder_conflict_count()));
+	printf("strains\t%llu\n",static_cast<unsigned long long>(plan->get_strain_count()));
+	printf("growlogs\t%llu\n",static_cast<unsigned long long>(plan->get_growlogs().size()));
+	printf("existing-growlogs\t%llu\n",static_cast<unsigned long long>(plan->get_growlog_conflict_count()));
+	printf("growlog-entries\t%llu\n",static_cast<unsigned long long>(plan->get_entry_count()));
+
+	for (auto &item: plan->get_breeders()) {
+		if (item.exists)
+			printf("breeder\t%s\t%s\n",
+			       (item.action == IMPORT_CONFLICT_UPDATE ? "update" : "merge"),
+			       item.name.c_str());
+	}
+	for (auto &item: plan->get_growlogs()) {
+		if (!item.exists)
+			continue;
+		if (item.action == IMPORT_CONFLICT_RENAME) {
+			printf("growlog\trename\t%s\t%s\n",item.name.c_str(),item.new_title.c_str());
+		} else {
+			printf("growlog\tskip\t%s\n",item.name.c_str());
+		}
+	}
+}
+
+static int
+_cmd_import(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	ImportConflictAction breeder_action = IMPORT_CONFLICT_MERGE_ALL;
+	ImportConflictAction growlog_action = IMPORT_CONFLICT_SKIP_ALL;
+	uint64_t offset = 0;
+	bool dry_run = false;
+	std::string filename;
+	
+	for (auto &arg: args) {
+		std::string value;
+		if (arg == "--dry-run") {
+			dry_run = true;
+		} else if (_parse_option(arg,"--breeders",value)) {
+			if (value == "merge") {
+				breeder_action = IMPORT_CONFLICT_MERGE_ALL;
+			} else if (value == "update") {
+				breeder_action = IMPORT_CONFLICT_UPDATE_ALL;
+			} else {
+				_usage();
+				return EXIT_FAILURE;
+			}
+		} else if (_parse_option(arg,"--growlogs",value)) {
+			if (value == "skip") {
+				growlog_action = IMPORT_CONFLICT_SKIP_ALL;
+			} else if (value == "rename") {
+				growlog_action = IMPORT_CONFLICT_RENAME;
+			} else {
+				_usage();
+				return EXIT_FAILURE;
+			}
+		} else if (_parse_option(arg,"--offset",value)) {
+			if (!_parse_uint64(value,offset)) {
+				_usage();
+				return EXIT_FAILURE;
+			}
+		} else if (filename.empty()) {
+			filename = arg;
+		} else {
+			_usage();
+			return EXIT_FAILURE;
+		}
+	}
+	if (filename.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+	if (!Glib::file_test(filename,Glib::FILE_TEST_EXISTS)) {
+		_error(_("File does not exist!"));
+		return EXIT_FAILURE;
+	}
+
+	Glib::RefPtr<Importer> importer;
+	Glib::RefPtr<NDJSON_Importer> ndjson_importer;
+	if (_has_ending(filename,".db")) {
+		importer = DB_Importer::create(db,filename);
+	} else if (_has_ending(filename,".gbsnap")) {
+		importer = Snapshot_Importer::create(db,filename);
+	} else if (_has_ending(filename,".ndjson")) {
+		ndjson_importer = NDJSON_Importer::create(db,filename);
+		ndjson_importer->set_offset(offset);
+		importer = ndjson_importer;
+	} else {
+		importer = XML_Importer::create(db,filename);
+	}
+
+	Glib::RefPtr<ImportConflictHandler> handler = ImportConflictHandler::create(breeder_action,growlog_action);
+	if (dry_run) {
+		Glib::RefPtr<ImportPlan> plan = importer->scan();
+		if (!plan) {
+			_error(_("A dry run is not supported for this file!"));
+			return EXIT_FAILURE;
+		}
+		if (!plan->resolve(handler))
+			return EXIT_FAILURE;
+		_print_import_plan(plan);
+		return EXIT_SUCCESS;
+	}
+
+	importer->import_db(handler);
+	if (ndjson_importer)
+		printf("%llu\n",static_cast<unsigned long long>(ndjson_importer->get_offset()));
+	return EXIT_SUCCESS;
+}
+
+static int
+_cmd_add_entry(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	std::string growlog_name,text,time_str;
+	bool has_text = false;
+	
+	for (auto &arg: args) {
+		std::string value;
+		if (_parse_option(arg,"--time",value)) {
+			time_str = value;
+		} else if (growlog_name.empty()) {
+			growlog_name = arg;
+		} else if (!has_text) {
+			text = arg;
+			has_text = true;
+		} else {
+			_usage();
+			return EXIT_FAILURE;
+		}
+	}
+	if (growlog_name.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+	if (!has_text || text == "-") {
+		text.assign(std::istreambuf_iterator<char>(std::cin),std::istreambuf_iterator<char>());
+		while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+			text.pop_back();
+	}
+	if (text.empty()) {
+		_error(_("No text given!"));
+		return EXIT_FAILURE;
+	}
+	if (!Glib::ustring(text).validate()) {
+		_error(_("Text is not valid UTF-8!"));
+		return EXIT_FAILURE;
+	}
+
+	time_t created_on = 0;
+	if (!time_str.empty()) {
+		tm datetime;
+		memset(&datetime,0,sizeof(datetime));
+		const char *end = strptime(time_str.c_str(),DATETIME_ISO_FORMAT,&datetime);
+		if (!end || *end != '\0') {
+			_error(_("Invalid time, use \"YYYY-MM-DD HH:MM:SS\"!"));
+			return EXIT_FAILURE;
+		}
+		datetime.tm_isdst = -1;
+		created_on = mktime(&datetime);
+	}
+
+	Glib::RefPtr<Growlog> growlog = _find_growlog(db,growlog_name);
+	if (!growlog) {
+		_error(_("Growlog not found!"));
+		return EXIT_FAILURE;
+	}
+	db->add_growlog_entry(GrowlogEntry::create(growlog->get_id(),text,created_on));
+	return EXIT_SUCCESS;
+}
+
+static int
+_cmd_list_growlogs(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	std::list<Glib::RefPtr<Growlog> > growlogs;
+	if (args.empty()) {
+		growlogs = db->get_growlogs();
+	} else if (args.size() == 1 && args[0] == "--ongoing") {
+		growlogs = db->get_ongoing_growlogs();
+	} else if (args.size() == 1 && args[0] == "--finished") {
+		growlogs = db->get_finished_growlogs();
+	} else {
+		_usage();
+		return EXIT_FAILURE;
+	}
+
+	for (auto &growlog: growlogs) {
+		printf("%llu\t%s\t%s\t%s\n",
+		       static_cast<unsigned long long>(growlog->get_id()),
+		       (growlog->get_finished_on() ? "finished" : "ongoing"),
+		       growlog->get_created_on_format().c_str(),
+		       growlog->get_title().c_str());
+	}
+	return EXIT_SUCCESS;
+}
+
+static int
+_cmd_stats(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	if (!args.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+
+	std::list<Glib::RefPtr<Breeder> > breeders = db->get_breeders();
+	uint64_t n_strains = db->get_strains().size();
+
+	std::list<Glib::RefPtr<Growlog> > growlogs = db->get_growlogs();
+	uint64_t n_ongoing = 0,n_entries = 0,n_bytes = 0;
+	for (auto &growlog: growlogs) {
+		if (!growlog->get_finished_on())
+			++n_ongoing;
+	}
+	bool have_stats = true;
+	try {
+		for (auto &stats: db->get_growlog_stats()) {
+			n_entries += stats.entry_count;
+			n_bytes += stats.text_bytes;
+		}
+	} catch (DatabaseError &ex) {
+		// server books get their statistics from rebuild-stats, until then
+		// the entries are counted growlog by growlog
+		_error(_("The database has no statistics, run 'growbook-cli rebuild-stats' to add them."));
+		have_stats = false;
+		for (auto &growlog: growlogs)
+			n_entries += db->get_growlog_entry_count(growlog->get_id());
+	}
+
+	printf("breeders\t%llu\n",static_cast<unsigned long long>(breeders.size()));
+	printf("strains\t%llu\n",static_cast<unsigned long long>(n_strains));
+	printf("growlogs\t%llu\n",static_cast<unsigned long long>(growlogs.size()));
+	printf("ongoing-growlogs\t%llu\n",static_cast<unsigned long long>(n_ongoing));
+	printf("finished-growlogs\t%llu\n",static_cast<unsigned long long>(growlogs.size() - n_ongoing));
+	printf("growlog-entries\t%llu\n",static_cast<unsigned long long>(n_entries));
+	if (have_stats)
+		printf("growlog-entry-bytes\t%llu\n",static_cast<unsigned long long>(n_bytes));
+	return EXIT_SUCCESS;
+}
+
+static int
+_cmd_rebuild_stats(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	if (!args.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+	db->rebuild_stats();
+	return EXIT_SUCCESS;
+}
+
+static int
+_cmd_sync(const Glib::RefPtr<Database> &db, const ArgList &args)
+{
+	if (!args.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+	Glib::RefPtr<DatabaseMirror> mirror = Glib::RefPtr<DatabaseMirror>::cast_dynamic(db);
+	if (!mirror) {
+		_error(_("sync needs --mirror!"));
+		return EXIT_FAILURE;
+	}
+
+	bool online = mirror->sync();
+	if (!online)
+		_error(_("Unable to reach the database, the changes are kept in the mirror."));
+
+	printf("outbox\t%llu\n",static_cast<unsigned long long>(mirror->get_outbox_size()));
+	for (auto &conflict: mirror->get_conflicts()) {
+		const char *type = "";
+		switch (conflict.type) {
+			case MIRROR_CONFLICT_MODIFIED:
+				type = "modified";
+				break;
+			case MIRROR_CONFLICT_DELETED_REMOTE:
+				type = "deleted-remote";
+				break;
+			case MIRROR_CONFLICT_DELETED_LOCAL:
+				type = "deleted-local";
+				break;
+			case MIRROR_CONFLICT_REJECTED:
+				type = "rejected";
+				break;
+		}
+		printf("conflict\t%s\t%s\t%s\t%s\n",
+		       type,
+		       conflict.table.c_str(),
+		       conflict.name.c_str(),
+		       conflict.message.c_str());
+	}
+	mirror->clear_conflicts();
+	return (online ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*******************************************************************************
+ * main
+ ******************************************************************************/
+
+int
+main(int argc, char *argv[])
+{
+	std::string dbfile;
+	std::string password;
+	std::string mirror;
+	const char *env = getenv("GROWBOOK_DB_PASSWORD");
+	if (env)
+		password = env;
+
+	int i = 1;
+	for (; i < argc && argv[i][0] == '-'; ++i) {
+		std::string value;
+		if (_parse_option(argv[i],"--database",value)) {
+			dbfile = value;
+		} else if (_parse_option(argv[i],"--password",value)) {
+			password = value;
+		} else if (_parse_option(argv[i],"--mirror",value)) {
+			mirror = value;
+		} else {
+			_usage();
+			return (strcmp(argv[i],"--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (i >= argc) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+	std::string command = argv[i++];
+	ArgList args(argv + i,argv + argc);
+
+	db_init();
+	Glib::RefPtr<Settings> settings = Settings::create(argc,argv);
+
+	setlocale(LC_ALL,"");
+	bindtextdomain(GETTEXT_PACKAGE,settings->get_locale_dir().c_str());
+	textdomain(GETTEXT_PACKAGE);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+	bind_textdomain_codeset(GETTEXT_PACKAGE,"utf-8");
+#endif
+
+	settings->load();
+	db_set_sql_dir(settings->get_sql_dir());
+
+	int ret = EXIT_FAILURE;
+	try {
+		Glib::RefPtr<Database> db = _open_database(settings,dbfile,password,mirror);
+		if (!db)
+			return EXIT_FAILURE;
+		
+		if (command == "export") {
+			ret = _cmd_export(db,args);
+		} else if (command == "import") {
+			ret = _cmd_import(db,args);
+		} else if (command == "add-entry") {
+			ret = _cmd_add_entry(db,args);
+		} else if (command == "list-growlogs") {
+			ret = _cmd_list_growlogs(db,args);
+		} else if (command == "stats") {
+			ret = _cmd_stats(db,args);
+		} else if (command == "rebuild-stats") {
+			ret = _cmd_rebuild_stats(db,args);
+		} else if (command == "sync") {
+			ret = _cmd_sync(db,args);
+		} else {
+			_usage();
+		}
+
+		Glib::RefPtr<DatabaseMirror> db_mirror = Glib::RefPtr<DatabaseMirror>::cast_dynamic(db);
+		if (db_mirror && command != "sync" && db_mirror->get_outbox_size())
+			db_mirror->sync();
+		db->close();
+	} catch (DatabaseError &ex) {
+		_error(ex.what());
+	} catch (Glib::Error &ex) {
+		_error(ex.what());
+	}
+	return ret;
+}
@@ -0,0 +1,583 @@
+//           growbook-gen.cc
+//  Di Oktober 20 17:02:36 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// growbook-gen.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+// growbook-gen deterministically generates a large growbook from a seed,
+// so importer, exporter and UI performance can be measured on identical
+// data. The distributions are skewed on purpose: a few breeders own most
+// of the strains, a few strains are grown over and over, some growlogs run
+// for years and entry texts are several KB long.
+//
+// Usage:
+//   growbook-gen [--seed=S] [--breeders=N] [--strains=M] [--growlogs=K]
+//                [--entries=E] [--years=Y] [--end=UNIXTIME]
+//                (--sqlite3=FILE | --xml=FILE)
+//
+// E is the total number of entries, use --entries=1000000 for a book of
+// production scale. The generator only uses its own PRNG and the times are
+// relative to --end, so the same arguments always produce the same book.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <glibmm.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "database.h"
+#include "database-sqlite3.h"
+#include "datatypes.h"
+#include "error.h"
+#include "random.h"
+#include "xml_exporter.h"
+
+/*******************************************************************************
+ * GenConfig
+ ******************************************************************************/
+
+struct GenConfig
+{
+	uint64_t seed;
+	unsigned int breeders;
+	unsigned int strains;
+	unsigned int growlogs;
+	unsigned int entries;
+	unsigned int years;
+	time_t end;
+	std::string sqlite3_file;
+	std::string xml_file;
+};
+
+static const time_t DAY = 86400;
+
+/*******************************************************************************
+ * Zipf
+ ******************************************************************************/
+
+class Zipf
+{
+	private:
+		std::vector<double> m_cumulative_;
+
+	public:
+		Zipf(size_t n, double exponent);
+		~Zipf();
+
+	public:
+		size_t pick(Random &random) const;
+};
+
+Zipf::Zipf(size_t n, double exponent):
+	m_cumulative_(n)
+{
+	double sum = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		sum += 1.0 / std::pow(static_cast<double>(i + 1),exponent);
+		m_cumulative_[i] = sum;
+	}
+	for (auto &value: m_cumulative_)
+		value /= sum;
+}
+
+Zipf::~Zipf()
+{}
+
+size_t
+Zipf::pick(Random &random) const
+{
+	if (m_cumulative_.empty())
+		return 0;
+	auto iter = std::lower_bound(m_cumulative_.begin(),m_cumulative_.end(),random.uniform());
+	if (iter == m_cumulative_.end())
+		return m_cumulative_.size() - 1;
+	return static_cast<size_t>(iter - m_cumulative_.begin());
+}
+
+/*******************************************************************************
+ * text
+ ******************************************************************************/
+
+static const char *BREEDER_PREFIXES[] = {
+	"Green", "Royal", "Dutch", "Emerald", "Northern", "Sweet", "Barney's",
+	"Humboldt", "Paradise", "Dinafem", "Mountain", "Sensi", "Holy", "Atlas",
+	"Pacific", "Amsterdam", "Alpine", "Delta", "Silver", "Bavarian"
+};
+
+static const char *BREEDER_SUFFIXES[] = {
+	"Seeds", "Genetics", "Seed Co.", "Seedbank", "Farms", "Gardens", "Labs"
+};
+
+static const char *STRAIN_ADJECTIVES[] = {
+	"Purple", "White", "Blue", "Lemon", "Super", "Northern", "Cherry",
+	"Golden", "Critical", "Sour", "Amnesia", "Mango", "Bubble", "Strawberry",
+	"Orange", "Skunk", "Jack", "Gorilla", "Wedding", "Zkittle", "Frosty"
+};
+
+static const char *STRAIN_NOUNS[] = {
+	"Haze", "Kush", "Widow", "Dream", "Diesel", "Cheese", "Lights", "Glue",
+	"Cookies", "Cake", "Gum", "Bomb", "Punch", "Queen", "Express", "Auto",
+	"Runtz", "Berry", "Skunk", "Fire"
+};
+
+static const char *WORDS[] = {
+	"watered", "with", "of", "the", "plants", "nutrients", "at", "ph", "ec",
+	"leaves", "show", "slight", "yellowing", "stretch", "is", "strong", "buds",
+	"trichomes", "mostly", "cloudy", "amber", "defoliated", "lower", "canopy",
+	"flushed", "humidity", "temperature", "lights", "raised", "cycle",
+	"roots", "transplanted", "into", "pots", "topped", "trained", "tied",
+	"down", "smell", "is", "getting", "stronger", "no", "signs", "pests",
+	"added", "calmag", "runoff", "measured", "reservoir", "changed"
+};
+
+#define N_ITEMS(array) (sizeof(array) / sizeof(array[0]))
+
+static std::string
+_text(Random &random, size_t length)
+{
+	std::string text;
+	text.reserve(length + 16);
+	bool sentence_start = true;
+	while (text.size() < length) {
+		std::string word = WORDS[random.below(N_ITEMS(WORDS))];
+		if (!text.empty() && text.back() != '\n')
+			text += ' ';
+		if (sentence_start) {
+			word[0] = static_cast<char>(toupper(word[0]));
+			sentence_start = false;
+		}
+		text += word;
+		
+		if (random.below(12) == 0) {
+			// a few numbers, readings make up much of a real growlog
+			char number[16];
+			snprintf(number,sizeof(number)," %.1f",random.below(1000) / 10.0);
+			text += number;
+		}
+		if (random.below(10) == 0) {
+			text += '.';
+			sentence_start = true;
+			if (random.below(6) == 0)
+				text += "\n\n";
+		}
+	}
+	if (!sentence_start)
+		text += '.';
+	return text;
+}
+
+static size_t
+_text_length(Random &random, double median, size_t min, size_t max)
+{
+	double length = random.lognormal(median,0.8);
+	return std::min(max,std::max(min,static_cast<size_t>(length)));
+}
+
+static std::string
+_format_month(time_t t)
+{
+	char buffer[16];
+#ifdef NATIVE_WINDOWS
+	tm *datetime = gmtime(&t);
+	if (!datetime || !strftime(buffer,sizeof(buffer),"%Y-%m",datetime))
+		return std::to_string(t);
+#else
+	tm datetime;
+	if (gmtime_r(&t,&datetime) != &datetime
+	    || !strftime(buffer,sizeof(buffer),"%Y-%m",&datetime))
+		return std::to_string(t);
+#endif
+	return buffer;
+}
+
+/*******************************************************************************
+ * Generator
+ ******************************************************************************/
+
+class Generator
+{
+	private:
+		const GenConfig &m_config_;
+		Glib::RefPtr<Database> m_database_;
+		Random m_random_;
+		uint64_t m_text_bytes_;
+
+		std::vector<Glib::RefPtr<Breeder> > m_breeders_;
+		std::vector<Glib::RefPtr<Strain> > m_strains_;
+		std::vector<Glib::RefPtr<Growlog> > m_growlogs_;
+		std::vector<double> m_growlog_weights_;
+
+	public:
+		Generator(const GenConfig &config,
+		          const Glib::RefPtr<Database> &database);
+		~Generator();
+
+	private:
+		void _progress(const char *what, uint64_t done, uint64_t total) const;
+		void _generate_breeders();
+		void _generate_strains();
+		void _generate_growlogs();
+		void _generate_entries();
+
+	public:
+		void generate();
+		uint64_t get_text_bytes() const;
+};
+
+Generator::Generator(const GenConfig &config,
+                     const Glib::RefPtr<Database> &database):
+	m_config_{config},
+	m_database_{database},
+	m_random_{config.seed},
+	m_text_bytes_{0}
+{}
+
+Generator::~Generator()
+{}
+
+void
+Generator::_progress(const char *what, uint64_t done, uint64_t total) const
+{
+	if (!total)
+		return;
+	uint64_t step = std::max<uint64_t>(total / 10,1);
+	if (done % step == 0 || done == total)
+		fprintf(stderr,"growbook-gen: %s %3u%%\r%s",
+		        what,
+		        static_cast<unsigned int>((done * 100) / total),
+		        (done == total ? "\n" : ""));
+}
+
+void
+Generator::_generate_breeders()
+{
+	std::set<std::string> names;
+	for (unsigned int i = 0; i < m_config_.breeders; ++i) {
+		std::string name = BREEDER_PREFIXES[m_random_.below(N_ITEMS(BREEDER_PREFIXES))];
+		name += ' ';
+		name += BREEDER_SUFFIXES[m_random_.below(N_ITEMS(BREEDER_SUFFIXES))];
+		if (!names.insert(name).second) {
+			name += " " + std::to_string(i + 1);
+			names.insert(name);
+		}
+		std::string homepage;
+		if (m_random_.below(4)) {
+			homepage = "https://www.";
+			for (auto c: name) {
+				if (isalnum(static_cast<unsigned char>(c)))
+					homepage += static_cast<char>(tolower(c));
+			}
+			homepage += ".example.com";
+		}
+		m_database_->add_breeder(Breeder::create(name,homepage));
+		m_breeders_.push_back(m_database_->get_breeder(name));
+		_progress("breeders",i + 1,m_config_.breeders);
+	}
+}
+
+void
+Generator::_generate_strains()
+{
+	if (m_breeders_.empty())
+		return;
+	
+	// the first breeders own most of the strains
+	Zipf breeders(m_breeders_.size(),1.1);
+	std::set<std::pair<uint64_t,std::string> > names;
+	
+	for (unsigned int i = 0; i < m_config_.strains; ++i) {
+		Glib::RefPtr<Breeder> breeder = m_breeders_[breeders.pick(m_random_)];
+
+		std::string name = STRAIN_ADJECTIVES[m_random_.below(N_ITEMS(STRAIN_ADJECTIVES))];
+		name += ' ';
+		name += STRAIN_NOUNS[m_random_.below(N_ITEMS(STRAIN_NOUNS))];
+		if (m_random_.below(5) == 0)
+			name += " Auto";
+		if (!names.insert(std::make_pair(breeder->get_id(),name)).second) {
+			name += " #" + std::to_string(i + 1);
+			names.insert(std::make_pair(breeder->get_id(),name));
+		}
+
+		std::string info = _text(m_random_,_text_length(m_random_,60,20,200));
+		std::string description = _text(m_random_,_text_length(m_random_,800,100,8192));
+		m_text_bytes_ += info.size() + description.size();
+
+		std::string homepage,seedfinder;
+		if (!breeder->get_homepage().empty())
+			homepage = breeder->get_homepage() + "/strains/" + std::to_string(i + 1);
+		if (m_random_.below(2))
+			seedfinder = "https://seedfinder.example.org/strain/" + std::to_string(i + 1);
+		
+		m_database_->add_strain(Strain::create(breeder->get_id(),
+		                                       breeder->get_name(),
+		                                       name,
+		                                       info,
+		                                       description,
+		                                       homepage,
+		                                       seedfinder));
+		m_strains_.push_back(m_database_->get_strain(breeder->get_name(),name));
+		_progress("strains",i + 1,m_config_.strains);
+	}
+}
+
+void
+Generator::_generate_growlogs()
+{
+	// a few favourites are grown again and again
+	Zipf strains(m_strains_.size(),1.0);
+	time_t span = static_cast<time_t>(m_config_.years) * 365 * DAY;
+	time_t begin = m_config_.end - span;
+	
+	for (unsigned int i = 0; i < m_config_.growlogs; ++i) {
+		time_t created_on = begin + static_cast<time_t>(m_random_.uniform() * span);
+		created_on -= created_on % 60;
+
+		// every fifth growlog keeps mothers and runs for years
+		bool mother = (m_random_.below(5) == 0);
+		time_t days = (mother
+		               ? static_cast<time_t>(m_random_.lognormal(700,0.6))
+		               : 80 + static_cast<time_t>(m_random_.below(100)));
+		time_t flower_on = 0,finished_on = 0;
+		if (!mother)
+			flower_on = created_on + (days * 2 / 5) * DAY;
+		if (created_on + days * DAY < m_config_.end) {
+			finished_on = created_on + days * DAY;
+		} else {
+			days = (m_config_.end - created_on) / DAY + 1;
+			if (flower_on >= m_config_.end)
+				flower_on = 0;
+		}
+
+		std::vector<Glib::RefPtr<Strain> > grown;
+		size_t n_strains = (m_strains_.empty() ? 0 : 1 + m_random_.below(4));
+		for (size_t j = 0; j < n_strains; ++j) {
+			Glib::RefPtr<Strain> strain = m_strains_[strains.pick(m_random_)];
+			if (std::find(grown.begin(),grown.end(),strain) == grown.end())
+				grown.push_back(strain);
+		}
+
+		std::string title = (grown.empty() ? std::string("Grow") : std::string(grown.front()->get_name()));
+		title += " ";
+		title += _format_month(created_on);
+		title += (mother ? " (mothers)" : "");
+		title += " #" + std::to_string(i + 1);
+		std::string description = _text(m_random_,_text_length(m_random_,300,0,4096));
+		m_text_bytes_ += description.size();
+
+		m_database_->add_growlog(Growlog::create(title,description,created_on,flower_on,finished_on));
+		Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(title);
+		for (auto &strain: grown)
+			m_database_->add_strain_for_growlog(growlog,strain);
+
+		m_growlogs_.push_back(growlog);
+		// long running growlogs collect more entries, a few diligent growers
+		// write far more than the rest
+		m_growlog_weights_.push_back(static_cast<double>(days) * m_random_.pareto(1.5));
+		_progress("growlogs",i + 1,m_config_.growlogs);
+	}
+}
+
+void
+Generator::_generate_entries()
+{
+	if (m_growlogs_.empty())
+		return;
+	
+	double total_weight = 0.0;
+	for (auto weight: m_growlog_weights_)
+		total_weight += weight;
+
+	uint64_t done = 0;
+	uint64_t assigned = 0;
+	for (size_t i = 0; i < m_growlogs_.size(); ++i) {
+		Glib::RefPtr<Growlog> growlog = m_growlogs_[i];
+		uint64_t n;
+		if (i + 1 == m_growlogs_.size()) {
+			n = m_config_.entries - assigned;
+		} else {
+			n = static_cast<uint64_t>((m_growlog_weights_[i] / total_weight) * m_config_.entries);
+			n = std::min<uint64_t>(n,m_config_.entries - assigned);
+		}
+		assigned += n;
+		if (!n)
+			continue;
+
+		time_t first = growlog->get_created_on();
+		time_t last = (growlog->get_finished_on() ? growlog->get_finished_on() : m_config_.end);
+		std::vector<time_t> times(n);
+		for (auto &t: times)
+			t = first + static_cast<time_t>(m_random_.uniform() * (last - first));
+		std::sort(times.begin(),times.end());
+
+		for (auto t: times) {
+			std::string text = _text(m_random_,_text_length(m_random_,1500,80,32768));
+			m_text_bytes_ += text.size();
+			m_database_->add_growlog_entry(GrowlogEntry::create(growlog->get_id(),text,t - t % 60));
+			_progress("entries",++done,m_config_.entries);
+		}
+	}
+}
+
+void
+Generator::generate()
+{
+	_generate_breeders();
+	_generate_strains();
+	_generate_growlogs();
+	_generate_entries();
+}
+
+uint64_t
+Generator::get_text_bytes() const
+{
+	return m_text_bytes_;
+}
+
+/*******************************************************************************
+ * main
+ ******************************************************************************/
+
+static void
+_usage()
+{
+	fprintf(stderr,
+	        "Usage: growbook-gen [--seed=S] [--breeders=N] [--strains=M] [--growlogs=K]\n"
+	        "                    [--entries=E] [--years=Y] [--end=UNIXTIME]\n"
+	        "                    (--sqlite3=FILE | --xml=FILE)\n");
+}
+
+static bool
+_parse_option(const char *arg, const char *name, std::string &value)
+{
+	size_t len = strlen(name);
+	if (strncmp(arg,name,len) != 0 || arg[len] != '=')
+		return false;
+	value = arg + len + 1;
+	return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+	// 2026-01-01 00:00:00 UTC
+	GenConfig config{42,80,2500,600,100000,10,1767225600,"",""};
+
+	for (int i = 1; i < argc; ++i) {
+		std::string value;
+		if (_parse_option(argv[i],"--seed",value)) {
+			config.seed = std::stoull(value);
+		} else if (_parse_option(argv[i],"--breeders",value)) {
+			config.breeders = std::stoul(value);
+		} else if (_parse_option(argv[i],"--strains",value)) {
+			config.strains = std::stoul(value);
+		} else if (_parse_option(argv[i],"--growlogs",value)) {
+			config.growlogs = std::stoul(value);
+		} else if (_parse_option(argv[i],"--entries",value)) {
+			config.entries = std::stoul(value);
+		} else if (_parse_option(argv[i],"--years",value)) {
+			config.years = std::max(1ul,std::stoul(value));
+		} else if (_parse_option(argv[i],"--end",value)) {
+			config.end = static_cast<time_t>(std::stoll(value));
+		} else if (_parse_option(argv[i],"--sqlite3",value)) {
+			config.sqlite3_file = value;
+		} else if (_parse_option(argv[i],"--xml",value)) {
+			config.xml_file = value;
+		} else {
+			_usage();
+			return (strcmp(argv[i],"--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (config.sqlite3_file.empty() == config.xml_file.empty()) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+
+	// XML is written by the exporter from a scratch database
+	std::string dbfile = config.sqlite3_file;
+	if (dbfile.empty()) {
+		dbfile = Glib::build_filename(Glib::get_tmp_dir(),
+		                              "growbook-gen-" + std::to_string(getpid()) + ".db");
+	}
+	if (Glib::file_test(dbfile,Glib::FILE_TEST_EXISTS)) {
+		if (!config.sqlite3_file.empty()) {
+			fprintf(stderr,"growbook-gen: \"%s\" already exists!\n",dbfile.c_str());
+			return EXIT_FAILURE;
+		}
+		unlink(dbfile.c_str());
+	}
+
+	db_init();
+	
+	auto start = std::chrono::steady_clock::now();
+	Glib::RefPtr<DatabaseSqlite3> db = DatabaseSqlite3::create(DatabaseSettings::create("sqlite3",
+	                                                                                     dbfile,
+	                                                                                     DB_NAME_IS_FILENAME));
+	int ret = EXIT_SUCCESS;
+	try {
+		db->connect();
+		db->create_database();
+		db->set_synchronous(false);
+
+		Generator generator(config,db);
+		generator.generate();
+		db->set_synchronous(true);
+
+		if (!config.xml_file.empty()) {
+			std::ofstream out(config.xml_file,std::ofstream::out | std::ofstream::trunc);
+			if (!out.is_open()) {
+				fprintf(stderr,"growbook-gen: unable to open \"%s\"!\n",config.xml_file.c_str());
+				ret = EXIT_FAILURE;
+			} else {
+				xml_export_database(db,out);
+			}
+		}
+		db->close();
+
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		fprintf(stderr,
+		        "growbook-gen: %u breeders, %u strains, %u growlogs, %u entries, "
+		        "%llu bytes of text in %.1fs\n",
+		        config.breeders,
+		        config.strains,
+		        config.growlogs,
+		        config.entries,
+		        static_cast<unsigned long long>(generator.get_text_bytes()),
+		        std::chrono::duration<double>(elapsed).count());
+	} catch (DatabaseError &ex) {
+		fprintf(stderr,"growbook-gen: %s\n",ex.what());
+		ret = EXIT_FAILURE;
+	}
+
+	if (config.sqlite3_file.empty())
+		unlink(dbfile.c_str());
+	return ret;
+}
@@ -44,6 +44,7 @@ CREATE TABLE IF NOT EXISTS growlog_entry (
 		ON DELETE RESTRICT
 );
 CREATE INDEX IF NOT EXISTS idx_growlog_entry_growlog ON growlog_entry(growlog);
+CREATE INDEX IF NOT EXISTS idx_growlog_entry_created_on ON growlog_entry(growlog,created_on,id);
 
 CREATE TABLE IF NOT EXISTS growlog_strain (
 	id SERIAL PRIMARY KEY,
@@ -60,4 +61,289 @@ CREATE TABLE IF NOT EXISTS growlog_strain (
 CREATE INDEX IF NOT EXISTS idx_growlog_strain_growlog ON growlog_strain(growlog);
 CREATE INDEX IF NOT EXISTS idx_growlog_strain_strain ON growlog_strain(strain);
 
+-- Statistics maintained by the triggers below. Days are counted between
+-- calendar dates, a growlog counts for veg_days once it has a flowering
+-- date and for flower_days once it is finished as well.
+CREATE TABLE IF NOT EXISTS growlog_stats (
+	growlog BIGINT UNSIGNED PRIMARY KEY,
+	entry_count BIGINT NOT NULL DEFAULT 0,
+	first_entry_on DATETIME,
+	last_entry_on DATETIME,
+	text_bytes BIGINT NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS strain_stats (
+	strain BIGINT UNSIGNED PRIMARY KEY,
+	growlog_count BIGINT NOT NULL DEFAULT 0,
+	veg_count BIGINT NOT NULL DEFAULT 0,
+	veg_days BIGINT NOT NULL DEFAULT 0,
+	flower_count BIGINT NOT NULL DEFAULT 0,
+	flower_days BIGINT NOT NULL DEFAULT 0
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_insert_stats AFTER INSERT ON growlog
+FOR EACH ROW
+	INSERT IGNORE INTO growlog_stats (growlog) VALUES (NEW.id);
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_update_stats AFTER UPDATE ON growlog
+FOR EACH ROW
+	UPDATE strain_stats SET
+		veg_count = veg_count - (OLD.flower_on IS NOT NULL) + (NEW.flower_on IS NOT NULL),
+		veg_days = veg_days
+			- IFNULL(DATEDIFF(OLD.flower_on,OLD.created_on),0)
+			+ IFNULL(DATEDIFF(NEW.flower_on,NEW.created_on),0),
+		flower_count = flower_count
+			- (OLD.flower_on IS NOT NULL AND OLD.finished_on IS NOT NULL)
+			+ (NEW.flower_on IS NOT NULL AND NEW.finished_on IS NOT NULL),
+		flower_days = flower_days
+			- IFNULL(DATEDIFF(OLD.finished_on,OLD.flower_on),0)
+			+ IFNULL(DATEDIFF(NEW.finished_on,NEW.flower_on),0)
+	WHERE strain IN (SELECT strain FROM growlog_strain WHERE growlog = NEW.id);
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_delete_stats AFTER DELETE ON growlog
+FOR EACH ROW
+BEGIN
+	DELETE FROM growlog_stats WHERE growlog = OLD.id;
+	UPDATE strain_stats SET
+		growlog_count = growlog_count - 1,
+		veg_count = veg_count - (OLD.flower_on IS NOT NULL),
+		veg_days = veg_days - IFNULL(DATEDIFF(OLD.flower_on,OLD.created_on),0),
+		flower_count = flower_count - (OLD.flower_on IS NOT NULL AND OLD.finished_on IS NOT NULL),
+		flower_days = flower_days - IFNULL(DATEDIFF(OLD.finished_on,OLD.flower_on),0)
+	WHERE strain IN (SELECT strain FROM growlog_strain WHERE growlog = OLD.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_insert_stats AFTER INSERT ON growlog_entry
+FOR EACH ROW
+BEGIN
+	INSERT IGNORE INTO growlog_stats (growlog) SELECT id FROM growlog WHERE id = NEW.growlog;
+	UPDATE growlog_stats SET
+		entry_count = entry_count + 1,
+		first_entry_on = IF(first_entry_on IS NULL OR NEW.created_on < first_entry_on,
+		                    NEW.created_on,first_entry_on),
+		last_entry_on = IF(last_entry_on IS NULL OR NEW.created_on > last_entry_on,
+		                   NEW.created_on,last_entry_on),
+		text_bytes = text_bytes + LENGTH(NEW.entry)
+	WHERE growlog = NEW.growlog;
+END;
+
+-- first and last entry are looked up in idx_growlog_entry_created_on
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_update_stats AFTER UPDATE ON growlog_entry
+FOR EACH ROW
+BEGIN
+	UPDATE growlog_stats SET
+		entry_count = entry_count - 1,
+		text_bytes = text_bytes - LENGTH(OLD.entry)
+	WHERE growlog = OLD.growlog;
+	INSERT IGNORE INTO growlog_stats (growlog) SELECT id FROM growlog WHERE id = NEW.growlog;
+	UPDATE growlog_stats SET
+		entry_count = entry_count + 1,
+		text_bytes = text_bytes + LENGTH(NEW.entry)
+	WHERE growlog = NEW.growlog;
+	UPDATE growlog_stats SET
+		first_entry_on = (SELECT MIN(created_on) FROM growlog_entry WHERE growlog = growlog_stats.growlog),
+		last_entry_on = (SELECT MAX(created_on) FROM growlog_entry WHERE growlog = growlog_stats.growlog)
+	WHERE growlog IN (OLD.growlog,NEW.growlog);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_delete_stats AFTER DELETE ON growlog_entry
+FOR EACH ROW
+	UPDATE growlog_stats SET
+		entry_count = entry_count - 1,
+		first_entry_on = (SELECT MIN(created_on) FROM growlog_entry WHERE growlog = OLD.growlog),
+		last_entry_on = (SELECT MAX(created_on) FROM growlog_entry WHERE growlog = OLD.growlog),
+		text_bytes = text_bytes - LENGTH(OLD.entry)
+	WHERE growlog = OLD.growlog;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_insert_stats AFTER INSERT ON strain
+FOR EACH ROW
+	INSERT IGNORE INTO strain_stats (strain) VALUES (NEW.id);
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_delete_stats AFTER DELETE ON strain
+FOR EACH ROW
+	DELETE FROM strain_stats WHERE strain = OLD.id;
+
+-- a link to a growlog that does not exist (any more) does not count
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_insert_stats AFTER INSERT ON growlog_strain
+FOR EACH ROW
+BEGIN
+	INSERT IGNORE INTO strain_stats (strain) SELECT id FROM strain WHERE id = NEW.strain;
+	UPDATE strain_stats AS s JOIN growlog AS g ON g.id = NEW.growlog SET
+		s.growlog_count = s.growlog_count + 1,
+		s.veg_count = s.veg_count + (g.flower_on IS NOT NULL),
+		s.veg_days = s.veg_days + IFNULL(DATEDIFF(g.flower_on,g.created_on),0),
+		s.flower_count = s.flower_count + (g.flower_on IS NOT NULL AND g.finished_on IS NOT NULL),
+		s.flower_days = s.flower_days + IFNULL(DATEDIFF(g.finished_on,g.flower_on),0)
+	WHERE s.strain = NEW.strain;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_delete_stats AFTER DELETE ON growlog_strain
+FOR EACH ROW
+	UPDATE strain_stats AS s JOIN growlog AS g ON g.id = OLD.growlog SET
+		s.growlog_count = s.growlog_count - 1,
+		s.veg_count = s.veg_count - (g.flower_on IS NOT NULL),
+		s.veg_days = s.veg_days - IFNULL(DATEDIFF(g.flower_on,g.created_on),0),
+		s.flower_count = s.flower_count - (g.flower_on IS NOT NULL AND g.finished_on IS NOT NULL),
+		s.flower_days = s.flower_days - IFNULL(DATEDIFF(g.finished_on,g.flower_on),0)
+	WHERE s.strain = OLD.strain;
+
+-- Change tracking for incremental exports. Every insert or update of a row
+-- moves its 'U' record to the end of the log, so there is one per row and
+-- its seq tells when the row changed last. Deletes leave a 'D' record and
+-- changes of a natural key an 'R' record; they carry the natural key the
+-- row had (key1..key3) and for 'R' the new one (new_key1..new_key3), so
+-- they can be applied to books with other ids:
+--   breeder          name
+--   strain           breeder name, name
+--   growlog          title
+--   growlog_strain   growlog title, breeder name, strain name
+--   growlog_entry    growlog title, created_on, entry
+-- Changes of growlog_strain are tracked per growlog, row_id is the id of
+-- the growlog. Updates of growlog_entry and growlog_strain are recorded as
+-- delete and insert. Keys are compared with BINARY, a change of case is a
+-- change of the key.
+CREATE TABLE IF NOT EXISTS change_log (
+	seq SERIAL PRIMARY KEY,
+	table_name VARCHAR(32) NOT NULL,
+	row_id BIGINT UNSIGNED NOT NULL,
+	op CHAR(1) NOT NULL,
+	key1 MEDIUMTEXT,
+	key2 MEDIUMTEXT,
+	key3 MEDIUMTEXT,
+	new_key1 MEDIUMTEXT,
+	new_key2 MEDIUMTEXT,
+	new_key3 MEDIUMTEXT
+);
+CREATE INDEX IF NOT EXISTS idx_change_log_row ON change_log(table_name,row_id);
+
+-- the last change_log seq an incremental export has written
+CREATE TABLE IF NOT EXISTS change_watermark (
+	name VARCHAR(512) PRIMARY KEY,
+	seq BIGINT UNSIGNED NOT NULL
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_breeder_insert_changes AFTER INSERT ON breeder
+FOR EACH ROW
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('breeder',NEW.id,'U');
+
+CREATE TRIGGER IF NOT EXISTS trg_breeder_update_changes AFTER UPDATE ON breeder
+FOR EACH ROW
+BEGIN
+	IF BINARY OLD.name <> BINARY NEW.name THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,new_key1)
+			VALUES ('breeder',NEW.id,'R',OLD.name,NEW.name);
+	END IF;
+	DELETE FROM change_log WHERE table_name = 'breeder' AND row_id = NEW.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('breeder',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_breeder_delete_changes AFTER DELETE ON breeder
+FOR EACH ROW
+BEGIN
+	DELETE FROM change_log WHERE table_name = 'breeder' AND row_id = OLD.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op,key1) VALUES ('breeder',OLD.id,'D',OLD.name);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_insert_changes AFTER INSERT ON strain
+FOR EACH ROW
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('strain',NEW.id,'U');
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_update_changes AFTER UPDATE ON strain
+FOR EACH ROW
+BEGIN
+	IF BINARY OLD.name <> BINARY NEW.name OR OLD.breeder <> NEW.breeder THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,key2,new_key1,new_key2)
+			VALUES ('strain',NEW.id,'R',
+			        (SELECT name FROM breeder WHERE id = OLD.breeder),OLD.name,
+			        (SELECT name FROM breeder WHERE id = NEW.breeder),NEW.name);
+	END IF;
+	DELETE FROM change_log WHERE table_name = 'strain' AND row_id = NEW.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('strain',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_delete_changes AFTER DELETE ON strain
+FOR EACH ROW
+BEGIN
+	DELETE FROM change_log WHERE table_name = 'strain' AND row_id = OLD.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op,key1,key2)
+		VALUES ('strain',OLD.id,'D',(SELECT name FROM breeder WHERE id = OLD.breeder),OLD.name);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_insert_changes AFTER INSERT ON growlog
+FOR EACH ROW
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog',NEW.id,'U');
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_update_changes AFTER UPDATE ON growlog
+FOR EACH ROW
+BEGIN
+	IF BINARY OLD.title <> BINARY NEW.title THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,new_key1)
+			VALUES ('growlog',NEW.id,'R',OLD.title,NEW.title);
+	END IF;
+	DELETE FROM change_log WHERE table_name = 'growlog' AND row_id = NEW.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_delete_changes AFTER DELETE ON growlog
+FOR EACH ROW
+BEGIN
+	DELETE FROM change_log WHERE table_name IN ('growlog','growlog_strain') AND row_id = OLD.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op,key1) VALUES ('growlog',OLD.id,'D',OLD.title);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_insert_changes AFTER INSERT ON growlog_entry
+FOR EACH ROW
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_entry',NEW.id,'U');
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_update_changes AFTER UPDATE ON growlog_entry
+FOR EACH ROW
+BEGIN
+	IF OLD.growlog <> NEW.growlog OR OLD.created_on <> NEW.created_on
+	   OR BINARY OLD.entry <> BINARY NEW.entry THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+			VALUES ('growlog_entry',OLD.id,'D',
+			        (SELECT title FROM growlog WHERE id = OLD.growlog),OLD.created_on,OLD.entry);
+	END IF;
+	DELETE FROM change_log WHERE table_name = 'growlog_entry' AND row_id = NEW.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_entry',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_delete_changes AFTER DELETE ON growlog_entry
+FOR EACH ROW
+BEGIN
+	DELETE FROM change_log WHERE table_name = 'growlog_entry' AND row_id = OLD.id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+		VALUES ('growlog_entry',OLD.id,'D',
+		        (SELECT title FROM growlog WHERE id = OLD.growlog),OLD.created_on,OLD.entry);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_insert_changes AFTER INSERT ON growlog_strain
+FOR EACH ROW
+BEGIN
+	DELETE FROM change_log WHERE table_name = 'growlog_strain' AND row_id = NEW.growlog AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_strain',NEW.growlog,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_update_changes AFTER UPDATE ON growlog_strain
+FOR EACH ROW
+BEGIN
+	IF OLD.growlog <> NEW.growlog OR OLD.strain <> NEW.strain THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+			SELECT 'growlog_strain',OLD.growlog,'D',
+			       (SELECT title FROM growlog WHERE id = OLD.growlog),b.name,s.name
+			FROM strain AS s JOIN breeder AS b ON b.id = s.breeder
+			WHERE s.id = OLD.strain;
+	END IF;
+	DELETE FROM change_log WHERE table_name = 'growlog_strain' AND row_id = NEW.growlog AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_strain',NEW.growlog,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_delete_changes AFTER DELETE ON growlog_strain
+FOR EACH ROW
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+		SELECT 'growlog_strain',OLD.growlog,'D',
+		       (SELECT title FROM growlog WHERE id = OLD.growlog),b.name,s.name
+		FROM strain AS s JOIN breeder AS b ON b.id = s.breeder
+		WHERE s.id = OLD.strain;
+
 COMMIT;
@@ -0,0 +1,44 @@
+BEGIN TRANSACTION;
+
+-- Tables of a DatabaseMirror, kept in the local sqlite3 replica next to the
+-- tables of growbook.sqlite3.sql.
+
+-- Writes made to the replica that have not reached the remote database
+-- yet. The records are copied from change_log, so row_id is the local id
+-- and for growlog_strain the id of the growlog. There is at most one 'U'
+-- record per row; it moves to the end when the row changes again.
+CREATE TABLE IF NOT EXISTS mirror_outbox (
+	seq INTEGER PRIMARY KEY AUTOINCREMENT,
+	table_name VARCHAR(32) NOT NULL,
+	row_id INTEGER NOT NULL,
+	op CHAR(1) NOT NULL,
+	key1 TEXT,
+	key2 TEXT,
+	key3 TEXT
+);
+CREATE INDEX IF NOT EXISTS idx_mirror_outbox_row ON mirror_outbox(table_name,row_id);
+
+-- Local and remote id of every mirrored row. pushed_seq is the remote
+-- change_log seq after the row was last written to the remote database,
+-- remote changes up to it are our own and are not pulled again.
+CREATE TABLE IF NOT EXISTS mirror_id_map (
+	table_name VARCHAR(32) NOT NULL,
+	local_id INTEGER NOT NULL,
+	remote_id INTEGER NOT NULL,
+	pushed_seq INTEGER NOT NULL DEFAULT 0,
+	PRIMARY KEY (table_name,local_id),
+	UNIQUE (table_name,remote_id)
+);
+
+CREATE TABLE IF NOT EXISTS mirror_conflict (
+	id INTEGER PRIMARY KEY,
+	type INTEGER NOT NULL,
+	table_name VARCHAR(32) NOT NULL,
+	local_id INTEGER NOT NULL,
+	remote_id INTEGER NOT NULL,
+	name TEXT DEFAULT '',
+	message TEXT DEFAULT '',
+	created_on TIMESTAMP NOT NULL
+);
+
+COMMIT;
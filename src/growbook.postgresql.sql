@@ -54,6 +54,7 @@ CREATE TABLE IF NOT EXISTS growlog_entry (
 		ON DELETE RESTRICT
 );
 CREATE INDEX IF NOT EXISTS idx_growlog_entry_growlog ON growlog_entry(growlog);
+CREATE INDEX IF NOT EXISTS idx_growlog_entry_created_on ON growlog_entry(growlog,created_on,id);
 
 CREATE TABLE IF NOT EXISTS growlog_strain (
 	id SERIAL PRIMARY KEY,
@@ -70,4 +71,289 @@ CREATE TABLE IF NOT EXISTS growlog_strain (
 CREATE INDEX IF NOT EXISTS idx_growlog_strain_growlog ON growlog_strain(growlog);
 CREATE INDEX IF NOT EXISTS idx_growlog_strain_strain ON growlog_strain(strain);
 
+-- Statistics maintained by the triggers below. Days are counted between
+-- calendar dates, a growlog counts for veg_days once it has a flowering
+-- date and for flower_days once it is finished as well.
+CREATE TABLE IF NOT EXISTS growlog_stats (
+	growlog INTEGER PRIMARY KEY,
+	entry_count BIGINT NOT NULL DEFAULT 0,
+	first_entry_on TIMESTAMP,
+	last_entry_on TIMESTAMP,
+	text_bytes BIGINT NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS strain_stats (
+	strain INTEGER PRIMARY KEY,
+	growlog_count BIGINT NOT NULL DEFAULT 0,
+	veg_count BIGINT NOT NULL DEFAULT 0,
+	veg_days BIGINT NOT NULL DEFAULT 0,
+	flower_count BIGINT NOT NULL DEFAULT 0,
+	flower_days BIGINT NOT NULL DEFAULT 0
+);
+
+-- adds factor times the contribution of a growlog to the stats of a strain,
+-- or of all strains of the growlog if strain_id is NULL
+CREATE OR REPLACE FUNCTION strain_stats_add(growlog_id INTEGER,
+                                            strain_id INTEGER,
+                                            factor INTEGER,
+                                            created_on TIMESTAMP,
+                                            flower_on DATE,
+                                            finished_on TIMESTAMP) RETURNS VOID AS $$
+BEGIN
+	UPDATE strain_stats SET
+		growlog_count = growlog_count + factor,
+		veg_count = veg_count + factor * (CASE WHEN flower_on IS NOT NULL THEN 1 ELSE 0 END),
+		veg_days = veg_days + factor * COALESCE(flower_on - created_on::date,0),
+		flower_count = flower_count
+			+ factor * (CASE WHEN flower_on IS NOT NULL AND finished_on IS NOT NULL THEN 1 ELSE 0 END),
+		flower_days = flower_days + factor * COALESCE(finished_on::date - flower_on,0)
+	WHERE (strain_id IS NULL AND strain IN (SELECT strain FROM growlog_strain WHERE growlog = growlog_id))
+		OR strain = strain_id;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION growlog_stats_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'INSERT' THEN
+		INSERT INTO growlog_stats (growlog) VALUES (NEW.id) ON CONFLICT (growlog) DO NOTHING;
+	ELSIF TG_OP = 'UPDATE' THEN
+		IF NEW.created_on IS DISTINCT FROM OLD.created_on
+		   OR NEW.flower_on IS DISTINCT FROM OLD.flower_on
+		   OR NEW.finished_on IS DISTINCT FROM OLD.finished_on THEN
+			PERFORM strain_stats_add(OLD.id,NULL,-1,OLD.created_on,OLD.flower_on,OLD.finished_on);
+			PERFORM strain_stats_add(NEW.id,NULL,1,NEW.created_on,NEW.flower_on,NEW.finished_on);
+		END IF;
+	ELSE
+		DELETE FROM growlog_stats WHERE growlog = OLD.id;
+		PERFORM strain_stats_add(OLD.id,NULL,-1,OLD.created_on,OLD.flower_on,OLD.finished_on);
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_growlog_stats ON growlog;
+CREATE TRIGGER trg_growlog_stats AFTER INSERT OR UPDATE OR DELETE ON growlog
+	FOR EACH ROW EXECUTE PROCEDURE growlog_stats_trigger();
+
+-- first and last entry are looked up in idx_growlog_entry_created_on
+CREATE OR REPLACE FUNCTION growlog_entry_stats_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'DELETE' OR TG_OP = 'UPDATE' THEN
+		UPDATE growlog_stats SET
+			entry_count = entry_count - 1,
+			first_entry_on = (SELECT MIN(created_on) FROM growlog_entry WHERE growlog = OLD.growlog),
+			last_entry_on = (SELECT MAX(created_on) FROM growlog_entry WHERE growlog = OLD.growlog),
+			text_bytes = text_bytes - octet_length(OLD.entry)
+		WHERE growlog = OLD.growlog;
+	END IF;
+	IF TG_OP = 'INSERT' OR TG_OP = 'UPDATE' THEN
+		INSERT INTO growlog_stats (growlog) SELECT id FROM growlog WHERE id = NEW.growlog
+			ON CONFLICT (growlog) DO NOTHING;
+		UPDATE growlog_stats SET
+			entry_count = entry_count + 1,
+			first_entry_on = LEAST(first_entry_on,NEW.created_on),
+			last_entry_on = GREATEST(last_entry_on,NEW.created_on),
+			text_bytes = text_bytes + octet_length(NEW.entry)
+		WHERE growlog = NEW.growlog;
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_growlog_entry_stats ON growlog_entry;
+CREATE TRIGGER trg_growlog_entry_stats AFTER INSERT OR UPDATE OR DELETE ON growlog_entry
+	FOR EACH ROW EXECUTE PROCEDURE growlog_entry_stats_trigger();
+
+CREATE OR REPLACE FUNCTION strain_stats_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'INSERT' THEN
+		INSERT INTO strain_stats (strain) VALUES (NEW.id) ON CONFLICT (strain) DO NOTHING;
+	ELSE
+		DELETE FROM strain_stats WHERE strain = OLD.id;
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_strain_stats ON strain;
+CREATE TRIGGER trg_strain_stats AFTER INSERT OR DELETE ON strain
+	FOR EACH ROW EXECUTE PROCEDURE strain_stats_trigger();
+
+-- a link to a growlog that does not exist (any more) does not count
+CREATE OR REPLACE FUNCTION growlog_strain_stats_trigger() RETURNS TRIGGER AS $$
+DECLARE
+	g growlog%ROWTYPE;
+BEGIN
+	IF TG_OP = 'INSERT' THEN
+		INSERT INTO strain_stats (strain) SELECT id FROM strain WHERE id = NEW.strain
+			ON CONFLICT (strain) DO NOTHING;
+		SELECT * INTO g FROM growlog WHERE id = NEW.growlog;
+		IF FOUND THEN
+			PERFORM strain_stats_add(g.id,NEW.strain,1,g.created_on,g.flower_on,g.finished_on);
+		END IF;
+	ELSE
+		SELECT * INTO g FROM growlog WHERE id = OLD.growlog;
+		IF FOUND THEN
+			PERFORM strain_stats_add(g.id,OLD.strain,-1,g.created_on,g.flower_on,g.finished_on);
+		END IF;
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_growlog_strain_stats ON growlog_strain;
+CREATE TRIGGER trg_growlog_strain_stats AFTER INSERT OR DELETE ON growlog_strain
+	FOR EACH ROW EXECUTE PROCEDURE growlog_strain_stats_trigger();
+
+-- Change tracking for incremental exports. Every insert or update of a row
+-- moves its 'U' record to the end of the log, so there is one per row and
+-- its seq tells when the row changed last. Deletes leave a 'D' record and
+-- changes of a natural key an 'R' record; they carry the natural key the
+-- row had (key1..key3) and for 'R' the new one (new_key1..new_key3), so
+-- they can be applied to books with other ids:
+--   breeder          name
+--   strain           breeder name, name
+--   growlog          title
+--   growlog_strain   growlog title, breeder name, strain name
+--   growlog_entry    growlog title, created_on, entry
+-- Changes of growlog_strain are tracked per growlog, row_id is the id of
+-- the growlog. Updates of growlog_entry and growlog_strain are recorded as
+-- delete and insert.
+CREATE TABLE IF NOT EXISTS change_log (
+	seq BIGSERIAL PRIMARY KEY,
+	table_name VARCHAR(32) NOT NULL,
+	row_id BIGINT NOT NULL,
+	op CHAR(1) NOT NULL,
+	key1 TEXT,
+	key2 TEXT,
+	key3 TEXT,
+	new_key1 TEXT,
+	new_key2 TEXT,
+	new_key3 TEXT
+);
+CREATE INDEX IF NOT EXISTS idx_change_log_row ON change_log(table_name,row_id);
+
+-- the last change_log seq an incremental export has written
+CREATE TABLE IF NOT EXISTS change_watermark (
+	name VARCHAR(512) PRIMARY KEY,
+	seq BIGINT NOT NULL
+);
+
+CREATE OR REPLACE FUNCTION change_log_touch(name VARCHAR,id BIGINT) RETURNS VOID AS $$
+BEGIN
+	DELETE FROM change_log WHERE table_name = name AND row_id = id AND op = 'U';
+	INSERT INTO change_log (table_name,row_id,op) VALUES (name,id,'U');
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION breeder_changes_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'DELETE' THEN
+		DELETE FROM change_log WHERE table_name = 'breeder' AND row_id = OLD.id AND op = 'U';
+		INSERT INTO change_log (table_name,row_id,op,key1) VALUES ('breeder',OLD.id,'D',OLD.name);
+		RETURN NULL;
+	END IF;
+	IF TG_OP = 'UPDATE' AND OLD.name <> NEW.name THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,new_key1)
+			VALUES ('breeder',NEW.id,'R',OLD.name,NEW.name);
+	END IF;
+	PERFORM change_log_touch('breeder',NEW.id);
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_breeder_changes ON breeder;
+CREATE TRIGGER trg_breeder_changes AFTER INSERT OR UPDATE OR DELETE ON breeder
+	FOR EACH ROW EXECUTE PROCEDURE breeder_changes_trigger();
+
+CREATE OR REPLACE FUNCTION strain_changes_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'DELETE' THEN
+		DELETE FROM change_log WHERE table_name = 'strain' AND row_id = OLD.id AND op = 'U';
+		INSERT INTO change_log (table_name,row_id,op,key1,key2)
+			VALUES ('strain',OLD.id,'D',(SELECT name FROM breeder WHERE id = OLD.breeder),OLD.name);
+		RETURN NULL;
+	END IF;
+	IF TG_OP = 'UPDATE' AND (OLD.name <> NEW.name OR OLD.breeder <> NEW.breeder) THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,key2,new_key1,new_key2)
+			VALUES ('strain',NEW.id,'R',
+			        (SELECT name FROM breeder WHERE id = OLD.breeder),OLD.name,
+			        (SELECT name FROM breeder WHERE id = NEW.breeder),NEW.name);
+	END IF;
+	PERFORM change_log_touch('strain',NEW.id);
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_strain_changes ON strain;
+CREATE TRIGGER trg_strain_changes AFTER INSERT OR UPDATE OR DELETE ON strain
+	FOR EACH ROW EXECUTE PROCEDURE strain_changes_trigger();
+
+CREATE OR REPLACE FUNCTION growlog_changes_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'DELETE' THEN
+		DELETE FROM change_log WHERE table_name IN ('growlog','growlog_strain') AND row_id = OLD.id AND op = 'U';
+		INSERT INTO change_log (table_name,row_id,op,key1) VALUES ('growlog',OLD.id,'D',OLD.title);
+		RETURN NULL;
+	END IF;
+	IF TG_OP = 'UPDATE' AND OLD.title <> NEW.title THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,new_key1)
+			VALUES ('growlog',NEW.id,'R',OLD.title,NEW.title);
+	END IF;
+	PERFORM change_log_touch('growlog',NEW.id);
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_growlog_changes ON growlog;
+CREATE TRIGGER trg_growlog_changes AFTER INSERT OR UPDATE OR DELETE ON growlog
+	FOR EACH ROW EXECUTE PROCEDURE growlog_changes_trigger();
+
+CREATE OR REPLACE FUNCTION growlog_entry_changes_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'DELETE'
+	   OR (TG_OP = 'UPDATE' AND (OLD.growlog <> NEW.growlog
+	                             OR OLD.created_on <> NEW.created_on
+	                             OR OLD.entry <> NEW.entry)) THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+			VALUES ('growlog_entry',OLD.id,'D',
+			        (SELECT title FROM growlog WHERE id = OLD.growlog),
+			        to_char(OLD.created_on,'YYYY-MM-DD HH24:MI:SS'),OLD.entry);
+	END IF;
+	IF TG_OP = 'DELETE' THEN
+		DELETE FROM change_log WHERE table_name = 'growlog_entry' AND row_id = OLD.id AND op = 'U';
+	ELSIF TG_OP = 'INSERT' THEN
+		INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_entry',NEW.id,'U');
+	ELSE
+		PERFORM change_log_touch('growlog_entry',NEW.id);
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_growlog_entry_changes ON growlog_entry;
+CREATE TRIGGER trg_growlog_entry_changes AFTER INSERT OR UPDATE OR DELETE ON growlog_entry
+	FOR EACH ROW EXECUTE PROCEDURE growlog_entry_changes_trigger();
+
+CREATE OR REPLACE FUNCTION growlog_strain_changes_trigger() RETURNS TRIGGER AS $$
+BEGIN
+	IF TG_OP = 'DELETE'
+	   OR (TG_OP = 'UPDATE' AND (OLD.growlog <> NEW.growlog OR OLD.strain <> NEW.strain)) THEN
+		INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+			SELECT 'growlog_strain',OLD.growlog,'D',
+			       (SELECT title FROM growlog WHERE id = OLD.growlog),b.name,s.name
+			FROM strain AS s JOIN breeder AS b ON b.id = s.breeder
+			WHERE s.id = OLD.strain;
+	END IF;
+	IF TG_OP <> 'DELETE' THEN
+		PERFORM change_log_touch('growlog_strain',NEW.growlog);
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_growlog_strain_changes ON growlog_strain;
+CREATE TRIGGER trg_growlog_strain_changes AFTER INSERT OR UPDATE OR DELETE ON growlog_strain
+	FOR EACH ROW EXECUTE PROCEDURE growlog_strain_changes_trigger();
+
 COMMIT;
@@ -57,6 +57,7 @@ CREATE TABLE IF NOT EXISTS growlog_entry (
 		ON DELETE RESTRICT
 );
 CREATE INDEX IF NOT EXISTS idx_growlog_entry_growlog ON growlog_entry(growlog);
+CREATE INDEX IF NOT EXISTS idx_growlog_entry_created_on ON growlog_entry(growlog,created_on,id);
 
 CREATE TABLE IF NOT EXISTS growlog_strain (
 	id INTEGER PRIMARY KEY,
@@ -73,4 +74,304 @@ CREATE TABLE IF NOT EXISTS growlog_strain (
 CREATE INDEX IF NOT EXISTS idx_growlog_strain_growlog ON growlog_strain(growlog);
 CREATE INDEX IF NOT EXISTS idx_growlog_strain_strain ON growlog_strain(strain);
 
-COMMIT;
\ No newline at end of file
+-- Statistics maintained by the triggers below. Days are counted between
+-- calendar dates, a growlog counts for veg_days once it has a flowering
+-- date and for flower_days once it is finished as well.
+CREATE TABLE IF NOT EXISTS growlog_stats (
+	growlog INTEGER PRIMARY KEY,
+	entry_count INTEGER NOT NULL DEFAULT 0,
+	first_entry_on TIMESTAMP,
+	last_entry_on TIMESTAMP,
+	text_bytes INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS strain_stats (
+	strain INTEGER PRIMARY KEY,
+	growlog_count INTEGER NOT NULL DEFAULT 0,
+	veg_count INTEGER NOT NULL DEFAULT 0,
+	veg_days INTEGER NOT NULL DEFAULT 0,
+	flower_count INTEGER NOT NULL DEFAULT 0,
+	flower_days INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_insert_stats AFTER INSERT ON growlog
+BEGIN
+	INSERT OR IGNORE INTO growlog_stats (growlog) VALUES (NEW.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_update_stats
+	AFTER UPDATE OF created_on,flower_on,finished_on ON growlog
+BEGIN
+	UPDATE strain_stats SET
+		veg_count = veg_count - (OLD.flower_on IS NOT NULL) + (NEW.flower_on IS NOT NULL),
+		veg_days = veg_days
+			- IFNULL(julianday(date(OLD.flower_on)) - julianday(date(OLD.created_on)),0)
+			+ IFNULL(julianday(date(NEW.flower_on)) - julianday(date(NEW.created_on)),0),
+		flower_count = flower_count
+			- (OLD.flower_on IS NOT NULL AND OLD.finished_on IS NOT NULL)
+			+ (NEW.flower_on IS NOT NULL AND NEW.finished_on IS NOT NULL),
+		flower_days = flower_days
+			- IFNULL(julianday(date(OLD.finished_on)) - julianday(date(OLD.flower_on)),0)
+			+ IFNULL(julianday(date(NEW.finished_on)) - julianday(date(NEW.flower_on)),0)
+	WHERE strain IN (SELECT strain FROM growlog_strain WHERE growlog = NEW.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_delete_stats AFTER DELETE ON growlog
+BEGIN
+	DELETE FROM growlog_stats WHERE growlog = OLD.id;
+	UPDATE strain_stats SET
+		growlog_count = growlog_count - 1,
+		veg_count = veg_count - (OLD.flower_on IS NOT NULL),
+		veg_days = veg_days - IFNULL(julianday(date(OLD.flower_on)) - julianday(date(OLD.created_on)),0),
+		flower_count = flower_count - (OLD.flower_on IS NOT NULL AND OLD.finished_on IS NOT NULL),
+		flower_days = flower_days - IFNULL(julianday(date(OLD.finished_on)) - julianday(date(OLD.flower_on)),0)
+	WHERE strain IN (SELECT strain FROM growlog_strain WHERE growlog = OLD.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_insert_stats AFTER INSERT ON growlog_entry
+BEGIN
+	INSERT OR IGNORE INTO growlog_stats (growlog) SELECT id FROM growlog WHERE id = NEW.growlog;
+	UPDATE growlog_stats SET
+		entry_count = entry_count + 1,
+		first_entry_on = CASE WHEN first_entry_on IS NULL OR NEW.created_on < first_entry_on
+			THEN NEW.created_on ELSE first_entry_on END,
+		last_entry_on = CASE WHEN last_entry_on IS NULL OR NEW.created_on > last_entry_on
+			THEN NEW.created_on ELSE last_entry_on END,
+		text_bytes = text_bytes + length(CAST(NEW.entry AS BLOB))
+	WHERE growlog = NEW.growlog;
+END;
+
+-- first and last entry are looked up in idx_growlog_entry_created_on
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_update_stats
+	AFTER UPDATE OF growlog,entry,created_on ON growlog_entry
+BEGIN
+	UPDATE growlog_stats SET
+		entry_count = entry_count - 1,
+		text_bytes = text_bytes - length(CAST(OLD.entry AS BLOB))
+	WHERE growlog = OLD.growlog;
+	INSERT OR IGNORE INTO growlog_stats (growlog) SELECT id FROM growlog WHERE id = NEW.growlog;
+	UPDATE growlog_stats SET
+		entry_count = entry_count + 1,
+		text_bytes = text_bytes + length(CAST(NEW.entry AS BLOB))
+	WHERE growlog = NEW.growlog;
+	UPDATE growlog_stats SET
+		first_entry_on = (SELECT MIN(created_on) FROM growlog_entry WHERE growlog = growlog_stats.growlog),
+		last_entry_on = (SELECT MAX(created_on) FROM growlog_entry WHERE growlog = growlog_stats.growlog)
+	WHERE growlog IN (OLD.growlog,NEW.growlog);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_delete_stats AFTER DELETE ON growlog_entry
+BEGIN
+	UPDATE growlog_stats SET
+		entry_count = entry_count - 1,
+		first_entry_on = (SELECT MIN(created_on) FROM growlog_entry WHERE growlog = OLD.growlog),
+		last_entry_on = (SELECT MAX(created_on) FROM growlog_entry WHERE growlog = OLD.growlog),
+		text_bytes = text_bytes - length(CAST(OLD.entry AS BLOB))
+	WHERE growlog = OLD.growlog;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_insert_stats AFTER INSERT ON strain
+BEGIN
+	INSERT OR IGNORE INTO strain_stats (strain) VALUES (NEW.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_delete_stats AFTER DELETE ON strain
+BEGIN
+	DELETE FROM strain_stats WHERE strain = OLD.id;
+END;
+
+-- a link to a growlog that does not exist (any more) does not count
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_insert_stats AFTER INSERT ON growlog_strain
+BEGIN
+	INSERT OR IGNORE INTO strain_stats (strain) SELECT id FROM strain WHERE id = NEW.strain;
+	UPDATE strain_stats SET
+		growlog_count = growlog_count
+			+ (SELECT COUNT(*) FROM growlog WHERE id = NEW.growlog),
+		veg_count = veg_count
+			+ (SELECT COUNT(flower_on) FROM growlog WHERE id = NEW.growlog),
+		veg_days = veg_days
+			+ IFNULL((SELECT julianday(date(flower_on)) - julianday(date(created_on))
+			          FROM growlog WHERE id = NEW.growlog),0),
+		flower_count = flower_count
+			+ (SELECT COUNT(*) FROM growlog
+			   WHERE id = NEW.growlog AND flower_on IS NOT NULL AND finished_on IS NOT NULL),
+		flower_days = flower_days
+			+ IFNULL((SELECT julianday(date(finished_on)) - julianday(date(flower_on))
+			          FROM growlog WHERE id = NEW.growlog),0)
+	WHERE strain = NEW.strain;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_delete_stats AFTER DELETE ON growlog_strain
+BEGIN
+	UPDATE strain_stats SET
+		growlog_count = growlog_count
+			- (SELECT COUNT(*) FROM growlog WHERE id = OLD.growlog),
+		veg_count = veg_count
+			- (SELECT COUNT(flower_on) FROM growlog WHERE id = OLD.growlog),
+		veg_days = veg_days
+			- IFNULL((SELECT julianday(date(flower_on)) - julianday(date(created_on))
+			          FROM growlog WHERE id = OLD.growlog),0),
+		flower_count = flower_count
+			- (SELECT COUNT(*) FROM growlog
+			   WHERE id = OLD.growlog AND flower_on IS NOT NULL AND finished_on IS NOT NULL),
+		flower_days = flower_days
+			- IFNULL((SELECT julianday(date(finished_on)) - julianday(date(flower_on))
+			          FROM growlog WHERE id = OLD.growlog),0)
+	WHERE strain = OLD.strain;
+END;
+
+-- Change tracking for incremental exports. Every insert or update of a row
+-- moves its 'U' record to the end of the log, so there is one per row and
+-- its seq tells when the row changed last. Deletes leave a 'D' record and
+-- changes of a natural key an 'R' record; they carry the natural key the
+-- row had (key1..key3) and for 'R' the new one (new_key1..new_key3), so
+-- they can be applied to books with other ids:
+--   breeder          name
+--   strain           breeder name, name
+--   growlog          title
+--   growlog_strain   growlog title, breeder name, strain name
+--   growlog_entry    growlog title, created_on, entry
+-- Changes of growlog_strain are tracked per growlog, row_id is the id of
+-- the growlog. Updates of growlog_entry and growlog_strain are recorded as
+-- delete and insert.
+-- seq is a plain rowid, AUTOINCREMENT costs a lookup per row. It never goes
+-- back because the triggers insert before they delete, so the record with
+-- the highest seq is never removed.
+CREATE TABLE IF NOT EXISTS change_log (
+	seq INTEGER PRIMARY KEY,
+	table_name VARCHAR(32) NOT NULL,
+	row_id INTEGER NOT NULL,
+	op CHAR(1) NOT NULL,
+	key1 TEXT,
+	key2 TEXT,
+	key3 TEXT,
+	new_key1 TEXT,
+	new_key2 TEXT,
+	new_key3 TEXT
+);
+CREATE INDEX IF NOT EXISTS idx_change_log_row ON change_log(row_id);
+
+-- the last change_log seq an incremental export has written
+CREATE TABLE IF NOT EXISTS change_watermark (
+	name VARCHAR(512) PRIMARY KEY,
+	seq INTEGER NOT NULL
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_breeder_insert_changes AFTER INSERT ON breeder
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('breeder',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_breeder_update_changes AFTER UPDATE ON breeder
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,new_key1)
+		SELECT 'breeder',NEW.id,'R',OLD.name,NEW.name WHERE OLD.name <> NEW.name;
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('breeder',NEW.id,'U');
+	DELETE FROM change_log WHERE row_id = NEW.id AND table_name = 'breeder' AND op = 'U'
+		AND seq < (SELECT MAX(seq) FROM change_log);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_breeder_delete_changes AFTER DELETE ON breeder
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1) VALUES ('breeder',OLD.id,'D',OLD.name);
+	DELETE FROM change_log WHERE row_id = OLD.id AND table_name = 'breeder' AND op = 'U';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_insert_changes AFTER INSERT ON strain
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('strain',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_update_changes AFTER UPDATE ON strain
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,new_key1,new_key2)
+		SELECT 'strain',NEW.id,'R',
+			(SELECT name FROM breeder WHERE id = OLD.breeder),OLD.name,
+			(SELECT name FROM breeder WHERE id = NEW.breeder),NEW.name
+		WHERE OLD.name <> NEW.name OR OLD.breeder <> NEW.breeder;
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('strain',NEW.id,'U');
+	DELETE FROM change_log WHERE row_id = NEW.id AND table_name = 'strain' AND op = 'U'
+		AND seq < (SELECT MAX(seq) FROM change_log);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_strain_delete_changes AFTER DELETE ON strain
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,key2)
+		VALUES ('strain',OLD.id,'D',(SELECT name FROM breeder WHERE id = OLD.breeder),OLD.name);
+	DELETE FROM change_log WHERE row_id = OLD.id AND table_name = 'strain' AND op = 'U';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_insert_changes AFTER INSERT ON growlog
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_update_changes AFTER UPDATE ON growlog
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,new_key1)
+		SELECT 'growlog',NEW.id,'R',OLD.title,NEW.title WHERE OLD.title <> NEW.title;
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog',NEW.id,'U');
+	DELETE FROM change_log WHERE row_id = NEW.id AND table_name = 'growlog' AND op = 'U'
+		AND seq < (SELECT MAX(seq) FROM change_log);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_delete_changes AFTER DELETE ON growlog
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1) VALUES ('growlog',OLD.id,'D',OLD.title);
+	DELETE FROM change_log WHERE row_id = OLD.id AND table_name IN ('growlog','growlog_strain') AND op = 'U';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_insert_changes AFTER INSERT ON growlog_entry
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_entry',NEW.id,'U');
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_update_changes AFTER UPDATE ON growlog_entry
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+		SELECT 'growlog_entry',OLD.id,'D',
+			(SELECT title FROM growlog WHERE id = OLD.growlog),OLD.created_on,OLD.entry
+		WHERE OLD.growlog <> NEW.growlog OR OLD.created_on <> NEW.created_on OR OLD.entry <> NEW.entry;
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_entry',NEW.id,'U');
+	DELETE FROM change_log WHERE row_id = NEW.id AND table_name = 'growlog_entry' AND op = 'U'
+		AND seq < (SELECT MAX(seq) FROM change_log);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_entry_delete_changes AFTER DELETE ON growlog_entry
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+		VALUES ('growlog_entry',OLD.id,'D',
+			(SELECT title FROM growlog WHERE id = OLD.growlog),OLD.created_on,OLD.entry);
+	DELETE FROM change_log WHERE row_id = OLD.id AND table_name = 'growlog_entry' AND op = 'U';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_insert_changes AFTER INSERT ON growlog_strain
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_strain',NEW.growlog,'U');
+	DELETE FROM change_log WHERE row_id = NEW.growlog AND table_name = 'growlog_strain' AND op = 'U'
+		AND seq < (SELECT MAX(seq) FROM change_log);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_update_changes AFTER UPDATE ON growlog_strain
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+		SELECT 'growlog_strain',OLD.growlog,'D',
+			(SELECT title FROM growlog WHERE id = OLD.growlog),
+			(SELECT b.name FROM strain AS s JOIN breeder AS b ON b.id = s.breeder WHERE s.id = OLD.strain),
+			(SELECT name FROM strain WHERE id = OLD.strain)
+		WHERE OLD.growlog <> NEW.growlog OR OLD.strain <> NEW.strain;
+	INSERT INTO change_log (table_name,row_id,op) VALUES ('growlog_strain',NEW.growlog,'U');
+	DELETE FROM change_log WHERE row_id = NEW.growlog AND table_name = 'growlog_strain' AND op = 'U'
+		AND seq < (SELECT MAX(seq) FROM change_log);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_growlog_strain_delete_changes AFTER DELETE ON growlog_strain
+BEGIN
+	INSERT INTO change_log (table_name,row_id,op,key1,key2,key3)
+		VALUES ('growlog_strain',OLD.growlog,'D',
+			(SELECT title FROM growlog WHERE id = OLD.growlog),
+			(SELECT b.name FROM strain AS s JOIN breeder AS b ON b.id = s.breeder WHERE s.id = OLD.strain),
+			(SELECT name FROM strain WHERE id = OLD.strain));
+END;
+
+COMMIT;
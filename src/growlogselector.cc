@@ -31,6 +31,7 @@
 #include "growlogview.h"
 #include "application.h"
 #include "growlogdialog.h"
+#include "trace.h"
 
 /*******************************************************************************
  * GrowlogSelectorColumns
@@ -40,6 +41,7 @@ GrowlogSelectorColumns::GrowlogSelectorColumns()
 {
 	add(column_id);
 	add(column_title);
+	add(column_tooltip);
 }
 
 GrowlogSelectorColumns::~GrowlogSelectorColumns()
@@ -61,9 +63,12 @@ GrowlogSelectorTreeView::GrowlogSelectorTreeView(const Glib::RefPtr<Database> &d
 	m_delete_menuitem_{_("Delete")},
 	m_popup_menu_{}
 {
-	set_model(_create_model());
+	// The data is filled in by refresh() or set_data(), so that the owner
+	// can decide whether to load it synchronously or in the background.
+	set_loading();
 	append_column (_("Title"),columns.column_title);
 	set_headers_visible (false);
+	set_tooltip_column (columns.column_tooltip.index());
 
 	m_popup_menu_.attach_to_widget(*this);
 
@@ -93,9 +98,68 @@ GrowlogSelectorTreeView::~GrowlogSelectorTreeView()
 {
 }
 
+void
+GrowlogSelectorTreeView::load_data(const Glib::RefPtr<Database> &db,Data &data)
+{
+	TRACE_SCOPE("ui","GrowlogSelectorTreeView::load_data");
+
+	data.ongoing_growlogs = db->get_ongoing_growlogs();
+	data.finished_growlogs = db->get_finished_growlogs();
+	data.strain_growlogs.clear();
+
+	std::list<Glib::RefPtr<Breeder> > breeders = db->get_breeders();
+	for (auto b_iter = breeders.begin(); b_iter != breeders.end(); ++b_iter) {
+		std::list<Glib::RefPtr<Strain> > strains{db->get_strains_for_breeder(*b_iter)};
+		for (auto s_iter = strains.begin(); s_iter != strains.end(); ++s_iter) {
+			std::list<Glib::RefPtr<Growlog> > growlogs{db->get_growlogs_for_strain(*s_iter)};
+			if (growlogs.empty())
+				continue;
+
+			GrowlogSelectorStrainGrowlogs item;
+			item.breeder = *b_iter;
+			item.strain = *s_iter;
+			item.growlogs.swap(growlogs);
+			data.strain_growlogs.push_back(item);
+		}
+	}
+
+	// growlog_stats is kept up to date by triggers, books created before
+	// it was added have to run "growbook-cli rebuild-stats" first
+	data.growlog_stats.clear();
+	try {
+		for (auto &stats: db->get_growlog_stats())
+			data.growlog_stats[stats.growlog_id] = stats;
+	} catch (DatabaseError &ex) {
+		data.growlog_stats.clear();
+	}
+}
+
+void
+GrowlogSelectorTreeView::_set_growlog_row(Gtk::TreeModel::Row &row,
+                                          const Glib::RefPtr<Growlog> &growlog,
+                                          const Data &data)
+{
+	row[columns.column_id] = growlog->get_id();
+	row[columns.column_title] = growlog->get_title();
+
+	auto iter = data.growlog_stats.find(growlog->get_id());
+	if (iter == data.growlog_stats.end())
+		return;
+
+	const GrowlogStats &stats = iter->second;
+	Glib::ustring tooltip = Glib::ustring::compose(_("Entries: %1"),stats.entry_count);
+	if (stats.last_entry_on) {
+		tooltip += "\n";
+		tooltip += Glib::ustring::compose(_("Last entry: %1"),
+		                                  Glib::DateTime::create_now_local(stats.last_entry_on).format("%x %X"));
+	}
+	row[columns.column_tooltip] = tooltip;
+}
+
 Glib::RefPtr<Gtk::TreeStore>
-GrowlogSelectorTreeView::_create_model()
+GrowlogSelectorTreeView::_create_model(const Data &data)
 {
+	TRACE_SCOPE("ui","GrowlogSelectorTreeView::_create_model");
 	Glib::RefPtr<Gtk::TreeStore> model = Gtk::TreeStore::create(columns);
 
 	Gtk::TreeModel::iterator parent_iter = model->append();
@@ -104,30 +168,24 @@ GrowlogSelectorTreeView::_create_model()
 	// ongoing growlogs
 	parent_row[columns.column_id] = 0;
 	parent_row[columns.column_title] = _("Ongoing Growlogs");
-	std::list<Glib::RefPtr<Growlog> > ongoing_growlogs{m_database_->get_ongoing_growlogs()};
-	for (auto gl_iter = ongoing_growlogs.begin(); gl_iter != ongoing_growlogs.end(); ++gl_iter) {
+	for (auto gl_iter = data.ongoing_growlogs.begin(); gl_iter != data.ongoing_growlogs.end(); ++gl_iter) {
 		Glib::RefPtr<Growlog> growlog = *gl_iter;
 		Gtk::TreeModel::iterator iter = model->append(parent_row.children());
 		Gtk::TreeModel::Row row = *iter;
-		row[columns.column_id] = growlog->get_id();
-		row[columns.column_title] = growlog->get_title();
+		_set_growlog_row(row,growlog,data);
 	}
-	ongoing_growlogs.clear();
 
 	// finished growlogs
 	parent_iter = model->append();
 	parent_row = *parent_iter;
 	parent_row[columns.column_id] = 0;
 	parent_row[columns.column_title] = _("Finished Growlogs");
-	std::list<Glib::RefPtr<Growlog> > finished_growlogs{m_database_->get_finished_growlogs()};
-	for (auto gl_iter = finished_growlogs.begin(); gl_iter != finished_growlogs.end(); ++gl_iter) {
+	for (auto gl_iter = data.finished_growlogs.begin(); gl_iter != data.finished_growlogs.end(); ++gl_iter) {
 		Glib::RefPtr<Growlog> growlog = *gl_iter;
 		Gtk::TreeModel::iterator iter = model->append(parent_row.children());
 		Gtk::TreeModel::Row row = *iter;
-		row[columns.column_id] = growlog->get_id();
-		row[columns.column_title] = growlog->get_title();
+		_set_growlog_row(row,growlog,data);
 	}
-	finished_growlogs.clear();
 
 	// growlogs per strain
 	parent_iter = model->append();
@@ -135,36 +193,27 @@ GrowlogSelectorTreeView::_create_model()
 	parent_row[columns.column_id] = 0;
 	parent_row[columns.column_title] = _("Strains");
 
-	std::list<Glib::RefPtr<Breeder> > breeders = m_database_->get_breeders();
-	for (auto b_iter = breeders.begin(); b_iter != breeders.end(); ++b_iter) {
-		Glib::RefPtr<Breeder> breeder = *b_iter;
-		Gtk::TreeModel::iterator breeder_iter;
-		
-		std::list<Glib::RefPtr<Strain> > strains{m_database_->get_strains_for_breeder(breeder)};
-		for (auto s_iter = strains.begin(); s_iter != strains.end(); ++s_iter) {
-			Glib::RefPtr<Strain> strain = *s_iter;
-			Gtk::TreeModel::iterator strain_iter;
-			
-			std::list<Glib::RefPtr<Growlog> > growlogs{m_database_->get_growlogs_for_strain(strain)};
-			for (auto gl_iter = growlogs.begin(); gl_iter != growlogs.end(); ++gl_iter) {
-				Glib::RefPtr<Growlog> growlog = *gl_iter;
-				if (!breeder_iter) {
-					breeder_iter = model->append(parent_row.children());
-					Gtk::TreeModel::Row row = *breeder_iter;
-					row[columns.column_id] = 0;
-					row[columns.column_title] = breeder->get_name(); 
-				}
-				if (!strain_iter) {
-					strain_iter = model->append(breeder_iter->children());
-					Gtk::TreeModel::Row row = *strain_iter;
-					row[columns.column_id] = 0;
-					row[columns.column_title] = strain->get_name();
-				}
-				Gtk::TreeModel::iterator iter = model->append(strain_iter->children());
-				Gtk::TreeModel::Row row = *iter;
-				row[columns.column_id] = growlog->get_id();
-				row[columns.column_title] = growlog->get_title();
-			}
+	Gtk::TreeModel::iterator breeder_iter;
+	uint64_t breeder_id = 0;
+	for (auto s_iter = data.strain_growlogs.begin(); s_iter != data.strain_growlogs.end(); ++s_iter) {
+		if (!breeder_iter || s_iter->breeder->get_id() != breeder_id) {
+			breeder_id = s_iter->breeder->get_id();
+			breeder_iter = model->append(parent_row.children());
+			Gtk::TreeModel::Row row = *breeder_iter;
+			row[columns.column_id] = 0;
+			row[columns.column_title] = s_iter->breeder->get_name();
+		}
+
+		Gtk::TreeModel::iterator strain_iter = model->append(breeder_iter->children());
+		Gtk::TreeModel::Row strain_row = *strain_iter;
+		strain_row[columns.column_id] = 0;
+		strain_row[columns.column_title] = s_iter->strain->get_name();
+
+		for (auto gl_iter = s_iter->growlogs.begin(); gl_iter != s_iter->growlogs.end(); ++gl_iter) {
+			Glib::RefPtr<Growlog> growlog = *gl_iter;
+			Gtk::TreeModel::iterator iter = model->append(strain_iter->children());
+			Gtk::TreeModel::Row row = *iter;
+			_set_growlog_row(row,growlog,data);
 		}
 	}
 	
@@ -174,7 +223,28 @@ GrowlogSelectorTreeView::_create_model()
 void
 GrowlogSelectorTreeView::refresh()
 {
-	set_model(_create_model());
+	Data data;
+	load_data(m_database_,data);
+	set_data(data);
+}
+
+void
+GrowlogSelectorTreeView::set_loading()
+{
+	Glib::RefPtr<Gtk::TreeStore> model = Gtk::TreeStore::create(columns);
+	Gtk::TreeModel::Row row = *(model->append());
+	row[columns.column_id] = 0;
+	row[columns.column_title] = _("Loading...");
+
+	set_model(model);
+	set_sensitive(false);
+}
+
+void
+GrowlogSelectorTreeView::set_data(const Data &data)
+{
+	set_model(_create_model(data));
+	set_sensitive(true);
 	show();
 }
 
@@ -399,3 +469,16 @@ GrowlogSelector::refresh()
 	m_treeview_.refresh();
 	show_all();
 }
+
+void
+GrowlogSelector::set_loading()
+{
+	m_treeview_.set_loading();
+}
+
+void
+GrowlogSelector::set_data(const Data &data)
+{
+	m_treeview_.set_data(data);
+	show_all();
+}
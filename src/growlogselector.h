@@ -32,6 +32,9 @@
 #include <gtkmm/menu.h>
 #include <gtkmm/menuitem.h>
 
+#include <list>
+#include <map>
+
 #include "database.h"
 
 class GrowlogSelectorColumns:
@@ -40,17 +43,38 @@ class GrowlogSelectorColumns:
 	 public:
 		 Gtk::TreeModelColumn<uint64_t> column_id;
 		 Gtk::TreeModelColumn<Glib::ustring> column_title;
+		 Gtk::TreeModelColumn<Glib::ustring> column_tooltip;
 
 	public:
 		 GrowlogSelectorColumns();
 		 virtual ~GrowlogSelectorColumns();
 };
 
+// Growlogs of a single strain, as listed in the "Strains" branch.
+struct GrowlogSelectorStrainGrowlogs
+{
+	Glib::RefPtr<Breeder> breeder;
+	Glib::RefPtr<Strain> strain;
+	std::list<Glib::RefPtr<Growlog> > growlogs;
+};
+
+// Everything GrowlogSelectorTreeView shows. It is fetched by
+// GrowlogSelectorTreeView::load_data(), which does not touch any widget
+// and may therefore run off the main thread.
+struct GrowlogSelectorData
+{
+	std::list<Glib::RefPtr<Growlog> > ongoing_growlogs;
+	std::list<Glib::RefPtr<Growlog> > finished_growlogs;
+	std::list<GrowlogSelectorStrainGrowlogs> strain_growlogs;
+	std::map<uint64_t,GrowlogStats> growlog_stats;
+};
+
 class GrowlogSelectorTreeView:
 	public Gtk::TreeView
 {
 	public:
 		using Columns = GrowlogSelectorColumns;
+		using Data = GrowlogSelectorData;
 	public:
 		Columns columns;
 	private:
@@ -67,14 +91,21 @@ class GrowlogSelectorTreeView:
 		virtual ~GrowlogSelectorTreeView();
 
 	private:
-		Glib::RefPtr<Gtk::TreeStore> _create_model();
+		Glib::RefPtr<Gtk::TreeStore> _create_model(const Data &data);
+		void _set_growlog_row(Gtk::TreeModel::Row &row,
+		                      const Glib::RefPtr<Growlog> &growlog,
+		                      const Data &data);
 
 		void on_open();
 		void on_new();
 		void on_edit();
 		void on_delete();
 	public:
+		static void load_data(const Glib::RefPtr<Database> &database,Data &data);
+
 		void refresh();
+		void set_loading();
+		void set_data(const Data &data);
 
 		Glib::RefPtr<Database> get_database();
 		Glib::RefPtr<const Database> get_database() const;
@@ -91,6 +122,7 @@ class GrowlogSelector:
 	public:
 		using Columns = GrowlogSelectorColumns;
 		using TreeView = GrowlogSelectorTreeView;
+		using Data = GrowlogSelectorData;
 		
 	private:
 		TreeView m_treeview_;
@@ -107,6 +139,8 @@ class GrowlogSelector:
 		Glib::RefPtr<const Database> get_database() const;
 
 		void refresh();
+		void set_loading();
+		void set_data(const Data &data);
 };
 
 
@@ -30,6 +30,7 @@
 #include <gtkmm/scrolledwindow.h>
 #include <gtkmm/box.h>
 #include <gtkmm/messagedialog.h>
+#include <gtkmm/cellrenderertext.h>
 
 #include <cassert>
 
@@ -37,6 +38,17 @@
 #include "growlogdialog.h"
 #include "growlogentrydialog.h"
 #include "strainview.h"
+#include "trace.h"
+
+// regions of the GrowlogView text buffer
+enum {
+	GROWLOG_TEXT_TITLE = 0,
+	GROWLOG_TEXT_DATES,
+	GROWLOG_TEXT_AGE,
+	GROWLOG_TEXT_FLOWERING,
+	GROWLOG_TEXT_DESCRIPTION,
+	GROWLOG_TEXT_N_REGIONS
+};
 
 /*******************************************************************************
  * GrowlogViewStrainColumns
@@ -113,6 +125,7 @@ GrowlogViewStrainView::~GrowlogViewStrainView()
 Glib::RefPtr<Gtk::ListStore>
 GrowlogViewStrainView::_create_model()
 {
+	TRACE_SCOPE("ui","GrowlogViewStrainView::_create_model");
 	Glib::RefPtr<Gtk::ListStore> model = Gtk::ListStore::create(columns);
 	
 	std::list<Glib::RefPtr<Strain> > strains{m_database_->get_strains_for_growlog(m_growlog_)};
@@ -167,6 +180,87 @@ GrowlogViewStrainView::set_growlog(const Glib::RefPtr<Growlog> &growlog)
 	show();
 }
 
+/*******************************************************************************
+ * GrowlogViewEntryModel
+ ******************************************************************************/
+
+GrowlogViewEntryModel::GrowlogViewEntryModel(const Columns &columns,
+                                             const Glib::RefPtr<Database> &db,
+                                             const Glib::RefPtr<Growlog> &growlog):
+	DatabaseListModel{columns},
+	m_database_{db},
+	m_growlog_{growlog},
+	m_datetime_format_{app->get_settings()->get_datetime_format()},
+	m_column_id_{columns.column_id.index()},
+	m_column_text_{columns.column_text.index()},
+	m_column_datetime_{columns.column_datetime.index()},
+	m_column_created_on_{columns.column_created_on.index()}
+{
+	assert(m_database_);
+	assert(m_growlog_);
+}
+
+GrowlogViewEntryModel::~GrowlogViewEntryModel()
+{
+}
+
+Glib::RefPtr<GrowlogViewEntryModel>
+GrowlogViewEntryModel::create(const Columns &columns,
+                              const Glib::RefPtr<Database> &db,
+                              const Glib::RefPtr<Growlog> &growlog)
+{
+	return Glib::RefPtr<GrowlogViewEntryModel>(new GrowlogViewEntryModel(columns,db,growlog));
+}
+
+Glib::ustring
+GrowlogViewEntryModel::_format_datetime(const Glib::RefPtr<GrowlogEntry> &entry) const
+{
+	// Always three lines, the view is in fixed height mode and takes the
+	// row height from the first row.
+	time_t day = 24*60*60;
+	Glib::ustring datetime = entry->get_created_on_format(m_datetime_format_);
+	datetime += "\n";
+	datetime += _("Age [days]: ");
+	datetime += std::to_string(entry->get_created_on()/day - m_growlog_->get_created_on()/day);
+	datetime += "\n";
+	if (m_growlog_->get_flower_on() && (entry->get_created_on() >= m_growlog_->get_flower_on())) {
+		datetime += _("Flowering [days]: ");
+		datetime += std::to_string(entry->get_created_on()/day - m_growlog_->get_flower_on()/day);
+	}
+	return datetime;
+}
+
+size_t
+GrowlogViewEntryModel::count_rows_vfunc() const
+{
+	return m_database_->get_growlog_entry_count(m_growlog_->get_id());
+}
+
+std::list<Glib::RefPtr<RefClass> >
+GrowlogViewEntryModel::fetch_rows_vfunc(size_t offset,size_t limit) const
+{
+	std::list<Glib::RefPtr<GrowlogEntry> > entries{m_database_->get_growlog_entries(m_growlog_->get_id(),offset,limit)};
+	return std::list<Glib::RefPtr<RefClass> >(entries.begin(),entries.end());
+}
+
+void
+GrowlogViewEntryModel::get_item_value_vfunc(const Glib::RefPtr<RefClass> &item,
+                                            int column,
+                                            Glib::ValueBase &value) const
+{
+	Glib::RefPtr<GrowlogEntry> entry = Glib::RefPtr<GrowlogEntry>::cast_static(item);
+
+	if (column == m_column_id_) {
+		set_value<uint64_t>(value,entry->get_id());
+	} else if (column == m_column_text_) {
+		set_value<Glib::ustring>(value,entry->get_text());
+	} else if (column == m_column_datetime_) {
+		set_value<Glib::ustring>(value,_format_datetime(entry));
+	} else if (column == m_column_created_on_) {
+		set_value<time_t>(value,entry->get_created_on());
+	}
+}
+
 /*******************************************************************************
  * GrowlogViewEntryView
  ******************************************************************************/
@@ -176,56 +270,66 @@ GrowlogViewEntryView::GrowlogViewEntryView(const Glib::RefPtr<Database> &db,
 	Gtk::TreeView{},
 	columns{},
 	m_database_{db},
-	m_growlog_{growlog}
+	m_growlog_{growlog},
+	m_sort_order_{Gtk::SORT_ASCENDING}
 {
 	assert(m_database_);
 	assert(m_growlog_);
 
-	set_model(_create_model());
-
 	append_column("Created on",columns.column_datetime);
 	append_column("Text",columns.column_text);
 
+	// Fixed height mode lets the view ask only for the visible rows, so
+	// the model fetches the entries page by page while scrolling.
 	Gtk::TreeViewColumn *col = get_column(0);
-	if (col)
-		col->set_sort_column(columns.column_created_on);
+	if (col) {
+		col->set_sizing(Gtk::TREE_VIEW_COLUMN_FIXED);
+		col->set_fixed_width(180);
+		col->set_resizable(true);
+		col->set_clickable(true);
+		col->set_sort_indicator(true);
+		col->set_sort_order(m_sort_order_);
+		col->signal_clicked().connect(sigc::mem_fun(*this,&GrowlogViewEntryView::on_created_on_clicked));
+	}
+	col = get_column(1);
+	if (col) {
+		col->set_sizing(Gtk::TREE_VIEW_COLUMN_FIXED);
+		col->set_fixed_width(200);
+		col->set_expand(true);
+		Gtk::CellRendererText *renderer = dynamic_cast<Gtk::CellRendererText*>(col->get_first_cell());
+		if (renderer)
+			renderer->property_ellipsize() = Pango::ELLIPSIZE_END;
+	}
+	set_fixed_height_mode(true);
+
+	set_model(_create_model());
 }
 
 GrowlogViewEntryView::~GrowlogViewEntryView()
 {
 }
 
-Glib::RefPtr<Gtk::ListStore>
+Glib::RefPtr<GrowlogViewEntryModel>
 GrowlogViewEntryView::_create_model()
 {
-	Glib::RefPtr<Gtk::ListStore> model = Gtk::ListStore::create(columns);
-
-	std::list<Glib::RefPtr<GrowlogEntry> > entries{m_database_->get_growlog_entries(m_growlog_)};
-	for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
-		Glib::RefPtr<GrowlogEntry> entry = *iter;
-		Gtk::TreeModel::iterator model_iter = model->append();
-		Gtk::TreeModel::Row row = *model_iter;
-
-		row[columns.column_id] = entry->get_id();
-		row[columns.column_text] = entry->get_text();
-		row[columns.column_created_on] = entry->get_created_on();
-		
-		time_t day = 24*60*60;
-		Glib::ustring datetime = entry->get_created_on_format(app->get_settings()->get_datetime_format());
-		datetime += "\n";
-		datetime += _("Age [days]: ");
-		datetime += std::to_string(entry->get_created_on()/day - m_growlog_->get_created_on()/day);
-		if (m_growlog_->get_flower_on() && (entry->get_created_on() >= m_growlog_->get_flower_on())) {
-			datetime += "\n";
-			datetime += _("Flowering [days]: ");
-			datetime += std::to_string(entry->get_created_on()/day - m_growlog_->get_flower_on()/day);
-		}
-		row[columns.column_datetime] = datetime; 
-	}
+	TRACE_SCOPE("ui","GrowlogViewEntryView::_create_model");
+	Glib::RefPtr<GrowlogViewEntryModel> model = GrowlogViewEntryModel::create(columns,m_database_,m_growlog_);
+	model->set_reversed(m_sort_order_ == Gtk::SORT_DESCENDING);
 	
 	return model;
 }
 
+void
+GrowlogViewEntryView::on_created_on_clicked()
+{
+	m_sort_order_ = (m_sort_order_ == Gtk::SORT_ASCENDING) ? Gtk::SORT_DESCENDING : Gtk::SORT_ASCENDING;
+
+	Gtk::TreeViewColumn *col = get_column(0);
+	if (col)
+		col->set_sort_order(m_sort_order_);
+	set_model(_create_model());
+}
+
 Glib::RefPtr<Database>
 GrowlogViewEntryView::get_database()
 {
@@ -279,6 +383,8 @@ GrowlogView::GrowlogView(const Glib::RefPtr<Database> &db,
 	m_edit_logentry_button_{_("Edit log-entry")},
 	m_remove_logentry_button_{_("Remove log-entry")},
 	m_toolbar_{},
+	m_text_regions_{GROWLOG_TEXT_N_REGIONS},
+	m_textview_{},
 	m_strain_view_{db,growlog},
 	m_entry_view_{db,growlog}
 {
@@ -352,7 +458,8 @@ GrowlogView::GrowlogView(const Glib::RefPtr<Database> &db,
 	pack_start(*scrolled,true,true,0);
 
 	// TextView ////////////////////////////////////////////////////////////////
-	m_textview_.set_buffer(_create_textbuffer());
+	_update_textbuffer();
+	m_textview_.set_buffer(m_text_regions_.get_buffer());
 	m_textview_.set_wrap_mode(Gtk::WRAP_WORD);
 	m_textview_.set_border_width (5);
 	m_textview_.set_editable(false);
@@ -374,73 +481,71 @@ GrowlogView::~GrowlogView()
 {
 }
 
-Glib::RefPtr<Gtk::TextBuffer>
-GrowlogView::_create_textbuffer()
+void
+GrowlogView::_update_textbuffer()
 {
-	Glib::RefPtr<Gtk::TextBuffer> buffer = Gtk::TextBuffer::create();
-	Glib::RefPtr<Gtk::TextTagTable> tag_table = buffer->get_tag_table();
-	
-	Glib::RefPtr<Gtk::TextTag> title_tag = Gtk::TextTag::create("title");
-	title_tag->property_weight() = PANGO_WEIGHT_BOLD;
-	title_tag->property_scale() = 3.0;
-	tag_table->add(title_tag);
-	
-	Glib::RefPtr<Gtk::TextTag> paragraph_tag = Gtk::TextTag::create("paragraph");
-	paragraph_tag->property_weight() = PANGO_WEIGHT_BOLD;
-	paragraph_tag->property_scale() = 2.0;
-	tag_table->add(paragraph_tag);
-	
-	Glib::RefPtr<Gtk::TextTag> bold_tag = Gtk::TextTag::create("bold");
-	bold_tag->property_weight() = PANGO_WEIGHT_BOLD;
-	tag_table->add(bold_tag);
-
-	buffer->insert_with_tag(buffer->begin(),m_growlog_->get_title(),title_tag);
-	buffer->insert(buffer->end(),"\n\n");
-
-	buffer->insert_with_tag(buffer->end(),_("Created on: "),bold_tag);
-	buffer->insert(buffer->end(),m_growlog_->get_created_on_format(app->get_settings()->get_datetime_format()));
-	buffer->insert(buffer->end(),"\n");
+	TRACE_SCOPE("ui","GrowlogView::_update_textbuffer");
+	using Pieces = TextBufferRegions::Pieces;
 
+	Glib::ustring datetime_format = app->get_settings()->get_datetime_format();
 	time_t current_time = time(nullptr);
 	time_t day = 24*60*60;
 	time_t age;
 
+	m_text_regions_.set_region(GROWLOG_TEXT_TITLE,Pieces{
+		{"title",m_growlog_->get_title()},
+		{"","\n\n"}
+	});
+
+	Pieces dates{
+		{"bold",_("Created on: ")},
+		{"",m_growlog_->get_created_on_format(datetime_format)},
+		{"","\n"}
+	};
 	if (m_growlog_->get_finished_on()) {
 		age = (m_growlog_->get_finished_on()/day - m_growlog_->get_created_on()/day);
 
-		buffer->insert_with_tag(buffer->end(),_("Finished on: "),bold_tag);
-		buffer->insert(buffer->end(),m_growlog_->get_finished_on_format(app->get_settings()->get_datetime_format()));
-		buffer->insert(buffer->end(),"\n");
+		dates.push_back({"bold",_("Finished on: ")});
+		dates.push_back({"",m_growlog_->get_finished_on_format(datetime_format)});
+		dates.push_back({"","\n"});
 	} else {
 		age = current_time/day - m_growlog_->get_created_on()/day;
 	}
-	buffer->insert_with_tag(buffer->end(),_("Age: "),bold_tag);
-	buffer->insert(buffer->end(),std::to_string(age));
-	buffer->insert(buffer->end(),_(" day(s)"));
-	buffer->insert(buffer->end(),"\n");
+	m_text_regions_.set_region(GROWLOG_TEXT_DATES,dates);
 
+	m_text_regions_.set_region(GROWLOG_TEXT_AGE,Pieces{
+		{"bold",_("Age: ")},
+		{"",std::to_string(age)},
+		{"",_(" day(s)")},
+		{"","\n"}
+	});
+
+	Pieces flowering_pieces;
 	if (m_growlog_->get_flower_on()) {
-		buffer->insert_with_tag(buffer->end(),_("Started flowering on: "),bold_tag);
-		buffer->insert(buffer->end(),m_growlog_->get_flower_on_format(app->get_settings()->get_date_format()));
-		buffer->insert(buffer->end(),"\n");
-		buffer->insert_with_tag(buffer->end(),_("Flowering-days: "),bold_tag);
 		time_t flowering;
 		if (m_growlog_->get_finished_on()) {
 			flowering = (m_growlog_->get_finished_on()/day - m_growlog_->get_flower_on()/day);
 		} else {
 			flowering = (current_time/day - m_growlog_->get_flower_on()/day);
 		}
-		buffer->insert(buffer->end(),std::to_string(flowering));
-		buffer->insert(buffer->end(),"\n");
+		flowering_pieces = Pieces{
+			{"bold",_("Started flowering on: ")},
+			{"",m_growlog_->get_flower_on_format(app->get_settings()->get_date_format())},
+			{"","\n"},
+			{"bold",_("Flowering-days: ")},
+			{"",std::to_string(flowering)},
+			{"","\n"}
+		};
 	}
+	m_text_regions_.set_region(GROWLOG_TEXT_FLOWERING,flowering_pieces);
 
-	buffer->insert(buffer->end(),"\n");
-
-	buffer->insert_with_tag(buffer->end(),_("Description"),paragraph_tag);
-	buffer->insert(buffer->end(),"\n");
-	buffer->insert(buffer->end(),m_growlog_->get_description());
-	buffer->insert(buffer->end(),"\n");
-	return buffer;
+	m_text_regions_.set_region(GROWLOG_TEXT_DESCRIPTION,Pieces{
+		{"","\n"},
+		{"paragraph",_("Description")},
+		{"","\n"},
+		{"",m_growlog_->get_description()},
+		{"","\n"}
+	});
 }
 
 uint64_t
@@ -469,7 +574,7 @@ GrowlogView::on_refresh()
 	} else {
 		m_add_logentry_button_.set_sensitive(true);
 	}
-	m_textview_.set_buffer(_create_textbuffer());
+	_update_textbuffer();
 	m_strain_view_.set_growlog(m_growlog_);
 	m_entry_view_.set_growlog(m_growlog_);
 	on_entry_view_selection_changed();
@@ -34,6 +34,8 @@
 #include <gtkmm/liststore.h>
 
 #include "browserpage.h"
+#include "databaselistmodel.h"
+#include "textbufferregions.h"
 
 class GrowlogViewStrainColumns:
 	public Gtk::TreeModelColumnRecord
@@ -62,6 +64,44 @@ class GrowlogViewEntryColumns:
 		virtual ~GrowlogViewEntryColumns();
 };
 
+class GrowlogViewEntryModel:
+	public DatabaseListModel
+{
+	public:
+		using Columns = GrowlogViewEntryColumns;
+
+	private:
+		Glib::RefPtr<Database> m_database_;
+		Glib::RefPtr<Growlog> m_growlog_;
+		Glib::ustring m_datetime_format_;
+		int m_column_id_;
+		int m_column_text_;
+		int m_column_datetime_;
+		int m_column_created_on_;
+
+	protected:
+		GrowlogViewEntryModel(const Columns &columns,
+		                      const Glib::RefPtr<Database> &database,
+		                      const Glib::RefPtr<Growlog> &growlog);
+
+	public:
+		virtual ~GrowlogViewEntryModel();
+
+		static Glib::RefPtr<GrowlogViewEntryModel> create(const Columns &columns,
+		                                                  const Glib::RefPtr<Database> &database,
+		                                                  const Glib::RefPtr<Growlog> &growlog);
+
+	private:
+		Glib::ustring _format_datetime(const Glib::RefPtr<GrowlogEntry> &entry) const;
+
+	protected:
+		virtual size_t count_rows_vfunc() const override;
+		virtual std::list<Glib::RefPtr<RefClass> > fetch_rows_vfunc(size_t offset,size_t limit) const override;
+		virtual void get_item_value_vfunc(const Glib::RefPtr<RefClass> &item,
+		                                  int column,
+		                                  Glib::ValueBase &value) const override;
+};
+
 class GrowlogViewStrainView:
 	public Gtk::TreeView
 {
@@ -103,6 +143,7 @@ class GrowlogViewEntryView:
 	private:
 		Glib::RefPtr<Database> m_database_;
 		Glib::RefPtr<Growlog> m_growlog_;
+		Gtk::SortType m_sort_order_;
 		
 	public:
 		GrowlogViewEntryView(const Glib::RefPtr<Database> &database,
@@ -110,7 +151,9 @@ class GrowlogViewEntryView:
 		virtual ~GrowlogViewEntryView();
 
 	private:
-		Glib::RefPtr<Gtk::ListStore> _create_model();
+		Glib::RefPtr<GrowlogViewEntryModel> _create_model();
+
+		void on_created_on_clicked();
 
 	public:
 		Glib::RefPtr<Database> get_database();
@@ -145,6 +188,7 @@ class GrowlogView:
 		 Gtk::ToolButton m_remove_logentry_button_;
 		 Gtk::Toolbar m_toolbar_;
 
+		 TextBufferRegions m_text_regions_;
 		 Gtk::TextView m_textview_;
 		 StrainView m_strain_view_;
 		 EntryView m_entry_view_;
@@ -155,7 +199,7 @@ class GrowlogView:
 		 virtual ~GrowlogView();
 
 	private:
-		 Glib::RefPtr<Gtk::TextBuffer> _create_textbuffer();
+		 void _update_textbuffer();
 		 
 		 
 	protected:
@@ -28,20 +28,349 @@
 #include <glibmm.h>
 #include <glibmm/i18n.h>
 
-#include <gtkmm/messagedialog.h>
-
 #include <cassert>
-
+#include <cstdio>
 #include <ctime>
+#include <set>
 
 #ifdef NATIVE_WINDOWS
 # include "strptime.h"
 #endif
 
-#include "application.h"
+#include "database-mirror.h"
 #include "error.h"
-#include "growlogdialog.h"
-#include "xml_importer.h"
+#include "trace.h"
+
+/*******************************************************************************
+ * ImportConflictHandler
+ ******************************************************************************/
+
+ImportConflictHandler::ImportConflictHandler(ImportConflictAction breeder_action,
+                                             ImportConflictAction growlog_action):
+	RefClass{},
+	m_breeder_action_{breeder_action},
+	m_growlog_action_{growlog_action}
+{
+}
+
+ImportConflictHandler::~ImportConflictHandler()
+{
+}
+
+Glib::RefPtr<ImportConflictHandler>
+ImportConflictHandler::create(ImportConflictAction breeder_action,
+                              ImportConflictAction growlog_action)
+{
+	return Glib::RefPtr<ImportConflictHandler>(new ImportConflictHandler(breeder_action,growlog_action));
+}
+
+ImportConflictAction
+ImportConflictHandler::resolve_breeder(const Glib::ustring &name)
+{
+	return resolve_breeder_vfunc(name);
+}
+
+ImportConflictAction
+ImportConflictHandler::resolve_growlog(const Glib::RefPtr<const Database> &database,
+                                       const Glib::ustring &title,
+                                       Glib::ustring &new_title)
+{
+	ImportConflictAction action = resolve_growlog_vfunc(database,title,new_title);
+	if (action == IMPORT_CONFLICT_RENAME
+	    && (new_title.empty() || database->get_growlog(new_title))) {
+		Glib::ustring msg = _("Unable to rename growlog, skipping it!");
+		msg += "\n(";
+		msg += title;
+		msg += ")";
+		warning(msg);
+		return IMPORT_CONFLICT_SKIP;
+	}
+	return action;
+}
+
+void
+ImportConflictHandler::warning(const Glib::ustring &message)
+{
+	warning_vfunc(message);
+}
+
+ImportConflictAction
+ImportConflictHandler::resolve_breeder_vfunc(const Glib::ustring &name)
+{
+	return m_breeder_action_;
+}
+
+ImportConflictAction
+ImportConflictHandler::resolve_growlog_vfunc(const Glib::RefPtr<const Database> &database,
+                                             const Glib::ustring &title,
+                                             Glib::ustring &new_title)
+{
+	if (m_growlog_action_ == IMPORT_CONFLICT_RENAME) {
+		for (unsigned int i = 2; ; ++i) {
+			new_title = title + " (" + std::to_string(i) + ")";
+			if (!database->get_growlog(new_title))
+				break;
+		}
+	}
+	return m_growlog_action_;
+}
+
+void
+ImportConflictHandler::warning_vfunc(const Glib::ustring &message)
+{
+	fprintf(stderr,"%s\n",message.c_str());
+}
+
+/*******************************************************************************
+ * ImportPlan
+ ******************************************************************************/
+
+ImportPlan::ImportPlan(const Glib::RefPtr<const Database> &database):
+	RefClass{},
+	m_database_{database},
+	m_breeder_names_{},
+	m_titles_{},
+	m_breeders_{},
+	m_growlogs_{},
+	m_breeder_index_{},
+	m_growlog_index_{},
+	m_breeder_conflicts_{0},
+	m_growlog_conflicts_{0},
+	m_strain_count_{0},
+	m_entry_count_{0}
+{
+	assert(m_database_);
+
+	for (auto &breeder: m_database_->get_breeders())
+		m_breeder_names_.insert(breeder->get_name().raw());
+	for (auto &growlog: m_database_->get_growlogs())
+		m_titles_.insert(growlog->get_title().raw());
+}
+
+ImportPlan::~ImportPlan()
+{
+}
+
+Glib::RefPtr<ImportPlan>
+ImportPlan::create(const Glib::RefPtr<const Database> &database)
+{
+	return Glib::RefPtr<ImportPlan>(new ImportPlan(database));
+}
+
+void
+ImportPlan::add_breeder(const Glib::ustring &name)
+{
+	if (m_breeder_index_.count(name.raw()))
+		return;
+
+	bool exists = m_breeder_names_.count(name.raw()) > 0;
+	if (exists)
+		++m_breeder_conflicts_;
+	m_breeder_index_[name.raw()] = m_breeders_.size();
+	m_breeders_.push_back(ImportPlanItem{name,exists,IMPORT_CONFLICT_MERGE,Glib::ustring()});
+}
+
+void
+ImportPlan::add_growlog(const Glib::ustring &title)
+{
+	if (m_growlog_index_.count(title.raw()))
+		return;
+
+	bool exists = !m_titles_.insert(title.raw()).second;
+	ImportConflictAction action = IMPORT_CONFLICT_MERGE;
+	if (exists) {
+		++m_growlog_conflicts_;
+		action = IMPORT_CONFLICT_SKIP;
+	}
+	m_growlog_index_[title.raw()] = m_growlogs_.size();
+	m_growlogs_.push_back(ImportPlanItem{title,exists,action,Glib::ustring()});
+}
+
+void
+ImportPlan::add_strains(uint64_t n)
+{
+	m_strain_count_ += n;
+}
+
+void
+ImportPlan::add_entries(uint64_t n)
+{
+	m_entry_count_ += n;
+}
+
+const std::vector<ImportPlanItem>&
+ImportPlan::get_breeders() const
+{
+	return m_breeders_;
+}
+
+const std::vector<ImportPlanItem>&
+ImportPlan::get_growlogs() const
+{
+	return m_growlogs_;
+}
+
+const ImportPlanItem*
+ImportPlan::find_breeder(const Glib::ustring &name) const
+{
+	auto iter = m_breeder_index_.find(name.raw());
+	if (iter == m_breeder_index_.end())
+		return nullptr;
+	return &m_breeders_[iter->second];
+}
+
+const ImportPlanItem*
+ImportPlan::find_growlog(const Glib::ustring &title) const
+{
+	auto iter = m_growlog_index_.find(title.raw());
+	if (iter == m_growlog_index_.end())
+		return nullptr;
+	return &m_growlogs_[iter->second];
+}
+
+size_t
+ImportPlan::get_breeder_conflict_count() const
+{
+	return m_breeder_conflicts_;
+}
+
+size_t
+ImportPlan::get_growlog_conflict_count() const
+{
+	return m_growlog_conflicts_;
+}
+
+uint64_t
+ImportPlan::get_strain_count() const
+{
+	return m_strain_count_;
+}
+
+uint64_t
+ImportPlan::get_entry_count() const
+{
+	return m_entry_count_;
+}
+
+bool
+ImportPlan::has_conflicts() const
+{
+	return (m_breeder_conflicts_ > 0 || m_growlog_conflicts_ > 0);
+}
+
+void
+ImportPlan::set_breeder_action(size_t index, ImportConflictAction action)
+{
+	assert(index < m_breeders_.size());
+	assert(action == IMPORT_CONFLICT_MERGE || action == IMPORT_CONFLICT_UPDATE);
+
+	if (m_breeders_[index].exists)
+		m_breeders_[index].action = action;
+}
+
+bool
+ImportPlan::rename_growlog(size_t index, const Glib::ustring &new_title)
+{
+	assert(index < m_growlogs_.size());
+	ImportPlanItem &item = m_growlogs_[index];
+	if (!item.exists)
+		return false;
+	if (item.action == IMPORT_CONFLICT_RENAME && item.new_title == new_title)
+		return true;
+	if (!is_title_free(new_title))
+		return false;
+
+	skip_growlog(index);
+	m_titles_.insert(new_title.raw());
+	item.action = IMPORT_CONFLICT_RENAME;
+	item.new_title = new_title;
+	return true;
+}
+
+void
+ImportPlan::skip_growlog(size_t index)
+{
+	assert(index < m_growlogs_.size());
+	ImportPlanItem &item = m_growlogs_[index];
+	if (!item.exists)
+		return;
+
+	if (item.action == IMPORT_CONFLICT_RENAME)
+		m_titles_.erase(item.new_title.raw());
+	item.action = IMPORT_CONFLICT_SKIP;
+	item.new_title.clear();
+}
+
+bool
+ImportPlan::is_title_free(const Glib::ustring &title) const
+{
+	return (!title.empty() && !m_titles_.count(title.raw()));
+}
+
+Glib::ustring
+ImportPlan::suggest_title(const Glib::ustring &title) const
+{
+	Glib::ustring new_title;
+	for (unsigned int i = 2; ; ++i) {
+		new_title = title + " (" + std::to_string(i) + ")";
+		if (is_title_free(new_title))
+			break;
+	}
+	return new_title;
+}
+
+bool
+ImportPlan::resolve(const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	TRACE_SCOPE("import","ImportPlan::resolve");
+	assert(handler);
+
+	ImportConflictAction response = IMPORT_CONFLICT_ABORT;
+	for (size_t i = 0; i < m_breeders_.size(); ++i) {
+		if (!m_breeders_[i].exists)
+			continue;
+		if (response != IMPORT_CONFLICT_UPDATE_ALL && response != IMPORT_CONFLICT_MERGE_ALL) {
+			response = handler->resolve_breeder(m_breeders_[i].name);
+			if (response == IMPORT_CONFLICT_ABORT)
+				return false;
+		}
+		if (response == IMPORT_CONFLICT_UPDATE || response == IMPORT_CONFLICT_UPDATE_ALL) {
+			set_breeder_action(i,IMPORT_CONFLICT_UPDATE);
+		} else {
+			set_breeder_action(i,IMPORT_CONFLICT_MERGE);
+		}
+	}
+
+	bool skip_all = false;
+	for (size_t i = 0; i < m_growlogs_.size(); ++i) {
+		if (!m_growlogs_[i].exists)
+			continue;
+		skip_growlog(i);
+		if (skip_all)
+			continue;
+
+		Glib::ustring title = m_growlogs_[i].name;
+		Glib::ustring new_title;
+		ImportConflictAction action = handler->resolve_growlog(m_database_,title,new_title);
+		if (action == IMPORT_CONFLICT_ABORT)
+			return false;
+		if (action == IMPORT_CONFLICT_SKIP_ALL)
+			skip_all = true;
+		if (action != IMPORT_CONFLICT_RENAME)
+			continue;
+		// resolve_growlog() only knows the titles already in the book, a
+		// title that another growlog of the file uses is replaced by the
+		// next free one
+		if (!rename_growlog(i,new_title) && !rename_growlog(i,suggest_title(title))) {
+			Glib::ustring msg = _("Unable to rename growlog, skipping it!");
+			msg += "\n(";
+			msg += title;
+			msg += ")";
+			handler->warning(msg);
+		}
+	}
+	return true;
+}
 
 /*******************************************************************************
  * Importer
@@ -50,7 +379,8 @@
 Importer::Importer(const Glib::RefPtr<Database> &database,
                    const std::string &filename):
 	m_database_(database),
-	m_filename_(filename)
+	m_filename_(filename),
+	m_plan_()
 {
 	assert(m_database_);
 	assert(m_database_->is_connected());
@@ -91,17 +421,67 @@ Importer::get_filename() const
 void
 Importer::import_db()
 {
+	import_db(ImportConflictHandler::create());
+}
+
+void
+Importer::import_db(const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	TRACE_SCOPE("import","Importer::import_db");
 	assert(file_exists());
-	
-	import_vfunc(*app->get_appwindow());
+	assert(handler);
+
+	Glib::RefPtr<ImportPlan> plan = scan();
+	if (plan && !plan->resolve(handler))
+		return;
+	_import(plan,handler);
 }
 
 void
-Importer::import_db(Gtk::Window &parent)
+Importer::import_db(const Glib::RefPtr<ImportPlan> &plan,
+                    const Glib::RefPtr<ImportConflictHandler> &handler)
 {
+	TRACE_SCOPE("import","Importer::import_db");
 	assert(file_exists());
-	
-	import_vfunc(parent);
+	assert(plan);
+	assert(handler);
+
+	_import(plan,handler);
+}
+
+void
+Importer::_import(const Glib::RefPtr<ImportPlan> &plan,
+                  const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	m_plan_ = plan;
+	try {
+		import_vfunc(handler);
+	} catch (...) {
+		m_plan_.reset();
+		throw;
+	}
+	m_plan_.reset();
+}
+
+Glib::RefPtr<ImportPlan>
+Importer::scan()
+{
+	TRACE_SCOPE("import","Importer::scan");
+	assert(file_exists());
+
+	return scan_vfunc();
+}
+
+Glib::RefPtr<const ImportPlan>
+Importer::get_plan() const
+{
+	return m_plan_;
+}
+
+Glib::RefPtr<ImportPlan>
+Importer::scan_vfunc()
+{
+	return Glib::RefPtr<ImportPlan>();
 }
 
 bool
@@ -120,7 +500,8 @@ DB_Importer::DB_Importer(const Glib::RefPtr<Database> &db,
 	Importer(db, filename),
 	m_breeder_map_(),
 	m_strain_map_(),
-	m_growlog_map_()
+	m_growlog_map_(),
+	m_merge_in_engine_(true)
 {
 }
 
@@ -135,14 +516,22 @@ DB_Importer::create(const Glib::RefPtr<Database> &db,
 	return Glib::RefPtr<DB_Importer>(new DB_Importer(db,filename));
 }
 
+bool
+DB_Importer::get_merge_in_engine() const
+{
+	return m_merge_in_engine_;
+}
 
 void
-DB_Importer::import_vfunc(Gtk::Window &parent)
+DB_Importer::set_merge_in_engine(bool b)
+{
+	m_merge_in_engine_ = b;
+}
+
+
+Glib::RefPtr<Database>
+DB_Importer::_open_import_db()
 {
-	m_breeder_map_.clear();
-	m_strain_map_.clear();
-	m_growlog_map_.clear();
-	
 	Glib::RefPtr<DatabaseModule> module = db_get_module("sqlite3");
 	assert(module);
 
@@ -152,54 +541,78 @@ DB_Importer::import_vfunc(Gtk::Window &parent)
 	Glib::RefPtr<Database> import_db = module->create_database(import_settings);
 	assert(import_db);
 	
+	import_db->connect();
+	return import_db;
+}
+
+Glib::RefPtr<ImportPlan>
+DB_Importer::scan_vfunc()
+{
+	TRACE_SCOPE("import","DB_Importer::scan_vfunc");
+	Glib::RefPtr<Database> import_db = _open_import_db();
+	Glib::RefPtr<ImportPlan> plan = ImportPlan::create(get_database());
+
+	for (auto &breeder: import_db->get_breeders())
+		plan->add_breeder(breeder->get_name());
+	plan->add_strains(import_db->get_strains().size());
+	std::list<Glib::RefPtr<Growlog> > growlogs{import_db->get_growlogs()};
+	for (auto &growlog: growlogs)
+		plan->add_growlog(growlog->get_title());
+
+	// files written before growlog_stats was added do not have the table,
+	// their entries are counted growlog by growlog
 	try {
-		import_db->connect();
-	} catch (DatabaseError ex) {
-		Gtk::MessageDialog dialog(parent,
-		                          ex.what(),
-		                          false,
-		                          Gtk::MESSAGE_ERROR,
-		                          Gtk::BUTTONS_OK,
-		                          true);
-		dialog.run();
-		dialog.hide();
+		for (auto &stats: import_db->get_growlog_stats())
+			plan->add_entries(stats.entry_count);
+	} catch (DatabaseError &ex) {
+		for (auto &growlog: growlogs)
+			plan->add_entries(import_db->get_growlog_entry_count(growlog->get_id()));
+	}
+
+	import_db->close();
+	return plan;
+}
+
+void
+DB_Importer::import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	TRACE_SCOPE("import","DB_Importer::import_vfunc");
+	assert(get_plan());
+	m_breeder_map_.clear();
+	m_strain_map_.clear();
+	m_growlog_map_.clear();
+	
+	Glib::RefPtr<Database> import_db = _open_import_db();
+
+	// a mirror has to see every write to queue it for the remote database
+	Glib::RefPtr<DatabaseSqlite3> db = Glib::RefPtr<DatabaseSqlite3>::cast_dynamic(get_database());
+	if (m_merge_in_engine_ && db && !Glib::RefPtr<DatabaseMirror>::cast_dynamic(get_database())) {
+		_merge_sqlite3(import_db,db);
 		return;
 	}
 
-	_import_strains(parent,import_db);
-	_import_growlogs(parent,import_db);
+	_import_strains(import_db);
+	_import_growlogs(import_db);
 }
 
 
 void
-DB_Importer::_import_strains(Gtk::Window &parent,
-                             const Glib::RefPtr<Database> &import_db)
+DB_Importer::_import_strains(const Glib::RefPtr<Database> &import_db)
 {
+	TRACE_SCOPE("import","DB_Importer::_import_strains");
 	assert(import_db && import_db->is_connected());
 
-	int response = RESPONSE_NONE;
+	Glib::RefPtr<const ImportPlan> plan = get_plan();
 	Glib::RefPtr<Database> db = get_database();
 	std::list<Glib::RefPtr<Breeder> > breeders{import_db->get_breeders()};
 	for (auto breeder_iter = breeders.begin(); breeder_iter != breeders.end(); ++breeder_iter) {
 		Glib::RefPtr<Breeder> import_breeder = *breeder_iter;
 		Glib::RefPtr<Breeder> breeder = db->get_breeder(import_breeder->get_name());
+		bool update = false;
 
-		if (breeder && response != RESPONSE_UPDATE_ALL && !response != RESPONSE_MERGE_ALL) {
-			Gtk::MessageDialog dialog(parent,
-			                          "Breeder already exists! How do you want to perceed?",
-			                          false,
-			                          Gtk::MESSAGE_QUESTION,
-			                          Gtk::BUTTONS_NONE,
-			                          true);
-			dialog.add_button(_("Merge"), RESPONSE_MERGE);
-			dialog.add_button(_("Merge All"), RESPONSE_MERGE_ALL);
-			dialog.add_button(_("Update"), RESPONSE_UPDATE);
-			dialog.add_button(_("Update All"), RESPONSE_UPDATE_ALL);
-			
-			response = dialog.run();
-			dialog.hide();
-			if (response == Gtk::RESPONSE_DELETE_EVENT)
-				return;
+		if (breeder) {
+			const ImportPlanItem *item = plan->find_breeder(import_breeder->get_name());
+			update = (item && item->action == IMPORT_CONFLICT_UPDATE);
 		}
 		if (!breeder) {
 			breeder = Breeder::create(import_breeder->get_name(),
@@ -207,7 +620,7 @@ DB_Importer::_import_strains(Gtk::Window &parent,
 			db->add_breeder(breeder);
 			breeder = db->get_breeder(import_breeder->get_name());
 			assert(breeder);
-		} if (response == RESPONSE_UPDATE || response == RESPONSE_UPDATE_ALL) {
+		} else if (update) {
 			breeder->set_homepage(import_breeder->get_homepage());
 			db->add_breeder(breeder);
 		}
@@ -230,7 +643,7 @@ DB_Importer::_import_strains(Gtk::Window &parent,
 				db->add_strain(strain);
 				strain = db->get_strain(breeder->get_name(),
 				                                 import_strain->get_name());
-			} else if (response == RESPONSE_UPDATE || response == RESPONSE_UPDATE_ALL) {
+			} else if (update) {
 				strain->set_info(import_strain->get_info());
 				strain->set_description(import_strain->get_description());
 				strain->set_homepage(import_strain->get_homepage());
@@ -244,57 +657,31 @@ DB_Importer::_import_strains(Gtk::Window &parent,
 }
 
 void
-DB_Importer::_import_growlogs(Gtk::Window &parent,
-                              const Glib::RefPtr<Database> &import_db)
+DB_Importer::_import_growlogs(const Glib::RefPtr<Database> &import_db)
 {
-	int response = RESPONSE_NONE;
+	TRACE_SCOPE("import","DB_Importer::_import_growlogs");
+	Glib::RefPtr<const ImportPlan> plan = get_plan();
 	Glib::RefPtr<Database> db = get_database();
 
 	std::list<Glib::RefPtr<Growlog> > growlogs = import_db->get_growlogs();
 	for (auto growlog_iter = growlogs.begin(); growlog_iter != growlogs.end(); ++growlog_iter) {
 		Glib::RefPtr<Growlog> import_growlog = *growlog_iter;
-		Glib::RefPtr<Growlog> growlog = db->get_growlog(import_growlog->get_title());
-		if (growlog && response != RESPONSE_IGNORE_ALL) {
-			Gtk::MessageDialog dialog(parent,
-			                          _("Growlog exists already! How do you want to perceed?"),
-			                          false,
-			                          Gtk::MESSAGE_QUESTION,
-			                          Gtk::BUTTONS_NONE,
-			                          true);
-			dialog.add_button(_("Edit"), RESPONSE_EDIT);
-			dialog.add_button(_("Ignore"), RESPONSE_IGNORE);
-			dialog.add_button(_("Ignore All"), RESPONSE_IGNORE_ALL);
-
-			if (response == RESPONSE_EDIT) {
-				bool edit_done = false;
-				while (!edit_done) {
-					GrowlogDialog growlog_dialog{import_db,import_growlog};
-					growlog_dialog.set_update_database(false);
-
-					int res = growlog_dialog.run();
-					growlog_dialog.hide();
-					if (res == Gtk::RESPONSE_APPLY) {
-						import_growlog = growlog_dialog.get_growlog();
-						growlog = db->get_growlog(import_growlog->get_title());
-						if (!growlog)
-							edit_done = true;
-					}
-				} 
-			} else if (response == RESPONSE_IGNORE
-				       || response == RESPONSE_IGNORE_ALL) {
-					continue;
-			}
-		} else if (growlog && response == RESPONSE_IGNORE_ALL) {
+		Glib::ustring title = import_growlog->get_title();
+		Glib::RefPtr<Growlog> growlog = db->get_growlog(title);
+		if (growlog) {
+			const ImportPlanItem *item = plan->find_growlog(title);
+			if (!item || item->action != IMPORT_CONFLICT_RENAME)
 				continue;
+			title = item->new_title;
 		}
 		
-		growlog = Growlog::create(import_growlog->get_title(),
+		growlog = Growlog::create(title,
 		                          import_growlog->get_description(),
 		                          import_growlog->get_created_on(),
 		                          import_growlog->get_flower_on(),
 		                          import_growlog->get_finished_on());
 		db->add_growlog(growlog);
-		growlog = db->get_growlog(import_growlog->get_title());
+		growlog = db->get_growlog(title);
 		assert(growlog);
 		
 		m_growlog_map_[import_growlog->get_id()] = growlog;
@@ -312,118 +699,40 @@ DB_Importer::_import_growlogs(Gtk::Window &parent,
 		for (auto strain_iter = strains.begin(); strain_iter != strains.end(); ++strain_iter) {
 			Glib::RefPtr<Strain> import_strain = *strain_iter;
 			Glib::RefPtr<Strain> strain = m_strain_map_[import_strain->get_id()];
-			db->add_strain_for_growlog(growlog,strain);
+			if (strain)
+				db->add_strain_for_growlog(growlog,strain);
 		}
 	}
 }
 
-/*******************************************************************************
- * ImportDialog
- ******************************************************************************/
-
-const char ImportDialog::TITLE[] = N_("GrowBook: Import");
-
-ImportDialog::ImportDialog(const Glib::RefPtr<Database> &db):
-	Gtk::FileChooserDialog{_(TITLE),Gtk::FILE_CHOOSER_ACTION_OPEN},
-	m_parent_{nullptr},
-	m_database_{db}
-{
-	assert(m_database_);
-
-	_add_buttons();
-	_configure();
-
-	show_all();
-}
-
-ImportDialog::ImportDialog(Gtk::Window &parent,
-                           const Glib::RefPtr<Database> &db):
-	Gtk::FileChooserDialog{parent,_(TITLE),Gtk::FILE_CHOOSER_ACTION_OPEN},
-	m_parent_{&parent},
-	m_database_{db}
-{
-	assert(m_database_);
-
-	_add_buttons();
-	_configure();
-
-	show_all();
-}
-
+// The plan holds the names of the breeders to update and the titles of the
+// growlogs, sqlite3 copies the rows.
 void
-ImportDialog::_add_buttons()
+DB_Importer::_merge_sqlite3(const Glib::RefPtr<Database> &import_db,
+                            const Glib::RefPtr<DatabaseSqlite3> &db)
 {
-	add_button(_("Apply"), Gtk::RESPONSE_APPLY);
-	add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
-}
-
-void
-ImportDialog::_configure()
-{
-	Glib::RefPtr<Gtk::FileFilter> filter = Gtk::FileFilter::create();
-	filter->set_name(_("All GrowBook files"));
-	filter->add_pattern("*.db");
-	filter->add_pattern("*.growbook");
-	add_filter(filter);
-	set_filter(filter);
-
-	filter = Gtk::FileFilter::create();
-	filter->set_name(_("Database files"));
-	filter->add_pattern("*.db");
-	add_filter(filter);
-
-	filter = Gtk::FileFilter::create();
-	filter->set_name(_("Growbook files"));
-	filter->add_pattern("*.growbook");
-	add_filter(filter);
-
-	filter = Gtk::FileFilter::create();
-	filter->set_name(_("All files"));
-	filter->add_pattern("*");
-	add_filter(filter);
-		
-	set_current_folder(Glib::get_user_special_dir(Glib::USER_DIRECTORY_DOCUMENTS));	
-}
-
-static bool _has_ending(const std::string &s,const std::string &end)
-{
-	if (s.length() >= end.length()) 
-		return (0 == s.compare(s.length() - end.length(), end.length(), end));
-	return false;
-}
+	TRACE_SCOPE("import","DB_Importer::_merge_sqlite3");
+	assert(import_db && import_db->is_connected());
 
-Glib::RefPtr<Importer>
-ImportDialog::get_importer()
-{
-	std::string filename = get_filename();
-	if (filename.empty())
-		return Glib::RefPtr<Importer>();
+	Glib::RefPtr<const ImportPlan> plan = get_plan();
+	std::set<Glib::ustring> update_breeders;
+	for (auto &item: plan->get_breeders()) {
+		if (item.exists && item.action == IMPORT_CONFLICT_UPDATE)
+			update_breeders.insert(item.name);
+	}
 
-	
-	if (_has_ending(filename, ".growbook")) {
-		return XML_Importer::create(m_database_,filename);
-	} else if (_has_ending(filename,".db")) {
-		return DB_Importer::create(m_database_,filename);
-	} else {
-		const char MESSAGE[] = N_("Unable to import file!\n(Unknown file format!)");
-		if (m_parent_) {
-			Gtk::MessageDialog dialog(*m_parent_,
-			                          _(MESSAGE),
-			                          false,
-			                          Gtk::MESSAGE_ERROR,
-			                          Gtk::BUTTONS_OK,
-			                          true);
-			dialog.run();
-			dialog.hide();
-		} else {
-			Gtk::MessageDialog dialog(_(MESSAGE),
-			                          false,
-			                          Gtk::MESSAGE_ERROR,
-			                          Gtk::BUTTONS_OK,
-			                          true);
-			dialog.run();
-			dialog.hide();
+	std::map<uint64_t,Glib::ustring> growlogs;
+	for (auto &import_growlog: import_db->get_growlogs()) {
+		const ImportPlanItem *item = plan->find_growlog(import_growlog->get_title());
+		if (!item)
+			continue;
+		if (!item->exists) {
+			growlogs[import_growlog->get_id()] = item->name;
+		} else if (item->action == IMPORT_CONFLICT_RENAME) {
+			growlogs[import_growlog->get_id()] = item->new_title;
 		}
 	}
-	return Glib::RefPtr<Importer>();
+	import_db->close();
+
+	db->merge_database(get_filename(),update_breeders,growlogs);
 }
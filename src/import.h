@@ -28,28 +28,172 @@
 #define __IMPORT_H__
 
 
-#include <gtkmm/filechooserdialog.h>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "refclass.h"
 #include "database.h"
+#include "database-sqlite3.h"
 
-enum ImportResponseID {
-	 RESPONSE_NONE = 0,
-	 RESPONSE_UPDATE,
-	 RESPONSE_UPDATE_ALL,
-	 RESPONSE_MERGE,
-	 RESPONSE_MERGE_ALL,
-	 RESPONSE_EDIT,
-	 RESPONSE_IGNORE,
-	 RESPONSE_IGNORE_ALL		 
+enum ImportConflictAction {
+	 IMPORT_CONFLICT_ABORT = 0,
+	 IMPORT_CONFLICT_MERGE,
+	 IMPORT_CONFLICT_MERGE_ALL,
+	 IMPORT_CONFLICT_UPDATE,
+	 IMPORT_CONFLICT_UPDATE_ALL,
+	 IMPORT_CONFLICT_RENAME,
+	 IMPORT_CONFLICT_SKIP,
+	 IMPORT_CONFLICT_SKIP_ALL
 };
 
+/*******************************************************************************
+ * ImportConflictHandler
+ ******************************************************************************/
+
+// Decides what happens to breeders and growlogs that already exist in the
+// target database. The base class answers with fixed actions, so headless
+// imports never block; the GUI overrides the vfuncs with dialogs.
+class ImportConflictHandler:
+	public RefClass
+{
+	private:
+		ImportConflictAction m_breeder_action_;
+		ImportConflictAction m_growlog_action_;
+
+	private:
+		ImportConflictHandler(const ImportConflictHandler &src) = delete;
+		ImportConflictHandler& operator=(const ImportConflictHandler &src) = delete;
+
+	protected:
+		ImportConflictHandler(ImportConflictAction breeder_action,
+		                      ImportConflictAction growlog_action);
+
+	public:
+		virtual ~ImportConflictHandler();
+
+		static Glib::RefPtr<ImportConflictHandler> create(ImportConflictAction breeder_action = IMPORT_CONFLICT_MERGE_ALL,
+		                                                  ImportConflictAction growlog_action = IMPORT_CONFLICT_SKIP_ALL);
+
+	public:
+		// Returns one of MERGE, MERGE_ALL, UPDATE, UPDATE_ALL or ABORT.
+		ImportConflictAction resolve_breeder(const Glib::ustring &name);
+
+		// Returns one of RENAME, SKIP, SKIP_ALL or ABORT. On RENAME new_title
+		// holds a title that does not exist in database.
+		ImportConflictAction resolve_growlog(const Glib::RefPtr<const Database> &database,
+		                                     const Glib::ustring &title,
+		                                     Glib::ustring &new_title);
+
+		// Reports problems that do not stop the import.
+		void warning(const Glib::ustring &message);
+
+	protected:
+		virtual ImportConflictAction resolve_breeder_vfunc(const Glib::ustring &name);
+		virtual ImportConflictAction resolve_growlog_vfunc(const Glib::RefPtr<const Database> &database,
+		                                                   const Glib::ustring &title,
+		                                                   Glib::ustring &new_title);
+		virtual void warning_vfunc(const Glib::ustring &message);
+};
+
+/*******************************************************************************
+ * ImportPlan
+ ******************************************************************************/
+
+// A breeder or growlog of the import file. action is MERGE or UPDATE for
+// breeders and RENAME or SKIP for growlogs that exist in the target
+// database, new items are always added and have MERGE.
+struct ImportPlanItem {
+	Glib::ustring name;
+	bool exists;
+	ImportConflictAction action;
+	Glib::ustring new_title;
+};
+
+// What an import is going to do, worked out by Importer::scan() before
+// anything is written. The breeder names and growlog titles of the target
+// database are loaded once by create(), the items of the file are looked
+// up in those sets instead of querying the database for each of them.
+// All conflicts are decided up front, by resolve() or item by item, and
+// the write phase of the importer just follows the plan.
+class ImportPlan:
+	public RefClass
+{
+	private:
+		Glib::RefPtr<const Database> m_database_;
+		std::unordered_set<std::string> m_breeder_names_;
+		// the titles of the target database, of the file and the new titles
+		// of renamed growlogs, none of them is free for a rename
+		std::unordered_set<std::string> m_titles_;
+
+		std::vector<ImportPlanItem> m_breeders_;
+		std::vector<ImportPlanItem> m_growlogs_;
+		std::unordered_map<std::string,size_t> m_breeder_index_;
+		std::unordered_map<std::string,size_t> m_growlog_index_;
+		size_t m_breeder_conflicts_;
+		size_t m_growlog_conflicts_;
+		uint64_t m_strain_count_;
+		uint64_t m_entry_count_;
+
+	private:
+		ImportPlan(const ImportPlan &src) = delete;
+		ImportPlan& operator=(const ImportPlan &src) = delete;
+
+	protected:
+		ImportPlan(const Glib::RefPtr<const Database> &database);
+
+	public:
+		virtual ~ImportPlan();
+
+		static Glib::RefPtr<ImportPlan> create(const Glib::RefPtr<const Database> &database);
+
+	public:
+		// Called by the scan of an importer for the contents of the file.
+		// Names that were added before are ignored.
+		void add_breeder(const Glib::ustring &name);
+		void add_growlog(const Glib::ustring &title);
+		void add_strains(uint64_t n);
+		void add_entries(uint64_t n);
+
+		const std::vector<ImportPlanItem>& get_breeders() const;
+		const std::vector<ImportPlanItem>& get_growlogs() const;
+		// Return nullptr for names that are not in the file.
+		const ImportPlanItem* find_breeder(const Glib::ustring &name) const;
+		const ImportPlanItem* find_growlog(const Glib::ustring &title) const;
+
+		size_t get_breeder_conflict_count() const;
+		size_t get_growlog_conflict_count() const;
+		uint64_t get_strain_count() const;
+		uint64_t get_entry_count() const;
+		bool has_conflicts() const;
+
+		// action is MERGE or UPDATE.
+		void set_breeder_action(size_t index, ImportConflictAction action);
+		// Returns false and leaves the growlog alone if new_title is not free.
+		bool rename_growlog(size_t index, const Glib::ustring &new_title);
+		void skip_growlog(size_t index);
+
+		bool is_title_free(const Glib::ustring &title) const;
+		// Returns "title (N)" with the lowest N that is free.
+		Glib::ustring suggest_title(const Glib::ustring &title) const;
+
+		// Asks handler about every conflict in the order of the file, the
+		// *_ALL answers decide the remaining ones. Returns false if the
+		// handler aborted, the plan is incomplete then.
+		bool resolve(const Glib::RefPtr<ImportConflictHandler> &handler);
+};
+
+/*******************************************************************************
+ * Importer
+ ******************************************************************************/
+
 class Importer:
 	public RefClass
 {
 	private:
 		Glib::RefPtr<Database> m_database_;
 		std::string m_filename_;
+		Glib::RefPtr<const ImportPlan> m_plan_;
 
 	private:
 		Importer(const Importer &src) = delete;
@@ -69,13 +213,35 @@ class Importer:
 		std::string get_filename() const;
 		void set_filename(const std::string &filename);
 
+		// Imports with the non-interactive ImportConflictHandler defaults.
+		// Errors are thrown as DatabaseError or Glib::Error.
 		void import_db();
-		void import_db(Gtk::Window &parent);
+		// Importers that can scan() resolve the plan with handler before
+		// writing anything, the others ask it while they write.
+		void import_db(const Glib::RefPtr<ImportConflictHandler> &handler);
+		// Imports a plan returned by scan() and resolved by the caller,
+		// handler only gets the warnings.
+		void import_db(const Glib::RefPtr<ImportPlan> &plan,
+		               const Glib::RefPtr<ImportConflictHandler> &handler);
+
+		// Reads the breeders and growlogs of the file into an ImportPlan
+		// without writing to the database. Returns an empty RefPtr for
+		// importers that resolve conflicts while writing.
+		Glib::RefPtr<ImportPlan> scan();
 
 		bool file_exists() const;
-		
+
+	protected:
+		// The plan of the running import, empty for importers that can not scan.
+		Glib::RefPtr<const ImportPlan> get_plan() const;
+
+	private:
+		void _import(const Glib::RefPtr<ImportPlan> &plan,
+		             const Glib::RefPtr<ImportConflictHandler> &handler);
+
 	protected:
-		virtual void import_vfunc(Gtk::Window &parent) = 0; 
+		virtual Glib::RefPtr<ImportPlan> scan_vfunc();
+		virtual void import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler) = 0; 
 };
 
 /******************************************************************************/
@@ -98,7 +264,7 @@ class DB_Importer:
 		std::map<uint64_t,Glib::RefPtr<Breeder> > m_breeder_map_;
 		std::map<uint64_t,Glib::RefPtr<Strain> > m_strain_map_;
 		std::map<uint64_t,Glib::RefPtr<Growlog> > m_growlog_map_;
-		
+		bool m_merge_in_engine_;
 
 	private:
 		 DB_Importer(const DB_Importer &src) = delete;
@@ -115,40 +281,23 @@ class DB_Importer:
 		 static Glib::RefPtr<DB_Importer> create(const Glib::RefPtr<Database> & database,
 		                                         const std::string &filename);
 
-	protected:
-		 virtual void import_vfunc(Gtk::Window &parent);
-		
-	private:
-		 void _import_strains(Gtk::Window &parent,
-		                      const Glib::RefPtr<Database> &import_from);
-		 void _import_growlogs(Gtk::Window &parent,
-		                       const Glib::RefPtr<Database> &import_from);
-		
-};
-
-/******************************************************************************/
-
-class ImportDialog:
-	public Gtk::FileChooserDialog
-{
-	private:
-		static const char TITLE[];
+		 // sqlite3 books are merged by sqlite3 itself, see
+		 // DatabaseSqlite3::merge_database(). Turning it off imports them
+		 // object by object like other engines, e.g. to compare both.
+		 bool get_merge_in_engine() const;
+		 void set_merge_in_engine(bool b);
 
-	private:
-		Gtk::Window *m_parent_;
-		Glib::RefPtr<Database> m_database_;
+	protected:
+		 virtual Glib::RefPtr<ImportPlan> scan_vfunc() override;
+		 virtual void import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler) override;
 		
-	public:
-		ImportDialog(const Glib::RefPtr<Database> &database);
-		ImportDialog(Gtk::Window &parent,
-		             const Glib::RefPtr<Database> &database);
-
 	private:
-		void _add_buttons();
-		void _configure();
+		 Glib::RefPtr<Database> _open_import_db();
+		 void _import_strains(const Glib::RefPtr<Database> &import_from);
+		 void _import_growlogs(const Glib::RefPtr<Database> &import_from);
+		 void _merge_sqlite3(const Glib::RefPtr<Database> &import_from,
+		                     const Glib::RefPtr<DatabaseSqlite3> &db);
 		
-	 public:
-		Glib::RefPtr<Importer> get_importer();
 };
 
 #endif /* __IMPORT_H__ */
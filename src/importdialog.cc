@@ -0,0 +1,540 @@
+//           importdialog.cc
+//  Di Oktober 20 18:14:22 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// importdialog.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "importdialog.h"
+
+#include <glibmm.h>
+#include <glibmm/i18n.h>
+
+#include <gtkmm/box.h>
+#include <gtkmm/dialog.h>
+#include <gtkmm/entry.h>
+#include <gtkmm/grid.h>
+#include <gtkmm/label.h>
+#include <gtkmm/messagedialog.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/separator.h>
+
+#include <cassert>
+#include <cstdio>
+
+#include "compression.h"
+#include "ndjson_importer.h"
+#include "snapshot_importer.h"
+#include "xml_importer.h"
+
+/*******************************************************************************
+ * RenameGrowlogDialog
+ ******************************************************************************/
+
+class RenameGrowlogDialog:
+	public Gtk::Dialog
+{
+	private:
+		Glib::RefPtr<const Database> m_database_;
+		Gtk::Entry m_title_entry_;
+	public:
+		RenameGrowlogDialog(Gtk::Window &parent,
+		                    const Glib::RefPtr<const Database> &database,
+		                    const Glib::ustring &title);
+		virtual ~ RenameGrowlogDialog();
+
+	public:
+		void set_growlog_title(const Glib::ustring &title);
+		Glib::ustring get_growlog_title() const;
+
+		bool get_is_renamed() const;
+};
+
+RenameGrowlogDialog::RenameGrowlogDialog(Gtk::Window &parent,
+                                         const Glib::RefPtr<const Database> &db,
+                                         const Glib::ustring &title):
+	Gtk::Dialog(_("Rename Growlog"),parent),
+	m_database_(db),
+	m_title_entry_()
+{
+	m_title_entry_.set_text(title);
+
+
+	Gtk::HBox *hbox = Gtk::manage(new Gtk::HBox());
+	Gtk::Label *label = Gtk::manage(new Gtk::Label(_("Title")));
+	hbox->pack_start(*label);
+	hbox->pack_start(m_title_entry_);
+
+	get_content_area()->pack_start(*hbox);
+
+	add_button(_("OK"), Gtk::RESPONSE_OK);
+	add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
+
+	show_all();
+}
+                                         
+RenameGrowlogDialog::~RenameGrowlogDialog()
+{}
+
+void
+RenameGrowlogDialog::set_growlog_title(const Glib::ustring &title)
+{
+	m_title_entry_.set_text(title);
+}
+
+Glib::ustring
+RenameGrowlogDialog::get_growlog_title() const
+{
+	return m_title_entry_.get_text();
+}
+
+bool
+RenameGrowlogDialog::get_is_renamed() const
+{
+	if (get_growlog_title().empty())
+		return false;
+	Glib::RefPtr<Growlog> gl = m_database_->get_growlog(get_growlog_title());
+	if (gl)
+		return false;
+	return true;
+}
+
+/*******************************************************************************
+ * ImportConflictDialogHandler
+ ******************************************************************************/
+
+ImportConflictDialogHandler::ImportConflictDialogHandler(Gtk::Window &parent):
+	ImportConflictHandler{IMPORT_CONFLICT_ABORT,IMPORT_CONFLICT_ABORT},
+	m_parent_{&parent}
+{
+}
+
+ImportConflictDialogHandler::~ImportConflictDialogHandler()
+{
+}
+
+Glib::RefPtr<ImportConflictDialogHandler>
+ImportConflictDialogHandler::create(Gtk::Window &parent)
+{
+	return Glib::RefPtr<ImportConflictDialogHandler>(new ImportConflictDialogHandler(parent));
+}
+
+ImportConflictAction
+ImportConflictDialogHandler::resolve_breeder_vfunc(const Glib::ustring &name)
+{
+	Glib::ustring msg_fmt = _("Breeder \"%s\" already exists!\nHow do you want to proceed?");
+	size_t msg_size = msg_fmt.bytes() + name.bytes() + 1;
+	char *msg = new char[msg_size];
+	msg[msg_size-1]='\0';
+	snprintf(msg,msg_size,msg_fmt.c_str(),name.c_str());
+	Gtk::MessageDialog dialog(*m_parent_,
+	                          (const char*) msg,
+	                          false,
+	                          Gtk::MESSAGE_QUESTION,
+	                          Gtk::BUTTONS_NONE,
+	                          true);
+	delete[] msg;
+	dialog.add_button(_("Merge"),IMPORT_CONFLICT_MERGE);
+	dialog.add_button(_("Merge All"),IMPORT_CONFLICT_MERGE_ALL);
+	dialog.add_button(_("Update"),IMPORT_CONFLICT_UPDATE);
+	dialog.add_button(_("Update All"),IMPORT_CONFLICT_UPDATE_ALL);
+
+	int result = dialog.run();
+	dialog.hide();
+	if (result == Gtk::RESPONSE_DELETE_EVENT)
+		return IMPORT_CONFLICT_ABORT;
+	return static_cast<ImportConflictAction>(result);
+}
+
+ImportConflictAction
+ImportConflictDialogHandler::resolve_growlog_vfunc(const Glib::RefPtr<const Database> &database,
+                                                   const Glib::ustring &title,
+                                                   Glib::ustring &new_title)
+{
+	Glib::ustring fmt = _("Growlog \"%s\" already exists!\nHow do you want to proceed?");
+	size_t msg_size = fmt.bytes() + title.bytes() + 1;
+	char *msg = new char[msg_size];
+	msg [msg_size -1] = '\0';
+	snprintf(msg,msg_size,fmt.c_str(),title.c_str());
+				
+	Gtk::MessageDialog dialog(*m_parent_,
+	                          (const char*) msg,
+	                          false,
+	                          Gtk::MESSAGE_QUESTION,
+	                          Gtk::BUTTONS_NONE,
+	                          true);
+	delete[] msg;
+	dialog.add_button(_("Rename"),IMPORT_CONFLICT_RENAME);
+	dialog.add_button(_("Skip"),IMPORT_CONFLICT_SKIP);
+	dialog.add_button(_("Skip All"),IMPORT_CONFLICT_SKIP_ALL);
+
+	int result = dialog.run();
+	dialog.hide();
+	if (result == Gtk::RESPONSE_DELETE_EVENT)
+		return IMPORT_CONFLICT_ABORT;
+	if (result != IMPORT_CONFLICT_RENAME)
+		return static_cast<ImportConflictAction>(result);
+
+	RenameGrowlogDialog rename_dialog(*m_parent_,database,title);
+	do {
+		rename_dialog.present();
+		if (rename_dialog.run() != Gtk::RESPONSE_OK) {
+			rename_dialog.hide();
+			return IMPORT_CONFLICT_SKIP;
+		}
+	} while(!rename_dialog.get_is_renamed());
+	rename_dialog.hide();
+	new_title = rename_dialog.get_growlog_title();
+	return IMPORT_CONFLICT_RENAME;
+}
+
+void
+ImportConflictDialogHandler::warning_vfunc(const Glib::ustring &message)
+{
+	Gtk::MessageDialog dialog(*m_parent_,
+	                          message,
+	                          false,
+	                          Gtk::MESSAGE_WARNING,
+	                          Gtk::BUTTONS_OK,
+	                          true);
+	dialog.run();
+	dialog.hide();
+}
+
+/*******************************************************************************
+ * ImportPlanDialog
+ ******************************************************************************/
+
+ImportPlanDialog::ImportPlanDialog(Gtk::Window &parent,
+                                   const Glib::RefPtr<ImportPlan> &plan):
+	Gtk::Dialog{_("GrowBook: Import Conflicts"),parent,true},
+	m_plan_{plan},
+	m_summary_label_{},
+	m_breeders_combo_{},
+	m_growlogs_combo_{},
+	m_breeder_rows_{},
+	m_growlog_rows_{}
+{
+	assert(m_plan_);
+
+	Glib::ustring summary = Glib::ustring::compose(_("The file holds %1 breeders with %2 strains and %3 growlogs with %4 entries."),
+	                                               m_plan_->get_breeders().size(),
+	                                               m_plan_->get_strain_count(),
+	                                               m_plan_->get_growlogs().size(),
+	                                               m_plan_->get_entry_count());
+	summary += "\n";
+	summary += Glib::ustring::compose(_("%1 breeders and %2 growlogs already exist."),
+	                                  m_plan_->get_breeder_conflict_count(),
+	                                  m_plan_->get_growlog_conflict_count());
+	m_summary_label_.set_text(summary);
+	m_summary_label_.set_halign(Gtk::ALIGN_START);
+
+	Gtk::Box *box = get_content_area();
+	box->pack_start(m_summary_label_,false,false,3);
+
+	// the combos on top set all rows at once
+	Gtk::Grid *grid = Gtk::manage(new Gtk::Grid());
+	grid->set_column_spacing(5);
+	if (m_plan_->get_breeder_conflict_count()) {
+		m_breeders_combo_.append("merge",_("Merge all breeders"));
+		m_breeders_combo_.append("update",_("Update all breeders"));
+		m_breeders_combo_.set_active_id("merge");
+		m_breeders_combo_.signal_changed().connect(sigc::mem_fun(*this,&ImportPlanDialog::on_breeders_combo_changed));
+		grid->attach(m_breeders_combo_,0,0,1,1);
+	}
+	if (m_plan_->get_growlog_conflict_count()) {
+		m_growlogs_combo_.append("skip",_("Skip all growlogs"));
+		m_growlogs_combo_.append("rename",_("Rename all growlogs"));
+		m_growlogs_combo_.set_active_id("skip");
+		m_growlogs_combo_.signal_changed().connect(sigc::mem_fun(*this,&ImportPlanDialog::on_growlogs_combo_changed));
+		grid->attach(m_growlogs_combo_,1,0,1,1);
+	}
+	box->pack_start(*grid,false,false,3);
+	box->pack_start(*Gtk::manage(new Gtk::HSeparator()),false,false,3);
+
+	// one row per conflict
+	grid = Gtk::manage(new Gtk::Grid());
+	grid->set_column_spacing(5);
+	int row = 0;
+	const std::vector<ImportPlanItem> &breeders = m_plan_->get_breeders();
+	for (size_t i = 0; i < breeders.size(); ++i) {
+		if (!breeders[i].exists)
+			continue;
+		Gtk::Label *label = Gtk::manage(new Gtk::Label(Glib::ustring::compose(_("Breeder \"%1\""),breeders[i].name)));
+		label->set_halign(Gtk::ALIGN_START);
+		grid->attach(*label,0,row,1,1);
+
+		Gtk::ComboBoxText *action = Gtk::manage(new Gtk::ComboBoxText());
+		action->append("merge",_("Merge"));
+		action->append("update",_("Update"));
+		action->set_active_id(breeders[i].action == IMPORT_CONFLICT_UPDATE ? "update" : "merge");
+		grid->attach(*action,1,row,1,1);
+		m_breeder_rows_.push_back(std::make_pair(i,action));
+		++row;
+	}
+
+	const std::vector<ImportPlanItem> &growlogs = m_plan_->get_growlogs();
+	for (size_t i = 0; i < growlogs.size(); ++i) {
+		if (!growlogs[i].exists)
+			continue;
+		Gtk::Label *label = Gtk::manage(new Gtk::Label(Glib::ustring::compose(_("Growlog \"%1\""),growlogs[i].name)));
+		label->set_halign(Gtk::ALIGN_START);
+		grid->attach(*label,0,row,1,1);
+
+		Gtk::ComboBoxText *action = Gtk::manage(new Gtk::ComboBoxText());
+		action->append("skip",_("Skip"));
+		action->append("rename",_("Rename"));
+		grid->attach(*action,1,row,1,1);
+
+		Gtk::Entry *title = Gtk::manage(new Gtk::Entry());
+		if (growlogs[i].action == IMPORT_CONFLICT_RENAME) {
+			title->set_text(growlogs[i].new_title);
+			action->set_active_id("rename");
+		} else {
+			title->set_text(m_plan_->suggest_title(growlogs[i].name));
+			title->set_sensitive(false);
+			action->set_active_id("skip");
+		}
+		action->signal_changed().connect(sigc::bind(sigc::mem_fun(*this,&ImportPlanDialog::on_growlog_action_changed),
+		                                            action,title));
+		grid->attach(*title,2,row,1,1);
+		m_growlog_rows_.push_back(GrowlogRow{i,action,title});
+		++row;
+	}
+
+	Gtk::ScrolledWindow *scrolled = Gtk::manage(new Gtk::ScrolledWindow());
+	scrolled->add(*grid);
+	scrolled->set_size_request(-1,300);
+	box->pack_start(*scrolled,true,true,0);
+
+	add_button(_("Import"), Gtk::RESPONSE_APPLY);
+	add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
+
+	show_all();
+}
+
+ImportPlanDialog::~ImportPlanDialog()
+{
+}
+
+bool
+ImportPlanDialog::apply()
+{
+	for (auto &breeder_row: m_breeder_rows_) {
+		if (breeder_row.second->get_active_id() == "update") {
+			m_plan_->set_breeder_action(breeder_row.first,IMPORT_CONFLICT_UPDATE);
+		} else {
+			m_plan_->set_breeder_action(breeder_row.first,IMPORT_CONFLICT_MERGE);
+		}
+	}
+
+	// the titles the rows had before are released first, so two rows can
+	// swap their titles
+	for (auto &growlog_row: m_growlog_rows_)
+		m_plan_->skip_growlog(growlog_row.index);
+	for (auto &growlog_row: m_growlog_rows_) {
+		if (growlog_row.action->get_active_id() != "rename")
+			continue;
+		if (!m_plan_->rename_growlog(growlog_row.index,growlog_row.title->get_text())) {
+			Gtk::MessageDialog dialog(*this,
+			                          _("Unable to rename growlog!"),
+			                          false,
+			                          Gtk::MESSAGE_ERROR,
+			                          Gtk::BUTTONS_OK,
+			                          true);
+			dialog.set_secondary_text(Glib::ustring::compose(_("The title \"%1\" is empty or taken."),
+			                                                 growlog_row.title->get_text()));
+			dialog.run();
+			dialog.hide();
+			growlog_row.title->grab_focus();
+			return false;
+		}
+	}
+	return true;
+}
+
+void
+ImportPlanDialog::on_breeders_combo_changed()
+{
+	Glib::ustring id = m_breeders_combo_.get_active_id();
+	for (auto &breeder_row: m_breeder_rows_)
+		breeder_row.second->set_active_id(id);
+}
+
+void
+ImportPlanDialog::on_growlogs_combo_changed()
+{
+	Glib::ustring id = m_growlogs_combo_.get_active_id();
+	for (auto &growlog_row: m_growlog_rows_)
+		growlog_row.action->set_active_id(id);
+}
+
+void
+ImportPlanDialog::on_growlog_action_changed(Gtk::ComboBoxText *action,Gtk::Entry *title)
+{
+	title->set_sensitive(action->get_active_id() == "rename");
+}
+
+/*******************************************************************************
+ * ImportDialog
+ ******************************************************************************/
+
+const char ImportDialog::TITLE[] = N_("GrowBook: Import");
+
+ImportDialog::ImportDialog(const Glib::RefPtr<Database> &db):
+	Gtk::FileChooserDialog{_(TITLE),Gtk::FILE_CHOOSER_ACTION_OPEN},
+	m_parent_{nullptr},
+	m_database_{db}
+{
+	assert(m_database_);
+
+	_add_buttons();
+	_configure();
+
+	show_all();
+}
+
+ImportDialog::ImportDialog(Gtk::Window &parent,
+                           const Glib::RefPtr<Database> &db):
+	Gtk::FileChooserDialog{parent,_(TITLE),Gtk::FILE_CHOOSER_ACTION_OPEN},
+	m_parent_{&parent},
+	m_database_{db}
+{
+	assert(m_database_);
+
+	_add_buttons();
+	_configure();
+
+	show_all();
+}
+
+void
+ImportDialog::_add_buttons()
+{
+	add_button(_("Apply"), Gtk::RESPONSE_APPLY);
+	add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
+}
+
+void
+ImportDialog::_configure()
+{
+	Glib::RefPtr<Gtk::FileFilter> filter = Gtk::FileFilter::create();
+	filter->set_name(_("All GrowBook files"));
+	filter->add_pattern("*.db");
+	filter->add_pattern("*.growbook");
+	if (compression_is_available(COMPRESSION_GZIP))
+		filter->add_pattern("*.growbook.gz");
+	if (compression_is_available(COMPRESSION_ZSTD))
+		filter->add_pattern("*.growbook.zst");
+	filter->add_pattern("*.gbsnap");
+	filter->add_pattern("*.ndjson");
+	add_filter(filter);
+	set_filter(filter);
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_("Database files"));
+	filter->add_pattern("*.db");
+	add_filter(filter);
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_("Growbook files"));
+	filter->add_pattern("*.growbook");
+	add_filter(filter);
+
+	if (compression_is_available(COMPRESSION_GZIP)) {
+		filter = Gtk::FileFilter::create();
+		filter->set_name(_("Growbook files (gzip compressed)"));
+		filter->add_pattern("*.growbook.gz");
+		add_filter(filter);
+	}
+	if (compression_is_available(COMPRESSION_ZSTD)) {
+		filter = Gtk::FileFilter::create();
+		filter->set_name(_("Growbook files (zstd compressed)"));
+		filter->add_pattern("*.growbook.zst");
+		add_filter(filter);
+	}
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_("Growbook snapshots"));
+	filter->add_pattern("*.gbsnap");
+	add_filter(filter);
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_("Newline delimited JSON files"));
+	filter->add_pattern("*.ndjson");
+	add_filter(filter);
+
+	filter = Gtk::FileFilter::create();
+	filter->set_name(_("All files"));
+	filter->add_pattern("*");
+	add_filter(filter);
+		
+	set_current_folder(Glib::get_user_special_dir(Glib::USER_DIRECTORY_DOCUMENTS));	
+}
+
+static bool _has_ending(const std::string &s,const std::string &end)
+{
+	if (s.length() >= end.length()) 
+		return (0 == s.compare(s.length() - end.length(), end.length(), end));
+	return false;
+}
+
+Glib::RefPtr<Importer>
+ImportDialog::get_importer()
+{
+	std::string filename = get_filename();
+	if (filename.empty())
+		return Glib::RefPtr<Importer>();
+
+	
+	if (_has_ending(filename, ".growbook")
+	    || _has_ending(filename, ".growbook.gz")
+	    || _has_ending(filename, ".growbook.zst")) {
+		return XML_Importer::create(m_database_,filename);
+	} else if (_has_ending(filename,".db")) {
+		return DB_Importer::create(m_database_,filename);
+	} else if (_has_ending(filename,".gbsnap")) {
+		return Snapshot_Importer::create(m_database_,filename);
+	} else if (_has_ending(filename,".ndjson")) {
+		return NDJSON_Importer::create(m_database_,filename);
+	} else {
+		const char MESSAGE[] = N_("Unable to import file!\n(Unknown file format!)");
+		if (m_parent_) {
+			Gtk::MessageDialog dialog(*m_parent_,
+			                          _(MESSAGE),
+			                          false,
+			                          Gtk::MESSAGE_ERROR,
+			                          Gtk::BUTTONS_OK,
+			                          true);
+			dialog.run();
+			dialog.hide();
+		} else {
+			Gtk::MessageDialog dialog(_(MESSAGE),
+			                          false,
+			                          Gtk::MESSAGE_ERROR,
+			                          Gtk::BUTTONS_OK,
+			                          true);
+			dialog.run();
+			dialog.hide();
+		}
+	}
+	return Glib::RefPtr<Importer>();
+}
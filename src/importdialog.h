@@ -0,0 +1,137 @@
+/***************************************************************************
+ *            importdialog.h
+ *
+ *  Di Oktober 20 18:14:22 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * importdialog.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __IMPORTDIALOG_H__
+#define __IMPORTDIALOG_H__
+
+#include <gtkmm/comboboxtext.h>
+#include <gtkmm/dialog.h>
+#include <gtkmm/entry.h>
+#include <gtkmm/filechooserdialog.h>
+#include <gtkmm/label.h>
+
+#include <vector>
+
+#include "import.h"
+
+/*******************************************************************************
+ * ImportConflictDialogHandler
+ ******************************************************************************/
+
+// Asks the user with message dialogs how to resolve import conflicts.
+class ImportConflictDialogHandler:
+	public ImportConflictHandler
+{
+	private:
+		Gtk::Window *m_parent_;
+
+	private:
+		ImportConflictDialogHandler(const ImportConflictDialogHandler &src) = delete;
+		ImportConflictDialogHandler& operator=(const ImportConflictDialogHandler &src) = delete;
+
+	protected:
+		ImportConflictDialogHandler(Gtk::Window &parent);
+
+	public:
+		virtual ~ImportConflictDialogHandler();
+
+		static Glib::RefPtr<ImportConflictDialogHandler> create(Gtk::Window &parent);
+
+	protected:
+		virtual ImportConflictAction resolve_breeder_vfunc(const Glib::ustring &name) override;
+		virtual ImportConflictAction resolve_growlog_vfunc(const Glib::RefPtr<const Database> &database,
+		                                                   const Glib::ustring &title,
+		                                                   Glib::ustring &new_title) override;
+		virtual void warning_vfunc(const Glib::ustring &message) override;
+};
+
+/*******************************************************************************
+ * ImportPlanDialog
+ ******************************************************************************/
+
+// Shows what an import is going to do and lets the user decide all
+// conflicts of an ImportPlan at once, instead of one dialog per item.
+// apply() writes the choices back into the plan.
+class ImportPlanDialog:
+	public Gtk::Dialog
+{
+	private:
+		struct GrowlogRow {
+			size_t index;
+			Gtk::ComboBoxText *action;
+			Gtk::Entry *title;
+		};
+
+		Glib::RefPtr<ImportPlan> m_plan_;
+		Gtk::Label m_summary_label_;
+		Gtk::ComboBoxText m_breeders_combo_;
+		Gtk::ComboBoxText m_growlogs_combo_;
+		std::vector<std::pair<size_t,Gtk::ComboBoxText*> > m_breeder_rows_;
+		std::vector<GrowlogRow> m_growlog_rows_;
+
+	public:
+		ImportPlanDialog(Gtk::Window &parent,
+		                 const Glib::RefPtr<ImportPlan> &plan);
+		virtual ~ImportPlanDialog();
+
+	public:
+		// Returns false and tells the user if a new title is not free.
+		bool apply();
+
+	private:
+		void on_breeders_combo_changed();
+		void on_growlogs_combo_changed();
+		void on_growlog_action_changed(Gtk::ComboBoxText *action,Gtk::Entry *title);
+};
+
+/*******************************************************************************
+ * ImportDialog
+ ******************************************************************************/
+
+class ImportDialog:
+	public Gtk::FileChooserDialog
+{
+	private:
+		static const char TITLE[];
+
+	private:
+		Gtk::Window *m_parent_;
+		Glib::RefPtr<Database> m_database_;
+		
+	public:
+		ImportDialog(const Glib::RefPtr<Database> &database);
+		ImportDialog(Gtk::Window &parent,
+		             const Glib::RefPtr<Database> &database);
+
+	private:
+		void _add_buttons();
+		void _configure();
+		
+	 public:
+		Glib::RefPtr<Importer> get_importer();
+};
+
+#endif /* __IMPORTDIALOG_H__ */
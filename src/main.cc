@@ -29,13 +29,28 @@
 
 #include "application.h"
 #include "database.h"
+#include "pool.h"
+#include "trace.h"
+
+#include <cstdlib>
 
 int
 main (int argc, char *argv[])
 {
-	db_init();
-	app = Application::create(argc,argv);
+	trace_init();
+	{
+		TRACE_SCOPE("startup","db_init");
+		db_init();
+	}
+	{
+		TRACE_SCOPE("startup","Application::create");
+		app = Application::create(argc,argv);
+	}
 	app->run();
+
+	if (getenv("GROWBOOK_POOL_STATS"))
+		pool_print_stats(stderr);
+	
 	return 0;
 }
 
@@ -0,0 +1,698 @@
+//           ndjson.cc
+//  Mo Oktober 19 16:05:12 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// ndjson.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ndjson.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef NATIVE_WINDOWS
+# include "strptime.h"
+#endif
+
+#include "trace.h"
+
+// the output is handed to the stream in blocks of about this size
+#define NDJSON_BUFFER_SIZE (1024 * 1024)
+// up to this many changed entries are looked up by id
+#define NDJSON_ENTRY_LOOKUP_LIMIT 1000
+
+/*******************************************************************************
+ * writing
+ ******************************************************************************/
+
+void
+ndjson_append_string(std::string &out, const char *s, size_t size)
+{
+	static const char HEX[] = "0123456789abcdef";
+
+	out += '"';
+	const char *start = s;
+	const char *end = s + size;
+	for (const char *p = s; p < end; ++p) {
+		unsigned char c = static_cast<unsigned char>(*p);
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+
+		out.append(start,p - start);
+		start = p + 1;
+		switch (c) {
+			case '"':
+				out += "\\\"";
+				break;
+			case '\\':
+				out += "\\\\";
+				break;
+			case '\n':
+				out += "\\n";
+				break;
+			case '\r':
+				out += "\\r";
+				break;
+			case '\t':
+				out += "\\t";
+				break;
+			default:
+				out += "\\u00";
+				out += HEX[c >> 4];
+				out += HEX[c & 0xf];
+				break;
+		}
+	}
+	out.append(start,end - start);
+	out += '"';
+}
+
+static void
+_append_key(std::string &out, const char *key)
+{
+	out += ",\"";
+	out += key;
+	out += "\":";
+}
+
+static void
+_append_string(std::string &out, const char *key, const Glib::ustring &value)
+{
+	_append_key(out,key);
+	ndjson_append_string(out,value.data(),value.bytes());
+}
+
+static void
+_append_time(std::string &out, const char *key, time_t value)
+{
+	char buffer[32];
+	size_t size = 0;
+
+	_append_key(out,key);
+	if (value)
+		size = db_format_datetime(value,buffer,sizeof(buffer));
+	if (size) {
+		out += '"';
+		out.append(buffer,size);
+		out += '"';
+	} else {
+		out += "null";
+	}
+}
+
+static void
+_begin_record(std::string &out, const char *type)
+{
+	out += "{\"type\":\"";
+	out += type;
+	out += '"';
+}
+
+static void
+_end_record(std::string &out, std::ostream &stream, uint64_t &bytes_written)
+{
+	out += "}\n";
+	if (out.size() >= NDJSON_BUFFER_SIZE) {
+		stream.write(out.data(),out.size());
+		bytes_written += out.size();
+		out.clear();
+	}
+}
+
+static void
+_append_breeder(std::string &out, const Glib::RefPtr<Breeder> &breeder)
+{
+	_begin_record(out,"breeder");
+	_append_string(out,"name",breeder->get_name());
+	_append_string(out,"homepage",breeder->get_homepage());
+}
+
+static void
+_append_strain(std::string &out, const Glib::RefPtr<Strain> &strain, const Glib::ustring &breeder_name)
+{
+	_begin_record(out,"strain");
+	_append_string(out,"breeder",breeder_name);
+	_append_string(out,"name",strain->get_name());
+	_append_string(out,"info",strain->get_info());
+	_append_string(out,"description",strain->get_description());
+	_append_string(out,"homepage",strain->get_homepage());
+	_append_string(out,"seedfinder",strain->get_seedfinder());
+}
+
+static void
+_append_growlog(std::string &out, const Glib::RefPtr<Growlog> &growlog)
+{
+	_begin_record(out,"growlog");
+	_append_string(out,"title",growlog->get_title());
+	_append_string(out,"description",growlog->get_description());
+	_append_time(out,"created_on",growlog->get_created_on());
+	_append_time(out,"flower_on",growlog->get_flower_on());
+	_append_time(out,"finished_on",growlog->get_finished_on());
+}
+
+static void
+_append_growlog_strain(std::string &out, const Glib::ustring &growlog_title, const Glib::RefPtr<Strain> &strain)
+{
+	_begin_record(out,"growlog_strain");
+	_append_string(out,"growlog",growlog_title);
+	_append_string(out,"breeder",strain->get_breeder_name());
+	_append_string(out,"strain",strain->get_name());
+}
+
+static void
+_append_entry(std::string &out, const Glib::ustring &growlog_title, const Glib::RefPtr<GrowlogEntry> &entry)
+{
+	_begin_record(out,"entry");
+	_append_string(out,"growlog",growlog_title);
+	_append_time(out,"created_on",entry->get_created_on());
+	_append_string(out,"text",entry->get_text());
+}
+
+static void
+_write_database(const Glib::RefPtr<const Database> &database,
+                std::string &buffer,
+                std::ostream &out,
+                uint64_t &bytes_written)
+{
+	std::unordered_map<uint64_t,Glib::ustring> breeder_names;
+	for (auto &breeder: database->get_breeders()) {
+		breeder_names[breeder->get_id()] = breeder->get_name();
+		_append_breeder(buffer,breeder);
+		_end_record(buffer,out,bytes_written);
+	}
+
+	for (auto &strain: database->get_strains()) {
+		_append_strain(buffer,strain,breeder_names[strain->get_breeder_id()]);
+		_end_record(buffer,out,bytes_written);
+	}
+
+	std::unordered_map<uint64_t,Glib::ustring> growlog_titles;
+	for (auto &growlog: database->get_growlogs()) {
+		growlog_titles[growlog->get_id()] = growlog->get_title();
+		_append_growlog(buffer,growlog);
+		_end_record(buffer,out,bytes_written);
+	}
+
+	for (auto &growlog_strains: database->get_strains_for_growlogs()) {
+		auto iter = growlog_titles.find(growlog_strains.first);
+		if (iter == growlog_titles.end())
+			continue;
+		for (auto &strain: growlog_strains.second) {
+			_append_growlog_strain(buffer,iter->second,strain);
+			_end_record(buffer,out,bytes_written);
+		}
+	}
+
+	database->foreach_growlog_entry([&](const Glib::RefPtr<GrowlogEntry> &entry) {
+		auto iter = growlog_titles.find(entry->get_growlog_id());
+		if (iter == growlog_titles.end())
+			return;
+		_append_entry(buffer,iter->second,entry);
+		_end_record(buffer,out,bytes_written);
+	});
+}
+
+static void
+_flush(std::string &buffer, std::ostream &out, uint64_t &bytes_written)
+{
+	out.write(buffer.data(),buffer.size());
+	bytes_written += buffer.size();
+	buffer.clear();
+	out.flush();
+}
+
+uint64_t
+ndjson_export_database(const Glib::RefPtr<const Database> &database,
+                       std::ostream &out)
+{
+	TRACE_SCOPE("export","ndjson_export_database");
+
+	std::string buffer;
+	buffer.reserve(NDJSON_BUFFER_SIZE + 64 * 1024);
+	uint64_t bytes_written = 0;
+
+	_begin_record(buffer,"growbook");
+	_append_key(buffer,"version");
+	buffer += std::to_string(NDJSON_VERSION);
+	_end_record(buffer,out,bytes_written);
+
+	_write_database(database,buffer,out,bytes_written);
+	_flush(buffer,out,bytes_written);
+
+	return bytes_written;
+}
+
+/*******************************************************************************
+ * changes
+ ******************************************************************************/
+
+// Deletes and renames carry the natural keys of change_log, see ChangeRecord.
+static void
+_append_change(std::string &out, const ChangeRecord &change)
+{
+	static const char *KEYS[][3] = {
+		{"name",nullptr,nullptr},          // breeder
+		{"breeder","name",nullptr},        // strain
+		{"title",nullptr,nullptr},         // growlog
+		{"growlog","breeder","strain"},    // growlog_strain
+		{"growlog","created_on","text"},   // entry
+	};
+	static const char *NEW_KEYS[][3] = {
+		{"new_name",nullptr,nullptr},
+		{"new_breeder","new_name",nullptr},
+		{"new_title",nullptr,nullptr},
+	};
+
+	const char *table;
+	int index;
+	if (change.table == "breeder") {
+		table = "breeder";
+		index = 0;
+	} else if (change.table == "strain") {
+		table = "strain";
+		index = 1;
+	} else if (change.table == "growlog") {
+		table = "growlog";
+		index = 2;
+	} else if (change.table == "growlog_strain") {
+		table = "growlog_strain";
+		index = 3;
+	} else if (change.table == "growlog_entry") {
+		table = "entry";
+		index = 4;
+	} else {
+		return;
+	}
+	if (change.type == CHANGE_RENAME && index > 2)
+		return;
+
+	_begin_record(out,(change.type == CHANGE_RENAME ? "rename" : "delete"));
+	_append_key(out,"table");
+	ndjson_append_string(out,table,strlen(table));
+	for (int i = 0; i < 3 && KEYS[index][i]; ++i)
+		_append_string(out,KEYS[index][i],change.key[i]);
+	if (change.type == CHANGE_RENAME) {
+		for (int i = 0; i < 3 && NEW_KEYS[index][i]; ++i)
+			_append_string(out,NEW_KEYS[index][i],change.new_key[i]);
+	}
+}
+
+uint64_t
+ndjson_export_changes(const Glib::RefPtr<const Database> &database,
+                      uint64_t after,
+                      uint64_t upto,
+                      std::ostream &out)
+{
+	TRACE_SCOPE("export","ndjson_export_changes");
+
+	std::string buffer;
+	buffer.reserve(NDJSON_BUFFER_SIZE + 64 * 1024);
+	uint64_t bytes_written = 0;
+
+	_begin_record(buffer,"growbook");
+	_append_key(buffer,"version");
+	buffer += std::to_string(NDJSON_VERSION);
+	_append_key(buffer,"delta");
+	buffer += "true";
+	_append_key(buffer,"after");
+	buffer += std::to_string(after);
+	_append_key(buffer,"seq");
+	buffer += std::to_string(upto);
+	_end_record(buffer,out,bytes_written);
+
+	if (after == 0) {
+		_write_database(database,buffer,out,bytes_written);
+		_flush(buffer,out,bytes_written);
+		return bytes_written;
+	}
+
+	// deletes and renames are written in the order they happened, the
+	// rows that changed follow with their current values
+	std::set<uint64_t> breeder_ids, strain_ids, growlog_ids, growlog_strain_ids;
+	std::unordered_set<uint64_t> entry_ids;
+	database->foreach_change(after,upto,[&](const ChangeRecord &change) {
+		if (change.type != CHANGE_UPDATE) {
+			_append_change(buffer,change);
+			_end_record(buffer,out,bytes_written);
+		} else if (change.table == "breeder") {
+			breeder_ids.insert(change.row_id);
+		} else if (change.table == "strain") {
+			strain_ids.insert(change.row_id);
+		} else if (change.table == "growlog") {
+			growlog_ids.insert(change.row_id);
+		} else if (change.table == "growlog_strain") {
+			growlog_strain_ids.insert(change.row_id);
+		} else if (change.table == "growlog_entry") {
+			entry_ids.insert(change.row_id);
+		}
+	});
+
+	for (auto id: breeder_ids) {
+		Glib::RefPtr<Breeder> breeder = database->get_breeder(id);
+		if (breeder) {
+			_append_breeder(buffer,breeder);
+			_end_record(buffer,out,bytes_written);
+		}
+	}
+
+	for (auto id: strain_ids) {
+		Glib::RefPtr<Strain> strain = database->get_strain(id);
+		if (strain) {
+			_append_strain(buffer,strain,strain->get_breeder_name());
+			_end_record(buffer,out,bytes_written);
+		}
+	}
+
+	std::unordered_map<uint64_t,Glib::ustring> growlog_titles;
+	auto get_title = [&](uint64_t growlog_id) -> const Glib::ustring& {
+		auto iter = growlog_titles.find(growlog_id);
+		if (iter == growlog_titles.end()) {
+			Glib::RefPtr<Growlog> growlog = database->get_growlog(growlog_id);
+			iter = growlog_titles.emplace(growlog_id,(growlog ? growlog->get_title() : Glib::ustring())).first;
+		}
+		return iter->second;
+	};
+
+	for (auto id: growlog_ids) {
+		Glib::RefPtr<Growlog> growlog = database->get_growlog(id);
+		if (growlog) {
+			growlog_titles[id] = growlog->get_title();
+			_append_growlog(buffer,growlog);
+			_end_record(buffer,out,bytes_written);
+		}
+	}
+
+	for (auto id: growlog_strain_ids) {
+		const Glib::ustring &title = get_title(id);
+		if (title.empty())
+			continue;
+		for (auto &strain: database->get_strains_for_growlog(id)) {
+			_append_growlog_strain(buffer,title,strain);
+			_end_record(buffer,out,bytes_written);
+		}
+	}
+
+	// many changed entries are cheaper to pick from a single scan than to
+	// look up one by one
+	if (entry_ids.size() <= NDJSON_ENTRY_LOOKUP_LIMIT) {
+		std::vector<uint64_t> ids(entry_ids.begin(),entry_ids.end());
+		std::sort(ids.begin(),ids.end());
+		for (auto id: ids) {
+			Glib::RefPtr<GrowlogEntry> entry = database->get_growlog_entry(id);
+			if (!entry)
+				continue;
+			const Glib::ustring &title = get_title(entry->get_growlog_id());
+			if (title.empty())
+				continue;
+			_append_entry(buffer,title,entry);
+			_end_record(buffer,out,bytes_written);
+		}
+	} else {
+		for (auto &growlog: database->get_growlogs())
+			growlog_titles[growlog->get_id()] = growlog->get_title();
+		database->foreach_growlog_entry([&](const Glib::RefPtr<GrowlogEntry> &entry) {
+			if (!entry_ids.count(entry->get_id()))
+				return;
+			auto iter = growlog_titles.find(entry->get_growlog_id());
+			if (iter == growlog_titles.end())
+				return;
+			_append_entry(buffer,iter->second,entry);
+			_end_record(buffer,out,bytes_written);
+		});
+	}
+
+	_flush(buffer,out,bytes_written);
+	return bytes_written;
+}
+
+/*******************************************************************************
+ * NdjsonRecord
+ ******************************************************************************/
+
+NdjsonRecord::NdjsonRecord():
+	m_values_{},
+	m_key_{},
+	m_value_{}
+{
+}
+
+NdjsonRecord::~NdjsonRecord()
+{
+}
+
+static void
+_skip_space(const char *&p, const char *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+		++p;
+}
+
+static int
+_hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+static bool
+_parse_hex4(const char *&p, const char *end, unsigned int &value)
+{
+	if (end - p < 4)
+		return false;
+	value = 0;
+	for (int i = 0; i < 4; ++i) {
+		int v = _hex_value(*p++);
+		if (v < 0)
+			return false;
+		value = (value << 4) | static_cast<unsigned int>(v);
+	}
+	return true;
+}
+
+static void
+_append_utf8(std::string &out, unsigned int c)
+{
+	if (c < 0x80) {
+		out += static_cast<char>(c);
+	} else if (c < 0x800) {
+		out += static_cast<char>(0xc0 | (c >> 6));
+		out += static_cast<char>(0x80 | (c & 0x3f));
+	} else if (c < 0x10000) {
+		out += static_cast<char>(0xe0 | (c >> 12));
+		out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+		out += static_cast<char>(0x80 | (c & 0x3f));
+	} else {
+		out += static_cast<char>(0xf0 | (c >> 18));
+		out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+		out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+		out += static_cast<char>(0x80 | (c & 0x3f));
+	}
+}
+
+// p points to the opening quote.
+bool
+NdjsonRecord::_parse_string(const char *&p, const char *end, std::string &out)
+{
+	out.clear();
+	if (p >= end || *p != '"')
+		return false;
+	++p;
+
+	const char *start = p;
+	while (p < end) {
+		char c = *p;
+		if (c == '"') {
+			out.append(start,p - start);
+			++p;
+			return true;
+		} else if (c == '\\') {
+			out.append(start,p - start);
+			if (++p >= end)
+				return false;
+			switch (*p++) {
+				case '"':
+					out += '"';
+					break;
+				case '\\':
+					out += '\\';
+					break;
+				case '/':
+					out += '/';
+					break;
+				case 'b':
+					out += '\b';
+					break;
+				case 'f':
+					out += '\f';
+					break;
+				case 'n':
+					out += '\n';
+					break;
+				case 'r':
+					out += '\r';
+					break;
+				case 't':
+					out += '\t';
+					break;
+				case 'u':
+				{
+					unsigned int code;
+					if (!_parse_hex4(p,end,code))
+						return false;
+					if (code >= 0xd800 && code < 0xdc00) {
+						unsigned int low;
+						if (end - p < 2 || p[0] != '\\' || p[1] != 'u')
+							return false;
+						p += 2;
+						if (!_parse_hex4(p,end,low) || low < 0xdc00 || low >= 0xe000)
+							return false;
+						code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					} else if (code >= 0xdc00 && code < 0xe000) {
+						return false;
+					}
+					_append_utf8(out,code);
+					break;
+				}
+				default:
+					return false;
+			}
+			start = p;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			return false;
+		} else {
+			++p;
+		}
+	}
+	return false;
+}
+
+bool
+NdjsonRecord::_parse_value(const char *&p, const char *end, std::string &out, bool &is_null)
+{
+	is_null = false;
+	if (p >= end)
+		return false;
+	if (*p == '"')
+		return _parse_string(p,end,out);
+
+	// numbers, true, false and null are kept as they are written
+	const char *start = p;
+	while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+		if (*p == '{' || *p == '[' || *p == '"')
+			return false;
+		++p;
+	}
+	if (p == start)
+		return false;
+	out.assign(start,p - start);
+	is_null = (out == "null");
+	return true;
+}
+
+bool
+NdjsonRecord::parse(const char *data, size_t size)
+{
+	// the strings of the previous line are reused, unless a file makes
+	// up new keys on every line
+	if (m_values_.size() > 64)
+		m_values_.clear();
+	for (auto &value: m_values_)
+		value.second.clear();
+
+	const char *p = data;
+	const char *end = data + size;
+
+	_skip_space(p,end);
+	if (p >= end || *p++ != '{')
+		return false;
+	_skip_space(p,end);
+	if (p < end && *p == '}') {
+		++p;
+	} else {
+		for (;;) {
+			_skip_space(p,end);
+			if (!_parse_string(p,end,m_key_))
+				return false;
+			_skip_space(p,end);
+			if (p >= end || *p++ != ':')
+				return false;
+			_skip_space(p,end);
+			bool is_null;
+			if (!_parse_value(p,end,m_value_,is_null))
+				return false;
+			if (!is_null)
+				m_values_[m_key_].swap(m_value_);
+			_skip_space(p,end);
+			if (p < end && *p == ',') {
+				++p;
+			} else if (p < end && *p == '}') {
+				++p;
+				break;
+			} else {
+				return false;
+			}
+		}
+	}
+	_skip_space(p,end);
+	return (p == end);
+}
+
+bool
+NdjsonRecord::has(const std::string &key) const
+{
+	auto iter = m_values_.find(key);
+	return (iter != m_values_.end() && !iter->second.empty());
+}
+
+const std::string&
+NdjsonRecord::get(const std::string &key) const
+{
+	static const std::string empty;
+
+	auto iter = m_values_.find(key);
+	if (iter == m_values_.end())
+		return empty;
+	return iter->second;
+}
+
+time_t
+NdjsonRecord::get_time(const std::string &key) const
+{
+	const std::string &value = get(key);
+	if (value.empty())
+		return 0;
+
+	tm datetime;
+	memset(&datetime,0,sizeof(datetime));
+	if (!strptime(value.c_str(),DATETIME_ISO_FORMAT,&datetime))
+		return 0;
+	datetime.tm_isdst = -1;
+	return mktime(&datetime);
+}
@@ -0,0 +1,132 @@
+/***************************************************************************
+ *            ndjson.h
+ *
+ *  Mo Oktober 19 16:05:12 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * ndjson.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __NDJSON_H__
+#define __NDJSON_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "database.h"
+
+/*
+ * Newline delimited JSON, one flat object per line. Every record names its
+ * type and refers to other records by name, so each line can be processed
+ * on its own and files can simply be appended to:
+ *
+ *   {"type":"growbook","version":1}
+ *   {"type":"breeder","name":...,"homepage":...}
+ *   {"type":"strain","breeder":...,"name":...,"info":...,"description":...,
+ *    "homepage":...,"seedfinder":...}
+ *   {"type":"growlog","title":...,"description":...,"created_on":...,
+ *    "flower_on":...,"finished_on":...}
+ *   {"type":"growlog_strain","growlog":...,"breeder":...,"strain":...}
+ *   {"type":"entry","growlog":...,"created_on":...,"text":...}
+ *
+ * Times are local time in DATETIME_ISO_FORMAT, unset times are null.
+ * Readers ignore records of unknown types and unknown keys.
+ *
+ * A delta, written by ndjson_export_changes(), starts with
+ *
+ *   {"type":"growbook","version":1,"delta":true,"after":...,"seq":...}
+ *
+ * followed by the deletes and renames of the change_log in the order they
+ * happened, and then the rows that changed, as records of the types above
+ * with their current values. Deletes and renames name the rows the way the
+ * other records do:
+ *
+ *   {"type":"delete","table":"breeder","name":...}
+ *   {"type":"delete","table":"strain","breeder":...,"name":...}
+ *   {"type":"delete","table":"growlog","title":...}
+ *   {"type":"delete","table":"growlog_strain","growlog":...,"breeder":...,
+ *    "strain":...}
+ *   {"type":"delete","table":"entry","growlog":...,"created_on":...,"text":...}
+ *   {"type":"rename","table":"breeder","name":...,"new_name":...}
+ *   {"type":"rename","table":"strain","breeder":...,"name":...,
+ *    "new_breeder":...,"new_name":...}
+ *   {"type":"rename","table":"growlog","title":...,"new_title":...}
+ *
+ * When a delta is imported existing rows are updated instead of asking
+ * the ImportConflictHandler, and entries that already exist are skipped.
+ */
+
+#define NDJSON_VERSION 1
+
+// Writes the whole database as NDJSON. Entries are streamed, so memory use
+// does not grow with the number of entries. Returns the number of bytes
+// written.
+uint64_t ndjson_export_database(const Glib::RefPtr<const Database> &database,
+                                std::ostream &out);
+
+// Writes the changes with after < seq <= upto as a delta, see
+// Database::foreach_change(). With after 0 every row is written. Returns
+// the number of bytes written.
+uint64_t ndjson_export_changes(const Glib::RefPtr<const Database> &database,
+                               uint64_t after,
+                               uint64_t upto,
+                               std::ostream &out);
+
+// Appends s as a quoted JSON string.
+void ndjson_append_string(std::string &out, const char *s, size_t size);
+
+/******************************************************************************/
+
+// One parsed line. Only flat objects are accepted; strings, numbers,
+// true/false and null are the allowed values. A record is meant to be
+// reused for every line, so parsing does not allocate once the buffers
+// are large enough.
+class NdjsonRecord
+{
+	 private:
+		 std::map<std::string,std::string> m_values_;
+		 std::string m_key_;
+		 std::string m_value_;
+
+	public:
+		 NdjsonRecord();
+		 ~NdjsonRecord();
+
+	public:
+		 // Returns false if data is not a flat JSON object.
+		 bool parse(const char *data, size_t size);
+
+		 // null counts as missing.
+		 bool has(const std::string &key) const;
+		 // Returns "" if key is missing.
+		 const std::string& get(const std::string &key) const;
+		 // Returns 0 if key is missing or not a valid time.
+		 time_t get_time(const std::string &key) const;
+
+	private:
+		 bool _parse_string(const char *&p, const char *end, std::string &out);
+		 bool _parse_value(const char *&p, const char *end, std::string &out, bool &is_null);
+};
+
+#endif /* __NDJSON_H__ */
@@ -0,0 +1,576 @@
+//           ndjson_importer.cc
+//  Mo Oktober 19 16:05:12 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// ndjson_importer.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <glibmm.h>
+#include <glibmm/i18n.h>
+
+#include "ndjson_importer.h"
+#include "ndjson.h"
+#include "error.h"
+#include "trace.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#define NDJSON_IMPORT_CHUNK_SIZE (64 * 1024)
+// entries are handed to the database in batches of this size
+#define NDJSON_IMPORT_BATCH_SIZE 10000
+
+/*******************************************************************************
+ * NdjsonImport
+ ******************************************************************************/
+
+// The state of one import run. Growlogs that are not in the file part
+// that is read, because they were imported by an earlier run, are looked
+// up by title.
+//
+// In a delta the rows are identified by their names, see ndjson.h. Entries
+// have no name, so the entries of the growlog last touched are cached by
+// creation time and text.
+class NdjsonImport
+{
+	private:
+		struct PendingEntry
+		{
+			uint64_t growlog_id;
+			std::string text;
+			time_t created_on;
+		};
+
+	private:
+		Glib::RefPtr<ImportConflictHandler> m_handler_;
+		Glib::RefPtr<Database> m_database_;
+		ImportConflictAction m_breeder_response_;
+		bool m_skip_all_;
+		bool m_delta_;
+		std::map<std::string,bool> m_breeder_update_;
+		std::map<std::string,uint64_t> m_growlogs_;
+		std::vector<PendingEntry> m_pending_;
+		std::vector<GrowlogEntryRow> m_rows_;
+		uint64_t m_entry_growlog_id_;
+		std::unordered_multimap<std::string,uint64_t> m_entries_;
+
+	public:
+		NdjsonImport(const Glib::RefPtr<ImportConflictHandler> &handler,
+		             const Glib::RefPtr<Database> &database);
+		~NdjsonImport();
+
+	public:
+		// Returns false if the import was aborted.
+		bool import_record(const NdjsonRecord &record);
+		bool has_pending() const;
+		void flush();
+
+	private:
+		bool _import_breeder(const NdjsonRecord &record);
+		void _import_strain(const NdjsonRecord &record);
+		bool _import_growlog(const NdjsonRecord &record);
+		void _import_growlog_strain(const NdjsonRecord &record);
+		void _import_entry(const NdjsonRecord &record);
+		void _import_delete(const NdjsonRecord &record);
+		void _import_rename(const NdjsonRecord &record);
+
+		uint64_t _lookup_growlog(const std::string &title);
+		void _load_entries(uint64_t growlog_id);
+		static std::string _entry_key(time_t created_on, const std::string &text);
+		void _warning(const char *message, const std::string &name);
+};
+
+NdjsonImport::NdjsonImport(const Glib::RefPtr<ImportConflictHandler> &handler,
+                           const Glib::RefPtr<Database> &database):
+	m_handler_{handler},
+	m_database_{database},
+	m_breeder_response_{IMPORT_CONFLICT_ABORT},
+	m_skip_all_{false},
+	m_delta_{false},
+	m_breeder_update_{},
+	m_growlogs_{},
+	m_pending_{},
+	m_rows_{},
+	m_entry_growlog_id_{0},
+	m_entries_{}
+{
+	m_pending_.reserve(NDJSON_IMPORT_BATCH_SIZE);
+	m_rows_.reserve(NDJSON_IMPORT_BATCH_SIZE);
+}
+
+NdjsonImport::~NdjsonImport()
+{
+}
+
+bool
+NdjsonImport::import_record(const NdjsonRecord &record)
+{
+	const std::string &type = record.get("type");
+	if (type == "entry") {
+		_import_entry(record);
+	} else if (type == "breeder") {
+		return _import_breeder(record);
+	} else if (type == "strain") {
+		_import_strain(record);
+	} else if (type == "growlog") {
+		return _import_growlog(record);
+	} else if (type == "growlog_strain") {
+		_import_growlog_strain(record);
+	} else if (type == "delete") {
+		flush();
+		_import_delete(record);
+	} else if (type == "rename") {
+		flush();
+		_import_rename(record);
+	} else if (type == "growbook") {
+		if (std::strtoull(record.get("version").c_str(),nullptr,10) > NDJSON_VERSION) {
+			Glib::ustring msg = _("Unsupported NDJSON version!");
+			msg += "\n(";
+			msg += record.get("version");
+			msg += ")";
+			throw Glib::FileError(Glib::FileError::FAILED,msg);
+		}
+		m_delta_ = (record.get("delta") == "true");
+	}
+	return true;
+}
+
+bool
+NdjsonImport::has_pending() const
+{
+	return !m_pending_.empty();
+}
+
+void
+NdjsonImport::flush()
+{
+	if (m_pending_.empty())
+		return;
+
+	m_rows_.clear();
+	for (auto &entry: m_pending_) {
+		GrowlogEntryRow row;
+		row.growlog_id = entry.growlog_id;
+		row.text = entry.text.data();
+		row.text_size = entry.text.size();
+		row.created_on = entry.created_on;
+		m_rows_.push_back(row);
+	}
+	m_database_->add_growlog_entries(m_rows_);
+	m_pending_.clear();
+}
+
+bool
+NdjsonImport::_import_breeder(const NdjsonRecord &record)
+{
+	const std::string &name = record.get("name");
+	if (name.empty()) {
+		_warning(N_("Breeder without name, skipping it!"),name);
+		return true;
+	}
+
+	Glib::RefPtr<Breeder> breeder = m_database_->get_breeder(name);
+	bool update = m_delta_;
+	if (breeder && !m_delta_) {
+		if (m_breeder_response_ != IMPORT_CONFLICT_UPDATE_ALL
+		    && m_breeder_response_ != IMPORT_CONFLICT_MERGE_ALL) {
+			m_breeder_response_ = m_handler_->resolve_breeder(name);
+			if (m_breeder_response_ == IMPORT_CONFLICT_ABORT)
+				return false;
+		}
+		update = (m_breeder_response_ == IMPORT_CONFLICT_UPDATE
+		          || m_breeder_response_ == IMPORT_CONFLICT_UPDATE_ALL);
+	}
+	if (!breeder) {
+		m_database_->add_breeder(Breeder::create(name,record.get("homepage")));
+	} else if (update) {
+		breeder->set_homepage(record.get("homepage"));
+		m_database_->add_breeder(breeder);
+	}
+	m_breeder_update_[name] = update;
+	return true;
+}
+
+void
+NdjsonImport::_import_strain(const NdjsonRecord &record)
+{
+	const std::string &breeder_name = record.get("breeder");
+	const std::string &name = record.get("name");
+	Glib::RefPtr<Breeder> breeder = m_database_->get_breeder(breeder_name);
+	if (!breeder || name.empty()) {
+		_warning(N_("Strain without breeder, skipping it!"),name);
+		return;
+	}
+
+	Glib::RefPtr<Strain> strain = m_database_->get_strain(breeder_name,name);
+	if (!strain) {
+		m_database_->add_strain(Strain::create(breeder->get_id(),
+		                                       breeder->get_name(),
+		                                       name,
+		                                       record.get("info"),
+		                                       record.get("description"),
+		                                       record.get("homepage"),
+		                                       record.get("seedfinder")));
+	} else if (m_delta_ || m_breeder_update_[breeder_name]) {
+		strain->set_info(record.get("info"));
+		strain->set_description(record.get("description"));
+		strain->set_homepage(record.get("homepage"));
+		strain->set_seedfinder(record.get("seedfinder"));
+		m_database_->add_strain(strain);
+	}
+}
+
+bool
+NdjsonImport::_import_growlog(const NdjsonRecord &record)
+{
+	std::string file_title = record.get("title");
+	Glib::ustring title = file_title;
+	if (title.empty() || !record.has("created_on")) {
+		_warning(N_("Growlog without title or creation time, skipping it!"),file_title);
+		return true;
+	}
+
+	Glib::RefPtr<Growlog> existing = m_database_->get_growlog(title);
+	if (existing && m_delta_) {
+		existing->set_description(record.get("description"));
+		existing->set_flower_on(record.get_time("flower_on"));
+		existing->set_finished_on(record.get_time("finished_on"));
+		m_database_->add_growlog(existing);
+		m_growlogs_[file_title] = existing->get_id();
+		return true;
+	} else if (existing) {
+		m_growlogs_[file_title] = 0;
+		if (m_skip_all_)
+			return true;
+
+		Glib::ustring new_title;
+		ImportConflictAction response = m_handler_->resolve_growlog(m_database_,title,new_title);
+		if (response == IMPORT_CONFLICT_ABORT)
+			return false;
+		if (response == IMPORT_CONFLICT_SKIP_ALL)
+			m_skip_all_ = true;
+		if (response != IMPORT_CONFLICT_RENAME)
+			return true;
+		title = new_title;
+	}
+
+	m_database_->add_growlog(Growlog::create(title,
+	                                         record.get("description"),
+	                                         record.get_time("created_on"),
+	                                         record.get_time("flower_on"),
+	                                         record.get_time("finished_on")));
+	Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(title);
+	m_growlogs_[file_title] = (growlog ? growlog->get_id() : 0);
+	return true;
+}
+
+void
+NdjsonImport::_import_growlog_strain(const NdjsonRecord &record)
+{
+	uint64_t growlog_id = _lookup_growlog(record.get("growlog"));
+	if (!growlog_id)
+		return;
+
+	Glib::RefPtr<Strain> strain = m_database_->get_strain(record.get("breeder"),record.get("strain"));
+	if (!strain) {
+		_warning(N_("Unknown strain, skipping it!"),record.get("strain"));
+		return;
+	}
+	if (m_delta_) {
+		for (auto &linked: m_database_->get_strains_for_growlog(growlog_id)) {
+			if (linked->get_id() == strain->get_id())
+				return;
+		}
+	}
+	m_database_->add_strain_for_growlog(growlog_id,strain->get_id());
+}
+
+void
+NdjsonImport::_import_entry(const NdjsonRecord &record)
+{
+	uint64_t growlog_id = _lookup_growlog(record.get("growlog"));
+	if (!growlog_id)
+		return;
+
+	time_t created_on = record.get_time("created_on");
+	if (!created_on) {
+		_warning(N_("Growlog-entry without creation time, skipping it!"),record.get("growlog"));
+		return;
+	}
+	if (m_delta_) {
+		_load_entries(growlog_id);
+		std::string key = _entry_key(created_on,record.get("text"));
+		if (m_entries_.count(key))
+			return;
+		m_entries_.emplace(std::move(key),0);
+	}
+
+	m_pending_.push_back(PendingEntry{growlog_id,record.get("text"),created_on});
+	if (m_pending_.size() >= NDJSON_IMPORT_BATCH_SIZE)
+		flush();
+}
+
+// Rows that are already gone are ignored, the delta may be imported twice.
+void
+NdjsonImport::_import_delete(const NdjsonRecord &record)
+{
+	const std::string &table = record.get("table");
+	if (table == "breeder") {
+		Glib::RefPtr<Breeder> breeder = m_database_->get_breeder(record.get("name"));
+		if (breeder)
+			m_database_->remove_breeder(breeder);
+	} else if (table == "strain") {
+		Glib::RefPtr<Strain> strain = m_database_->get_strain(record.get("breeder"),record.get("name"));
+		if (strain)
+			m_database_->remove_strain(strain);
+	} else if (table == "growlog") {
+		Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(record.get("title"));
+		m_growlogs_.erase(record.get("title"));
+		if (!growlog)
+			return;
+		if (growlog->get_id() == m_entry_growlog_id_) {
+			m_entry_growlog_id_ = 0;
+			m_entries_.clear();
+		}
+		m_database_->remove_growlog(growlog);
+	} else if (table == "growlog_strain") {
+		Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(record.get("growlog"));
+		Glib::RefPtr<Strain> strain = m_database_->get_strain(record.get("breeder"),record.get("strain"));
+		if (growlog && strain)
+			m_database_->remove_strain_for_growlog(growlog,strain);
+	} else if (table == "entry") {
+		Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(record.get("growlog"));
+		if (!growlog)
+			return;
+		_load_entries(growlog->get_id());
+		auto iter = m_entries_.find(_entry_key(record.get_time("created_on"),record.get("text")));
+		if (iter == m_entries_.end())
+			return;
+		m_database_->remove_growlog_entry(iter->second);
+		m_entries_.erase(iter);
+	}
+}
+
+// Strains can not be moved to another breeder, a strain that changed its
+// breeder is left alone and imported again under the new breeder.
+void
+NdjsonImport::_import_rename(const NdjsonRecord &record)
+{
+	const std::string &table = record.get("table");
+	if (table == "breeder") {
+		Glib::RefPtr<Breeder> breeder = m_database_->get_breeder(record.get("name"));
+		if (!breeder)
+			return;
+		if (m_database_->get_breeder(record.get("new_name"))) {
+			_warning(N_("Breeder already exists, can not rename it!"),record.get("new_name"));
+			return;
+		}
+		breeder->set_name(record.get("new_name"));
+		m_database_->add_breeder(breeder);
+	} else if (table == "strain") {
+		Glib::RefPtr<Strain> strain = m_database_->get_strain(record.get("breeder"),record.get("name"));
+		if (!strain)
+			return;
+		if (record.get("new_breeder") != record.get("breeder")) {
+			_warning(N_("Strain changed its breeder, keeping the old one!"),record.get("name"));
+			return;
+		}
+		if (m_database_->get_strain(record.get("breeder"),record.get("new_name"))) {
+			_warning(N_("Strain already exists, can not rename it!"),record.get("new_name"));
+			return;
+		}
+		strain->set_name(record.get("new_name"));
+		m_database_->add_strain(strain);
+	} else if (table == "growlog") {
+		Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(record.get("title"));
+		m_growlogs_.erase(record.get("title"));
+		m_growlogs_.erase(record.get("new_title"));
+		if (!growlog)
+			return;
+		if (m_database_->get_growlog(record.get("new_title"))) {
+			_warning(N_("Growlog already exists, can not rename it!"),record.get("new_title"));
+			return;
+		}
+		growlog->set_title(record.get("new_title"));
+		m_database_->add_growlog(growlog);
+	}
+}
+
+// Returns 0 for growlogs that are skipped or unknown.
+uint64_t
+NdjsonImport::_lookup_growlog(const std::string &title)
+{
+	auto iter = m_growlogs_.find(title);
+	if (iter != m_growlogs_.end())
+		return iter->second;
+
+	Glib::RefPtr<Growlog> growlog = m_database_->get_growlog(title);
+	if (!growlog)
+		_warning(N_("Unknown growlog, skipping its records!"),title);
+	uint64_t id = (growlog ? growlog->get_id() : 0);
+	m_growlogs_[title] = id;
+	return id;
+}
+
+void
+NdjsonImport::_load_entries(uint64_t growlog_id)
+{
+	if (growlog_id == m_entry_growlog_id_)
+		return;
+
+	flush();
+	m_entries_.clear();
+	for (auto &entry: m_database_->get_growlog_entries(growlog_id))
+		m_entries_.emplace(_entry_key(entry->get_created_on(),entry->get_text().raw()),entry->get_id());
+	m_entry_growlog_id_ = growlog_id;
+}
+
+std::string
+NdjsonImport::_entry_key(time_t created_on, const std::string &text)
+{
+	std::string key = std::to_string(created_on);
+	key += '\0';
+	key += text;
+	return key;
+}
+
+void
+NdjsonImport::_warning(const char *message, const std::string &name)
+{
+	Glib::ustring msg = _(message);
+	msg += "\n(";
+	msg += name;
+	msg += ")";
+	m_handler_->warning(msg);
+}
+
+/*******************************************************************************
+ * NDJSON_Importer
+ ******************************************************************************/
+
+NDJSON_Importer::NDJSON_Importer(const Glib::RefPtr<Database> &db,
+                                 const std::string &filename):
+	Importer(db,filename),
+	m_offset_{0}
+{
+}
+
+NDJSON_Importer::~NDJSON_Importer()
+{
+}
+
+Glib::RefPtr<NDJSON_Importer>
+NDJSON_Importer::create(const Glib::RefPtr<Database> &db,
+                        const std::string &filename)
+{
+	return Glib::RefPtr<NDJSON_Importer>(new NDJSON_Importer(db,filename));
+}
+
+uint64_t
+NDJSON_Importer::get_offset() const
+{
+	return m_offset_;
+}
+
+void
+NDJSON_Importer::set_offset(uint64_t offset)
+{
+	m_offset_ = offset;
+}
+
+void
+NDJSON_Importer::import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	TRACE_SCOPE("import","NDJSON_Importer::import_vfunc");
+
+	std::ifstream is(get_filename().c_str(),std::ifstream::binary);
+	if (!is)
+		throw Glib::FileError(Glib::FileError::FAILED,_("Unable to open file for reading!"));
+
+	// a file that got shorter was replaced, so it is read from the start
+	is.seekg(0,std::ios_base::end);
+	uint64_t size = static_cast<uint64_t>(is.tellg());
+	if (m_offset_ > size) {
+		Glib::ustring msg = _("The file is shorter than the offset, importing it from the start!");
+		msg += "\n(";
+		msg += get_filename();
+		msg += ")";
+		handler->warning(msg);
+		m_offset_ = 0;
+	}
+	is.seekg(static_cast<std::streamoff>(m_offset_));
+
+	NdjsonImport import(handler,get_database());
+	NdjsonRecord record;
+	std::vector<char> buffer(NDJSON_IMPORT_CHUNK_SIZE);
+	size_t buffer_size = 0;
+	uint64_t offset = m_offset_;
+	uint64_t line_number = 0;
+
+	// m_offset_ only moves past lines whose records are in the database,
+	// so an import that fails can be repeated from get_offset()
+	for (;;) {
+		if (buffer_size == buffer.size())
+			buffer.resize(buffer.size() * 2);
+		is.read(buffer.data() + buffer_size,buffer.size() - buffer_size);
+		std::streamsize n_read = is.gcount();
+		if (n_read <= 0)
+			break;
+		buffer_size += static_cast<size_t>(n_read);
+
+		const char *start = buffer.data();
+		const char *end = buffer.data() + buffer_size;
+		const char *newline;
+		while ((newline = static_cast<const char*>(memchr(start,'\n',end - start)))) {
+			++line_number;
+			if (newline > start && !record.parse(start,newline - start)) {
+				Glib::ustring msg = _("Unable to parse line, skipping it!");
+				msg += "\n(";
+				msg += std::to_string(line_number);
+				msg += ")";
+				handler->warning(msg);
+			} else if (newline > start && !import.import_record(record)) {
+				// the aborted line is read again by the next import
+				import.flush();
+				m_offset_ = offset;
+				return;
+			}
+			offset += (newline + 1 - start);
+			start = newline + 1;
+			if (!import.has_pending())
+				m_offset_ = offset;
+		}
+
+		// an incomplete last line is kept for the next read
+		buffer_size = end - start;
+		memmove(buffer.data(),start,buffer_size);
+		if (buffer.size() > NDJSON_IMPORT_CHUNK_SIZE && buffer_size < NDJSON_IMPORT_CHUNK_SIZE) {
+			buffer.resize(NDJSON_IMPORT_CHUNK_SIZE);
+			buffer.shrink_to_fit();
+		}
+	}
+
+	import.flush();
+	m_offset_ = offset;
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *            ndjson_importer.h
+ *
+ *  Mo Oktober 19 16:05:12 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * ndjson_importer.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __NDJSON_IMPORTER_H__
+#define __NDJSON_IMPORTER_H__
+
+#include <cstdint>
+
+#include "import.h"
+
+// Imports NDJSON written by NDJSON_Exporter, or by anything else that
+// follows ndjson.h. The file is read line by line with constant memory.
+//
+// Reading starts at the byte offset set with set_offset(). Only complete
+// lines are imported; afterwards get_offset() points behind the last one,
+// so a file that is still being appended to can be imported piece by piece
+// by passing the offset back in. Lines that can not be parsed are reported
+// to the ImportConflictHandler and skipped.
+//
+// A delta written by ndjson_export_changes() is applied to the database:
+// deletes and renames are carried out, rows that exist are updated without
+// asking the ImportConflictHandler and entries that exist are skipped.
+class NDJSON_Importer:
+	public Importer
+{
+	 private:
+		 uint64_t m_offset_;
+
+	private:
+		 NDJSON_Importer(const NDJSON_Importer &src) = delete;
+		 NDJSON_Importer& operator=(const NDJSON_Importer &src) = delete;
+
+	protected:
+		 NDJSON_Importer(const Glib::RefPtr<Database> &database,
+		                 const std::string &filename);
+
+	public:
+		 virtual ~NDJSON_Importer();
+
+		 static Glib::RefPtr<NDJSON_Importer> create(const Glib::RefPtr<Database> &database,
+		                                             const std::string &filename);
+
+	public:
+		 uint64_t get_offset() const;
+		 void set_offset(uint64_t offset);
+
+	protected:
+		 void import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler);
+};
+
+#endif /* __NDJSON_IMPORTER_H__ */
@@ -0,0 +1,287 @@
+//           pool.cc
+//  Mo Oktober 19 09:14:02 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// pool.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "pool.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <cassert>
+
+/*******************************************************************************
+ * PoolStats
+ ******************************************************************************/
+
+size_t
+PoolStats::get_reserved_bytes() const
+{
+	return slabs * objects_per_slab * object_size;
+}
+
+size_t
+PoolStats::get_used_bytes() const
+{
+	return in_use * object_size;
+}
+
+double
+PoolStats::get_fragmentation() const
+{
+	size_t reserved = get_reserved_bytes();
+	if (!reserved)
+		return 0.0;
+	return 1.0 - (static_cast<double>(get_used_bytes()) / static_cast<double>(reserved));
+}
+
+/*******************************************************************************
+ * ObjectPool
+ ******************************************************************************/
+
+ObjectPool::ObjectPool(size_t object_size, size_t objects_per_slab):
+	m_object_size_{object_size},
+	m_objects_per_slab_{objects_per_slab},
+	m_mutex_{},
+	m_free_list_{nullptr},
+	m_slabs_{},
+	m_free_{0},
+	m_allocations_{0},
+	m_deallocations_{0}
+{
+	assert(m_object_size_ >= sizeof(FreeNode));
+	assert(m_object_size_ % alignof(std::max_align_t) == 0);
+	assert(m_objects_per_slab_ > 0);
+}
+
+ObjectPool::~ObjectPool()
+{
+	for (auto slab: m_slabs_)
+		::operator delete(slab);
+}
+
+size_t
+ObjectPool::get_object_size() const
+{
+	return m_object_size_;
+}
+
+void
+ObjectPool::_add_slab()
+{
+	char *slab = static_cast<char*>(::operator new(m_object_size_ * m_objects_per_slab_));
+	m_slabs_.push_back(slab);
+
+	// chain the new objects in address order so consecutive allocations
+	// of a bulk fetch end up next to each other
+	for (size_t i = m_objects_per_slab_; i > 0; --i) {
+		FreeNode *node = reinterpret_cast<FreeNode*>(slab + ((i - 1) * m_object_size_));
+		node->next = m_free_list_;
+		m_free_list_ = node;
+	}
+	m_free_ += m_objects_per_slab_;
+}
+
+void*
+ObjectPool::allocate()
+{
+	++m_allocations_;
+	
+	std::lock_guard<std::mutex> lock(m_mutex_);
+	if (!m_free_list_)
+		_add_slab();
+
+	FreeNode *node = m_free_list_;
+	m_free_list_ = node->next;
+	--m_free_;
+
+	return node;
+}
+
+void
+ObjectPool::deallocate(void *ptr)
+{
+	if (!ptr)
+		return;
+	
+	++m_deallocations_;
+
+	std::lock_guard<std::mutex> lock(m_mutex_);
+	FreeNode *node = static_cast<FreeNode*>(ptr);
+	node->next = m_free_list_;
+	m_free_list_ = node;
+	++m_free_;
+}
+
+PoolStats
+ObjectPool::get_stats()
+{
+	PoolStats stats;
+
+	stats.object_size = m_object_size_;
+	stats.objects_per_slab = m_objects_per_slab_;
+	stats.allocations = m_allocations_.load();
+	stats.deallocations = m_deallocations_.load();
+	stats.fallback_allocations = 0;
+	stats.in_use = stats.allocations - stats.deallocations;
+	
+	std::lock_guard<std::mutex> lock(m_mutex_);
+	stats.slabs = m_slabs_.size();
+	stats.free = m_free_;
+
+	return stats;
+}
+
+/*******************************************************************************
+ * pool functions
+ ******************************************************************************/
+
+#define POOL_SIZE_CLASSES (POOL_MAX_OBJECT_SIZE / POOL_SIZE_CLASS_GRANULARITY)
+#define POOL_DEFAULT_SLAB_OBJECTS 256
+
+// The pools are never destroyed. Objects may still be referenced by
+// static RefPtrs when the program exits.
+static std::atomic<ObjectPool*> pool_size_classes[POOL_SIZE_CLASSES];
+static std::mutex pool_mutex;
+
+// Counters for allocations that bypass the pools because they are too big
+// or because pooling was disabled.
+static std::atomic<uint64_t> pool_fallback_allocations{0};
+static std::atomic<uint64_t> pool_fallback_deallocations{0};
+
+static inline size_t
+_pool_size_class(size_t size)
+{
+	return (size + POOL_SIZE_CLASS_GRANULARITY - 1) / POOL_SIZE_CLASS_GRANULARITY;
+}
+
+bool
+pool_is_enabled()
+{
+	static const bool enabled = (getenv("GROWBOOK_DISABLE_POOL") == nullptr);
+	return enabled;
+}
+
+size_t
+pool_slab_objects()
+{
+	return POOL_DEFAULT_SLAB_OBJECTS;
+}
+
+static ObjectPool*
+_pool_get(size_t size_class)
+{
+	ObjectPool *pool = pool_size_classes[size_class - 1].load(std::memory_order_acquire);
+	if (pool)
+		return pool;
+
+	std::lock_guard<std::mutex> lock(pool_mutex);
+	pool = pool_size_classes[size_class - 1].load(std::memory_order_relaxed);
+	if (!pool) {
+		pool = new ObjectPool(size_class * POOL_SIZE_CLASS_GRANULARITY,
+		                      pool_slab_objects());
+		pool_size_classes[size_class - 1].store(pool, std::memory_order_release);
+	}
+	return pool;
+}
+
+void*
+pool_allocate(size_t size)
+{
+	size_t size_class = _pool_size_class(size);
+	
+	if (!pool_is_enabled() || size_class == 0 || size_class > POOL_SIZE_CLASSES) {
+		++pool_fallback_allocations;
+		return ::operator new(size);
+	}
+	return _pool_get(size_class)->allocate();
+}
+
+void
+pool_deallocate(void *ptr, size_t size)
+{
+	if (!ptr)
+		return;
+	
+	size_t size_class = _pool_size_class(size);
+
+	if (!pool_is_enabled() || size_class == 0 || size_class > POOL_SIZE_CLASSES) {
+		++pool_fallback_deallocations;
+		::operator delete(ptr);
+		return;
+	}
+	_pool_get(size_class)->deallocate(ptr);
+}
+
+std::list<PoolStats>
+pool_get_stats()
+{
+	std::list<PoolStats> ret;
+
+	for (size_t i = 0; i < POOL_SIZE_CLASSES; ++i) {
+		ObjectPool *pool = pool_size_classes[i].load(std::memory_order_acquire);
+		if (pool)
+			ret.push_back(pool->get_stats());
+	}
+
+	if (pool_fallback_allocations.load()) {
+		PoolStats stats;
+		stats.object_size = 0;
+		stats.objects_per_slab = 0;
+		stats.slabs = 0;
+		stats.allocations = pool_fallback_allocations.load();
+		stats.deallocations = pool_fallback_deallocations.load();
+		stats.fallback_allocations = stats.allocations;
+		stats.in_use = stats.allocations - stats.deallocations;
+		stats.free = 0;
+		ret.push_back(stats);
+	}
+	
+	return ret;
+}
+
+void
+pool_print_stats(FILE *file)
+{
+	fprintf(file, "%-8s %8s %12s %12s %12s %10s %8s\n",
+	        "size", "slabs", "allocs", "frees", "in use", "reserved", "frag");
+	for (auto stats: pool_get_stats()) {
+		if (!stats.object_size) {
+			fprintf(file, "%-8s %8s %12llu %12llu %12llu %10s %8s\n",
+			        "system", "-",
+			        static_cast<unsigned long long>(stats.allocations),
+			        static_cast<unsigned long long>(stats.deallocations),
+			        static_cast<unsigned long long>(stats.in_use),
+			        "-", "-");
+			continue;
+		}
+		fprintf(file, "%-8lu %8llu %12llu %12llu %12llu %10lu %7.1f%%\n",
+		        static_cast<unsigned long>(stats.object_size),
+		        static_cast<unsigned long long>(stats.slabs),
+		        static_cast<unsigned long long>(stats.allocations),
+		        static_cast<unsigned long long>(stats.deallocations),
+		        static_cast<unsigned long long>(stats.in_use),
+		        static_cast<unsigned long>(stats.get_reserved_bytes()),
+		        stats.get_fragmentation() * 100.0);
+	}
+}
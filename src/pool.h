@@ -0,0 +1,114 @@
+/***************************************************************************
+ *            pool.h
+ *
+ *  Mo Oktober 19 09:14:02 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * pool.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <list>
+
+/*
+ * Size-class pools for the small, short lived objects the database backends
+ * create in bulk (Breeder, Strain, Growlog, GrowlogEntry). Every size class
+ * keeps a freelist that is fed from slabs of pool_slab_objects() objects.
+ * Slabs are never handed back to the system; freed objects are recycled.
+ *
+ * Pooling can be disabled by setting the environment variable
+ * GROWBOOK_DISABLE_POOL before the first object is allocated. The counters
+ * are kept in both modes so runs can be compared.
+ */
+
+#define POOL_SIZE_CLASS_GRANULARITY 16
+#define POOL_MAX_OBJECT_SIZE 512
+
+struct PoolStats
+{
+	size_t object_size;
+	size_t objects_per_slab;
+	uint64_t slabs;
+	uint64_t allocations;
+	uint64_t deallocations;
+	uint64_t fallback_allocations;
+	uint64_t in_use;
+	uint64_t free;
+
+	size_t get_reserved_bytes() const;
+	size_t get_used_bytes() const;
+	double get_fragmentation() const;
+};
+
+class ObjectPool
+{
+	private:
+		struct FreeNode {
+			FreeNode *next;
+		};
+		
+		size_t m_object_size_;
+		size_t m_objects_per_slab_;
+
+		std::mutex m_mutex_;
+		FreeNode *m_free_list_;
+		std::vector<void*> m_slabs_;
+		uint64_t m_free_;
+
+		std::atomic<uint64_t> m_allocations_;
+		std::atomic<uint64_t> m_deallocations_;
+
+	private:
+		ObjectPool(const ObjectPool &src) = delete;
+		ObjectPool& operator=(const ObjectPool &src) = delete;
+
+		void _add_slab();
+		
+	public:
+		ObjectPool(size_t object_size, size_t objects_per_slab);
+		~ObjectPool();
+
+	public:
+		size_t get_object_size() const;
+		
+		void* allocate();
+		void deallocate(void *ptr);
+
+		PoolStats get_stats();
+};
+
+void* pool_allocate(size_t size);
+void pool_deallocate(void *ptr, size_t size);
+
+bool pool_is_enabled();
+size_t pool_slab_objects();
+
+std::list<PoolStats> pool_get_stats();
+void pool_print_stats(FILE *file);
+
+#endif /* __POOL_H__ */
@@ -0,0 +1,492 @@
+//           querystats.cc
+//  Mo Oktober 19 13:02:45 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// querystats.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "querystats.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <deque>
+#include <memory>
+
+/*******************************************************************************
+ * QueryStatSnapshot
+ ******************************************************************************/
+
+double
+QueryStatSnapshot::get_average_ms() const
+{
+	if (!count)
+		return 0.0;
+	return (static_cast<double>(total_ns) / static_cast<double>(count)) / 1000000.0;
+}
+
+double
+QueryStatSnapshot::get_percentile_ms(double percentile) const
+{
+	uint64_t n = 0;
+	for (int i = 0; i < QUERY_STAT_HISTOGRAM_BUCKETS; ++i)
+		n += histogram[i];
+	if (!n)
+		return 0.0;
+
+	uint64_t rank = static_cast<uint64_t>((percentile / 100.0) * static_cast<double>(n));
+	if (rank >= n)
+		rank = n - 1;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < QUERY_STAT_HISTOGRAM_BUCKETS; ++i) {
+		seen += histogram[i];
+		if (seen > rank) {
+			// upper bound of the bucket: 2^i microseconds
+			double upper_ms = static_cast<double>(1ull << i) / 1000.0;
+			double max_ms = static_cast<double>(max_ns) / 1000000.0;
+			return (upper_ms < max_ms ? upper_ms : max_ms);
+		}
+	}
+	return static_cast<double>(max_ns) / 1000000.0;
+}
+
+/*******************************************************************************
+ * QueryStat
+ ******************************************************************************/
+
+QueryStat::QueryStat(QueryStatKind kind,
+                     const std::string &engine,
+                     const std::string &key):
+	m_kind_{kind},
+	m_engine_{engine},
+	m_key_{key},
+	m_count_{0},
+	m_total_ns_{0},
+	m_max_ns_{0},
+	m_rows_{0},
+	m_bytes_{0}
+{
+	for (int i = 0; i < QUERY_STAT_HISTOGRAM_BUCKETS; ++i)
+		m_histogram_[i].store(0,std::memory_order_relaxed);
+}
+
+QueryStat::~QueryStat()
+{}
+
+QueryStatKind
+QueryStat::get_kind() const
+{
+	return m_kind_;
+}
+
+const std::string&
+QueryStat::get_engine() const
+{
+	return m_engine_;
+}
+
+const std::string&
+QueryStat::get_key() const
+{
+	return m_key_;
+}
+
+static inline int
+_histogram_bucket(uint64_t ns)
+{
+	uint64_t us = ns / 1000;
+	int bucket = 0;
+	while (us && bucket < QUERY_STAT_HISTOGRAM_BUCKETS - 1) {
+		us >>= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+void
+QueryStat::record(uint64_t ns, uint64_t rows, uint64_t bytes)
+{
+	m_count_.fetch_add(1,std::memory_order_relaxed);
+	m_total_ns_.fetch_add(ns,std::memory_order_relaxed);
+	if (rows)
+		m_rows_.fetch_add(rows,std::memory_order_relaxed);
+	if (bytes)
+		m_bytes_.fetch_add(bytes,std::memory_order_relaxed);
+	m_histogram_[_histogram_bucket(ns)].fetch_add(1,std::memory_order_relaxed);
+
+	uint64_t max = m_max_ns_.load(std::memory_order_relaxed);
+	while (ns > max && !m_max_ns_.compare_exchange_weak(max,ns,std::memory_order_relaxed));
+}
+
+void
+QueryStat::add_rows(uint64_t rows, uint64_t bytes)
+{
+	m_rows_.fetch_add(rows,std::memory_order_relaxed);
+	m_bytes_.fetch_add(bytes,std::memory_order_relaxed);
+}
+
+void
+QueryStat::reset()
+{
+	m_count_.store(0,std::memory_order_relaxed);
+	m_total_ns_.store(0,std::memory_order_relaxed);
+	m_max_ns_.store(0,std::memory_order_relaxed);
+	m_rows_.store(0,std::memory_order_relaxed);
+	m_bytes_.store(0,std::memory_order_relaxed);
+	for (int i = 0; i < QUERY_STAT_HISTOGRAM_BUCKETS; ++i)
+		m_histogram_[i].store(0,std::memory_order_relaxed);
+}
+
+QueryStatSnapshot
+QueryStat::get_snapshot() const
+{
+	QueryStatSnapshot snapshot;
+	snapshot.kind = m_kind_;
+	snapshot.engine = m_engine_;
+	snapshot.key = m_key_;
+	snapshot.count = m_count_.load(std::memory_order_relaxed);
+	snapshot.total_ns = m_total_ns_.load(std::memory_order_relaxed);
+	snapshot.max_ns = m_max_ns_.load(std::memory_order_relaxed);
+	snapshot.rows = m_rows_.load(std::memory_order_relaxed);
+	snapshot.bytes = m_bytes_.load(std::memory_order_relaxed);
+	for (int i = 0; i < QUERY_STAT_HISTOGRAM_BUCKETS; ++i)
+		snapshot.histogram[i] = m_histogram_[i].load(std::memory_order_relaxed);
+	return snapshot;
+}
+
+/*******************************************************************************
+ * QueryStatScope
+ ******************************************************************************/
+
+QueryStatScope::QueryStatScope(QueryStat *stat):
+	m_stat_{query_stats_get_enabled() ? stat : nullptr},
+	m_start_{},
+	m_rows_{0},
+	m_bytes_{0}
+{
+	if (m_stat_)
+		m_start_ = std::chrono::steady_clock::now();
+}
+
+QueryStatScope::~QueryStatScope()
+{
+	if (!m_stat_)
+		return;
+
+	auto elapsed = std::chrono::steady_clock::now() - m_start_;
+	m_stat_->record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+	                m_rows_,
+	                m_bytes_);
+}
+
+void
+QueryStatScope::set_rows(uint64_t rows, uint64_t bytes)
+{
+	m_rows_ = rows;
+	m_bytes_ = bytes;
+}
+
+/*******************************************************************************
+ * query_stats functions
+ ******************************************************************************/
+
+// The registry is never destroyed, so the exit handler and static
+// QueryStat pointers in the backends stay valid until the very end.
+struct QueryStatRegistry {
+	std::mutex mutex;
+	std::unordered_map<std::string,QueryStat*> map;
+	std::deque<std::unique_ptr<QueryStat> > stats;
+};
+
+static QueryStatRegistry*
+_query_stats_registry()
+{
+	static QueryStatRegistry *registry = new QueryStatRegistry();
+	return registry;
+}
+
+QueryStat*
+query_stats_get(QueryStatKind kind,
+                const std::string &engine,
+                const std::string &key)
+{
+	QueryStatRegistry *registry = _query_stats_registry();
+	std::string map_key = std::to_string(static_cast<int>(kind)) + ':' + engine + ':' + key;
+
+	std::lock_guard<std::mutex> lock(registry->mutex);
+	auto iter = registry->map.find(map_key);
+	if (iter != registry->map.end())
+		return iter->second;
+
+	QueryStat *stat = new QueryStat(kind,engine,key);
+	registry->stats.emplace_back(stat);
+	registry->map[map_key] = stat;
+	return stat;
+}
+
+QueryStat*
+query_stats_get_method(const char *method)
+{
+	return query_stats_get(QUERY_STAT_METHOD,"",method);
+}
+
+QueryStat*
+query_stats_get_sql(const char *engine, const char *sql)
+{
+	return query_stats_get(QUERY_STAT_SQL,engine,sql);
+}
+
+// The cache is keyed by a hash of the statement text and checks the text
+// on a hit, so a collision only costs a trip to the registry.
+struct QueryStatCacheEntry {
+	const char *engine;
+	std::string sql;
+	QueryStat *stat;
+};
+
+// hashes 8 bytes at a time, statements are long enough for that to matter
+static inline uint64_t
+_query_stats_hash(const char *sql, size_t len)
+{
+	uint64_t hash = 14695981039346656037ull ^ len;
+	size_t i = 0;
+	for (; i + 8 <= len; i += 8) {
+		uint64_t word;
+		memcpy(&word,sql + i,8);
+		hash = (hash ^ word) * 1099511628211ull;
+		hash ^= hash >> 29;
+	}
+	for (; i < len; ++i)
+		hash = (hash ^ static_cast<unsigned char>(sql[i])) * 1099511628211ull;
+	return hash;
+}
+
+QueryStat*
+query_stats_lookup_sql(const char *engine, const char *sql)
+{
+	static thread_local std::unordered_map<uint64_t,QueryStatCacheEntry> cache;
+
+	size_t len = strlen(sql);
+	uint64_t hash = _query_stats_hash(sql,len);
+	auto iter = cache.find(hash);
+	if (iter != cache.end()) {
+		const QueryStatCacheEntry &entry = iter->second;
+		if (entry.sql.size() == len
+		    && memcmp(entry.sql.data(),sql,len) == 0
+		    && strcmp(entry.engine,engine) == 0)
+			return entry.stat;
+		return query_stats_get_sql(engine,query_stats_normalize_sql(sql).c_str());
+	}
+
+	QueryStat *stat = query_stats_get_sql(engine,query_stats_normalize_sql(sql).c_str());
+	if (cache.size() >= QUERY_STAT_CACHE_SIZE)
+		cache.clear();
+	cache.emplace(hash,QueryStatCacheEntry{engine,sql,stat});
+	return stat;
+}
+
+std::string
+query_stats_normalize_sql(const char *sql)
+{
+	std::string ret;
+	if (!sql)
+		return ret;
+
+	const char *p = sql;
+	while (*p) {
+		if (*p == '\'') {
+			// string literal, '' and \' do not terminate it
+			++p;
+			while (*p) {
+				if (*p == '\\' && *(p + 1)) {
+					p += 2;
+				} else if (*p == '\'' && *(p + 1) == '\'') {
+					p += 2;
+				} else if (*p == '\'') {
+					++p;
+					break;
+				} else {
+					++p;
+				}
+			}
+			ret += '?';
+		} else if (isdigit(static_cast<unsigned char>(*p))
+		           && (ret.empty() || !(isalnum(static_cast<unsigned char>(ret.back())) || ret.back() == '_'))) {
+			while (isalnum(static_cast<unsigned char>(*p)) || *p == '.')
+				++p;
+			ret += '?';
+		} else if (*p == '%' && isalpha(static_cast<unsigned char>(*(p + 1)))) {
+			// a conversion of a printf format used as the key, e.g. %s or %llu
+			++p;
+			while (isalpha(static_cast<unsigned char>(*p)))
+				++p;
+			ret += '?';
+		} else {
+			ret += *p;
+			++p;
+		}
+	}
+	return ret;
+}
+
+std::list<QueryStatSnapshot>
+query_stats_get_snapshots()
+{
+	QueryStatRegistry *registry = _query_stats_registry();
+	std::list<QueryStatSnapshot> ret;
+
+	std::lock_guard<std::mutex> lock(registry->mutex);
+	for (auto iter = registry->stats.begin(); iter != registry->stats.end(); ++iter)
+		ret.push_back((*iter)->get_snapshot());
+	
+	return ret;
+}
+
+void
+query_stats_reset()
+{
+	QueryStatRegistry *registry = _query_stats_registry();
+
+	std::lock_guard<std::mutex> lock(registry->mutex);
+	for (auto iter = registry->stats.begin(); iter != registry->stats.end(); ++iter)
+		(*iter)->reset();
+}
+
+void
+query_stats_write_json_string(std::ostream &out, const std::string &str)
+{
+	out << '"';
+	for (auto c: str) {
+		switch (c) {
+			case '"':
+				out << "\\\"";
+				break;
+			case '\\':
+				out << "\\\\";
+				break;
+			case '\n':
+				out << "\\n";
+				break;
+			case '\r':
+				out << "\\r";
+				break;
+			case '\t':
+				out << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char buffer[8];
+					snprintf(buffer,sizeof(buffer),"\\u%04x",static_cast<unsigned int>(c));
+					out << buffer;
+				} else {
+					out << c;
+				}
+				break;
+		}
+	}
+	out << '"';
+}
+
+void
+query_stats_write_json(std::ostream &out)
+{
+	std::list<QueryStatSnapshot> snapshots = query_stats_get_snapshots();
+
+	out << "{\n  \"statements\": [";
+	bool first = true;
+	for (auto iter = snapshots.begin(); iter != snapshots.end(); ++iter) {
+		if (!iter->count)
+			continue;
+		
+		out << (first ? "\n" : ",\n") << "    {\"kind\": "
+			<< (iter->kind == QUERY_STAT_METHOD ? "\"method\"" : "\"sql\"");
+		if (!iter->engine.empty()) {
+			out << ", \"engine\": ";
+			query_stats_write_json_string(out,iter->engine);
+		}
+		out << ", \"key\": ";
+		query_stats_write_json_string(out,iter->key);
+		out << ", \"count\": " << iter->count
+			<< ", \"total_ns\": " << iter->total_ns
+			<< ", \"max_ns\": " << iter->max_ns
+			<< ", \"rows\": " << iter->rows
+			<< ", \"bytes\": " << iter->bytes
+			<< ", \"histogram_us_log2\": [";
+		for (int i = 0; i < QUERY_STAT_HISTOGRAM_BUCKETS; ++i) {
+			if (i)
+				out << ',';
+			out << iter->histogram[i];
+		}
+		out << "]}";
+		first = false;
+	}
+	out << "\n  ]\n}\n";
+}
+
+static std::atomic<bool> _query_stats_enabled{false};
+
+bool
+query_stats_get_enabled()
+{
+	return _query_stats_enabled.load(std::memory_order_relaxed);
+}
+
+void
+query_stats_set_enabled(bool enabled)
+{
+	_query_stats_enabled.store(enabled,std::memory_order_relaxed);
+}
+
+static void
+_query_stats_atexit()
+{
+	const char *filename = getenv("GROWBOOK_QUERY_STATS");
+	if (!filename || !*filename)
+		return;
+
+	std::ofstream out(filename);
+	if (!out.is_open()) {
+		fprintf(stderr,"Unable to write query statistics to \"%s\"!\n",filename);
+		return;
+	}
+	query_stats_write_json(out);
+}
+
+void
+query_stats_init()
+{
+	static bool initialized = false;
+	if (initialized)
+		return;
+	initialized = true;
+
+	const char *filename = getenv("GROWBOOK_QUERY_STATS");
+	if (filename && *filename) {
+		_query_stats_registry();
+		query_stats_set_enabled(true);
+		atexit(_query_stats_atexit);
+	}
+}
@@ -0,0 +1,173 @@
+/***************************************************************************
+ *            querystats.h
+ *
+ *  Mo Oktober 19 13:02:45 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * querystats.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __QUERYSTATS_H__
+#define __QUERYSTATS_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <ostream>
+
+/*
+ * Per-statement counters for the Database layer.
+ *
+ * Every public Database method and every SQL statement the backends issue
+ * owns a QueryStat. The methods keep theirs in function-local statics, the
+ * backends look statements up in a cache of the calling thread, so the
+ * registry lock is only taken the first time a thread sees a statement.
+ * The counters themselves are updated lock free. Latencies are collected
+ * in a log2 histogram of microseconds.
+ *
+ * Nothing is collected until query_stats_set_enabled() turns collection
+ * on, e.g. from the Diagnostics dialog. If the environment variable
+ * GROWBOOK_QUERY_STATS names a file, collection starts with the program
+ * and the counters are written to that file as JSON when it exits.
+ */
+
+#define QUERY_STAT_HISTOGRAM_BUCKETS 32
+// entries of the per-thread statement cache before it is dropped
+#define QUERY_STAT_CACHE_SIZE 512
+
+enum QueryStatKind {
+	QUERY_STAT_METHOD,
+	QUERY_STAT_SQL
+};
+
+struct QueryStatSnapshot
+{
+	QueryStatKind kind;
+	std::string engine;
+	std::string key;
+	uint64_t count;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t rows;
+	uint64_t bytes;
+	uint64_t histogram[QUERY_STAT_HISTOGRAM_BUCKETS];
+
+	double get_average_ms() const;
+	double get_percentile_ms(double percentile) const;
+};
+
+class QueryStat
+{
+	private:
+		QueryStatKind m_kind_;
+		std::string m_engine_;
+		std::string m_key_;
+		
+		std::atomic<uint64_t> m_count_;
+		std::atomic<uint64_t> m_total_ns_;
+		std::atomic<uint64_t> m_max_ns_;
+		std::atomic<uint64_t> m_rows_;
+		std::atomic<uint64_t> m_bytes_;
+		std::atomic<uint64_t> m_histogram_[QUERY_STAT_HISTOGRAM_BUCKETS];
+
+	private:
+		QueryStat(const QueryStat &src) = delete;
+		QueryStat& operator=(const QueryStat &src) = delete;
+
+	public:
+		QueryStat(QueryStatKind kind,
+		          const std::string &engine,
+		          const std::string &key);
+		~QueryStat();
+
+	public:
+		QueryStatKind get_kind() const;
+		const std::string& get_engine() const;
+		const std::string& get_key() const;
+		
+		void record(uint64_t ns, uint64_t rows = 0, uint64_t bytes = 0);
+		void add_rows(uint64_t rows, uint64_t bytes);
+		void reset();
+
+		QueryStatSnapshot get_snapshot() const;
+};
+
+/*! Times the enclosing scope and records it in a QueryStat.
+ */
+class QueryStatScope
+{
+	private:
+		QueryStat *m_stat_;
+		std::chrono::steady_clock::time_point m_start_;
+		uint64_t m_rows_;
+		uint64_t m_bytes_;
+
+	private:
+		QueryStatScope(const QueryStatScope &src) = delete;
+		QueryStatScope& operator=(const QueryStatScope &src) = delete;
+
+	public:
+		QueryStatScope(QueryStat *stat);
+		~QueryStatScope();
+
+	public:
+		void set_rows(uint64_t rows, uint64_t bytes = 0);
+};
+
+QueryStat* query_stats_get(QueryStatKind kind,
+                           const std::string &engine,
+                           const std::string &key);
+QueryStat* query_stats_get_method(const char *method);
+QueryStat* query_stats_get_sql(const char *engine, const char *sql);
+
+/*! Returns the QueryStat of the normalized sql from the cache of the
+ * calling thread. Hits cost a hash of the text and a compare, misses
+ * normalize the text and take the registry lock. sql should have
+ * placeholders instead of values, texts with values in them only churn
+ * the cache.
+ */
+QueryStat* query_stats_lookup_sql(const char *engine, const char *sql);
+
+/*! Replaces literals and printf conversions in a SQL statement with '?'
+ * so statements that only differ in their values share a QueryStat.
+ */
+std::string query_stats_normalize_sql(const char *sql);
+
+std::list<QueryStatSnapshot> query_stats_get_snapshots();
+void query_stats_reset();
+void query_stats_write_json(std::ostream &out);
+/*! Writes str as a quoted JSON string.
+ */
+void query_stats_write_json_string(std::ostream &out, const std::string &str);
+
+/*! Backends check this before they time a statement or count its rows.
+ */
+bool query_stats_get_enabled();
+void query_stats_set_enabled(bool enabled);
+
+/*! Enables collection and installs the exit handler if
+ * GROWBOOK_QUERY_STATS is set.
+ * Called by db_init().
+ */
+void query_stats_init();
+
+#endif /* __QUERYSTATS_H__ */
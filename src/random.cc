@@ -0,0 +1,78 @@
+//           random.cc
+//  Mi Oktober 21 09:14:52 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// random.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "random.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cmath>
+
+Random::Random(uint64_t seed):
+	m_state_{seed ? seed : 0x9e3779b97f4a7c15ull}
+{}
+
+Random::~Random()
+{}
+
+uint64_t
+Random::next()
+{
+	m_state_ ^= m_state_ >> 12;
+	m_state_ ^= m_state_ << 25;
+	m_state_ ^= m_state_ >> 27;
+	return m_state_ * 2685821657736338717ull;
+}
+
+double
+Random::uniform()
+{
+	return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+size_t
+Random::below(size_t n)
+{
+	return (n ? static_cast<size_t>(next() % n) : 0);
+}
+
+double
+Random::normal()
+{
+	double u1 = uniform();
+	double u2 = uniform();
+	if (u1 < 1e-300)
+		u1 = 1e-300;
+	return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+double
+Random::lognormal(double median, double sigma)
+{
+	return median * std::exp(sigma * normal());
+}
+
+double
+Random::pareto(double alpha)
+{
+	return 1.0 / std::pow(1.0 - uniform(),1.0 / alpha);
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+ *            random.h
+ *
+ *  Mi Oktober 21 09:14:52 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * random.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * xorshift64* and hand written distributions for growbook-gen and
+ * growbook-bench. The distributions of the standard library differ between
+ * implementations, this one gives the same numbers for the same seed
+ * everywhere.
+ */
+class Random
+{
+	private:
+		uint64_t m_state_;
+
+	public:
+		Random(uint64_t seed);
+		~Random();
+
+	public:
+		uint64_t next();
+		double uniform();
+		size_t below(size_t n);
+		double normal();
+		double lognormal(double median, double sigma);
+		double pareto(double alpha);
+};
+
+#endif /* __RANDOM_H__ */
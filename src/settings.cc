@@ -250,6 +250,11 @@ Settings::Settings(int argc, char **argv) noexcept:
 	m_open_ongoing_growlogs_{true},
 	m_date_format_{"%m-%d-%Y"},
 	m_datetime_format_{"%m-%d-%Y %H:%M:%S"},
+	m_db_mirror_{false},
+	m_db_mirror_file_{Glib::build_filename(Glib::get_user_data_dir(),"growbook","mirror.db")},
+	m_backup_interval_{0},
+	m_backup_dir_{Glib::build_filename(Glib::get_user_data_dir(),"growbook","backups")},
+	m_backup_keep_{7},
 	m_signal_load_{},
 	m_signal_save_{}
 {
@@ -437,6 +442,16 @@ Settings::on_load()
 		m_date_format_ = get("date-format");
 	if (has_key("datetime-format"))
 		m_datetime_format_ = get("datetime-format");
+	if (has_key("db-mirror"))
+		m_db_mirror_ = get_bool("db-mirror");
+	if (has_key("db-mirror-file"))
+		m_db_mirror_file_ = get("db-mirror-file");
+	if (has_key("backup-interval"))
+		m_backup_interval_ = get_uint32("backup-interval");
+	if (has_key("backup-dir"))
+		m_backup_dir_ = get("backup-dir");
+	if (has_key("backup-keep"))
+		m_backup_keep_ = get_uint16("backup-keep");
 
 	if (has_key("db-engine")) {
 		Glib::ustring db_engine = get("db-engine");
@@ -501,6 +516,11 @@ Settings::on_save()
 	set_uint16("db-port",m_db_settings_->get_port());
 	set("db-user", m_db_settings_->get_user());
 	set_bool("db-ask-password",m_db_settings_->get_ask_password());
+	set_bool("db-mirror",m_db_mirror_);
+	set("db-mirror-file",m_db_mirror_file_);
+	set_uint32("backup-interval",m_backup_interval_);
+	set("backup-dir",m_backup_dir_);
+	set_uint16("backup-keep",m_backup_keep_);
 
 	if (!m_db_settings_->get_ask_password()) {
 		set("db-password",m_db_settings_->get_password());
@@ -876,3 +896,63 @@ Settings::set_datetime_format(const Glib::ustring &fmt)
 {
 	m_datetime_format_ = fmt;
 }
+
+bool
+Settings::get_db_mirror() const
+{
+	return m_db_mirror_;
+}
+
+void
+Settings::set_db_mirror(bool b)
+{
+	m_db_mirror_ = b;
+}
+
+std::string
+Settings::get_db_mirror_file() const
+{
+	return m_db_mirror_file_;
+}
+
+void
+Settings::set_db_mirror_file(const std::string &filename)
+{
+	m_db_mirror_file_ = filename;
+}
+
+uint32_t
+Settings::get_backup_interval() const
+{
+	return m_backup_interval_;
+}
+
+void
+Settings::set_backup_interval(uint32_t minutes)
+{
+	m_backup_interval_ = minutes;
+}
+
+std::string
+Settings::get_backup_dir() const
+{
+	return m_backup_dir_;
+}
+
+void
+Settings::set_backup_dir(const std::string &dir)
+{
+	m_backup_dir_ = dir;
+}
+
+uint16_t
+Settings::get_backup_keep() const
+{
+	return m_backup_keep_;
+}
+
+void
+Settings::set_backup_keep(uint16_t keep)
+{
+	m_backup_keep_ = keep;
+}
@@ -171,6 +171,11 @@ class Settings:
 		bool m_open_ongoing_growlogs_;
 		Glib::ustring m_date_format_;
 		Glib::ustring m_datetime_format_;
+		bool m_db_mirror_;
+		std::string m_db_mirror_file_;
+		uint32_t m_backup_interval_;
+		std::string m_backup_dir_;
+		uint16_t m_backup_keep_;
 		sigc::signal0<void> m_signal_load_;
 		sigc::signal0<void> m_signal_save_;
 		
@@ -268,6 +273,24 @@ class Settings:
 
 		Glib::ustring get_datetime_format() const;
 		void set_datetime_format(const Glib::ustring &format);
+
+		// Keep a local sqlite3 mirror of a remote database, see DatabaseMirror.
+		bool get_db_mirror() const;
+		void set_db_mirror(bool b);
+
+		std::string get_db_mirror_file() const;
+		void set_db_mirror_file(const std::string &filename);
+
+		// Minutes between scheduled backups, 0 disables them. See BackupScheduler.
+		uint32_t get_backup_interval() const;
+		void set_backup_interval(uint32_t minutes);
+
+		std::string get_backup_dir() const;
+		void set_backup_dir(const std::string &dir);
+
+		// Number of backups kept in the backup directory, 0 keeps all.
+		uint16_t get_backup_keep() const;
+		void set_backup_keep(uint16_t keep);
 };
 
 #endif /* __SETTINGS_H__ */
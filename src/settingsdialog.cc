@@ -41,6 +41,9 @@ SettingsDialog::SettingsDialog(const Glib::RefPtr<Settings> &settings):
 	m_open_ongoing_growlogs_checkbutton_{_(OPEN_ONGOING_GROWLOGS_CHECKBUTTON)},
 	m_date_format_entry_{},
 	m_datetime_format_entry_{},
+	m_backup_interval_spinbutton_{},
+	m_backup_dir_entry_{},
+	m_backup_keep_spinbutton_{},
 	m_database_settings_button_{DATABASE_SETTINGS_BUTTON}
 {
 	_add_buttons();
@@ -55,6 +58,9 @@ SettingsDialog::SettingsDialog(Gtk::Window &parent,
 	m_open_ongoing_growlogs_checkbutton_{_(OPEN_ONGOING_GROWLOGS_CHECKBUTTON)},
 	m_date_format_entry_{},
 	m_datetime_format_entry_{},
+	m_backup_interval_spinbutton_{},
+	m_backup_dir_entry_{},
+	m_backup_keep_spinbutton_{},
 	m_database_settings_button_{DATABASE_SETTINGS_BUTTON}
 {
 	_add_buttons();
@@ -91,10 +97,29 @@ SettingsDialog::_add_widgets()
 	m_datetime_format_entry_.set_text(m_settings_->get_datetime_format());
 	grid->attach(m_datetime_format_entry_,1,2,1,1);
 
+	label = Gtk::manage(new Gtk::Label(_("Backup every (minutes, 0 = never):")));
+	grid->attach(*label,0,3,1,1);
+	m_backup_interval_spinbutton_.set_range(0,60 * 24 * 7);
+	m_backup_interval_spinbutton_.set_increments(1,60);
+	m_backup_interval_spinbutton_.set_value(m_settings_->get_backup_interval());
+	grid->attach(m_backup_interval_spinbutton_,1,3,1,1);
+
+	label = Gtk::manage(new Gtk::Label(_("Backup folder:")));
+	grid->attach(*label,0,4,1,1);
+	m_backup_dir_entry_.set_text(m_settings_->get_backup_dir());
+	grid->attach(m_backup_dir_entry_,1,4,1,1);
+
+	label = Gtk::manage(new Gtk::Label(_("Backups kept (0 = all):")));
+	grid->attach(*label,0,5,1,1);
+	m_backup_keep_spinbutton_.set_range(0,1000);
+	m_backup_keep_spinbutton_.set_increments(1,10);
+	m_backup_keep_spinbutton_.set_value(m_settings_->get_backup_keep());
+	grid->attach(m_backup_keep_spinbutton_,1,5,1,1);
+
 	Gtk::ButtonBox *buttonbox = Gtk::manage(new Gtk::ButtonBox(Gtk::ORIENTATION_HORIZONTAL));
 	m_database_settings_button_.signal_clicked().connect(sigc::mem_fun(*this,&SettingsDialog::on_database_settings_clicked));
 	buttonbox->pack_start(m_database_settings_button_,false,false,0);
-	grid->attach(*buttonbox,0,3,2,1);
+	grid->attach(*buttonbox,0,6,2,1);
 
 	box->pack_start(*grid,true,true,0);
 }
@@ -117,6 +142,9 @@ SettingsDialog::on_response(int response_id)
 		m_settings_->set_open_ongoing_growlogs(m_open_ongoing_growlogs_checkbutton_.get_active());
 		m_settings_->set_date_format (m_date_format_entry_.get_text());
 		m_settings_->set_datetime_format (m_datetime_format_entry_.get_text());
+		m_settings_->set_backup_interval(static_cast<uint32_t>(m_backup_interval_spinbutton_.get_value_as_int()));
+		m_settings_->set_backup_dir(m_backup_dir_entry_.get_text());
+		m_settings_->set_backup_keep(static_cast<uint16_t>(m_backup_keep_spinbutton_.get_value_as_int()));
 		m_settings_->save();
 	}
 	Gtk::Dialog::on_response(response_id);
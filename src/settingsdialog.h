@@ -29,6 +29,7 @@
 #include <gtkmm/dialog.h>
 #include <gtkmm/checkbutton.h>
 #include <gtkmm/entry.h>
+#include <gtkmm/spinbutton.h>
 #include <gtkmm/button.h>
 
 #include "settings.h"
@@ -46,6 +47,9 @@ class SettingsDialog:
 		 Gtk::CheckButton m_open_ongoing_growlogs_checkbutton_;
 		 Gtk::Entry m_date_format_entry_;
 		 Gtk::Entry m_datetime_format_entry_;
+		 Gtk::SpinButton m_backup_interval_spinbutton_;
+		 Gtk::Entry m_backup_dir_entry_;
+		 Gtk::SpinButton m_backup_keep_spinbutton_;
 		 Gtk::Button m_database_settings_button_;
 		 
 	 public:
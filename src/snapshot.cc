@@ -0,0 +1,357 @@
+//           snapshot.cc
+//  Mo Oktober 19 14:21:36 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// snapshot.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "snapshot.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+# include <zlib.h>
+#endif
+
+#include "trace.h"
+
+/*******************************************************************************
+ * encoding helpers
+ ******************************************************************************/
+
+static void
+_put_uint32(std::string &out, uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xff);
+}
+
+static void
+_put_uint64(std::string &out, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xff);
+}
+
+static void
+_put_varint(std::string &out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out += static_cast<char>((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+static void
+_put_time(std::string &out, int64_t value)
+{
+	_put_varint(out,(static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+bool
+snapshot_check_magic(const char *data, size_t size)
+{
+	return (size >= SNAPSHOT_MAGIC_SIZE
+	        && memcmp(data,SNAPSHOT_MAGIC,SNAPSHOT_MAGIC_SIZE) == 0);
+}
+
+uint32_t
+snapshot_crc32(uint32_t crc, const void *data, size_t size)
+{
+#ifdef HAVE_ZLIB
+	const Bytef *p = static_cast<const Bytef*>(data);
+	while (size > 0) {
+		uInt n = static_cast<uInt>(std::min<size_t>(size,UINT_MAX));
+		crc = static_cast<uint32_t>(::crc32(crc,p,n));
+		p += n;
+		size -= n;
+	}
+	return crc;
+#else
+	static const std::vector<uint32_t> table = [] {
+		std::vector<uint32_t> t(256);
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+			t[i] = c;
+		}
+		return t;
+	}();
+
+	const unsigned char *p = static_cast<const unsigned char*>(data);
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i)
+		crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+#endif
+}
+
+/*******************************************************************************
+ * SnapshotDecoder
+ ******************************************************************************/
+
+SnapshotDecoder::SnapshotDecoder(const char *data, size_t size):
+	m_data_{reinterpret_cast<const unsigned char*>(data)},
+	m_end_{reinterpret_cast<const unsigned char*>(data) + size},
+	m_failed_{false}
+{
+}
+
+SnapshotDecoder::~SnapshotDecoder()
+{
+}
+
+uint64_t
+SnapshotDecoder::read_varint()
+{
+	uint64_t value = 0;
+	for (unsigned int shift = 0; shift < 64; shift += 7) {
+		if (m_data_ >= m_end_)
+			break;
+		unsigned char c = *m_data_++;
+		value |= static_cast<uint64_t>(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return value;
+	}
+	m_failed_ = true;
+	m_data_ = m_end_;
+	return 0;
+}
+
+int64_t
+SnapshotDecoder::read_time()
+{
+	uint64_t value = read_varint();
+	return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+const char*
+SnapshotDecoder::read_bytes(size_t size)
+{
+	if (size > static_cast<size_t>(m_end_ - m_data_)) {
+		m_failed_ = true;
+		m_data_ = m_end_;
+		return "";
+	}
+	const char *ret = reinterpret_cast<const char*>(m_data_);
+	m_data_ += size;
+	return ret;
+}
+
+bool
+SnapshotDecoder::at_end() const
+{
+	return (m_data_ == m_end_);
+}
+
+bool
+SnapshotDecoder::failed() const
+{
+	return m_failed_;
+}
+
+/*******************************************************************************
+ * snapshot_export_database
+ ******************************************************************************/
+
+// Deduplicates the strings of the STRS section, index 0 is "".
+class SnapshotStrings
+{
+	private:
+		std::unordered_map<std::string,uint64_t> m_index_;
+		std::string m_payload_;
+		uint64_t m_count_;
+
+	public:
+		SnapshotStrings():
+			m_index_{},
+			m_payload_{},
+			m_count_{1}
+		{
+			m_index_[""] = 0;
+		}
+
+	public:
+		uint64_t add(const Glib::ustring &s)
+		{
+			auto iter = m_index_.find(s.raw());
+			if (iter != m_index_.end())
+				return iter->second;
+
+			_put_varint(m_payload_,s.bytes());
+			m_payload_.append(s.data(),s.bytes());
+			m_index_[s.raw()] = m_count_;
+			return m_count_++;
+		}
+
+		std::string get_payload() const
+		{
+			std::string payload;
+			_put_varint(payload,m_count_ - 1);
+			payload += m_payload_;
+			return payload;
+		}
+};
+
+// Writes a section whose payload is prefix followed by body.
+static uint64_t
+_write_section(std::ostream &out,
+               uint32_t tag,
+               const std::string &prefix,
+               const std::string &body=std::string())
+{
+	std::string header;
+	_put_uint32(header,tag);
+	_put_uint32(header,snapshot_crc32(snapshot_crc32(0,prefix.data(),prefix.size()),
+	                                  body.data(),
+	                                  body.size()));
+	_put_uint64(header,prefix.size() + body.size());
+
+	out.write(header.data(),header.size());
+	out.write(prefix.data(),prefix.size());
+	out.write(body.data(),body.size());
+	return header.size() + prefix.size() + body.size();
+}
+
+uint64_t
+snapshot_export_database(const Glib::RefPtr<const Database> &database,
+                         std::ostream &out)
+{
+	TRACE_SCOPE("export","snapshot_export_database");
+
+	SnapshotStrings strings;
+	std::string breeders_payload, strains_payload, growlogs_payload, growlog_strains_payload;
+
+	std::unordered_map<uint64_t,uint64_t> breeder_index;
+	std::list<Glib::RefPtr<Breeder> > breeders(database->get_breeders());
+	_put_varint(breeders_payload,breeders.size());
+	for (auto &breeder: breeders) {
+		uint64_t index = breeder_index.size();
+		breeder_index[breeder->get_id()] = index;
+		_put_varint(breeders_payload,strings.add(breeder->get_name()));
+		_put_varint(breeders_payload,strings.add(breeder->get_homepage()));
+	}
+
+	std::unordered_map<uint64_t,uint64_t> strain_index;
+	std::string strains_body;
+	for (auto &strain: database->get_strains()) {
+		auto iter = breeder_index.find(strain->get_breeder_id());
+		if (iter == breeder_index.end())
+			continue;
+		uint64_t index = strain_index.size();
+		strain_index[strain->get_id()] = index;
+		_put_varint(strains_body,iter->second);
+		_put_varint(strains_body,strings.add(strain->get_name()));
+		_put_varint(strains_body,strings.add(strain->get_info()));
+		_put_varint(strains_body,strings.add(strain->get_description()));
+		_put_varint(strains_body,strings.add(strain->get_homepage()));
+		_put_varint(strains_body,strings.add(strain->get_seedfinder()));
+	}
+	_put_varint(strains_payload,strain_index.size());
+
+	std::unordered_map<uint64_t,uint64_t> growlog_index;
+	std::list<Glib::RefPtr<Growlog> > growlogs(database->get_growlogs());
+	_put_varint(growlogs_payload,growlogs.size());
+	for (auto &growlog: growlogs) {
+		uint64_t index = growlog_index.size();
+		growlog_index[growlog->get_id()] = index;
+		_put_varint(growlogs_payload,strings.add(growlog->get_title()));
+		_put_varint(growlogs_payload,strings.add(growlog->get_description()));
+		_put_time(growlogs_payload,growlog->get_created_on());
+		_put_time(growlogs_payload,growlog->get_flower_on());
+		_put_time(growlogs_payload,growlog->get_finished_on());
+	}
+
+	uint64_t n_growlog_strains = 0;
+	std::string growlog_strains_body;
+	for (auto &growlog_strains: database->get_strains_for_growlogs()) {
+		auto growlog_iter = growlog_index.find(growlog_strains.first);
+		if (growlog_iter == growlog_index.end())
+			continue;
+		for (auto &strain: growlog_strains.second) {
+			auto strain_iter = strain_index.find(strain->get_id());
+			if (strain_iter == strain_index.end())
+				continue;
+			_put_varint(growlog_strains_body,growlog_iter->second);
+			_put_varint(growlog_strains_body,strain_iter->second);
+			++n_growlog_strains;
+		}
+	}
+	_put_varint(growlog_strains_payload,n_growlog_strains);
+
+	std::string header(SNAPSHOT_MAGIC,SNAPSHOT_MAGIC_SIZE);
+	_put_uint32(header,SNAPSHOT_VERSION);
+	_put_uint32(header,0);
+	out.write(header.data(),header.size());
+
+	uint64_t bytes_written = header.size();
+	bytes_written += _write_section(out,SNAPSHOT_TAG_STRINGS,strings.get_payload());
+	bytes_written += _write_section(out,SNAPSHOT_TAG_BREEDERS,breeders_payload);
+	bytes_written += _write_section(out,SNAPSHOT_TAG_STRAINS,strains_payload,strains_body);
+	bytes_written += _write_section(out,SNAPSHOT_TAG_GROWLOGS,growlogs_payload);
+	bytes_written += _write_section(out,SNAPSHOT_TAG_GROWLOG_STRAINS,growlog_strains_payload,growlog_strains_body);
+
+	// the entries are streamed in sections of about
+	// SNAPSHOT_ENTRY_SECTION_SIZE bytes
+	std::string entries_body, entries_count;
+	entries_body.reserve(SNAPSHOT_ENTRY_SECTION_SIZE + 64 * 1024);
+	uint64_t n_entries = 0;
+	int64_t last_created_on = 0;
+	auto flush_entries = [&] {
+		entries_count.clear();
+		_put_varint(entries_count,n_entries);
+		bytes_written += _write_section(out,SNAPSHOT_TAG_ENTRIES,entries_count,entries_body);
+		entries_body.clear();
+		n_entries = 0;
+		last_created_on = 0;
+	};
+
+	database->foreach_growlog_entry([&](const Glib::RefPtr<GrowlogEntry> &entry) {
+		auto iter = growlog_index.find(entry->get_growlog_id());
+		if (iter == growlog_index.end())
+			return;
+
+		const Glib::ustring &text = entry->get_text();
+		int64_t created_on = entry->get_created_on();
+		_put_varint(entries_body,iter->second);
+		_put_time(entries_body,created_on - last_created_on);
+		_put_varint(entries_body,text.bytes());
+		entries_body.append(text.data(),text.bytes());
+		last_created_on = created_on;
+		++n_entries;
+
+		if (entries_body.size() >= SNAPSHOT_ENTRY_SECTION_SIZE)
+			flush_entries();
+	});
+	if (n_entries)
+		flush_entries();
+
+	bytes_written += _write_section(out,SNAPSHOT_TAG_END,std::string());
+	out.flush();
+
+	return bytes_written;
+}
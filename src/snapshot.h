@@ -0,0 +1,126 @@
+/***************************************************************************
+ *            snapshot.h
+ *
+ *  Mo Oktober 19 14:21:36 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * snapshot.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "database.h"
+
+/*
+ * Growbook snapshots are a compact binary dump of a whole database, meant
+ * for backups that have to be restored quickly.
+ *
+ * A snapshot starts with SNAPSHOT_MAGIC, the format version and flags
+ * (both uint32). Then follow sections, each made of a tag, the CRC-32 of
+ * the payload (both uint32), the payload size (uint64) and the payload.
+ * All integers in the headers are little endian.
+ *
+ * Inside the payloads numbers are varints (7 bits per byte, low bits
+ * first), timestamps are zigzag encoded varints. Names, homepages and
+ * descriptions are stored once in the STRS section and referenced by
+ * index, index 0 is the empty string. Breeders, strains and growlogs are
+ * referenced by their position in their sections, so database ids are not
+ * part of the file. The entries follow in ENTR sections of up to
+ * SNAPSHOT_ENTRY_SECTION_SIZE bytes with their text inline and created_on
+ * relative to the entry before. The file ends with an empty END section.
+ *
+ *   STRS  count, (length, bytes)...
+ *   BRDR  count, (name, homepage)...
+ *   STRN  count, (breeder, name, info, description, homepage, seedfinder)...
+ *   GLOG  count, (title, description, created_on, flower_on, finished_on)...
+ *   GLST  count, (growlog, strain)...
+ *   ENTR  count, (growlog, created_on delta, length, text)...
+ *
+ * Readers skip sections with unknown tags.
+ */
+
+#define SNAPSHOT_MAGIC "\x89GBSNAP\n"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE 16
+#define SNAPSHOT_SECTION_HEADER_SIZE 16
+#define SNAPSHOT_ENTRY_SECTION_SIZE (4 * 1024 * 1024)
+
+constexpr uint32_t
+snapshot_tag(char a, char b, char c, char d)
+{
+	return (static_cast<uint32_t>(static_cast<unsigned char>(a))
+	        | (static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8)
+	        | (static_cast<uint32_t>(static_cast<unsigned char>(c)) << 16)
+	        | (static_cast<uint32_t>(static_cast<unsigned char>(d)) << 24));
+}
+
+const uint32_t SNAPSHOT_TAG_STRINGS = snapshot_tag('S','T','R','S');
+const uint32_t SNAPSHOT_TAG_BREEDERS = snapshot_tag('B','R','D','R');
+const uint32_t SNAPSHOT_TAG_STRAINS = snapshot_tag('S','T','R','N');
+const uint32_t SNAPSHOT_TAG_GROWLOGS = snapshot_tag('G','L','O','G');
+const uint32_t SNAPSHOT_TAG_GROWLOG_STRAINS = snapshot_tag('G','L','S','T');
+const uint32_t SNAPSHOT_TAG_ENTRIES = snapshot_tag('E','N','T','R');
+const uint32_t SNAPSHOT_TAG_END = snapshot_tag('E','N','D',' ');
+
+// Writes the whole database as a snapshot. Returns the number of bytes
+// written.
+uint64_t snapshot_export_database(const Glib::RefPtr<const Database> &database,
+                                  std::ostream &out);
+
+// Returns true if data starts with SNAPSHOT_MAGIC.
+bool snapshot_check_magic(const char *data, size_t size);
+
+// CRC-32 as used by zlib and gzip, crc is 0 for the first block.
+uint32_t snapshot_crc32(uint32_t crc, const void *data, size_t size);
+
+/******************************************************************************/
+
+// Reads the values of a section payload. Reading past the end sets the
+// failed flag and returns 0, so a damaged section is detected by checking
+// failed() once after decoding.
+class SnapshotDecoder
+{
+	 private:
+		 const unsigned char *m_data_;
+		 const unsigned char *m_end_;
+		 bool m_failed_;
+
+	public:
+		 SnapshotDecoder(const char *data, size_t size);
+		 ~SnapshotDecoder();
+
+	public:
+		 uint64_t read_varint();
+		 int64_t read_time();
+		 // Returns a pointer into the payload.
+		 const char* read_bytes(size_t size);
+
+		 bool at_end() const;
+		 bool failed() const;
+};
+
+#endif /* __SNAPSHOT_H__ */
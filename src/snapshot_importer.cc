@@ -0,0 +1,346 @@
+//           snapshot_importer.cc
+//  Mo Oktober 19 14:21:36 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// snapshot_importer.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <glibmm.h>
+#include <glibmm/i18n.h>
+
+#include "snapshot_importer.h"
+#include "snapshot.h"
+#include "error.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+/*******************************************************************************
+ * helpers
+ ******************************************************************************/
+
+struct SnapshotSection
+{
+	uint32_t tag;
+	const char *data;
+	size_t size;
+};
+
+static void
+_damaged()
+{
+	Glib::ustring msg = _("Reading file failed!");
+	msg += "\n(";
+	msg += _("The snapshot is damaged or truncated.");
+	msg += ")";
+	throw Glib::FileError(Glib::FileError::FAILED,msg);
+}
+
+static uint64_t
+_get_uint(const char *data, int n_bytes)
+{
+	const unsigned char *p = reinterpret_cast<const unsigned char*>(data);
+	uint64_t value = 0;
+	for (int i = 0; i < n_bytes; ++i)
+		value |= static_cast<uint64_t>(p[i]) << (i * 8);
+	return value;
+}
+
+// Splits the file into its sections and verifies their checksums.
+static std::vector<SnapshotSection>
+_read_sections(const char *data, size_t size)
+{
+	TRACE_SCOPE("import","snapshot _read_sections");
+
+	if (!snapshot_check_magic(data,size) || size < SNAPSHOT_HEADER_SIZE) {
+		throw Glib::FileError(Glib::FileError::FAILED,
+		                      _("The file is not a growbook snapshot!"));
+	}
+	uint64_t version = _get_uint(data + SNAPSHOT_MAGIC_SIZE,4);
+	if (version > SNAPSHOT_VERSION) {
+		Glib::ustring msg = _("Unsupported snapshot version!");
+		msg += "\n(";
+		msg += std::to_string(version);
+		msg += ")";
+		throw Glib::FileError(Glib::FileError::FAILED,msg);
+	}
+
+	std::vector<SnapshotSection> sections;
+	size_t offset = SNAPSHOT_HEADER_SIZE;
+	for (;;) {
+		if (size - offset < SNAPSHOT_SECTION_HEADER_SIZE)
+			_damaged();
+
+		SnapshotSection section;
+		section.tag = static_cast<uint32_t>(_get_uint(data + offset,4));
+		uint32_t crc = static_cast<uint32_t>(_get_uint(data + offset + 4,4));
+		uint64_t section_size = _get_uint(data + offset + 8,8);
+		offset += SNAPSHOT_SECTION_HEADER_SIZE;
+		if (section_size > size - offset)
+			_damaged();
+
+		section.data = data + offset;
+		section.size = static_cast<size_t>(section_size);
+		offset += section.size;
+		if (snapshot_crc32(0,section.data,section.size) != crc)
+			_damaged();
+
+		if (section.tag == SNAPSHOT_TAG_END)
+			break;
+		sections.push_back(section);
+	}
+	return sections;
+}
+
+static const SnapshotSection*
+_find_section(const std::vector<SnapshotSection> &sections, uint32_t tag)
+{
+	for (auto &section: sections) {
+		if (section.tag == tag)
+			return &section;
+	}
+	return nullptr;
+}
+
+// Missing sections are read as empty ones.
+static SnapshotDecoder
+_section_decoder(const std::vector<SnapshotSection> &sections, uint32_t tag)
+{
+	const SnapshotSection *section = _find_section(sections,tag);
+	if (!section)
+		return SnapshotDecoder("\0",1);
+	return SnapshotDecoder(section->data,section->size);
+}
+
+static void
+_check_decoder(const SnapshotDecoder &decoder)
+{
+	if (decoder.failed() || !decoder.at_end())
+		_damaged();
+}
+
+/*******************************************************************************
+ * Snapshot_Importer
+ ******************************************************************************/
+
+Snapshot_Importer::Snapshot_Importer(const Glib::RefPtr<Database> &db,
+                                     const std::string &filename):
+	Importer(db,filename)
+{
+}
+
+Snapshot_Importer::~Snapshot_Importer()
+{
+}
+
+Glib::RefPtr<Snapshot_Importer>
+Snapshot_Importer::create(const Glib::RefPtr<Database> &db,
+                          const std::string &filename)
+{
+	return Glib::RefPtr<Snapshot_Importer>(new Snapshot_Importer(db,filename));
+}
+
+void
+Snapshot_Importer::import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	TRACE_SCOPE("import","Snapshot_Importer::import_vfunc");
+
+	GError *error = nullptr;
+	GMappedFile *mapped_file = g_mapped_file_new(get_filename().c_str(),FALSE,&error);
+	if (!mapped_file) {
+		Glib::ustring msg = _("Unable to open file for reading!");
+		msg += "\n(";
+		msg += error->message;
+		msg += ")";
+		g_error_free(error);
+		throw Glib::FileError(Glib::FileError::FAILED,msg);
+	}
+	std::unique_ptr<GMappedFile,void(*)(GMappedFile*)> mapped_file_ptr(mapped_file,g_mapped_file_unref);
+
+	std::vector<SnapshotSection> sections = _read_sections(g_mapped_file_get_contents(mapped_file),
+	                                                       g_mapped_file_get_length(mapped_file));
+	Glib::RefPtr<Database> db = get_database();
+
+	// string table
+	std::vector<Glib::ustring> strings{Glib::ustring()};
+	SnapshotDecoder decoder = _section_decoder(sections,SNAPSHOT_TAG_STRINGS);
+	for (uint64_t i = 0, n = decoder.read_varint(); i < n && !decoder.failed(); ++i) {
+		uint64_t length = decoder.read_varint();
+		const char *s = decoder.read_bytes(length);
+		strings.push_back(std::string(s,decoder.failed() ? 0 : length));
+	}
+	_check_decoder(decoder);
+	auto get_string = [&strings](uint64_t index) -> const Glib::ustring& {
+		if (index >= strings.size())
+			_damaged();
+		return strings[index];
+	};
+
+	// breeders
+	ImportConflictAction response = IMPORT_CONFLICT_ABORT;
+	std::vector<Glib::RefPtr<Breeder> > breeders;
+	std::vector<bool> breeder_update;
+	decoder = _section_decoder(sections,SNAPSHOT_TAG_BREEDERS);
+	for (uint64_t i = 0, n = decoder.read_varint(); i < n && !decoder.failed(); ++i) {
+		const Glib::ustring &name = get_string(decoder.read_varint());
+		const Glib::ustring &homepage = get_string(decoder.read_varint());
+
+		Glib::RefPtr<Breeder> breeder = db->get_breeder(name);
+		bool update = false;
+		if (breeder) {
+			if (response != IMPORT_CONFLICT_UPDATE_ALL && response != IMPORT_CONFLICT_MERGE_ALL) {
+				response = handler->resolve_breeder(name);
+				if (response == IMPORT_CONFLICT_ABORT)
+					return;
+			}
+			update = (response == IMPORT_CONFLICT_UPDATE || response == IMPORT_CONFLICT_UPDATE_ALL);
+		}
+		if (!breeder) {
+			db->add_breeder(Breeder::create(name,homepage));
+			breeder = db->get_breeder(name);
+			assert(breeder);
+		} else if (update) {
+			breeder->set_homepage(homepage);
+			db->add_breeder(breeder);
+		}
+		breeders.push_back(breeder);
+		breeder_update.push_back(update);
+	}
+	_check_decoder(decoder);
+
+	// strains
+	std::vector<uint64_t> strain_ids;
+	decoder = _section_decoder(sections,SNAPSHOT_TAG_STRAINS);
+	for (uint64_t i = 0, n = decoder.read_varint(); i < n && !decoder.failed(); ++i) {
+		uint64_t breeder_index = decoder.read_varint();
+		const Glib::ustring &name = get_string(decoder.read_varint());
+		const Glib::ustring &info = get_string(decoder.read_varint());
+		const Glib::ustring &description = get_string(decoder.read_varint());
+		const Glib::ustring &homepage = get_string(decoder.read_varint());
+		const Glib::ustring &seedfinder = get_string(decoder.read_varint());
+		if (breeder_index >= breeders.size())
+			_damaged();
+
+		Glib::RefPtr<Breeder> breeder = breeders[breeder_index];
+		Glib::RefPtr<Strain> strain = db->get_strain(breeder->get_name(),name);
+		if (!strain) {
+			db->add_strain(Strain::create(breeder->get_id(),
+			                              breeder->get_name(),
+			                              name,
+			                              info,
+			                              description,
+			                              homepage,
+			                              seedfinder));
+			strain = db->get_strain(breeder->get_name(),name);
+		} else if (breeder_update[breeder_index]) {
+			strain->set_info(info);
+			strain->set_description(description);
+			strain->set_homepage(homepage);
+			strain->set_seedfinder(seedfinder);
+			db->add_strain(strain);
+		}
+		assert(strain);
+		strain_ids.push_back(strain->get_id());
+	}
+	_check_decoder(decoder);
+
+	// growlogs, skipped ones get the id 0
+	bool skip_all = false;
+	std::vector<uint64_t> growlog_ids;
+	decoder = _section_decoder(sections,SNAPSHOT_TAG_GROWLOGS);
+	for (uint64_t i = 0, n = decoder.read_varint(); i < n && !decoder.failed(); ++i) {
+		Glib::ustring title = get_string(decoder.read_varint());
+		const Glib::ustring &description = get_string(decoder.read_varint());
+		time_t created_on = static_cast<time_t>(decoder.read_time());
+		time_t flower_on = static_cast<time_t>(decoder.read_time());
+		time_t finished_on = static_cast<time_t>(decoder.read_time());
+
+		if (db->get_growlog(title)) {
+			growlog_ids.push_back(0);
+			if (skip_all)
+				continue;
+
+			Glib::ustring new_title;
+			ImportConflictAction growlog_response = handler->resolve_growlog(db,title,new_title);
+			if (growlog_response == IMPORT_CONFLICT_ABORT)
+				return;
+			if (growlog_response == IMPORT_CONFLICT_SKIP_ALL)
+				skip_all = true;
+			if (growlog_response != IMPORT_CONFLICT_RENAME)
+				continue;
+			title = new_title;
+			growlog_ids.pop_back();
+		}
+
+		db->add_growlog(Growlog::create(title,description,created_on,flower_on,finished_on));
+		Glib::RefPtr<Growlog> growlog = db->get_growlog(title);
+		assert(growlog);
+		growlog_ids.push_back(growlog->get_id());
+	}
+	_check_decoder(decoder);
+
+	decoder = _section_decoder(sections,SNAPSHOT_TAG_GROWLOG_STRAINS);
+	for (uint64_t i = 0, n = decoder.read_varint(); i < n && !decoder.failed(); ++i) {
+		uint64_t growlog_index = decoder.read_varint();
+		uint64_t strain_index = decoder.read_varint();
+		if (growlog_index >= growlog_ids.size() || strain_index >= strain_ids.size())
+			_damaged();
+		if (growlog_ids[growlog_index])
+			db->add_strain_for_growlog(growlog_ids[growlog_index],strain_ids[strain_index]);
+	}
+	_check_decoder(decoder);
+
+	// The entries are handed to the database one section at a time, the
+	// texts point into the mapped file.
+	TRACE_SCOPE("import","Snapshot_Importer entries");
+	std::vector<GrowlogEntryRow> rows;
+	for (auto &section: sections) {
+		if (section.tag != SNAPSHOT_TAG_ENTRIES)
+			continue;
+
+		SnapshotDecoder entries(section.data,section.size);
+		uint64_t n = entries.read_varint();
+		int64_t created_on = 0;
+		rows.clear();
+		rows.reserve(std::min<uint64_t>(n,section.size));
+		for (uint64_t i = 0; i < n && !entries.failed(); ++i) {
+			uint64_t growlog_index = entries.read_varint();
+			created_on += entries.read_time();
+			uint64_t length = entries.read_varint();
+			const char *text = entries.read_bytes(length);
+			if (growlog_index >= growlog_ids.size())
+				_damaged();
+
+			if (growlog_ids[growlog_index] && !entries.failed()) {
+				GrowlogEntryRow row;
+				row.growlog_id = growlog_ids[growlog_index];
+				row.text = text;
+				row.text_size = static_cast<size_t>(length);
+				row.created_on = static_cast<time_t>(created_on);
+				rows.push_back(row);
+			}
+		}
+		_check_decoder(entries);
+		db->add_growlog_entries(rows);
+	}
+}
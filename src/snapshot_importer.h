@@ -0,0 +1,57 @@
+/***************************************************************************
+ *            snapshot_importer.h
+ *
+ *  Mo Oktober 19 14:21:36 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * snapshot_importer.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SNAPSHOT_IMPORTER_H__
+#define __SNAPSHOT_IMPORTER_H__
+
+#include "import.h"
+
+// Restores a snapshot written by Snapshot_Exporter. The file is mapped into
+// memory and all checksums are verified before the database is touched.
+// Breeders, strains and growlogs are merged like DB_Importer does it, the
+// entries are inserted in bulk straight from the mapped file.
+class Snapshot_Importer:
+	public Importer
+{
+	 private:
+		 Snapshot_Importer(const Snapshot_Importer &src) = delete;
+		 Snapshot_Importer& operator=(const Snapshot_Importer &src) = delete;
+
+	protected:
+		 Snapshot_Importer(const Glib::RefPtr<Database> &database,
+		                   const std::string &filename);
+
+	public:
+		 virtual ~Snapshot_Importer();
+
+		 static Glib::RefPtr<Snapshot_Importer> create(const Glib::RefPtr<Database> &database,
+		                                               const std::string &filename);
+
+	protected:
+		 void import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler);
+};
+
+#endif /* __SNAPSHOT_IMPORTER_H__ */
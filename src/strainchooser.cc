@@ -20,6 +20,8 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "strainchooser.h"
+#include "application.h"
+#include "trace.h"
 
 #ifdef HAVE_CONFIG_H
 # include "config.h"
@@ -28,6 +30,9 @@
 
 #include <cassert>
 
+// more matches than this are not worth listing, the user keeps typing
+static const size_t MAX_SEARCH_MATCHES = 500;
+
 /*******************************************************************************
  * StrainChooserColumns
  ******************************************************************************/
@@ -51,13 +56,29 @@ StrainChooserColumns::~StrainChooserColumns()
 StrainChooserTreeView::StrainChooserTreeView(const Glib::RefPtr<Database> &db):
 	Gtk::TreeView{},
 	m_database_{db},
+	m_strain_index_{},
+	m_store_{},
+	m_filter_{},
+	m_filtered_{false},
+	m_matching_strains_{},
+	m_matching_breeders_{},
 	columns{}
 {
 	assert(m_database_);
 
-	set_model(_create_model ());
+	// The index is built by the main window's loader and only describes
+	// the application's database.
+	AppWindow *window = app->get_appwindow();
+	if (window && app->get_database() == m_database_)
+		m_strain_index_ = window->get_strain_index();
+
+	m_store_ = _create_model();
+	m_filter_ = Gtk::TreeModelFilter::create(m_store_);
+	m_filter_->set_visible_func(sigc::mem_fun(*this,&StrainChooserTreeView::_is_visible));
+	set_model(m_filter_);
 	append_column(_("Name"),columns.column_name);
 	set_headers_visible(false);
+	set_enable_search(!m_strain_index_);
 }
 
 StrainChooserTreeView::~StrainChooserTreeView()
@@ -67,8 +88,11 @@ StrainChooserTreeView::~StrainChooserTreeView()
 Glib::RefPtr<Gtk::TreeStore>
 StrainChooserTreeView::_create_model()
 {
+	TRACE_SCOPE("ui","StrainChooserTreeView::_create_model");
 	Glib::RefPtr<Gtk::TreeStore> model = Gtk::TreeStore::create(columns);
 
+	// The strains of a breeder are loaded when its row is expanded; until
+	// then an empty placeholder child keeps the expander visible.
 	std::list<Glib::RefPtr<Breeder> > breeders{m_database_->get_breeders()};
 	for (auto breeder_iter = breeders.begin(); breeder_iter != breeders.end(); ++breeder_iter) {
 		Glib::RefPtr<Breeder> breeder = *breeder_iter;
@@ -79,18 +103,77 @@ StrainChooserTreeView::_create_model()
 		row0[columns.column_breeder_id] = breeder->get_id();
 		row0[columns.column_name] = breeder->get_name();
 
-		std::list<Glib::RefPtr<Strain> > strains{m_database_->get_strains_for_breeder(breeder)};
+		Gtk::TreeModel::Row row1 = *(model->append(row0.children()));
+		row1[columns.column_id] = 0;
+		row1[columns.column_breeder_id] = 0;
+		row1[columns.column_name] = "";
+	}
+	return model;
+}
+
+bool
+StrainChooserTreeView::_is_placeholder(const Gtk::TreeModel::iterator &iter) const
+{
+	return (iter && !(*iter)[columns.column_id] && !(*iter)[columns.column_breeder_id]);
+}
+
+void
+StrainChooserTreeView::_populate_breeder(const Gtk::TreeModel::iterator &breeder_iter)
+{
+	Gtk::TreeModel::Children children = breeder_iter->children();
+	if (children.empty() || !_is_placeholder(children.begin()))
+		return;
+
+	TRACE_SCOPE("ui","StrainChooserTreeView::_populate_breeder");
+	Gtk::TreeModel::iterator placeholder = children.begin();
+
+	// The strain index holds the whole catalogue, the database is only
+	// asked if there is no index.
+	uint64_t breeder_id = (*breeder_iter)[columns.column_breeder_id];
+	if (m_strain_index_) {
+		std::vector<StrainIndexRecord> records = m_strain_index_->get_records_for_breeder(breeder_id);
+		for (auto &record: records) {
+			Gtk::TreeModel::Row row = *(m_store_->append(breeder_iter->children()));
+
+			row[columns.column_id] = record.strain_id;
+			row[columns.column_breeder_id] = record.breeder_id;
+			row[columns.column_name] = record.strain_name;
+		}
+	} else {
+		std::list<Glib::RefPtr<Strain> > strains{m_database_->get_strains_for_breeder(breeder_id)};
 		for (auto strain_iter = strains.begin(); strain_iter != strains.end(); ++strain_iter) {
 			Glib::RefPtr<Strain> strain = *strain_iter;
-			Gtk::TreeModel::iterator iter1 = model->append(row0.children());
-			Gtk::TreeModel::Row row1 = *iter1;
+			Gtk::TreeModel::Row row = *(m_store_->append(breeder_iter->children()));
 
-			row1[columns.column_id] = strain->get_id();
-			row1[columns.column_breeder_id] = strain->get_breeder_id();
-			row1[columns.column_name] = strain->get_name();
+			row[columns.column_id] = strain->get_id();
+			row[columns.column_breeder_id] = strain->get_breeder_id();
+			row[columns.column_name] = strain->get_name();
 		}
 	}
-	return model;
+	m_store_->erase(placeholder);
+}
+
+bool
+StrainChooserTreeView::_is_visible(const Gtk::TreeModel::const_iterator &iter)
+{
+	if (!m_filtered_)
+		return true;
+
+	uint64_t id = (*iter)[columns.column_id];
+	if (id)
+		return (m_matching_strains_.find(id) != m_matching_strains_.end());
+
+	// placeholders have no breeder id and are never matched
+	uint64_t breeder_id = (*iter)[columns.column_breeder_id];
+	return (m_matching_breeders_.find(breeder_id) != m_matching_breeders_.end());
+}
+
+bool
+StrainChooserTreeView::on_test_expand_row(const Gtk::TreeModel::iterator &iter,
+                                          const Gtk::TreeModel::Path &path)
+{
+	_populate_breeder(m_filter_->convert_iter_to_child_iter(iter));
+	return Gtk::TreeView::on_test_expand_row(iter,path);
 }
 
 Glib::RefPtr<Strain>
@@ -106,6 +189,49 @@ StrainChooserTreeView::get_selected_strain()
 	return strain;
 }
 
+bool
+StrainChooserTreeView::has_search() const
+{
+	return static_cast<bool>(m_strain_index_);
+}
+
+void
+StrainChooserTreeView::set_search_text(const Glib::ustring &text)
+{
+	if (!m_strain_index_)
+		return;
+
+	TRACE_SCOPE("ui","StrainChooserTreeView::set_search_text");
+	m_matching_strains_.clear();
+	m_matching_breeders_.clear();
+	m_filtered_ = !StrainIndex::fold(text).empty();
+
+	if (m_filtered_) {
+		std::vector<uint64_t> ids = m_strain_index_->lookup(text,MAX_SEARCH_MATCHES);
+		for (auto id: ids) {
+			StrainIndexRecord record;
+			if (m_strain_index_->get_record(id,record)) {
+				m_matching_strains_.insert(record.strain_id);
+				m_matching_breeders_.insert(record.breeder_id);
+			}
+		}
+
+		// matching breeders need their strain rows before they are shown
+		Gtk::TreeModel::Children breeders = m_store_->children();
+		for (auto iter = breeders.begin(); iter != breeders.end(); ++iter) {
+			uint64_t breeder_id = (*iter)[columns.column_breeder_id];
+			if (m_matching_breeders_.find(breeder_id) != m_matching_breeders_.end())
+				_populate_breeder(iter);
+		}
+	}
+	m_filter_->refilter();
+
+	if (m_filtered_)
+		expand_all();
+	else
+		collapse_all();
+}
+
 Glib::RefPtr<Database>
 StrainChooserTreeView::get_database()
 {
@@ -172,6 +298,7 @@ const char StrainChooserDialog::TITLE[] = N_("GrowBook: Strain Chooser");
 
 StrainChooserDialog::StrainChooserDialog(const Glib::RefPtr<Database> &db):
 	Gtk::Dialog{_(TITLE)},
+	m_search_entry_{},
 	m_strain_chooser_{db}
 {
 	_add_buttons();
@@ -184,6 +311,7 @@ StrainChooserDialog::StrainChooserDialog(const Glib::RefPtr<Database> &db):
 StrainChooserDialog::StrainChooserDialog(Gtk::Window &parent,
                                          const Glib::RefPtr<Database> &db):
 	Gtk::Dialog{_(TITLE),parent},
+	m_search_entry_{},
 	m_strain_chooser_{db}
 {
 	_add_buttons();
@@ -207,6 +335,15 @@ StrainChooserDialog::_add_widgets()
 	StrainChooser::TreeView *tv = m_strain_chooser_.get_treeview();
 	tv->get_selection()->signal_changed().connect(sigc::mem_fun(*this,&StrainChooserDialog::on_chooser_selection_changed));
 	on_chooser_selection_changed ();
+
+	if (tv->has_search()) {
+		m_search_entry_.set_placeholder_text(_("Search strains"));
+		m_search_entry_.signal_search_changed().connect(sigc::mem_fun(*this,&StrainChooserDialog::on_search_changed));
+	} else {
+		m_search_entry_.set_placeholder_text(_("Search is not available yet"));
+		m_search_entry_.set_sensitive(false);
+	}
+	box->pack_start(m_search_entry_,false,false,0);
 	box->pack_start(m_strain_chooser_,true,true,0);
 }
 
@@ -226,6 +363,12 @@ StrainChooserDialog::on_chooser_selection_changed()
 	set_response_sensitive(Gtk::RESPONSE_APPLY,false);
 }
 
+void
+StrainChooserDialog::on_search_changed()
+{
+	m_strain_chooser_.get_treeview()->set_search_text(m_search_entry_.get_text());
+}
+
 Glib::RefPtr<Strain>
 StrainChooserDialog::get_selected_strain()
 {
@@ -28,10 +28,15 @@
 
 #include <gtkmm/dialog.h>
 #include <gtkmm/scrolledwindow.h>
+#include <gtkmm/searchentry.h>
 #include <gtkmm/treeview.h>
 #include <gtkmm/treestore.h>
+#include <gtkmm/treemodelfilter.h>
+
+#include <unordered_set>
 
 #include "database.h"
+#include "strainindex.h"
 
 class StrainChooserColumns:
 	public Gtk::TreeModelColumnRecord
@@ -54,6 +59,14 @@ class StrainChooserTreeView:
 
 	private:
 		Glib::RefPtr<Database> m_database_;
+		Glib::RefPtr<StrainIndex> m_strain_index_;
+		Glib::RefPtr<Gtk::TreeStore> m_store_;
+		Glib::RefPtr<Gtk::TreeModelFilter> m_filter_;
+
+		// matches of the search text, only used while m_filtered_ is set
+		bool m_filtered_;
+		std::unordered_set<uint64_t> m_matching_strains_;
+		std::unordered_set<uint64_t> m_matching_breeders_;
 
 	public:
 		Columns columns;
@@ -64,10 +77,26 @@ class StrainChooserTreeView:
 
 	private:
 		Glib::RefPtr<Gtk::TreeStore> _create_model();
+		bool _is_placeholder(const Gtk::TreeModel::iterator &iter) const;
+		void _populate_breeder(const Gtk::TreeModel::iterator &breeder_iter);
+		bool _is_visible(const Gtk::TreeModel::const_iterator &iter);
+
+	protected:
+		virtual bool on_test_expand_row(const Gtk::TreeModel::iterator &iter,
+		                                const Gtk::TreeModel::Path &path) override;
 
 	public:
 		Glib::RefPtr<Strain> get_selected_strain();
 
+		/*! true if the application's strain index can be searched for
+		 * this database.
+		 */
+		bool has_search() const;
+		/*! Show only the strains matching text and their breeders. An
+		 * empty text shows the whole catalogue again.
+		 */
+		void set_search_text(const Glib::ustring &text);
+
 		Glib::RefPtr<Database> get_database();
 		Glib::RefPtr<const Database> get_database() const;
 };
@@ -103,6 +132,7 @@ class StrainChooserDialog:
 		static const char TITLE[];
 		
 	private:
+		Gtk::SearchEntry m_search_entry_;
 		StrainChooser m_strain_chooser_;
 		
 	public:
@@ -114,6 +144,7 @@ class StrainChooserDialog:
 		void _add_widgets();
 
 		void on_chooser_selection_changed();
+		void on_search_changed();
 
 	public:
 		Glib::RefPtr<Strain> get_selected_strain();
@@ -0,0 +1,433 @@
+//           strainindex.cc
+//  Di Oktober 20 09:12:41 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// strainindex.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "strainindex.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <glibmm/unicode.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "trace.h"
+
+/*******************************************************************************
+ * helpers
+ ******************************************************************************/
+
+static std::vector<std::string>
+_split_words(const std::string &folded)
+{
+	std::vector<std::string> words;
+	std::string::size_type start = 0;
+	while (start < folded.size()) {
+		std::string::size_type end = folded.find(' ',start);
+		if (end == std::string::npos)
+			end = folded.size();
+		if (end > start)
+			words.push_back(folded.substr(start,end - start));
+		start = end + 1;
+	}
+	return words;
+}
+
+// true if a word of folded starts with prefix
+static bool
+_has_word_prefix(const std::string &folded,const std::string &prefix)
+{
+	std::string::size_type pos = folded.find(prefix);
+	while (pos != std::string::npos) {
+		if (pos == 0 || folded[pos - 1] == ' ')
+			return true;
+		pos = folded.find(prefix,pos + 1);
+	}
+	return false;
+}
+
+/*******************************************************************************
+ * StrainIndex
+ ******************************************************************************/
+
+StrainIndex::StrainIndex():
+	RefClass{},
+	m_entries_{},
+	m_keys_{},
+	m_n_indexed_{0},
+	m_n_dead_{0},
+	m_strains_{},
+	m_breeders_{},
+	m_connections_{}
+{
+}
+
+StrainIndex::~StrainIndex()
+{
+	untrack();
+}
+
+Glib::RefPtr<StrainIndex>
+StrainIndex::create()
+{
+	return Glib::RefPtr<StrainIndex>(new StrainIndex());
+}
+
+Glib::ustring
+StrainIndex::fold(const Glib::ustring &text)
+{
+	Glib::ustring decomposed = text.normalize(Glib::NORMALIZE_NFKD);
+	Glib::ustring stripped;
+	bool separated = true;
+
+	for (Glib::ustring::const_iterator iter = decomposed.begin(); iter != decomposed.end(); ++iter) {
+		gunichar c = *iter;
+		switch (Glib::Unicode::type(c)) {
+			case Glib::UNICODE_NON_SPACING_MARK:
+			case Glib::UNICODE_SPACING_MARK:
+			case Glib::UNICODE_ENCLOSING_MARK:
+				// accents
+				break;
+			case Glib::UNICODE_SPACE_SEPARATOR:
+			case Glib::UNICODE_LINE_SEPARATOR:
+			case Glib::UNICODE_PARAGRAPH_SEPARATOR:
+			case Glib::UNICODE_CONTROL:
+			case Glib::UNICODE_DASH_PUNCTUATION:
+			case Glib::UNICODE_CONNECT_PUNCTUATION:
+			case Glib::UNICODE_OTHER_PUNCTUATION:
+			case Glib::UNICODE_OPEN_PUNCTUATION:
+			case Glib::UNICODE_CLOSE_PUNCTUATION:
+				if (!separated) {
+					stripped += ' ';
+					separated = true;
+				}
+				break;
+			default:
+				stripped += c;
+				separated = false;
+				break;
+		}
+	}
+	if (separated && !stripped.empty())
+		stripped.erase(stripped.length() - 1);
+
+	return stripped.casefold();
+}
+
+void
+StrainIndex::_add(uint64_t strain_id,
+                  uint64_t breeder_id,
+                  const Glib::ustring &breeder_name,
+                  const Glib::ustring &strain_name)
+{
+	auto iter = m_strains_.find(strain_id);
+	if (iter != m_strains_.end())
+		_kill(iter->second);
+
+	uint32_t n = static_cast<uint32_t>(m_entries_.size());
+	Entry entry{StrainIndexRecord{strain_id,breeder_id,breeder_name,strain_name},
+	            fold(breeder_name + " " + strain_name).raw(),
+	            fold(strain_name).raw(),
+	            true};
+	m_entries_.push_back(std::move(entry));
+	m_strains_[strain_id] = n;
+	m_breeders_[breeder_id].push_back(n);
+}
+
+void
+StrainIndex::_kill(uint32_t n)
+{
+	Entry &entry = m_entries_[n];
+	if (!entry.alive)
+		return;
+
+	entry.alive = false;
+	auto iter = m_strains_.find(entry.record.strain_id);
+	if (iter != m_strains_.end() && iter->second == n)
+		m_strains_.erase(iter);
+	++m_n_dead_;
+}
+
+void
+StrainIndex::_compact()
+{
+	TRACE_SCOPE("database","StrainIndex::_compact");
+	std::vector<Entry> entries;
+	entries.reserve(m_entries_.size() - m_n_dead_);
+	for (auto &entry: m_entries_) {
+		if (entry.alive)
+			entries.push_back(std::move(entry));
+	}
+	m_entries_ = std::move(entries);
+
+	m_strains_.clear();
+	m_breeders_.clear();
+	for (uint32_t n = 0; n < m_entries_.size(); ++n) {
+		m_strains_[m_entries_[n].record.strain_id] = n;
+		m_breeders_[m_entries_[n].record.breeder_id].push_back(n);
+	}
+	m_keys_.clear();
+	m_n_indexed_ = 0;
+	m_n_dead_ = 0;
+}
+
+void
+StrainIndex::_update_keys()
+{
+	if (m_n_dead_ && m_n_dead_ * 2 >= m_entries_.size())
+		_compact();
+	if (m_n_indexed_ == m_entries_.size())
+		return;
+
+	TRACE_SCOPE("database","StrainIndex::_update_keys");
+	auto less = [](const Key &a,const Key &b) {
+		int cmp = a.word.compare(b.word);
+		return (cmp < 0 || (cmp == 0 && a.entry < b.entry));
+	};
+
+	// Sort the keys of the new records on their own and merge them into
+	// the sorted array instead of sorting everything again.
+	size_t n_sorted = m_keys_.size();
+	for (size_t n = m_n_indexed_; n < m_entries_.size(); ++n) {
+		if (!m_entries_[n].alive)
+			continue;
+		std::vector<std::string> words = _split_words(m_entries_[n].folded);
+		std::sort(words.begin(),words.end());
+		words.erase(std::unique(words.begin(),words.end()),words.end());
+		for (auto &word: words)
+			m_keys_.push_back(Key{std::move(word),static_cast<uint32_t>(n)});
+	}
+	std::sort(m_keys_.begin() + n_sorted,m_keys_.end(),less);
+	std::inplace_merge(m_keys_.begin(),m_keys_.begin() + n_sorted,m_keys_.end(),less);
+	m_n_indexed_ = m_entries_.size();
+}
+
+void
+StrainIndex::build(const Glib::RefPtr<Database> &database)
+{
+	assert(database);
+	TRACE_SCOPE("database","StrainIndex::build");
+
+	clear();
+	std::list<Glib::RefPtr<Breeder> > breeders{database->get_breeders()};
+	for (auto breeder_iter = breeders.begin(); breeder_iter != breeders.end(); ++breeder_iter) {
+		Glib::RefPtr<Breeder> breeder = *breeder_iter;
+		std::list<Glib::RefPtr<Strain> > strains{database->get_strains_for_breeder(breeder->get_id())};
+		for (auto strain_iter = strains.begin(); strain_iter != strains.end(); ++strain_iter)
+			_add((*strain_iter)->get_id(),breeder->get_id(),breeder->get_name(),(*strain_iter)->get_name());
+	}
+	_update_keys();
+}
+
+void
+StrainIndex::clear()
+{
+	m_entries_.clear();
+	m_keys_.clear();
+	m_n_indexed_ = 0;
+	m_n_dead_ = 0;
+	m_strains_.clear();
+	m_breeders_.clear();
+}
+
+void
+StrainIndex::swap(const Glib::RefPtr<StrainIndex> &other)
+{
+	assert(other);
+
+	m_entries_.swap(other->m_entries_);
+	m_keys_.swap(other->m_keys_);
+	std::swap(m_n_indexed_,other->m_n_indexed_);
+	std::swap(m_n_dead_,other->m_n_dead_);
+	m_strains_.swap(other->m_strains_);
+	m_breeders_.swap(other->m_breeders_);
+}
+
+void
+StrainIndex::track(const Glib::RefPtr<Database> &database)
+{
+	assert(database);
+
+	untrack();
+	m_connections_.push_back(database->signal_breeder_changed().connect(sigc::mem_fun(*this,&StrainIndex::on_breeder_changed)));
+	m_connections_.push_back(database->signal_breeder_removed().connect(sigc::mem_fun(*this,&StrainIndex::remove_breeder)));
+	m_connections_.push_back(database->signal_strain_changed().connect(sigc::mem_fun(*this,&StrainIndex::on_strain_changed)));
+	m_connections_.push_back(database->signal_strain_removed().connect(sigc::mem_fun(*this,&StrainIndex::remove_strain)));
+}
+
+void
+StrainIndex::untrack()
+{
+	for (auto &connection: m_connections_)
+		connection.disconnect();
+	m_connections_.clear();
+}
+
+void
+StrainIndex::on_breeder_changed(const Glib::RefPtr<Breeder> &breeder)
+{
+	rename_breeder(breeder->get_id(),breeder->get_name());
+}
+
+void
+StrainIndex::on_strain_changed(const Glib::RefPtr<Strain> &strain)
+{
+	add_strain(strain);
+}
+
+void
+StrainIndex::add_strain(const Glib::RefPtr<Strain> &strain)
+{
+	assert(strain);
+	if (!strain->get_id())
+		return;
+
+	_add(strain->get_id(),strain->get_breeder_id(),strain->get_breeder_name(),strain->get_name());
+}
+
+void
+StrainIndex::remove_strain(uint64_t strain_id)
+{
+	auto iter = m_strains_.find(strain_id);
+	if (iter != m_strains_.end())
+		_kill(iter->second);
+}
+
+void
+StrainIndex::rename_breeder(uint64_t breeder_id,const Glib::ustring &name)
+{
+	auto iter = m_breeders_.find(breeder_id);
+	if (iter == m_breeders_.end())
+		return;
+
+	std::vector<StrainIndexRecord> records = get_records_for_breeder(breeder_id);
+	for (auto &record: records) {
+		if (record.breeder_name != name)
+			_add(record.strain_id,breeder_id,name,record.strain_name);
+	}
+}
+
+void
+StrainIndex::remove_breeder(uint64_t breeder_id)
+{
+	auto iter = m_breeders_.find(breeder_id);
+	if (iter == m_breeders_.end())
+		return;
+
+	for (auto n: iter->second)
+		_kill(n);
+	m_breeders_.erase(iter);
+}
+
+std::vector<uint64_t>
+StrainIndex::lookup(const Glib::ustring &query,size_t max_results)
+{
+	TRACE_SCOPE("database","StrainIndex::lookup");
+	std::vector<uint64_t> result;
+	std::vector<std::string> words = _split_words(fold(query).raw());
+	if (words.empty())
+		return result;
+
+	_update_keys();
+
+	// Every query word selects a range of keys. The smallest range is
+	// walked, the other words are checked against the folded names of its
+	// records.
+	using KeyRange = std::pair<std::vector<Key>::const_iterator,std::vector<Key>::const_iterator>;
+	KeyRange range{m_keys_.cend(),m_keys_.cend()};
+	size_t selected = words.size();
+	for (size_t i = 0; i < words.size(); ++i) {
+		const std::string &word = words[i];
+		KeyRange r;
+		r.first = std::lower_bound(m_keys_.cbegin(),m_keys_.cend(),word,
+		                           [](const Key &key,const std::string &prefix) {
+			                           return key.word.compare(prefix) < 0;
+		                           });
+		r.second = std::upper_bound(r.first,m_keys_.cend(),word,
+		                            [](const std::string &prefix,const Key &key) {
+			                            return key.word.compare(0,prefix.size(),prefix) > 0;
+		                            });
+		if (selected == words.size() || r.second - r.first < range.second - range.first) {
+			range = r;
+			selected = i;
+		}
+	}
+
+	std::vector<bool> seen(m_entries_.size(),false);
+	for (auto iter = range.first; iter != range.second; ++iter) {
+		const Entry &entry = m_entries_[iter->entry];
+		if (!entry.alive || seen[iter->entry])
+			continue;
+		seen[iter->entry] = true;
+
+		bool match = true;
+		for (size_t i = 0; match && i < words.size(); ++i) {
+			if (i != selected)
+				match = _has_word_prefix(entry.folded,words[i]);
+		}
+		if (!match)
+			continue;
+
+		result.push_back(entry.record.strain_id);
+		if (max_results && result.size() >= max_results)
+			break;
+	}
+	return result;
+}
+
+bool
+StrainIndex::get_record(uint64_t strain_id,StrainIndexRecord &record) const
+{
+	auto iter = m_strains_.find(strain_id);
+	if (iter == m_strains_.end())
+		return false;
+
+	record = m_entries_[iter->second].record;
+	return true;
+}
+
+std::vector<StrainIndexRecord>
+StrainIndex::get_records_for_breeder(uint64_t breeder_id) const
+{
+	std::vector<StrainIndexRecord> records;
+	auto iter = m_breeders_.find(breeder_id);
+	if (iter == m_breeders_.end())
+		return records;
+
+	std::vector<uint32_t> entries;
+	for (auto n: iter->second) {
+		if (m_entries_[n].alive)
+			entries.push_back(n);
+	}
+	std::sort(entries.begin(),entries.end(),[this](uint32_t a,uint32_t b) {
+		return m_entries_[a].folded_name < m_entries_[b].folded_name;
+	});
+	for (auto n: entries)
+		records.push_back(m_entries_[n].record);
+	return records;
+}
+
+size_t
+StrainIndex::size() const
+{
+	return m_strains_.size();
+}
@@ -0,0 +1,161 @@
+/***************************************************************************
+ *            strainindex.h
+ *
+ *  Di Oktober 20 09:12:41 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * strainindex.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STRAININDEX_H__
+#define __STRAININDEX_H__
+
+#include "refclass.h"
+#include "database.h"
+
+#include <glibmm/ustring.h>
+#include <sigc++/sigc++.h>
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*******************************************************************************
+ * StrainIndex
+ ******************************************************************************/
+
+struct StrainIndexRecord
+{
+	uint64_t strain_id;
+	uint64_t breeder_id;
+	Glib::ustring breeder_name;
+	Glib::ustring strain_name;
+};
+
+/*
+ * In-memory search index over the "breeder strain" names of the whole
+ * catalogue. Names are folded (compatibility decomposed, combining marks
+ * stripped, case folded, punctuation turned into word breaks) and every
+ * word of a name is a key in a sorted array, so a query word is a prefix
+ * range found by binary search. A query with several words matches strains
+ * that contain a word starting with each of them, in any order.
+ *
+ * Changes are cheap: a changed strain is appended as a new record and the
+ * old one is marked dead. The keys of new records are sorted and merged
+ * into the key array by the next lookup(), and dead records are dropped
+ * once they make up half of the index.
+ *
+ * The index is not thread safe. It can be built on a worker thread and be
+ * handed to the main thread afterwards; track() keeps it current by
+ * following the change signals of a Database.
+ */
+class StrainIndex:
+	public RefClass
+{
+	private:
+		struct Entry {
+			StrainIndexRecord record;
+			std::string folded;
+			std::string folded_name;
+			bool alive;
+		};
+		struct Key {
+			std::string word;
+			uint32_t entry;
+		};
+
+		std::vector<Entry> m_entries_;
+		std::vector<Key> m_keys_;
+		size_t m_n_indexed_;
+		size_t m_n_dead_;
+		std::unordered_map<uint64_t,uint32_t> m_strains_;
+		std::unordered_map<uint64_t,std::vector<uint32_t> > m_breeders_;
+		std::list<sigc::connection> m_connections_;
+
+	private:
+		StrainIndex(const StrainIndex &src) = delete;
+		StrainIndex& operator = (const StrainIndex &src) = delete;
+
+	protected:
+		StrainIndex();
+
+	public:
+		static Glib::RefPtr<StrainIndex> create();
+		virtual ~StrainIndex();
+
+	private:
+		void _add(uint64_t strain_id,
+		          uint64_t breeder_id,
+		          const Glib::ustring &breeder_name,
+		          const Glib::ustring &strain_name);
+		void _kill(uint32_t entry);
+		void _compact();
+		void _update_keys();
+
+		void on_breeder_changed(const Glib::RefPtr<Breeder> &breeder);
+		void on_strain_changed(const Glib::RefPtr<Strain> &strain);
+
+	public:
+		/*! Fold text the way the index does: compatibility decomposition,
+		 * combining marks stripped, case folded and every run of spaces and
+		 * word separating punctuation replaced by a single space.
+		 */
+		static Glib::ustring fold(const Glib::ustring &text);
+
+		/*! Replace the contents of the index with all strains of the
+		 * database.
+		 */
+		void build(const Glib::RefPtr<Database> &database);
+		void clear();
+
+		/*! Exchange the contents with other. Each index keeps the database
+		 * it tracks, so a tracked index can take over the contents of one
+		 * built on a worker thread.
+		 */
+		void swap(const Glib::RefPtr<StrainIndex> &other);
+
+		/*! Follow the breeder and strain signals of database. Only one
+		 * database can be tracked at a time.
+		 */
+		void track(const Glib::RefPtr<Database> &database);
+		void untrack();
+
+		void add_strain(const Glib::RefPtr<Strain> &strain);
+		void remove_strain(uint64_t strain_id);
+		void rename_breeder(uint64_t breeder_id,const Glib::ustring &name);
+		void remove_breeder(uint64_t breeder_id);
+
+		/*! Ids of the strains matching query, ordered by their words
+		 * matching the most selective query word. At most max_results ids are returned
+		 * unless max_results is 0.
+		 */
+		std::vector<uint64_t> lookup(const Glib::ustring &query,size_t max_results = 0);
+
+		bool get_record(uint64_t strain_id,StrainIndexRecord &record) const;
+		/*! The strains of a breeder, ordered by their folded names.
+		 */
+		std::vector<StrainIndexRecord> get_records_for_breeder(uint64_t breeder_id) const;
+
+		size_t size() const;
+}; // StrainIndex class
+
+#endif /* __STRAININDEX_H__ */
@@ -33,6 +33,7 @@
 #include "breederdialog.h" 
 #include "straindialog.h"
 #include "error.h"
+#include "trace.h"
 
 /*******************************************************************************
  * StrainSelectorColumns
@@ -66,7 +67,8 @@ StrainSelectorTreeView::StrainSelectorTreeView(const Glib::RefPtr<Database> &db)
 	m_delete_menuitem_{_("Delete")},
 	m_popup_menu_{}
 {
-	set_model(_create_model());
+	// The breeders are filled in by refresh() or set_data().
+	set_loading();
 	append_column ("Name",columns.column_name);
 	set_headers_visible(false);
 	
@@ -102,32 +104,110 @@ StrainSelectorTreeView::~StrainSelectorTreeView()
 {
 }
 
+void
+StrainSelectorTreeView::load_data(const Glib::RefPtr<Database> &db,Data &data)
+{
+	TRACE_SCOPE("ui","StrainSelectorTreeView::load_data");
+	data.breeders = db->get_breeders();
+}
+
 Glib::RefPtr<Gtk::TreeStore>
-StrainSelectorTreeView::_create_model()
+StrainSelectorTreeView::_create_model(const Data &data)
 {
+	TRACE_SCOPE("ui","StrainSelectorTreeView::_create_model");
 	Glib::RefPtr<Gtk::TreeStore> model = Gtk::TreeStore::create(columns);
 
-	std::list<Glib::RefPtr<Breeder> > breeders{m_database_->get_breeders()};
-	for (auto breeder_iter = breeders.begin(); breeder_iter != breeders.end(); ++breeder_iter) {
+	// Only the breeders are loaded here. Every breeder row gets a placeholder
+	// child so it shows an expander; the strains are fetched the first time
+	// the row is expanded (see on_test_expand_row()).
+	for (auto breeder_iter = data.breeders.begin(); breeder_iter != data.breeders.end(); ++breeder_iter) {
 		Gtk::TreeModel::iterator model_iter = model->append();
 		Gtk::TreeModel::Row row = *model_iter;
 		row[columns.column_id] = 0;
 		row[columns.column_breeder_id] = (*breeder_iter)->get_id();
 		row[columns.column_name] = (*breeder_iter)->get_name();
-		
-		std::list<Glib::RefPtr<Strain> > strains{m_database_->get_strains_for_breeder(*breeder_iter)};
-		for (auto strain_iter = strains.begin(); strain_iter != strains.end(); ++strain_iter) {
-			Gtk::TreeModel::iterator child_iter = model->append(model_iter->children());
-			Gtk::TreeModel::Row row = *child_iter;
-			Glib::RefPtr<Strain> strain = *strain_iter;
-			row[columns.column_id] = strain->get_id();
-			row[columns.column_breeder_id] = strain->get_breeder_id();
-			row[columns.column_name] = strain->get_name();
-		}
+
+		_append_placeholder(model,model_iter);
 	}
 	return model;
 }
 
+void
+StrainSelectorTreeView::_append_placeholder(const Glib::RefPtr<Gtk::TreeStore> &model,
+                                            const Gtk::TreeModel::iterator &breeder_iter)
+{
+	Gtk::TreeModel::Row row = *(model->append(breeder_iter->children()));
+	row[columns.column_id] = 0;
+	row[columns.column_breeder_id] = 0;
+	row[columns.column_name] = "";
+}
+
+bool
+StrainSelectorTreeView::_is_placeholder(const Gtk::TreeModel::iterator &iter) const
+{
+	return (iter && !(*iter)[columns.column_id] && !(*iter)[columns.column_breeder_id]);
+}
+
+void
+StrainSelectorTreeView::_populate_breeder(const Gtk::TreeModel::iterator &breeder_iter)
+{
+	Gtk::TreeModel::Children children = breeder_iter->children();
+	if (children.empty() || !_is_placeholder(children.begin()))
+		return;
+
+	TRACE_SCOPE("ui","StrainSelectorTreeView::_populate_breeder");
+	Glib::RefPtr<Gtk::TreeStore> model = Glib::RefPtr<Gtk::TreeStore>::cast_dynamic(get_model());
+	Gtk::TreeModel::iterator placeholder = children.begin();
+
+	uint64_t breeder_id = (*breeder_iter)[columns.column_breeder_id];
+	std::list<Glib::RefPtr<Strain> > strains{m_database_->get_strains_for_breeder(breeder_id)};
+	for (auto strain_iter = strains.begin(); strain_iter != strains.end(); ++strain_iter) {
+		Gtk::TreeModel::iterator child_iter = model->append(breeder_iter->children());
+		Gtk::TreeModel::Row row = *child_iter;
+		Glib::RefPtr<Strain> strain = *strain_iter;
+		row[columns.column_id] = strain->get_id();
+		row[columns.column_breeder_id] = strain->get_breeder_id();
+		row[columns.column_name] = strain->get_name();
+	}
+	model->erase(placeholder);
+}
+
+Gtk::TreeModel::iterator
+StrainSelectorTreeView::_find_breeder(uint64_t breeder_id)
+{
+	Gtk::TreeModel::Children breeders = get_model()->children();
+	for (auto iter = breeders.begin(); iter != breeders.end(); ++iter) {
+		if ((*iter)[columns.column_breeder_id] == breeder_id)
+			return iter;
+	}
+	return Gtk::TreeModel::iterator();
+}
+
+void
+StrainSelectorTreeView::_invalidate_breeder(uint64_t breeder_id)
+{
+	// A populated breeder row keeps its strains until they are changed
+	// through this view. Drop them and put the placeholder back, so the
+	// strains are reloaded on the next expansion.
+	Gtk::TreeModel::iterator breeder_iter = _find_breeder(breeder_id);
+	if (!breeder_iter) {
+		refresh();
+		return;
+	}
+
+	Glib::RefPtr<Gtk::TreeStore> model = Glib::RefPtr<Gtk::TreeStore>::cast_dynamic(get_model());
+	Gtk::TreeModel::Path path = model->get_path(breeder_iter);
+	bool expanded = row_expanded(path);
+
+	Gtk::TreeModel::Children children = breeder_iter->children();
+	for (Gtk::TreeModel::iterator iter = children.begin(); iter; )
+		iter = model->erase(iter);
+	_append_placeholder(model,breeder_iter);
+
+	if (expanded)
+		expand_row(path,false);
+}
+
 Glib::RefPtr<Database>
 StrainSelectorTreeView::get_database()
 {
@@ -143,7 +223,29 @@ StrainSelectorTreeView::get_database() const
 void
 StrainSelectorTreeView::refresh()
 {
-	set_model(this->_create_model());
+	Data data;
+	load_data(m_database_,data);
+	set_data(data);
+}
+
+void
+StrainSelectorTreeView::set_loading()
+{
+	Glib::RefPtr<Gtk::TreeStore> model = Gtk::TreeStore::create(columns);
+	Gtk::TreeModel::Row row = *(model->append());
+	row[columns.column_id] = 0;
+	row[columns.column_breeder_id] = 0;
+	row[columns.column_name] = _("Loading...");
+
+	set_model(model);
+	set_sensitive(false);
+}
+
+void
+StrainSelectorTreeView::set_data(const Data &data)
+{
+	set_model(_create_model(data));
+	set_sensitive(true);
 	show();
 }
 
@@ -173,6 +275,14 @@ StrainSelectorTreeView::on_row_activated(const Gtk::TreeModel::Path &path,
 	}
 }
 
+bool
+StrainSelectorTreeView::on_test_expand_row(const Gtk::TreeModel::iterator &iter,
+                                           const Gtk::TreeModel::Path &path)
+{
+	_populate_breeder(iter);
+	return Gtk::TreeView::on_test_expand_row(iter,path);
+}
+
 bool
 StrainSelectorTreeView::on_button_press_event(GdkEventButton *event)
 {
@@ -269,7 +379,7 @@ StrainSelectorTreeView::on_add_strain()
 	StrainDialog dialog(*window,m_database_,strain);
 	int response = dialog.run();
 	if (response == Gtk::RESPONSE_APPLY) {
-		refresh();
+		_invalidate_breeder(breeder->get_id());
 	}
 }
 
@@ -294,7 +404,7 @@ StrainSelectorTreeView::on_edit()
 		int response = dialog.run();
 		dialog.hide();
 		if (response == Gtk::RESPONSE_APPLY) {
-			refresh();
+			_invalidate_breeder(strain->get_breeder_id());
 		}			
 	} else if (row[columns.column_breeder_id]) {
 		Glib::RefPtr<Breeder> breeder = m_database_->get_breeder(row[columns.column_breeder_id]);
@@ -332,8 +442,9 @@ StrainSelectorTreeView::on_delete()
 		dialog.hide();
 		if (response == Gtk::RESPONSE_YES) {
 			try {
+				uint64_t breeder_id = row[columns.column_breeder_id];
 				m_database_->remove_strain(row[columns.column_id]);
-				refresh();
+				_invalidate_breeder(breeder_id);
 			} catch (DatabaseError ex) {
 				Gtk::MessageDialog dialog{*window,ex.what(),false,Gtk::MESSAGE_ERROR,Gtk::BUTTONS_OK,true};
 				dialog.run();
@@ -417,3 +528,15 @@ StrainSelector::refresh()
 {
 	m_treeview_.refresh();
 }
+
+void
+StrainSelector::set_loading()
+{
+	m_treeview_.set_loading();
+}
+
+void
+StrainSelector::set_data(const Data &data)
+{
+	m_treeview_.set_data(data);
+}
@@ -31,6 +31,7 @@
 #include <gtkmm/scrolledwindow.h>
 #include <gtkmm/menu.h>
 #include <gtkmm/menuitem.h>
+#include <list>
 #include "database.h"
 
 class StrainSelectorColumns:
@@ -46,11 +47,20 @@ class StrainSelectorColumns:
 		 virtual ~StrainSelectorColumns();
 }; // StrainSelectorColumns class
 
+// The breeders shown by StrainSelectorTreeView. The strains are loaded
+// when a breeder is expanded. StrainSelectorTreeView::load_data() does not
+// touch any widget and may run off the main thread.
+struct StrainSelectorData
+{
+	std::list<Glib::RefPtr<Breeder> > breeders;
+};
+
 class StrainSelectorTreeView:
 	public Gtk::TreeView
 {
 	public:
 		using Columns = StrainSelectorColumns;
+		using Data = StrainSelectorData;
 
 	public:
 		Columns columns;
@@ -68,17 +78,29 @@ class StrainSelectorTreeView:
 		virtual ~StrainSelectorTreeView();
 
 	private:
-		Glib::RefPtr<Gtk::TreeStore> _create_model();
+		Glib::RefPtr<Gtk::TreeStore> _create_model(const Data &data);
+		void _append_placeholder(const Glib::RefPtr<Gtk::TreeStore> &model,
+		                         const Gtk::TreeModel::iterator &breeder_iter);
+		bool _is_placeholder(const Gtk::TreeModel::iterator &iter) const;
+		void _populate_breeder(const Gtk::TreeModel::iterator &breeder_iter);
+		Gtk::TreeModel::iterator _find_breeder(uint64_t breeder_id);
+		void _invalidate_breeder(uint64_t breeder_id);
 		
 	public:
 		Glib::RefPtr<Database> get_database();
 		Glib::RefPtr<const Database> get_database() const;
 
+		static void load_data(const Glib::RefPtr<Database> &database,Data &data);
+
 		void refresh();
+		void set_loading();
+		void set_data(const Data &data);
 	protected:
 		virtual void on_row_activated(const Gtk::TreeModel::Path &path, 
 		                              Gtk::TreeViewColumn *column) override;
 		virtual bool on_button_press_event (GdkEventButton *button_event) override;
+		virtual bool on_test_expand_row(const Gtk::TreeModel::iterator &iter,
+		                                const Gtk::TreeModel::Path &path) override;
 
 	private:
 		void on_open();
@@ -95,6 +117,7 @@ class StrainSelector:
 	public:
 		using Columns = StrainSelectorColumns;
 		using TreeView = StrainSelectorTreeView;
+		using Data = StrainSelectorData;
 		
 	private:
 		TreeView m_treeview_;
@@ -111,6 +134,8 @@ class StrainSelector:
 		Glib::RefPtr<const Database> get_database() const;
 
 		void refresh();
+		void set_loading();
+		void set_data(const Data &data);
 }; // StrainSelector class
 
 
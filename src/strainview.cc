@@ -34,6 +34,16 @@
 #include <gtk/gtk.h>
 
 #include "application.h"
+#include "trace.h"
+
+// regions of the StrainView text buffer
+enum {
+	STRAIN_TEXT_TITLE = 0,
+	STRAIN_TEXT_LINKS,
+	STRAIN_TEXT_INFO,
+	STRAIN_TEXT_DESCRIPTION,
+	STRAIN_TEXT_N_REGIONS
+};
 
 const char StrainView::TYPE[] = "growbook-strain";
 
@@ -46,6 +56,7 @@ StrainView::StrainView(const Glib::RefPtr<Database> &db,
 	m_homepage_button_{},
 	m_seedfinder_button_{},
 	m_refresh_button_{},
+	m_text_regions_{STRAIN_TEXT_N_REGIONS},
 	m_textview_{}
 {
 	assert(m_strain_);
@@ -85,7 +96,8 @@ StrainView::StrainView(const Glib::RefPtr<Database> &db,
 	
 	m_textview_.set_wrap_mode(Gtk::WRAP_WORD);
 	m_textview_.set_editable(false);
-	m_textview_.set_buffer(_create_textbuffer());
+	_update_textbuffer();
+	m_textview_.set_buffer(m_text_regions_.get_buffer());
 	m_textview_.set_border_width(5);
 
 	Gtk::ScrolledWindow *scrolled = Gtk::manage(new Gtk::ScrolledWindow());
@@ -97,53 +109,45 @@ StrainView::StrainView(const Glib::RefPtr<Database> &db,
 StrainView::~StrainView()
 {}
 
-Glib::RefPtr<Gtk::TextBuffer>
-StrainView::_create_textbuffer()
+void
+StrainView::_update_textbuffer()
 {
-	Glib::RefPtr<Gtk::TextBuffer> buffer = Gtk::TextBuffer::create();
-	Glib::RefPtr<Gtk::TextTagTable> tagtable = buffer->get_tag_table();
-
-	Glib::RefPtr<Gtk::TextTag> tag_title = Gtk::TextTag::create("title");
-	tag_title->property_scale() = 3.0;
-	tag_title->property_weight() = PANGO_WEIGHT_BOLD;
-	tagtable->add(tag_title);
+	TRACE_SCOPE("ui","StrainView::_update_textbuffer");
+	using Pieces = TextBufferRegions::Pieces;
 
-	Glib::RefPtr<Gtk::TextTag> tag_paragraph = Gtk::TextTag::create("paragraph");
-	tag_paragraph->property_scale() = 2.0;
-	tag_paragraph->property_weight() = PANGO_WEIGHT_BOLD;
-	tagtable->add(tag_paragraph);
+	m_text_regions_.set_region(STRAIN_TEXT_TITLE,Pieces{
+		{"title",get_title()},
+		{"","\n\n"}
+	});
 
-	Glib::RefPtr<Gtk::TextTag> tag_bold = Gtk::TextTag::create("bold");
-	tag_bold->property_weight() = PANGO_WEIGHT_BOLD;
-	tagtable->add(tag_bold);
-
-	buffer->insert_with_tag (buffer->begin(),get_title(),tag_title);
-	buffer->insert(buffer->end(),"\n\n");
+	Pieces links;
 	if (!m_strain_->get_homepage().empty()) {
-		buffer->insert_with_tag(buffer->end(),_("Homepage: "),tag_bold);
-		buffer->insert(buffer->end(),m_strain_->get_homepage());
-		buffer->insert(buffer->end(),"\n");
+		links.push_back({"bold",_("Homepage: ")});
+		links.push_back({"",m_strain_->get_homepage()});
+		links.push_back({"","\n"});
 	}
-	
 	if (!m_strain_->get_seedfinder().empty()) {
-		buffer->insert_with_tag(buffer->end(), _("SeedFinder.eu: "),tag_bold);
-		buffer->insert(buffer->end(),m_strain_->get_seedfinder());
-		buffer->insert(buffer->end(),"\n");
+		links.push_back({"bold",_("SeedFinder.eu: ")});
+		links.push_back({"",m_strain_->get_seedfinder()});
+		links.push_back({"","\n"});
 	}
+	m_text_regions_.set_region(STRAIN_TEXT_LINKS,links);
 
+	Pieces info;
 	if (!m_strain_->get_info().empty()) {
-		buffer->insert_with_tag(buffer->end(), _("Info\n"), tag_paragraph);
-		buffer->insert(buffer->end(), m_strain_->get_info());
-		buffer->insert(buffer->end(), "\n");
+		info.push_back({"paragraph",_("Info\n")});
+		info.push_back({"",m_strain_->get_info()});
+		info.push_back({"","\n"});
 	}
+	m_text_regions_.set_region(STRAIN_TEXT_INFO,info);
 
+	Pieces description;
 	if (!m_strain_->get_description().empty()) {
-		buffer->insert_with_tag(buffer->end(), _("Description\n"), tag_paragraph);
-		buffer->insert(buffer->end(),m_strain_->get_description());
-		buffer->insert(buffer->end(),"\n");
+		description.push_back({"paragraph",_("Description\n")});
+		description.push_back({"",m_strain_->get_description()});
+		description.push_back({"","\n"});
 	}
-	
-	return buffer;
+	m_text_regions_.set_region(STRAIN_TEXT_DESCRIPTION,description);
 }
 
 Glib::RefPtr<Strain>
@@ -203,7 +207,7 @@ StrainView::on_refresh()
 	} else {
 		m_seedfinder_button_.set_sensitive(false);
 	}
-	m_textview_.set_buffer(_create_textbuffer());
+	_update_textbuffer();
 	title_changed();
 	show_all();
 }
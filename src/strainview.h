@@ -33,6 +33,7 @@
 
 #include "browserpage.h"
 #include "database.h"
+#include "textbufferregions.h"
 
 class StrainView:
 	public BrowserPage
@@ -46,6 +47,7 @@ class StrainView:
 		 Gtk::ToolButton m_homepage_button_;
 		 Gtk::ToolButton m_seedfinder_button_;
 		 Gtk::ToolButton m_refresh_button_;
+		 TextBufferRegions m_text_regions_;
 		 Gtk::TextView m_textview_;
 		 
 	 public:
@@ -54,7 +56,7 @@ class StrainView:
 		 virtual ~StrainView();
 
 	private:
-		 Glib::RefPtr<Gtk::TextBuffer> _create_textbuffer();
+		 void _update_textbuffer();
 		 
 	public:
 		 Glib::RefPtr<Strain> get_strain();
@@ -0,0 +1,136 @@
+//           textbufferregions.cc
+//  Di Oktober 20 11:02:17 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// textbufferregions.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "textbufferregions.h"
+#include "trace.h"
+
+#include <cassert>
+
+/*******************************************************************************
+ * TextBufferRegions
+ ******************************************************************************/
+
+TextBufferRegions::TextBufferRegions(unsigned int n_regions):
+	m_buffer_{Gtk::TextBuffer::create(get_tag_table())},
+	m_marks_{},
+	m_keys_(n_regions),
+	m_valid_(n_regions,false)
+{
+	assert(n_regions > 0);
+
+	// All marks have left gravity; set_region() moves the marks of the
+	// following regions behind the inserted text itself.
+	for (unsigned int i = 0; i < n_regions; ++i)
+		m_marks_.push_back(m_buffer_->create_mark(m_buffer_->begin(),true));
+}
+
+TextBufferRegions::~TextBufferRegions()
+{
+}
+
+Glib::RefPtr<Gtk::TextTagTable>
+TextBufferRegions::get_tag_table()
+{
+	static Glib::RefPtr<Gtk::TextTagTable> tag_table;
+
+	if (!tag_table) {
+		tag_table = Gtk::TextTagTable::create();
+
+		Glib::RefPtr<Gtk::TextTag> title_tag = Gtk::TextTag::create("title");
+		title_tag->property_weight() = PANGO_WEIGHT_BOLD;
+		title_tag->property_scale() = 3.0;
+		tag_table->add(title_tag);
+
+		Glib::RefPtr<Gtk::TextTag> paragraph_tag = Gtk::TextTag::create("paragraph");
+		paragraph_tag->property_weight() = PANGO_WEIGHT_BOLD;
+		paragraph_tag->property_scale() = 2.0;
+		tag_table->add(paragraph_tag);
+
+		Glib::RefPtr<Gtk::TextTag> bold_tag = Gtk::TextTag::create("bold");
+		bold_tag->property_weight() = PANGO_WEIGHT_BOLD;
+		tag_table->add(bold_tag);
+	}
+	return tag_table;
+}
+
+std::string
+TextBufferRegions::_make_key(const Pieces &pieces)
+{
+	// Compared bytewise; Glib::ustring::compare() collates.
+	std::string key;
+	for (auto iter = pieces.begin(); iter != pieces.end(); ++iter) {
+		key += iter->first.raw();
+		key += '\x1f';
+		key += iter->second.raw();
+		key += '\x1e';
+	}
+	return key;
+}
+
+Glib::RefPtr<Gtk::TextBuffer>
+TextBufferRegions::get_buffer()
+{
+	return m_buffer_;
+}
+
+bool
+TextBufferRegions::set_region(unsigned int region,const Pieces &pieces)
+{
+	assert(region < m_marks_.size());
+
+	std::string key = _make_key(pieces);
+	if (m_valid_[region] && key == m_keys_[region])
+		return false;
+
+	TRACE_SCOPE("ui","TextBufferRegions::set_region");
+	Gtk::TextBuffer::iterator start = m_buffer_->get_iter_at_mark(m_marks_[region]);
+	Gtk::TextBuffer::iterator end = ((region + 1 < m_marks_.size()) ?
+	                                 m_buffer_->get_iter_at_mark(m_marks_[region + 1]) :
+	                                 m_buffer_->end());
+	int offset = start.get_offset();
+	start = m_buffer_->erase(start,end);
+
+	Glib::RefPtr<Gtk::TextTagTable> tag_table = m_buffer_->get_tag_table();
+	for (auto iter = pieces.begin(); iter != pieces.end(); ++iter) {
+		if (iter->second.empty())
+			continue;
+		Glib::RefPtr<Gtk::TextTag> tag;
+		if (!iter->first.empty())
+			tag = tag_table->lookup(iter->first);
+
+		if (tag)
+			start = m_buffer_->insert_with_tag(start,iter->second,tag);
+		else
+			start = m_buffer_->insert(start,iter->second);
+	}
+
+	// The marks of the following regions were left at the start of this
+	// region, move them behind the new text.
+	for (unsigned int i = region + 1; i < m_marks_.size(); ++i) {
+		if (m_buffer_->get_iter_at_mark(m_marks_[i]).get_offset() != offset)
+			break;
+		m_buffer_->move_mark(m_marks_[i],start);
+	}
+
+	m_keys_[region].swap(key);
+	m_valid_[region] = true;
+	return true;
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *            textbufferregions.h
+ *
+ *  Di Oktober 20 11:02:17 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * textbufferregions.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEXTBUFFERREGIONS_H__
+#define __TEXTBUFFERREGIONS_H__
+
+#include <gtkmm/textbuffer.h>
+#include <gtkmm/texttagtable.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/*******************************************************************************
+ * TextBufferRegions
+ ******************************************************************************/
+
+/*
+ * A persistent Gtk::TextBuffer split into a fixed number of consecutive
+ * regions. Each region is delimited by a mark, and set_region() only
+ * replaces the text of a region if its content actually changed. A refresh
+ * therefore does not delete and lay out a long description again when only
+ * the age line changed.
+ *
+ * All buffers share one tag table with the tags "title", "paragraph" and
+ * "bold".
+ */
+class TextBufferRegions
+{
+	public:
+		// (tag name, text) pairs; an empty tag name inserts untagged text
+		using Piece = std::pair<Glib::ustring,Glib::ustring>;
+		using Pieces = std::vector<Piece>;
+
+	private:
+		Glib::RefPtr<Gtk::TextBuffer> m_buffer_;
+		std::vector<Glib::RefPtr<Gtk::TextMark> > m_marks_;
+		std::vector<std::string> m_keys_;
+		std::vector<bool> m_valid_;
+
+	private:
+		TextBufferRegions(const TextBufferRegions &src) = delete;
+		TextBufferRegions& operator=(const TextBufferRegions &src) = delete;
+
+	public:
+		TextBufferRegions(unsigned int n_regions);
+		~TextBufferRegions();
+
+		static Glib::RefPtr<Gtk::TextTagTable> get_tag_table();
+
+	private:
+		static std::string _make_key(const Pieces &pieces);
+
+	public:
+		Glib::RefPtr<Gtk::TextBuffer> get_buffer();
+
+		/*! Replace the content of region with pieces.
+		 * @return true if the buffer was changed.
+		 */
+		bool set_region(unsigned int region,const Pieces &pieces);
+};
+
+#endif /* __TEXTBUFFERREGIONS_H__ */
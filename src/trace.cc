@@ -0,0 +1,212 @@
+//           trace.cc
+//  Di Oktober 20 09:40:37 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// trace.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "trace.h"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+
+#ifdef NATIVE_WINDOWS
+# include <process.h>
+# define getpid _getpid
+#else
+# include <unistd.h>
+#endif
+
+std::atomic<bool> trace_enabled{false};
+
+struct TraceEvent
+{
+	const char *category;
+	const char *name;
+	uint64_t start_us;
+	uint64_t duration_us;
+};
+
+struct TraceBuffer
+{
+	std::mutex mutex;
+	unsigned int tid;
+	std::string thread_name;
+	std::vector<TraceEvent> events;
+};
+
+// Buffers are owned by the registry, so events of threads that already
+// finished are still written at exit. The registry itself is never freed.
+struct TraceRegistry
+{
+	std::mutex mutex;
+	std::deque<std::unique_ptr<TraceBuffer> > buffers;
+	std::string filename;
+	std::chrono::steady_clock::time_point epoch;
+};
+
+static TraceRegistry*
+_trace_registry()
+{
+	static TraceRegistry *registry = new TraceRegistry();
+	return registry;
+}
+
+static TraceBuffer*
+_trace_thread_buffer()
+{
+	static thread_local TraceBuffer *buffer = nullptr;
+	if (buffer)
+		return buffer;
+
+	TraceRegistry *registry = _trace_registry();
+	std::lock_guard<std::mutex> lock(registry->mutex);
+	buffer = new TraceBuffer();
+	buffer->tid = registry->buffers.size() + 1;
+	buffer->events.reserve(4096);
+	registry->buffers.emplace_back(buffer);
+	return buffer;
+}
+
+uint64_t
+trace_now_us()
+{
+	auto elapsed = std::chrono::steady_clock::now() - _trace_registry()->epoch;
+	return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void
+trace_add_complete(const char *category,
+                   const char *name,
+                   uint64_t start_us,
+                   uint64_t duration_us)
+{
+	TraceBuffer *buffer = _trace_thread_buffer();
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->events.push_back(TraceEvent{category,name,start_us,duration_us});
+}
+
+void
+trace_set_thread_name(const char *name)
+{
+	if (!trace_is_enabled())
+		return;
+	
+	TraceBuffer *buffer = _trace_thread_buffer();
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->thread_name = name;
+}
+
+static void
+_trace_write_string(FILE *file, const char *str)
+{
+	fputc('"',file);
+	for (const char *p = str; *p; ++p) {
+		if (*p == '"' || *p == '\\')
+			fputc('\\',file);
+		if (static_cast<unsigned char>(*p) < 0x20)
+			continue;
+		fputc(*p,file);
+	}
+	fputc('"',file);
+}
+
+void
+trace_flush()
+{
+	TraceRegistry *registry = _trace_registry();
+	if (registry->filename.empty())
+		return;
+	
+	FILE *file = fopen(registry->filename.c_str(),"w");
+	if (!file) {
+		fprintf(stderr,"Unable to write trace file \"%s\"!\n",registry->filename.c_str());
+		return;
+	}
+
+	int pid = getpid();
+	bool first = true;
+	
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[",file);
+	
+	std::lock_guard<std::mutex> lock(registry->mutex);
+	for (auto iter = registry->buffers.begin(); iter != registry->buffers.end(); ++iter) {
+		TraceBuffer *buffer = iter->get();
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+		if (!buffer->thread_name.empty()) {
+			fprintf(file,"%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+			        (first ? "" : ","),pid,buffer->tid);
+			_trace_write_string(file,buffer->thread_name.c_str());
+			fputs("}}",file);
+			first = false;
+		}
+		
+		for (auto event = buffer->events.begin(); event != buffer->events.end(); ++event) {
+			fprintf(file,"%s\n{\"ph\":\"X\",\"cat\":",(first ? "" : ","));
+			_trace_write_string(file,event->category);
+			fputs(",\"name\":",file);
+			_trace_write_string(file,event->name);
+			fprintf(file,",\"ts\":%llu,\"dur\":%llu,\"pid\":%d,\"tid\":%u}",
+			        static_cast<unsigned long long>(event->start_us),
+			        static_cast<unsigned long long>(event->duration_us),
+			        pid,
+			        buffer->tid);
+			first = false;
+		}
+	}
+	fputs("\n]}\n",file);
+	fclose(file);
+}
+
+static void
+_trace_atexit()
+{
+	trace_enabled.store(false);
+	trace_flush();
+}
+
+void
+trace_init()
+{
+	static bool initialized = false;
+	if (initialized)
+		return;
+	initialized = true;
+
+	const char *filename = getenv("GROWBOOK_TRACE");
+	if (!filename || !*filename)
+		return;
+
+	TraceRegistry *registry = _trace_registry();
+	registry->filename = filename;
+	registry->epoch = std::chrono::steady_clock::now();
+
+	trace_enabled.store(true);
+	trace_set_thread_name("main");
+	atexit(_trace_atexit);
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+ *            trace.h
+ *
+ *  Di Oktober 20 09:40:37 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * trace.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Timeline tracing in the Chrome trace-event format.
+ *
+ * If the environment variable GROWBOOK_TRACE names a file, spans created
+ * with TRACE_SCOPE() are collected in a buffer per thread and written to that
+ * file when the program exits. The file can be loaded into chrome://tracing
+ * or Perfetto. When tracing is disabled a span costs one relaxed atomic load.
+ *
+ * Category and name have to be string literals (or otherwise outlive the
+ * program), only the pointers are stored.
+ */
+
+extern std::atomic<bool> trace_enabled;
+
+inline bool
+trace_is_enabled()
+{
+	return trace_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t trace_now_us();
+void trace_add_complete(const char *category,
+                        const char *name,
+                        uint64_t start_us,
+                        uint64_t duration_us);
+void trace_set_thread_name(const char *name);
+
+/*! Enables tracing if GROWBOOK_TRACE is set and installs the exit handler
+ * that writes the trace file. Called from main() and db_init().
+ */
+void trace_init();
+void trace_flush();
+
+class TraceSpan
+{
+	private:
+		const char *m_category_;
+		const char *m_name_;
+		uint64_t m_start_;
+		bool m_active_;
+
+	private:
+		TraceSpan(const TraceSpan &src) = delete;
+		TraceSpan& operator=(const TraceSpan &src) = delete;
+
+	public:
+		TraceSpan(const char *category, const char *name):
+			m_category_{category},
+			m_name_{name},
+			m_start_{0},
+			m_active_{trace_is_enabled()}
+		{
+			if (m_active_)
+				m_start_ = trace_now_us();
+		}
+		
+		~TraceSpan()
+		{
+			if (m_active_)
+				trace_add_complete(m_category_,m_name_,m_start_,trace_now_us() - m_start_);
+		}
+};
+
+#define __TRACE_CONCAT2__(a,b) a##b
+#define __TRACE_CONCAT__(a,b) __TRACE_CONCAT2__(a,b)
+#define TRACE_SCOPE(category,name) TraceSpan __TRACE_CONCAT__(__trace_span_,__LINE__){category,name}
+
+#endif /* __TRACE_H__ */
@@ -0,0 +1,810 @@
+//           xml_exporter.cc
+//  Di Oktober 20 16:41:07 2026
+//  Copyright  2026  Christian Moser
+//  <user@host>
+// xml_exporter.cc
+//
+// Copyright (C) 2026 - Christian Moser
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "xml_exporter.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "trace.h"
+
+/*******************************************************************************
+ * XmlWriter
+ ******************************************************************************/
+
+// Collects the output in one large buffer that is handed to the stream, or
+// appended to a string, whenever it fills up. Text is escaped straight into
+// the buffer, exactly like g_markup_escape_text() does it.
+class XmlWriter
+{
+	public:
+		static const size_t BUFFER_SIZE = 1024 * 1024;
+
+	private:
+		std::ostream *m_out_;
+		std::string *m_string_;
+		std::unique_ptr<char[]> m_buffer_;
+		size_t m_size_;
+		uint64_t m_bytes_written_;
+
+	private:
+		XmlWriter(const XmlWriter &src) = delete;
+		XmlWriter& operator=(const XmlWriter &src) = delete;
+
+	public:
+		XmlWriter(std::ostream &out);
+		XmlWriter(std::string &out);
+		~XmlWriter();
+
+	private:
+		void _write_output(const char *str, size_t len);
+		void _write_escaped_char(unsigned int c);
+
+	public:
+		// Flushes the buffer and continues writing to out.
+		void set_output(std::string &out);
+
+	public:
+		void write(const char *str, size_t len);
+		void write(const char *str);
+		void write(const std::string &str);
+		void write(const Glib::ustring &str);
+		void write_escaped(const char *str, size_t len);
+		void write_escaped(const std::string &str);
+		void write_escaped(const Glib::ustring &str);
+		void write_indent(unsigned int depth);
+		void flush();
+
+		uint64_t get_bytes_written() const;
+};
+
+// What g_markup_escape_text() does with a byte: 0 copy it, 1 replace it
+// with an entity, 2 write a character reference for the C0 control
+// character, 3 look at the next byte for a C1 control character.
+struct XmlEscapeTable
+{
+	unsigned char action[256];
+
+	XmlEscapeTable():
+		action{}
+	{
+		for (unsigned int c = 0x01; c <= 0x1f; ++c) {
+			if (c != '\t' && c != '\n' && c != '\r')
+				action[c] = 2;
+		}
+		action[0x7f] = 2;
+		action[0xc2] = 3;
+		action[static_cast<unsigned char>('\'')] = 1;
+		action[static_cast<unsigned char>('"')] = 1;
+		action[static_cast<unsigned char>('<')] = 1;
+		action[static_cast<unsigned char>('>')] = 1;
+		action[static_cast<unsigned char>('&')] = 1;
+	}
+};
+
+static const unsigned char*
+_escape_table()
+{
+	static const XmlEscapeTable table;
+	return table.action;
+}
+
+XmlWriter::XmlWriter(std::ostream &out):
+	m_out_{&out},
+	m_string_{nullptr},
+	m_buffer_{new char[BUFFER_SIZE]},
+	m_size_{0},
+	m_bytes_written_{0}
+{
+}
+
+XmlWriter::XmlWriter(std::string &out):
+	m_out_{nullptr},
+	m_string_{&out},
+	m_buffer_{new char[BUFFER_SIZE]},
+	m_size_{0},
+	m_bytes_written_{0}
+{
+}
+
+XmlWriter::~XmlWriter()
+{
+}
+
+void
+XmlWriter::_write_output(const char *str, size_t len)
+{
+	if (m_out_)
+		m_out_->write(str,len);
+	else
+		m_string_->append(str,len);
+	m_bytes_written_ += len;
+}
+
+void
+XmlWriter::set_output(std::string &out)
+{
+	flush();
+	m_out_ = nullptr;
+	m_string_ = &out;
+}
+
+void
+XmlWriter::write(const char *str, size_t len)
+{
+	if (m_size_ + len > BUFFER_SIZE) {
+		flush();
+		if (len > BUFFER_SIZE) {
+			_write_output(str,len);
+			return;
+		}
+	}
+	memcpy(m_buffer_.get() + m_size_,str,len);
+	m_size_ += len;
+}
+
+void
+XmlWriter::write(const char *str)
+{
+	write(str,strlen(str));
+}
+
+void
+XmlWriter::write(const std::string &str)
+{
+	write(str.data(),str.size());
+}
+
+void
+XmlWriter::write(const Glib::ustring &str)
+{
+	write(str.raw());
+}
+
+void
+XmlWriter::_write_escaped_char(unsigned int c)
+{
+	char buf[16];
+	int len = snprintf(buf,sizeof(buf),"&#x%x;",c);
+	write(buf,len);
+}
+
+void
+XmlWriter::write_escaped(const char *str, size_t len)
+{
+	const unsigned char *p = reinterpret_cast<const unsigned char*>(str);
+	const unsigned char *end = p + len;
+	const unsigned char *run = p;
+	const unsigned char *table = _escape_table();
+
+	while (p < end) {
+		unsigned char action = table[*p];
+		if (!action || (action == 3 && (p + 1 >= end || p[1] < 0x80 || p[1] > 0x9f || p[1] == 0x85))) {
+			++p;
+			continue;
+		}
+
+		write(reinterpret_cast<const char*>(run),p - run);
+		if (action == 1) {
+			switch (*p) {
+				case '&':
+					write("&amp;",5);
+					break;
+				case '<':
+					write("&lt;",4);
+					break;
+				case '>':
+					write("&gt;",4);
+					break;
+				case '\'':
+					write("&apos;",6);
+					break;
+				case '"':
+					write("&quot;",6);
+					break;
+			}
+			++p;
+		} else if (action == 2) {
+			_write_escaped_char(*p);
+			++p;
+		} else {
+			_write_escaped_char(p[1]);
+			p += 2;
+		}
+		run = p;
+	}
+	write(reinterpret_cast<const char*>(run),p - run);
+}
+
+void
+XmlWriter::write_escaped(const std::string &str)
+{
+	write_escaped(str.data(),str.size());
+}
+
+void
+XmlWriter::write_escaped(const Glib::ustring &str)
+{
+	write_escaped(str.raw());
+}
+
+void
+XmlWriter::write_indent(unsigned int depth)
+{
+	static const char spaces[] = "                    ";
+	while (depth > 10) {
+		write(spaces,20);
+		depth -= 10;
+	}
+	write(spaces,depth * 2);
+}
+
+void
+XmlWriter::flush()
+{
+	if (m_size_) {
+		_write_output(m_buffer_.get(),m_size_);
+		m_size_ = 0;
+	}
+}
+
+uint64_t
+XmlWriter::get_bytes_written() const
+{
+	return m_bytes_written_ + m_size_;
+}
+
+/*******************************************************************************
+ * xml_export_database
+ ******************************************************************************/
+
+template <typename String>
+static void
+_write_element(XmlWriter &writer,
+               unsigned int depth,
+               const char *name,
+               const String &text)
+{
+	writer.write_indent(depth);
+	writer.write("<");
+	writer.write(name);
+	writer.write(">");
+	writer.write_escaped(text);
+	writer.write("</");
+	writer.write(name);
+	writer.write(">\n");
+}
+
+template <typename String>
+static void
+_write_cdata_element(XmlWriter &writer,
+                     unsigned int depth,
+                     const char *name,
+                     const String &text)
+{
+	writer.write_indent(depth);
+	writer.write("<");
+	writer.write(name);
+	writer.write("><![CDATA[");
+	writer.write(text);
+	writer.write("]]></");
+	writer.write(name);
+	writer.write(">\n");
+}
+
+static void
+_write_breeders(XmlWriter &writer, const Glib::RefPtr<const Database> &database)
+{
+	std::list<Glib::RefPtr<Breeder> > breeders(database->get_breeders());
+
+	// all strains in one query, grouped by breeder
+	std::unordered_map<uint64_t,std::list<Glib::RefPtr<Strain> > > breeder_strains;
+	for (auto &strain: database->get_strains())
+		breeder_strains[strain->get_breeder_id()].push_back(strain);
+	
+	writer.write_indent(1);
+	writer.write("<breeders>\n");
+	for (auto &b: breeders) {
+		writer.write_indent(2);
+		writer.write("<breeder>\n");
+		_write_element(writer,3,"name",b->get_name());
+		if (!b->get_homepage().empty())
+			_write_element(writer,3,"homepage",b->get_homepage());
+
+		writer.write_indent(3);
+		writer.write("<strains>\n");
+		for (auto &s: breeder_strains[b->get_id()]) {
+			writer.write_indent(4);
+			writer.write("<strain>\n");
+			_write_element(writer,5,"name",s->get_name());
+			if (!s->get_homepage().empty())
+				_write_element(writer,5,"homepage",s->get_homepage());
+			if (!s->get_seedfinder().empty())
+				_write_element(writer,5,"seedfinder",s->get_seedfinder());
+			if (!s->get_info().empty())
+				_write_cdata_element(writer,5,"info",s->get_info());
+			if (!s->get_description().empty())
+				_write_cdata_element(writer,5,"description",s->get_description());
+			writer.write_indent(4);
+			writer.write("</strain>\n");
+		}
+		writer.write_indent(3);
+		writer.write("</strains>\n");
+
+		writer.write_indent(2);
+		writer.write("</breeder>\n");
+	}
+	writer.write_indent(1);
+	writer.write("</breeders>\n");
+}
+
+static void
+_write_growlog_begin(XmlWriter &writer,
+                     const Glib::RefPtr<Growlog> &gl,
+                     const std::list<Glib::RefPtr<Strain> > &strains)
+{
+	writer.write_indent(2);
+	writer.write("<growlog>\n");
+	_write_element(writer,3,"title",gl->get_title());
+	_write_element(writer,3,"created_on",gl->get_created_on_format());
+	if (gl->get_flower_on())
+		_write_element(writer,3,"flower_on",gl->get_flower_on_format());
+	if (gl->get_finished_on())
+		_write_element(writer,3,"finished_on",gl->get_finished_on_format());
+	if (!gl->get_description().empty())
+		_write_cdata_element(writer,3,"description",gl->get_description());
+
+	writer.write_indent(3);
+	writer.write("<strains>\n");
+	for (auto &strain: strains) {
+		writer.write_indent(4);
+		writer.write("<strain>\n");
+		_write_element(writer,5,"breeder",strain->get_breeder_name());
+		_write_element(writer,5,"name",strain->get_name());
+		writer.write_indent(4);
+		writer.write("</strain>\n");
+	}
+	writer.write_indent(3);
+	writer.write("</strains>\n");
+
+	writer.write_indent(3);
+	writer.write("<entries>\n");
+}
+
+static void
+_write_growlog_end(XmlWriter &writer)
+{
+	writer.write_indent(3);
+	writer.write("</entries>\n");
+	writer.write_indent(2);
+	writer.write("</growlog>\n");
+}
+
+// What the <growlogs> element is built from. Only read while writing, so
+// the worker threads share it without locking.
+struct XmlGrowlogData
+{
+	std::vector<Glib::RefPtr<Growlog> > growlogs;
+	std::unordered_map<uint64_t,size_t> growlog_index;
+	std::map<uint64_t,std::list<Glib::RefPtr<Strain> > > growlog_strains;
+};
+
+// Writes the growlogs up to (excluding) end that are not written yet,
+// next is the first of them. The growlog before next is still open.
+static void
+_write_growlogs_until(XmlWriter &writer,
+                      const XmlGrowlogData &data,
+                      size_t &next,
+                      size_t end)
+{
+	static const std::list<Glib::RefPtr<Strain> > no_strains;
+	
+	for (; next < end; ++next) {
+		if (next)
+			_write_growlog_end(writer);
+		auto iter = data.growlog_strains.find(data.growlogs[next]->get_id());
+		_write_growlog_begin(writer,
+		                     data.growlogs[next],
+		                     (iter != data.growlog_strains.end() ? iter->second : no_strains));
+	}
+}
+
+static void
+_write_growlog_entry(XmlWriter &writer, const Glib::RefPtr<GrowlogEntry> &entry)
+{
+	writer.write_indent(4);
+	writer.write("<entry>\n");
+	_write_element(writer,5,"created_on",entry->get_created_on_format());
+	_write_cdata_element(writer,5,"text",entry->get_text());
+	writer.write_indent(4);
+	writer.write("</entry>\n");
+}
+
+/*******************************************************************************
+ * XmlExportPool
+ ******************************************************************************/
+
+// A task covers up to this many entries or bytes of entry text
+#define XML_EXPORT_TASK_ENTRIES 1024
+#define XML_EXPORT_TASK_BYTES (256 * 1024)
+// Tasks in flight per worker, this bounds the memory of a parallel export
+#define XML_EXPORT_TASKS_PER_WORKER 4
+
+// A slice of the <growlogs> element: a run of entries together with the
+// growlogs that begin before each of them. The last task also closes the
+// remaining growlogs.
+struct XmlExportTask
+{
+	size_t next;
+	bool last;
+	std::vector<Glib::RefPtr<GrowlogEntry> > entries;
+	std::vector<size_t> growlog_indexes;
+	std::string output;
+	bool done;
+
+	XmlExportTask(size_t next_growlog):
+		next{next_growlog},
+		last{false},
+		entries{},
+		growlog_indexes{},
+		output{},
+		done{false}
+	{}
+};
+
+static void
+_write_task(XmlWriter &writer, const XmlGrowlogData &data, const XmlExportTask &task)
+{
+	size_t next = task.next;
+	for (size_t i = 0; i < task.entries.size(); ++i) {
+		_write_growlogs_until(writer,data,next,task.growlog_indexes[i] + 1);
+		_write_growlog_entry(writer,task.entries[i]);
+	}
+	if (task.last) {
+		_write_growlogs_until(writer,data,next,data.growlogs.size());
+		if (next)
+			_write_growlog_end(writer);
+	}
+}
+
+// Worker threads serialize the tasks into their output strings, a writer
+// thread hands the outputs to the XmlWriter in the order the tasks were
+// submitted. A task is owned by one thread at a time and the entries are
+// not shared outside of it, RefClass reference counts are not atomic.
+class XmlExportPool
+{
+	private:
+		const XmlGrowlogData &m_data_;
+		XmlWriter &m_writer_;
+		std::mutex m_mutex_;
+		std::condition_variable m_work_cond_;
+		std::condition_variable m_done_cond_;
+		std::condition_variable m_space_cond_;
+		// submitted and not yet written, in order
+		std::deque<std::unique_ptr<XmlExportTask> > m_tasks_;
+		// not yet picked up by a worker
+		std::deque<XmlExportTask*> m_pending_;
+		size_t m_max_tasks_;
+		bool m_finished_;
+		bool m_aborted_;
+		std::exception_ptr m_error_;
+		std::vector<std::thread> m_threads_;
+
+	private:
+		XmlExportPool(const XmlExportPool &src) = delete;
+		XmlExportPool& operator=(const XmlExportPool &src) = delete;
+
+	public:
+		XmlExportPool(const XmlGrowlogData &data,
+		              XmlWriter &writer,
+		              unsigned int n_workers);
+		~XmlExportPool();
+
+	public:
+		// Blocks while too many tasks are in flight. Returns false if the
+		// export was aborted.
+		bool submit(std::unique_ptr<XmlExportTask> task);
+		// Waits until all tasks are written, rethrows an error of a worker.
+		void finish();
+
+	private:
+		void _abort(std::exception_ptr error);
+		void _join();
+		void _worker();
+		void _writer();
+};
+
+XmlExportPool::XmlExportPool(const XmlGrowlogData &data,
+                             XmlWriter &writer,
+                             unsigned int n_workers):
+	m_data_(data),
+	m_writer_(writer),
+	m_mutex_{},
+	m_work_cond_{},
+	m_done_cond_{},
+	m_space_cond_{},
+	m_tasks_{},
+	m_pending_{},
+	m_max_tasks_{n_workers * XML_EXPORT_TASKS_PER_WORKER},
+	m_finished_{false},
+	m_aborted_{false},
+	m_error_{},
+	m_threads_{}
+{
+	m_threads_.emplace_back(&XmlExportPool::_writer,this);
+	for (unsigned int i = 0; i < n_workers; ++i)
+		m_threads_.emplace_back(&XmlExportPool::_worker,this);
+}
+
+XmlExportPool::~XmlExportPool()
+{
+	// only reached with running threads if the producer threw
+	_abort(std::exception_ptr());
+	_join();
+}
+
+bool
+XmlExportPool::submit(std::unique_ptr<XmlExportTask> task)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex_);
+		m_space_cond_.wait(lock,[this]() {
+			return (m_aborted_ || m_tasks_.size() < m_max_tasks_);
+		});
+		if (m_aborted_)
+			return false;
+		m_pending_.push_back(task.get());
+		m_tasks_.push_back(std::move(task));
+	}
+	m_work_cond_.notify_one();
+	return true;
+}
+
+void
+XmlExportPool::finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_);
+		m_finished_ = true;
+	}
+	m_work_cond_.notify_all();
+	m_done_cond_.notify_all();
+	_join();
+	
+	if (m_error_)
+		std::rethrow_exception(m_error_);
+}
+
+void
+XmlExportPool::_abort(std::exception_ptr error)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_);
+		if (error && !m_error_)
+			m_error_ = error;
+		m_aborted_ = true;
+	}
+	m_work_cond_.notify_all();
+	m_done_cond_.notify_all();
+	m_space_cond_.notify_all();
+}
+
+void
+XmlExportPool::_join()
+{
+	for (auto &thread: m_threads_) {
+		if (thread.joinable())
+			thread.join();
+	}
+}
+
+void
+XmlExportPool::_worker()
+{
+	trace_set_thread_name("xml export worker");
+
+	// one writer per thread, it is pointed at the output of each task so
+	// its buffer is reused
+	std::string no_output;
+	XmlWriter writer(no_output);
+	for (;;) {
+		XmlExportTask *task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex_);
+			m_work_cond_.wait(lock,[this]() {
+				return (m_aborted_ || m_finished_ || !m_pending_.empty());
+			});
+			if (m_aborted_ || m_pending_.empty())
+				return;
+			task = m_pending_.front();
+			m_pending_.pop_front();
+		}
+
+		try {
+			TRACE_SCOPE("export","XmlExportPool::_worker");
+			writer.set_output(task->output);
+			_write_task(writer,m_data_,*task);
+			writer.flush();
+		} catch (...) {
+			_abort(std::current_exception());
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex_);
+			task->done = true;
+		}
+		m_done_cond_.notify_one();
+	}
+}
+
+void
+XmlExportPool::_writer()
+{
+	trace_set_thread_name("xml export writer");
+
+	for (;;) {
+		std::unique_ptr<XmlExportTask> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex_);
+			m_done_cond_.wait(lock,[this]() {
+				return (m_aborted_
+				        || (m_tasks_.empty() && m_finished_)
+				        || (!m_tasks_.empty() && m_tasks_.front()->done));
+			});
+			if (m_aborted_ || m_tasks_.empty())
+				return;
+			task = std::move(m_tasks_.front());
+			m_tasks_.pop_front();
+		}
+		m_space_cond_.notify_one();
+
+		try {
+			TRACE_SCOPE("export","XmlExportPool::_writer");
+			m_writer_.write(task->output);
+			// the entries are released here, the producer no longer
+			// holds references to them
+			task.reset();
+		} catch (...) {
+			_abort(std::current_exception());
+			return;
+		}
+	}
+}
+
+/******************************************************************************/
+
+static void
+_write_growlogs_serial(XmlWriter &writer,
+                       const XmlGrowlogData &data,
+                       const Glib::RefPtr<const Database> &database)
+{
+	// The entries arrive grouped by growlog in the order of growlogs. A
+	// growlog is written up to its <entries> when its first entry shows
+	// up, growlogs without entries in between are written on the way.
+	size_t next = 0;
+	database->foreach_growlog_entry([&](const Glib::RefPtr<GrowlogEntry> &entry) {
+		auto iter = data.growlog_index.find(entry->get_growlog_id());
+		// growlogs added after get_growlogs() are not exported
+		if (iter == data.growlog_index.end() || iter->second + 1 < next)
+			return;
+		_write_growlogs_until(writer,data,next,iter->second + 1);
+		_write_growlog_entry(writer,entry);
+	});
+	_write_growlogs_until(writer,data,next,data.growlogs.size());
+	if (next)
+		_write_growlog_end(writer);
+}
+
+static void
+_write_growlogs_parallel(XmlWriter &writer,
+                         const XmlGrowlogData &data,
+                         const Glib::RefPtr<const Database> &database,
+                         unsigned int n_workers)
+{
+	XmlExportPool pool(data,writer,n_workers);
+
+	// Same bookkeeping as _write_growlogs_serial(), the tasks replay it.
+	// A full task is submitted when the next entry arrives, by then the
+	// database has dropped its references to the entries of the task.
+	size_t next = 0;
+	size_t task_bytes = 0;
+	std::unique_ptr<XmlExportTask> task(new XmlExportTask(next));
+	database->foreach_growlog_entry([&](const Glib::RefPtr<GrowlogEntry> &entry) {
+		if (!task)
+			return;
+		auto iter = data.growlog_index.find(entry->get_growlog_id());
+		if (iter == data.growlog_index.end() || iter->second + 1 < next)
+			return;
+
+		if (task->entries.size() >= XML_EXPORT_TASK_ENTRIES || task_bytes >= XML_EXPORT_TASK_BYTES) {
+			if (!pool.submit(std::move(task)))
+				return;
+			task.reset(new XmlExportTask(next));
+			task_bytes = 0;
+		}
+		next = std::max(next,iter->second + 1);
+		task->entries.push_back(entry);
+		task->growlog_indexes.push_back(iter->second);
+		task_bytes += entry->get_text().bytes();
+	});
+	if (task) {
+		task->last = true;
+		pool.submit(std::move(task));
+	}
+	pool.finish();
+}
+
+static void
+_write_growlogs(XmlWriter &writer,
+                const Glib::RefPtr<const Database> &database,
+                unsigned int n_threads)
+{
+	XmlGrowlogData data;
+	for (auto &growlog: database->get_growlogs()) {
+		data.growlog_index[growlog->get_id()] = data.growlogs.size();
+		data.growlogs.push_back(growlog);
+	}
+	data.growlog_strains = database->get_strains_for_growlogs();
+
+	writer.write_indent(1);
+	writer.write("<growlogs>\n");
+	if (n_threads > 1)
+		_write_growlogs_parallel(writer,data,database,n_threads);
+	else
+		_write_growlogs_serial(writer,data,database);
+	writer.write_indent(1);
+	writer.write("</growlogs>\n");
+}
+
+uint64_t
+xml_export_database(const Glib::RefPtr<const Database> &database,
+                    std::ostream &out,
+                    unsigned int n_threads)
+{
+	TRACE_SCOPE("export","xml_export_database");
+
+	if (!n_threads)
+		n_threads = std::thread::hardware_concurrency();
+
+	XmlWriter writer(out);
+	writer.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	writer.write("<growbook>\n");
+	_write_breeders(writer,database);
+	_write_growlogs(writer,database,n_threads);
+	writer.write("</growbook>\n");
+	writer.flush();
+	out.flush();
+
+	return writer.get_bytes_written();
+}
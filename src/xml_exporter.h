@@ -0,0 +1,47 @@
+/***************************************************************************
+ *            xml_exporter.h
+ *
+ *  Di Oktober 20 16:41:07 2026
+ *  Copyright  2026  Christian Moser
+ *  <user@host>
+ ****************************************************************************/
+/*
+ * xml_exporter.h
+ *
+ * Copyright (C) 2026 - Christian Moser
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __XML_EXPORTER_H__
+#define __XML_EXPORTER_H__
+
+#include <ostream>
+
+#include "database.h"
+
+// Writes the whole database as growbook XML. This is the format
+// XML_Exporter writes and XML_Importer reads; it does not depend on GTK so
+// command line tools produce byte-identical files. The data is read with a
+// handful of queries and the entries are streamed, so memory use does not
+// grow with the number of entries. Returns the number of bytes written.
+//
+// The growlog entries are formatted by n_threads worker threads, 0 uses
+// one per CPU and 1 formats them on the calling thread. The output does not
+// depend on n_threads.
+uint64_t xml_export_database(const Glib::RefPtr<const Database> &database,
+                             std::ostream &out,
+                             unsigned int n_threads=0);
+
+#endif /* __XML_EXPORTER_H__ */
@@ -29,18 +29,20 @@
 #include "debug.h"
 
 #include "xml_importer.h"
+#include "compression.h"
+#include "error.h"
+#include "trace.h"
 #include <glibmm/markup.h>
-#include <gtkmm/dialog.h>
-#include <gtkmm/box.h>
-#include <gtkmm/label.h>
-#include <gtkmm/entry.h>
-#include <gtkmm/button.h>
-#include <gtkmm/messagedialog.h>
 
 #include <fstream>
 #include <ctime>
 #include <cstdio>
 #include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#define XML_IMPORT_CHUNK_SIZE (64 * 1024)
 
 enum MarkupElement {
 	MARKUP_UNKNOWN = -1,
@@ -77,9 +79,7 @@ enum MarkupElement {
 enum BreederMode {
 	BREEDER_MODE_UNKNOWN,
 	BREEDER_MODE_UPDATE,
-	BREEDER_MODE_UPDATE_ALL,
-	BREEDER_MODE_MERGE,
-	BREEDER_MODE_MERGE_ALL
+	BREEDER_MODE_MERGE
 };
 
 struct MarkupNode {
@@ -97,9 +97,11 @@ class MarkupParser:
 	public Glib::Markup::Parser
 {
 	private:
-		Gtk::Window *m_parent_;
+		Glib::RefPtr<const ImportPlan> m_plan_;
+		Glib::RefPtr<ImportConflictHandler> m_handler_;
 		Glib::RefPtr<Database> m_database_;
 		MarkupNode  *m_node_;
+		bool m_aborted_;
 
 		BreederMode m_breeder_mode_;
 		bool m_breeder_exists_;
@@ -116,13 +118,16 @@ class MarkupParser:
 		Glib::ustring m_growlog_entry_text_;
 		
 	public:
-		MarkupParser(Gtk::Window &parent,
+		MarkupParser(const Glib::RefPtr<const ImportPlan> &plan,
+		             const Glib::RefPtr<ImportConflictHandler> &handler,
 		             const Glib::RefPtr<Database> &database);
 		virtual ~MarkupParser();
 
+	public:
+		bool is_aborted() const;
+		
 	private:
-		Glib::ustring _rename_growlog(const Glib::ustring &title);
-
+		void _abort();
 		void _create_growlog();
 		time_t _parse_date(const Glib::ustring &date);
 		time_t _parse_datetime(const Glib::ustring &datetime);
@@ -146,86 +151,19 @@ class MarkupParser:
 		                      const Glib::MarkupError &error) override;
 };
 
-/******************************************************************************/
-
-class RenameGrowlogDialog:
-	public Gtk::Dialog
-{
-	private:
-		Glib::RefPtr<Database> m_database_;
-		Gtk::Entry m_title_entry_;
-	public:
-		RenameGrowlogDialog(Gtk::Window &parent,
-		                    const Glib::RefPtr<Database> &database,
-		                    const Glib::ustring &title);
-		virtual ~ RenameGrowlogDialog();
-
-	public:
-		void set_growlog_title(const Glib::ustring &title);
-		Glib::ustring get_growlog_title() const;
-
-		bool get_is_renamed() const;
-};
-
-/*******************************************************************************
- * RenameGrowlogDialog
- ******************************************************************************/
-RenameGrowlogDialog::RenameGrowlogDialog(Gtk::Window &parent,
-                                         const Glib::RefPtr<Database> &db,
-                                         const Glib::ustring &title):
-	Gtk::Dialog(_("Rename Growlog"),parent),
-	m_database_(db),
-	m_title_entry_()
-{
-	m_title_entry_.set_text(title);
-
-
-	Gtk::HBox *hbox = Gtk::manage(new Gtk::HBox());
-	Gtk::Label *label = Gtk::manage(new Gtk::Label(_("Title")));
-	hbox->pack_start(*label);
-	hbox->pack_start(m_title_entry_);
-
-	get_content_area()->pack_start(*hbox);
-
-	add_button(_("OK"), Gtk::RESPONSE_OK);
-
-	show_all();
-}
-                                         
-RenameGrowlogDialog::~RenameGrowlogDialog()
-{}
-
-void
-RenameGrowlogDialog::set_growlog_title(const Glib::ustring &title)
-{
-	m_title_entry_.set_text(title);
-}
-
-Glib::ustring
-RenameGrowlogDialog::get_growlog_title() const
-{
-	return m_title_entry_.get_text();
-}
-
-bool
-RenameGrowlogDialog::get_is_renamed() const
-{
-	Glib::RefPtr<Growlog> gl = m_database_->get_growlog(get_growlog_title());
-	if (gl)
-		return false;
-	return true;
-}
-
 /*******************************************************************************
  * MarkupParser
  ******************************************************************************/
 
-MarkupParser::MarkupParser(Gtk::Window &parent,
+MarkupParser::MarkupParser(const Glib::RefPtr<const ImportPlan> &plan,
+                           const Glib::RefPtr<ImportConflictHandler> &handler,
                            const Glib::RefPtr<Database> &db):
 	Glib::Markup::Parser(),
-	m_parent_(&parent),
+	m_plan_(plan),
+	m_handler_(handler),
 	m_database_(db),
 	m_node_(new MarkupNode()),
+	m_aborted_(false),
 	m_breeder_exists_(false),
 	m_breeder_mode_(BREEDER_MODE_UNKNOWN),
 	m_breeder_(),
@@ -250,16 +188,18 @@ MarkupParser::~MarkupParser()
 	}
 }
 
-Glib::ustring
-MarkupParser::_rename_growlog(const Glib::ustring &title)
+bool
+MarkupParser::is_aborted() const
+{
+	return m_aborted_;
+}
+
+void
+MarkupParser::_abort()
 {
-	RenameGrowlogDialog dialog(*m_parent_,m_database_,title);
-	do {
-		dialog.present();
-		dialog.run();
-	} while(!dialog.get_is_renamed());
-	dialog.hide();
-	return dialog.get_growlog_title();
+	// throwing a MarkupError is the only way to stop the GMarkup parser
+	m_aborted_ = true;
+	throw Glib::MarkupError(Glib::MarkupError::INVALID_CONTENT,_("Import aborted!"));
 }
 
 time_t
@@ -496,24 +436,17 @@ MarkupParser::on_end_element(Glib::Markup::ParseContext &context,
 			assert(element == "breeder");
 			assert(m_breeder_);
 			
-			if (m_breeder_mode_ == BREEDER_MODE_UPDATE 
-			    || m_breeder_mode_ == BREEDER_MODE_UPDATE_ALL
-			    || !m_breeder_exists_) {
+			if (m_breeder_mode_ == BREEDER_MODE_UPDATE || !m_breeder_exists_) {
 				m_database_->add_breeder(m_breeder_);
 			}
 			m_breeder_exists_ = false;
-			
-			if (m_breeder_mode_ != BREEDER_MODE_UPDATE_ALL
-			    && m_breeder_mode_ != BREEDER_MODE_MERGE_ALL)
-				m_breeder_mode_ = BREEDER_MODE_UNKNOWN;
+			m_breeder_mode_ = BREEDER_MODE_UNKNOWN;
 
 			m_breeder_ = Glib::RefPtr<Breeder>();
 			break;
 		case MARKUP_GB_BREEDERS_BREEDER_STRAINS_STRAIN:
-			if (!m_strain_->get_id()
-			    || m_breeder_mode_ == BREEDER_MODE_UPDATE
-			    || m_breeder_mode_ == BREEDER_MODE_UPDATE_ALL) {
-				
+			if (!m_strain_->get_id() || m_breeder_mode_ == BREEDER_MODE_UPDATE) {
+
 				m_database_->add_strain(m_strain_);
 			}
 			m_strain_ = Glib::RefPtr<Strain>();
@@ -585,18 +518,13 @@ MarkupParser::on_text(Glib::Markup::ParseContext &context,
 					Glib::RefPtr<Breeder> b = Breeder::create(text,"");
 					try {
 						m_database_->add_breeder(b);
-					} catch (DatabaseError ex) {
-						Gtk::MessageDialog dialog (*m_parent_,
-						                           _("Unable to add breeder to database!"),
-						                           false,
-						                           Gtk::MESSAGE_ERROR,
-						                           Gtk::BUTTONS_OK,
-						                           true);
-						dialog.set_secondary_text(ex.what());
-						dialog.run();
-						dialog.hide();
-
-						exit(EXIT_FAILURE);
+					} catch (DatabaseError &ex) {
+						Glib::ustring msg = _("Unable to add breeder to database!");
+						msg += "\n(";
+						msg += ex.what();
+						msg += ")";
+						m_handler_->warning(msg);
+						_abort();
 					}
 					m_breeder_ = m_database_->get_breeder(text);
 					m_breeder_exists_ = false;
@@ -604,34 +532,11 @@ MarkupParser::on_text(Glib::Markup::ParseContext &context,
 						m_breeder_mode_ = BREEDER_MODE_UPDATE;
  				} else {
 					m_breeder_exists_ = true;
-					if (m_breeder_mode_ != BREEDER_MODE_UPDATE_ALL 
-						&& m_breeder_mode_ != BREEDER_MODE_MERGE_ALL) {
-						
-						Glib::ustring msg_fmt = 
-							_("Breeder \"%s\" already exists!\nHow do you want to proceed?");
-						size_t msg_size = msg_fmt.bytes() + text.bytes() + 1;
-						char *msg = new char[msg_size];
-						msg[msg_size-1]='\0';
-						snprintf(msg,msg_size,msg_fmt.c_str(),text.c_str());
-						Gtk::MessageDialog dialog(*m_parent_,
-					    	                      (const char*) msg,
-					    	                      false,
-					    	                      Gtk::MESSAGE_QUESTION,
-					    	                      Gtk::BUTTONS_NONE,
-					    	                      true);
-						delete[] msg;
-						dialog.add_button(_("Merge"),BREEDER_MODE_MERGE);
-						dialog.add_button(_("Merge All"),BREEDER_MODE_MERGE_ALL);
-						dialog.add_button(_("Update"),BREEDER_MODE_UPDATE);
-						dialog.add_button(_("Update All"),BREEDER_MODE_UPDATE);
-						
-						int result = BREEDER_MODE_UNKNOWN;
-						
-						do {
-							dialog.present();
-							result = dialog.run();
-						} while (result == Gtk::RESPONSE_DELETE_EVENT);
-						m_breeder_mode_ = (BreederMode) result;
+					const ImportPlanItem *item = m_plan_->find_breeder(text);
+					if (item && item->action == IMPORT_CONFLICT_UPDATE) {
+						m_breeder_mode_ = BREEDER_MODE_UPDATE;
+					} else {
+						m_breeder_mode_ = BREEDER_MODE_MERGE;
 					}
 				} 
 			} else {
@@ -667,32 +572,12 @@ MarkupParser::on_text(Glib::Markup::ParseContext &context,
 		case MARKUP_GB_GROWLOGS_GROWLOG_TITLE: {
 			Glib::RefPtr<Growlog> gl = m_database_->get_growlog(text);
 			if (gl) {
-				Glib::ustring fmt = _("Growlog \"%s\" already exists!\nHow do you want to proceed?");
-				size_t msg_size = fmt.bytes() + text.bytes() + 1;
-				char *msg = new char[msg_size];
-				msg [msg_size -1] = '\0';
-				snprintf(msg,msg_size,fmt.c_str(),text.c_str());
-				
-				Gtk::MessageDialog dialog(*m_parent_,
-				                          (const char*) msg,
-				                          false,
-				                          Gtk::MESSAGE_QUESTION,
-				                          Gtk::BUTTONS_NONE,
-				                          true);
-				delete[] msg;
-				dialog.add_button(_("Rename"),Gtk::RESPONSE_APPLY);
-				dialog.add_button(_("Skip"),Gtk::RESPONSE_CANCEL);
-
-				int result;
-				do {
-					dialog.present();
-					result = dialog.run();
-				} while (result == Gtk::RESPONSE_DELETE_EVENT);
-				dialog.hide();
-				if (result == Gtk::RESPONSE_APPLY) 
-					m_growlog_title_ = _rename_growlog(text);
-				else
+				const ImportPlanItem *item = m_plan_->find_growlog(text);
+				if (item && item->action == IMPORT_CONFLICT_RENAME) {
+					m_growlog_title_ = item->new_title;
+				} else {
 					m_growlog_ignore_ = true;
+				}
 			} else {
 				m_growlog_title_ = text;
 			}
@@ -748,15 +633,102 @@ void
 MarkupParser::on_error(Glib::Markup::ParseContext &context,
                        const Glib::MarkupError &error)
 {
-	Gtk::MessageDialog dialog(*m_parent_,
-	                          _("Markup Error!"),
-	                          false,
-	                          Gtk::MESSAGE_ERROR,
-	                          Gtk::BUTTONS_OK,
-	                          true);
-	dialog.set_secondary_text (error.what());
-	dialog.run();
-	dialog.hide();	                          
+	if (m_aborted_)
+		return;
+	
+	Glib::ustring msg = _("Markup Error!");
+	msg += "\n(";
+	msg += error.what();
+	msg += ")";
+	m_handler_->warning(msg);
+}
+
+/*******************************************************************************
+ * MarkupScanner
+ ******************************************************************************/
+
+// Collects the breeder names and growlog titles of a file into an
+// ImportPlan and counts strains and entries, nothing else is kept.
+class MarkupScanner:
+	public Glib::Markup::Parser
+{
+	private:
+		Glib::RefPtr<ImportPlan> m_plan_;
+		std::vector<Glib::ustring> m_path_;
+
+	public:
+		MarkupScanner(const Glib::RefPtr<ImportPlan> &plan);
+		virtual ~MarkupScanner();
+
+	private:
+		bool _at(std::initializer_list<const char*> path) const;
+
+	protected:
+		virtual void on_start_element(Glib::Markup::ParseContext &context,
+		                              const Glib::ustring &element_name,
+		                              const Glib::Markup::Parser::AttributeMap &attributes) override;
+		virtual void on_end_element(Glib::Markup::ParseContext &context,
+		                            const Glib::ustring &element_name) override;
+		virtual void on_text(Glib::Markup::ParseContext &context,
+		                     const Glib::ustring &text) override;
+};
+
+MarkupScanner::MarkupScanner(const Glib::RefPtr<ImportPlan> &plan):
+	Glib::Markup::Parser(),
+	m_plan_(plan),
+	m_path_()
+{
+}
+
+MarkupScanner::~MarkupScanner()
+{
+}
+
+bool
+MarkupScanner::_at(std::initializer_list<const char*> path) const
+{
+	if (path.size() != m_path_.size())
+		return false;
+
+	auto iter = m_path_.begin();
+	for (const char *element: path) {
+		if (*iter != element)
+			return false;
+		++iter;
+	}
+	return true;
+}
+
+void
+MarkupScanner::on_start_element(Glib::Markup::ParseContext &context,
+                                const Glib::ustring &element,
+                                const Glib::Markup::Parser::AttributeMap &attributes)
+{
+	m_path_.push_back(element);
+	if (_at({"growbook","breeders","breeder","strains","strain"})) {
+		m_plan_->add_strains(1);
+	} else if (_at({"growbook","growlogs","growlog","entries","entry"})) {
+		m_plan_->add_entries(1);
+	}
+}
+
+void
+MarkupScanner::on_end_element(Glib::Markup::ParseContext &context,
+                              const Glib::ustring &element)
+{
+	if (!m_path_.empty())
+		m_path_.pop_back();
+}
+
+void
+MarkupScanner::on_text(Glib::Markup::ParseContext &context,
+                       const Glib::ustring &text)
+{
+	if (_at({"growbook","breeders","breeder","name"})) {
+		m_plan_->add_breeder(text);
+	} else if (_at({"growbook","growlogs","growlog","title"})) {
+		m_plan_->add_growlog(text);
+	}
 }
 
 /*******************************************************************************
@@ -780,26 +752,67 @@ XML_Importer::create(const Glib::RefPtr<Database> &db,
 	return Glib::RefPtr<XML_Importer>(new XML_Importer(db,filename));
 }
 
+Glib::RefPtr<ImportPlan>
+XML_Importer::scan_vfunc()
+{
+	TRACE_SCOPE("import","XML_Importer::scan_vfunc");
+	Glib::RefPtr<ImportPlan> plan = ImportPlan::create(get_database());
+	MarkupScanner scanner(plan);
+	_parse_file(scanner);
+	return plan;
+}
+
+void
+XML_Importer::import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler)
+{
+	TRACE_SCOPE("import","XML_Importer::import_vfunc");
+	assert(get_plan());
+	MarkupParser parser(get_plan(),handler,get_database());
+	try {
+		_parse_file(parser);
+	} catch (Glib::MarkupError &ex) {
+		if (!parser.is_aborted())
+			throw;
+	}
+}
+
 void
-XML_Importer::import_vfunc(Gtk::Window &parent)
+XML_Importer::_parse_file(Glib::Markup::Parser &parser)
 {
-	MarkupParser parser(parent,get_database());
 	Glib::Markup::ParseContext context(parser);
 
-	std::ifstream is(get_filename().c_str());
+	std::ifstream is(get_filename().c_str(),std::ifstream::binary);
 	if (is) {
-		size_t size=0;
-		is.seekg(0,is.end);
-		size = is.tellg();
-		is.seekg(0,is.beg);
-			
-		char *buf = new char[size + 1];
-		is.read(buf,size);
-		buf[size] = 0;
+		// gzip and zstd files are recognized by their magic number, so a
+		// renamed file is imported as well
+		char magic[4];
+		std::streamsize n_magic = is.rdbuf()->sgetn(magic,sizeof(magic));
+		is.rdbuf()->pubseekpos(0);
+
+		CompressionType compression = compression_type_for_magic(magic,(n_magic > 0 ? n_magic : 0));
+		if (!compression_is_available(compression)) {
+			Glib::ustring msg = _("Compression is not supported by this build!");
+			msg += "\n(";
+			msg += compression_type_name(compression);
+			msg += ")";
+			throw Glib::FileError(Glib::FileError::FAILED,msg);
+		}
 
-		context.parse(buf, buf+size);
+		std::unique_ptr<DecompressInputBuffer> decompress;
+		std::streambuf *source = is.rdbuf();
+		if (compression != COMPRESSION_NONE) {
+			decompress = DecompressInputBuffer::create(source,compression);
+			source = decompress.get();
+		}
 
+		// the parse context keeps its state between chunks, so the file
+		// does not have to be held in memory
+		std::vector<char> buf(XML_IMPORT_CHUNK_SIZE);
+		std::streamsize size;
+		while ((size = source->sgetn(buf.data(),buf.size())) > 0)
+			context.parse(buf.data(), buf.data() + size);
+		if (decompress && decompress->failed())
+			throw Glib::FileError(Glib::FileError::FAILED,_("Reading file failed! (The file is damaged or truncated.)"));
 		context.end_parse();
-		delete[] buf;
 	}
 }
@@ -29,6 +29,8 @@
 
 #include "import.h"
 
+#include <glibmm/markup.h>
+
 class XML_Importer:
 	public Importer
 {
@@ -47,7 +49,12 @@ class XML_Importer:
 		                                          const std::string &filename);
 
 	protected:
-		 void import_vfunc(Gtk::Window &parent);		 
+		 Glib::RefPtr<ImportPlan> scan_vfunc() override;
+		 void import_vfunc(const Glib::RefPtr<ImportConflictHandler> &handler) override;
+
+	private:
+		 // Feeds the file to parser in chunks, compressed files included.
+		 void _parse_file(Glib::Markup::Parser &parser);
 };
 
 